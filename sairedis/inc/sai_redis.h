@@ -5,15 +5,35 @@
 #include "stdio.h"
 
 #include "sai.h"
+#include "sairedis.h"
 #include "sai_serialize.h"
+#include "sai_redis_pipeline.h"
+#include "sai_redis_pipeline_pool.h"
+#include "sai_redis_transport.h"
+#include "sai_redis_attr_cache.h"
+#include "sai_redis_object_view.h"
+#include "sai_redis_notifications.h"
+#include "sai_redis_counters.h"
+#include "sai_redis_recorder.h"
+#include "sai_redis_log.h"
+#include "sai_redis_latency.h"
 
 #include "sswcommon/dbconnector.h"
 #include "sswcommon/producertable.h"
 #include "sswcommon/consumertable.h"
 
 extern service_method_table_t           g_services;
-extern ssw::DBConnector                *g_db;
-extern ssw::ProducerTable              *g_asicState;
+extern RedisTransport                  *g_asicStatePipeline;
+extern ssw::DBConnector                *g_dbRead;
+extern std::mutex                       g_dbReadMutex;
+extern RedisAttributeCache             *g_attrCache;
+extern RedisObjectView                 *g_objectView;
+extern ssw::DBConnector                *g_dbNotifications;
+extern RedisNotificationConsumer       *g_notificationConsumer;
+extern RedisCounterPoller              *g_counterPoller;
+extern std::atomic<RedisRecorder*>     g_recorder;
+extern RedisChangeJournal              *g_changeJournal;
+extern sai_serialization_format_t       g_serialization_format;
 
 extern const sai_acl_api_t              redis_acl_api;
 extern const sai_buffer_api_t           redis_buffer_api;
@@ -41,19 +61,283 @@ extern const sai_virtual_router_api_t   redis_router_api;
 extern const sai_vlan_api_t             redis_vlan_api;
 extern const sai_wred_api_t             redis_wred_api;
 
+// profile keys read in sai_api_initialize
+
+/**
+ * @brief Redis server host name or address (default "localhost")
+ */
+#define SAI_REDIS_KEY_HOST "SAI_REDIS_HOST"
+
+/**
+ * @brief Redis server TCP port (default 6379)
+ */
+#define SAI_REDIS_KEY_PORT "SAI_REDIS_PORT"
+
+/**
+ * @brief Path of redis unix domain socket, when set it is used instead
+ * of host and port
+ */
+#define SAI_REDIS_KEY_UNIX_SOCKET "SAI_REDIS_UNIX_SOCKET"
+
+/**
+ * @brief Redis database number (default 0)
+ */
+#define SAI_REDIS_KEY_DB "SAI_REDIS_DB"
+
+/**
+ * @brief Number of connections ASIC_STATE is written through, objects
+ * are assigned to connection by hash of key, operations of different
+ * objects are ordered only by sai_redis_flush/sai_redis_sync when
+ * greater than 1 (default 1)
+ */
+#define SAI_REDIS_KEY_CONNECTION_POOL_SIZE "SAI_REDIS_CONNECTION_POOL_SIZE"
+
+/**
+ * @brief ASIC_STATE serialization format, "hex" (default) or "binary"
+ */
+#define SAI_REDIS_KEY_SERIALIZATION_FORMAT "SAI_REDIS_SERIALIZATION_FORMAT"
+
+/**
+ * @brief Max number of operations written to ASIC_STATE in one batch,
+ * 1 disables batching (default 128)
+ */
+#define SAI_REDIS_KEY_BATCH_SIZE "SAI_REDIS_BATCH_SIZE"
+
+/**
+ * @brief Max time in microseconds operation waits in batch before it
+ * is written to ASIC_STATE (default 1000)
+ */
+#define SAI_REDIS_KEY_FLUSH_LATENCY "SAI_REDIS_FLUSH_LATENCY_US"
+
+/**
+ * @brief "true" enables async mode, same as SAI_REDIS_INITIALIZE_FLAG_ASYNC
+ * (default "false")
+ */
+#define SAI_REDIS_KEY_ASYNC_MODE "SAI_REDIS_ASYNC_MODE"
+
+/**
+ * @brief "false" disables attribute cache, every get reads redis
+ * (default "true"), get which reads redis first writes operations
+ * still in pipeline, so it sees every earlier create and set
+ */
+#define SAI_REDIS_KEY_ATTR_CACHE "SAI_REDIS_ATTR_CACHE"
+
+/**
+ * @brief Write combining window in microseconds, repeated sets of same
+ * attribute pending in this window are written once, 0 disables write
+ * combining (default 0)
+ */
+#define SAI_REDIS_KEY_WRITE_COMBINING_WINDOW "SAI_REDIS_WRITE_COMBINING_WINDOW_US"
+
+/**
+ * @brief Max number of events passed to single notification callback
+ * (default 256)
+ */
+#define SAI_REDIS_KEY_NOTIFICATION_BATCH_SIZE "SAI_REDIS_NOTIFICATION_BATCH_SIZE"
+
+/**
+ * @brief "false" disables latency histograms (default "true")
+ */
+#define SAI_REDIS_KEY_LATENCY_STATS "SAI_REDIS_LATENCY_STATS"
+
+/**
+ * @brief File which latency histograms are periodically written to,
+ * no dump when not set
+ */
+#define SAI_REDIS_KEY_LATENCY_DUMP_FILE "SAI_REDIS_LATENCY_DUMP_FILE"
+
+/**
+ * @brief Latency dump interval in milliseconds (default 10000)
+ */
+#define SAI_REDIS_KEY_LATENCY_DUMP_INTERVAL "SAI_REDIS_LATENCY_DUMP_INTERVAL_MS"
+
+/**
+ * @brief Snapshot file of objects written to ASIC_STATE, enables view
+ * of objects, snapshot is written on uninitialize and checkpoint and
+ * loaded when SAI_KEY_WARM_BOOT is "1", replayed creates and sets
+ * identical to loaded objects are then not written again
+ */
+#define SAI_REDIS_KEY_SNAPSHOT_FILE "SAI_REDIS_SNAPSHOT_FILE"
+
+/**
+ * @brief File which calls made through method tables are recorded to,
+ * for replay by sai_replay, no recording when not set
+ */
+#define SAI_REDIS_KEY_RECORD_FILE "SAI_REDIS_RECORD_FILE"
+
+/**
+ * @brief Transport of ASIC_STATE operations, "redis" (default) or "shm"
+ * for shared memory ring read by local consumer
+ */
+#define SAI_REDIS_KEY_TRANSPORT "SAI_REDIS_TRANSPORT"
+
+/**
+ * @brief Name of shared memory ring (default "/sairedis_asic_state")
+ */
+#define SAI_REDIS_KEY_SHM_NAME "SAI_REDIS_SHM_NAME"
+
+/**
+ * @brief Size of shared memory ring created by first of producer and
+ * consumer, in bytes (default 64 MB)
+ */
+#define SAI_REDIS_KEY_SHM_SIZE "SAI_REDIS_SHM_SIZE"
+
+/**
+ * @brief Name of shared memory change journal, when set every ASIC_STATE
+ * operation is stamped with sequence number and kept in journal, so
+ * consumer catches up by reading operations after sequence it has, no
+ * journal when not set. Journal is emptied unless SAI_KEY_WARM_BOOT is
+ * "1". Write combining is off while journal is set.
+ */
+#define SAI_REDIS_KEY_JOURNAL_NAME "SAI_REDIS_JOURNAL_NAME"
+
+/**
+ * @brief Data size of change journal created by first of producer and
+ * consumer, in bytes (default 64 MB)
+ */
+#define SAI_REDIS_KEY_JOURNAL_SIZE "SAI_REDIS_JOURNAL_SIZE"
+
+#define SAI_REDIS_DEFAULT_HOST              "localhost"
+#define SAI_REDIS_DEFAULT_PORT              6379
+#define SAI_REDIS_DEFAULT_BATCH_SIZE        128
+#define SAI_REDIS_DEFAULT_FLUSH_LATENCY     1000
+#define SAI_REDIS_DEFAULT_NOTIFICATION_BATCH_SIZE 256
+#define SAI_REDIS_DEFAULT_LATENCY_DUMP_INTERVAL 10000
+#define SAI_REDIS_DEFAULT_SHM_NAME          "/sairedis_asic_state"
+#define SAI_REDIS_DEFAULT_SHM_SIZE          (64 * 1024 * 1024)
+#define SAI_REDIS_DEFAULT_JOURNAL_SIZE      (64 * 1024 * 1024)
+
+// default of SAI_SWITCH_ATTR_COUNTER_REFRESH_INTERVAL
+#define SAI_REDIS_DEFAULT_COUNTER_REFRESH_INTERVAL 1
+
 #define UNREFERENCED_PARAMETER(X)
-#define UTILS_LOG(level, fmt, arg ...) {\
-    fprintf(stderr, "%d: ", level); \
-    fprintf(stderr, fmt, ##arg); \
-    fprintf(stderr, "\n"); }
-
-#define REDIS_LOG_ENTER()   UTILS_LOG(SAI_LOG_DEBUG, "%s: >", __FUNCTION__)
-#define REDIS_LOG_EXIT()    UTILS_LOG(SAI_LOG_DEBUG, "%s: <", __FUNCTION__)
-#define REDIS_LOG_DBG(fmt, arg ...) UTILS_LOG(SAI_LOG_DEBUG, fmt, ##arg)
-#define REDIS_LOG_INF(fmt, arg ...) UTILS_LOG(SAI_LOG_INFO, fmt, ##arg)
-#define REDIS_LOG_WRN(fmt, arg ...) UTILS_LOG(SAI_LOG_WARN, fmt, ##arg)
-#define REDIS_LOG_ERR(fmt, arg ...) UTILS_LOG(SAI_LOG_ERROR, fmt, ##arg)
-#define REDIS_LOG_NTC(fmt, arg ...) UTILS_LOG(SAI_LOG_NOTICE, fmt, ##arg)
+
+#define ASIC_STATE_TABLE    "ASIC_STATE"
+#define NOTIFICATIONS_TABLE "NOTIFICATIONS"
+
+#define SAI_REDIS_VID_OBJECT_TYPE_SHIFT     48
+#define SAI_REDIS_VID_INDEX_MASK            ((1ULL << SAI_REDIS_VID_OBJECT_TYPE_SHIFT) - 1)
+
+sai_object_id_t redis_create_virtual_object_id(
+        _In_ sai_object_type_t object_type);
+
+/**
+ * @brief Makes sure index of restored virtual id is not allocated again
+ */
+void redis_restore_virtual_object_id(
+        _In_ sai_object_id_t vid);
+
+/**
+ * @brief Creates connection to redis endpoint read from profile in
+ * sai_api_initialize
+ */
+ssw::DBConnector* redis_create_db_connector();
+
+/**
+ * @brief Replaces connection after failed reply, hiredis context is not
+ * usable after error and replies still pending on it are lost, caller
+ * holds lock which guards connection
+ */
+void redis_reconnect_db(
+        _Inout_ ssw::DBConnector *&db);
+
+sai_status_t redis_profile_get_uint64(
+        _In_ const char *key,
+        _In_ uint64_t default_value,
+        _Out_ uint64_t &value);
+
+sai_status_t redis_profile_get_bool(
+        _In_ const char *key,
+        _In_ bool default_value,
+        _Out_ bool &value);
+
+sai_status_t redis_start_notification_consumer(
+        _In_ const sai_switch_notification_t *switch_notifications);
+
+void redis_stop_notification_consumer();
+
+sai_status_t internal_redis_serialize_attr_list(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t attr_count,
+        _In_ const sai_attribute_t *attr_list,
+        _Out_ std::vector<ssw::FieldValueTuple> &entry);
+
+/**
+ * @brief Makes cache and view forget object whose write to ASIC_STATE
+ * failed, so get reads redis and replay writes object again
+ */
+void redis_evict_unwritten_object(
+        _In_ const std::string &key);
+
+// bulk methods, instantiated for fdb, neighbor and route entries
+
+template<typename T>
+sai_status_t redis_bulk_generic_create(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const T *entries,
+        _In_ const uint32_t *attr_counts,
+        _In_ const sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+template<typename T>
+sai_status_t redis_bulk_generic_remove(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const T *entries,
+        _Out_ sai_status_t *statuses);
+
+template<typename T>
+sai_status_t redis_bulk_generic_set(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const T *entries,
+        _In_ const sai_attribute_t *attr_list,
+        _Out_ sai_status_t *statuses);
+
+template<typename T>
+sai_status_t redis_bulk_generic_get(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const T *entries,
+        _In_ const uint32_t *attr_counts,
+        _Inout_ sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t internal_redis_bulk_generic_get(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::vector<std::string> &serialized_object_ids,
+        _In_ const uint32_t *attr_counts,
+        _Inout_ sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+// statistics counters, served by counter poller
+
+sai_status_t redis_generic_get_stats(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_object_id_t object_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids,
+        _Out_ uint64_t *counters);
+
+sai_status_t redis_generic_get_stats_vlan(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_vlan_id_t vlan_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids,
+        _Out_ uint64_t *counters);
+
+sai_status_t redis_generic_clear_stats(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_object_id_t object_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids);
+
+sai_status_t redis_generic_clear_stats_vlan(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_vlan_id_t vlan_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids);
 
 // separate methods are needed for vlan to not confuse with object_id
 
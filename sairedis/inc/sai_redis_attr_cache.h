@@ -0,0 +1,102 @@
+#ifndef __SAI_REDIS_ATTR_CACHE__
+#define __SAI_REDIS_ATTR_CACHE__
+
+#include "sai.h"
+#include "sairedis.h"
+
+#include "sswcommon/table.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+// must be power of 2
+#define SAI_REDIS_ATTR_CACHE_SHARDS 16
+
+/**
+ * @brief Write-through cache of attributes written to ASIC_STATE
+ *
+ * Objects are keyed by serialized ASIC_STATE key, attributes keep
+ * serialized value as it was written so get only deserializes it.
+ * Create and set populate the cache, remove evicts the object. Read
+ * only attributes are never cached since only switch knows them.
+ *
+ * Objects are split to shards by hash of key, each with own lock, so
+ * threads working on different objects rarely contend.
+ */
+class RedisAttributeCache
+{
+    public:
+
+        RedisAttributeCache();
+
+        static bool isCacheable(
+                _In_ sai_object_type_t object_type,
+                _In_ sai_attr_id_t attr_id);
+
+        /**
+         * @brief Replaces cached object, entry[i] is serialized
+         * attr_list[i]
+         */
+        void create(
+                _In_ sai_object_type_t object_type,
+                _In_ const std::string &key,
+                _In_ uint32_t attr_count,
+                _In_ const sai_attribute_t *attr_list,
+                _In_ const std::vector<ssw::FieldValueTuple> &entry);
+
+        void set(
+                _In_ sai_object_type_t object_type,
+                _In_ const std::string &key,
+                _In_ sai_attr_id_t attr_id,
+                _In_ const std::string &value);
+
+        void remove(
+                _In_ const std::string &key);
+
+        /**
+         * @brief Looks up serialized attribute value, counts hit or miss
+         */
+        bool get(
+                _In_ const std::string &key,
+                _In_ sai_attr_id_t attr_id,
+                _Out_ std::string &value);
+
+        void clear();
+
+        void getStats(
+                _Out_ sai_redis_attr_cache_stats_t &stats);
+
+    private:
+
+        RedisAttributeCache(const RedisAttributeCache&);
+        RedisAttributeCache& operator=(const RedisAttributeCache&);
+
+        typedef std::unordered_map<sai_attr_id_t, std::string> AttributeMap;
+
+        struct Shard
+        {
+            Shard(): hits(0), misses(0)
+            {
+            }
+
+            std::unordered_map<std::string, AttributeMap> objects;
+
+            std::mutex mutex;
+
+            // counted per shard, so gets of different objects do not all
+            // update one counter
+            std::atomic<uint64_t> hits;
+
+            std::atomic<uint64_t> misses;
+        };
+
+        Shard& shard(
+                _In_ const std::string &key);
+
+        Shard m_shards[SAI_REDIS_ATTR_CACHE_SHARDS];
+};
+
+#endif // __SAI_REDIS_ATTR_CACHE__
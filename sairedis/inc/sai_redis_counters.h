@@ -0,0 +1,198 @@
+#ifndef __SAI_REDIS_COUNTERS__
+#define __SAI_REDIS_COUNTERS__
+
+#include "sai.h"
+#include "sairedis.h"
+
+#include "sswcommon/dbconnector.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+/**
+ * Counters are written by switch side to COUNTERS table, one hash for
+ * each object, key is same serialized object key as in ASIC_STATE:
+ *
+ *  COUNTERS:<object key>  field is counter id in decimal, value is
+ *                         counter value in decimal
+ *
+ * Only counter ids below SAI_REDIS_COUNTERS_MAX are supported, custom
+ * range counters are not.
+ */
+#define COUNTERS_TABLE "COUNTERS"
+
+#define SAI_REDIS_COUNTERS_MAX 128
+
+/**
+ * @brief Counter poller
+ *
+ * Objects are registered by first read of their counters, which goes
+ * to redis directly. Poller thread then reads counters of all registered
+ * objects each interval in one pipeline into snapshot which is not
+ * visible to readers, and publishes it when complete. Reads are served
+ * from published snapshot and never wait for redis or poller.
+ *
+ * Clear is done in process, cleared value is kept as baseline which is
+ * subtracted from values read later.
+ */
+class RedisCounterPoller
+{
+    public:
+
+        /**
+         * @param db - connection to COUNTERS, poller owns it and
+         * replaces it after failed reply
+         * @param interval_ms - poll interval, 0 disables polling and
+         * every read goes to redis
+         */
+        RedisCounterPoller(
+                _In_ ssw::DBConnector *db,
+                _In_ uint64_t interval_ms);
+
+        ~RedisCounterPoller();
+
+        void setInterval(
+                _In_ uint64_t interval_ms);
+
+        /**
+         * @param timestamp_ns - monotonic time counters were read at,
+         * may be NULL
+         */
+        sai_status_t get(
+                _In_ sai_object_type_t object_type,
+                _In_ const std::string &serialized_object_id,
+                _In_ uint32_t number_of_counters,
+                _In_ const int32_t *counter_ids,
+                _Out_ uint64_t *counters,
+                _Out_ uint64_t *timestamp_ns);
+
+        /**
+         * @param counter_ids - NULL clears all counters of object
+         */
+        sai_status_t clear(
+                _In_ sai_object_type_t object_type,
+                _In_ const std::string &serialized_object_id,
+                _In_ uint32_t number_of_counters,
+                _In_ const int32_t *counter_ids);
+
+        void getStats(
+                _Out_ sai_redis_counter_stats_t &stats) const;
+
+    private:
+
+        RedisCounterPoller(const RedisCounterPoller&);
+        RedisCounterPoller& operator=(const RedisCounterPoller&);
+
+        struct Values
+        {
+            uint64_t counters[SAI_REDIS_COUNTERS_MAX];
+
+            // bit set for counters present in redis
+            uint64_t present[SAI_REDIS_COUNTERS_MAX / 64];
+        };
+
+        struct Object
+        {
+            std::string tableKey;
+
+            // index of object in snapshot
+            size_t slot;
+
+            // raw values at last clear, subtracted on read
+            std::atomic<uint64_t> baseline[SAI_REDIS_COUNTERS_MAX];
+        };
+
+        struct Snapshot
+        {
+            // 0 until first poll
+            uint64_t timestamp;
+
+            std::vector<Values> values;
+
+            std::atomic<uint32_t> readers;
+        };
+
+        Object* getObject(
+                _In_ sai_object_type_t object_type,
+                _In_ const std::string &serialized_object_id);
+
+        /**
+         * @brief Reads raw values of object from published snapshot or
+         * from redis when object is not in snapshot yet
+         *
+         * @param counter_ids - NULL reads all counters, missing counters
+         * are then 0
+         */
+        sai_status_t read(
+                _In_ const Object &object,
+                _In_ uint32_t number_of_counters,
+                _In_ const int32_t *counter_ids,
+                _Out_ uint64_t *values,
+                _Out_ uint64_t &timestamp);
+
+        sai_status_t readDirect(
+                _In_ const Object &object,
+                _Out_ Values &values);
+
+        static sai_status_t pick(
+                _In_ const Values &values,
+                _In_ uint32_t number_of_counters,
+                _In_ const int32_t *counter_ids,
+                _Out_ uint64_t *counters);
+
+        static bool parseReply(
+                _In_ const redisReply *reply,
+                _Out_ Values &values);
+
+        void pollerThread();
+
+        /**
+         * @return error when reply failed, previous snapshot stays
+         * published
+         */
+        sai_status_t poll();
+
+        ssw::DBConnector *m_db;
+
+        // serializes poller and direct reads on connection
+        std::mutex m_dbMutex;
+
+        mutable std::mutex m_objectsMutex;
+
+        std::unordered_map<std::string, std::unique_ptr<Object>> m_objects;
+
+        // registered objects by slot, only grows
+        std::vector<Object*> m_slots;
+
+        // poller copy of slots, reused by all polls
+        std::vector<Object*> m_pollSlots;
+
+        Snapshot m_snapshots[2];
+
+        // index of published snapshot
+        std::atomic<uint32_t> m_published;
+
+        std::mutex m_intervalMutex;
+
+        std::condition_variable m_intervalCv;
+
+        std::atomic<uint64_t> m_intervalMs;
+
+        bool m_running;
+
+        std::atomic<uint64_t> m_polls;
+        std::atomic<uint64_t> m_pollErrors;
+        std::atomic<uint64_t> m_lastPollNs;
+        std::atomic<uint64_t> m_snapshotReads;
+        std::atomic<uint64_t> m_directReads;
+
+        std::thread m_thread;
+};
+
+#endif // __SAI_REDIS_COUNTERS__
@@ -0,0 +1,286 @@
+#ifndef __SAI_REDIS_JOURNAL__
+#define __SAI_REDIS_JOURNAL__
+
+#include "sai.h"
+#include "sai_serialize.h"
+
+#include "sswcommon/table.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+#define SAI_REDIS_JOURNAL_MAGIC     0x4c4e52554f4a5253ULL   // "SRJOURNL"
+#define SAI_REDIS_JOURNAL_VERSION   2
+
+/*
+ * Shared memory segment layout, header followed by index of entries
+ * and data of capacity bytes, both sizes are powers of 2:
+ *
+ * header:  u64 magic, u32 version, u32 reserved, u64 capacity,
+ *          u64 entries, u64 id, then sequence, first, next, head and
+ *          tail, written by different writers on own cache lines
+ * index:   u64 sequence, u64 position of its record, at s % entries,
+ *          sequence has top bit set while its writer stores entry
+ * record:  u64 position | 1, u64 sequence, u32 length of parts,
+ *          u32 flags, then parts, aligned to 8 bytes
+ * part:    u32 length, length bytes
+ *
+ * Writers reserve sequences by fetch add on sequence and space in data
+ * by compare and swap on tail, so records lie in data in order space
+ * was taken, not in sequence order. Record is never split, when it
+ * does not fit in rest of data rest is padded by record with pad flag,
+ * or skipped when shorter than record header. Position word is stored
+ * last, so writer which trims data waits until record at head is
+ * written. Index entry of sequence is stored when record is written or
+ * when sequence is skipped, next moves past entries stored without
+ * gap, so readers see only prefix where every sequence is decided.
+ * Writer claims index entry by compare and swap of its sequence, so
+ * truncate can decide sequences of writers which never finish.
+ *
+ * Writer moves first past records before it overwrites them or their
+ * index entries, reader which copied record checks first afterwards,
+ * so overwritten copy is never used.
+ */
+
+#define SAI_REDIS_JOURNAL_ALIGN     8
+
+typedef struct _sai_redis_journal_header_t
+{
+    uint64_t magic;
+
+    uint32_t version;
+
+    uint32_t reserved;
+
+    uint64_t capacity;
+
+    uint64_t entries;
+
+    // chosen when segment is created, sequences of different segments
+    // are not comparable
+    uint64_t id;
+
+    char padding0[24];
+
+    // sequence reserved by next writer
+    std::atomic<uint64_t> sequence;
+
+    char padding1[56];
+
+    // oldest sequence in journal, first >= next when journal is empty
+    std::atomic<uint64_t> first;
+
+    // sequences before next have record or were skipped
+    std::atomic<uint64_t> next;
+
+    char padding2[48];
+
+    // positions of oldest record and after newest record
+    std::atomic<uint64_t> head;
+
+    std::atomic<uint64_t> tail;
+
+    char padding3[48];
+
+} sai_redis_journal_header_t;
+
+typedef struct _sai_redis_journal_entry_t
+{
+    // stored last, entry belongs to this sequence
+    std::atomic<uint64_t> sequence;
+
+    std::atomic<uint64_t> position;
+
+} sai_redis_journal_entry_t;
+
+/**
+ * @brief Bounded journal of ASIC_STATE operations in POSIX shared
+ * memory, numbered by sequence
+ *
+ * Any number of writers reserve sequences and append operations framed
+ * as by transport without lock, oldest records are trimmed when data
+ * or index is full. Any number of readers in other processes read
+ * changes after sequence they already have, without consuming them,
+ * cost is proportional to number of changes read. Sequences start at 1
+ * and grow by 1, every reserved sequence is either appended, skipped
+ * or truncated by its writer, or truncated by later truncate when its
+ * writer never finished. Writer waits at most a second for older
+ * sequence to be decided, then truncates journal up to its own.
+ *
+ * Does not depend on rest of sairedis, so consumer process links it
+ * with ring and shared memory consumer alone.
+ */
+class RedisChangeJournal
+{
+    public:
+
+        RedisChangeJournal();
+
+        ~RedisChangeJournal();
+
+        /**
+         * @brief Maps segment, creates and initializes it when it does
+         * not exist yet
+         *
+         * @param size - data size of created segment, rounded up to
+         * power of 2, existing segment keeps its size and content
+         */
+        sai_status_t open(
+                _In_ const std::string &name,
+                _In_ uint64_t size);
+
+        void close();
+
+        /**
+         * @brief Removes segment name, mapped segments stay valid
+         */
+        static void unlink(
+                _In_ const std::string &name);
+
+        /**
+         * @brief Reserves count consecutive sequences, thread safe
+         *
+         * @return first of them
+         */
+        uint64_t reserve(
+                _In_ uint32_t count);
+
+        /**
+         * @brief Sequence which next reserve gets
+         */
+        uint64_t nextSequence() const;
+
+        /**
+         * @brief Appends record of reserved sequence, trims oldest
+         * records to make space, thread safe
+         *
+         * @return false when sequence is truncated instead, record is
+         * larger than half of journal, sequence was truncated already,
+         * or writer of older sequence did not finish in time
+         */
+        bool append(
+                _In_ uint64_t sequence,
+                _In_ uint32_t count,
+                _In_ const sai_serialized_view_t *parts);
+
+        /**
+         * @brief Marks reserved sequence as skipped, its operation was
+         * not written, readers pass it, thread safe
+         */
+        void skip(
+                _In_ uint64_t sequence);
+
+        /**
+         * @brief Drops all records up to reserved sequence and leaves
+         * it and every earlier sequence not appended or skipped yet
+         * without record, so reader of any earlier sequence resyncs,
+         * thread safe
+         */
+        void truncate(
+                _In_ uint64_t sequence);
+
+        /**
+         * @brief Reads up to max_count operations following sequence
+         * after, decoded same as ConsumerTable pop, skipped sequences
+         * are passed
+         *
+         * @param last - last sequence read, after when there are none
+         *
+         * @return SAI_STATUS_SUCCESS, changes are empty when reader
+         * has everything written so far, SAI_STATUS_ITEM_NOT_FOUND
+         * when operations following after were trimmed or after is not
+         * from this journal, reader has to resync
+         */
+        sai_status_t read(
+                _In_ uint64_t after,
+                _In_ size_t max_count,
+                _Out_ std::vector<ssw::KeyOpFieldsValuesTuple> &changes,
+                _Out_ uint64_t &last);
+
+        /**
+         * @brief Returns true when sequence is still in journal and was
+         * skipped, so consumer will never see its operation
+         */
+        bool isSkipped(
+                _In_ uint64_t sequence) const;
+
+        uint64_t id() const;
+
+        /**
+         * @brief Oldest sequence in journal
+         */
+        uint64_t firstSequence() const;
+
+        /**
+         * @brief Newest sequence readers can read, first - 1 or less
+         * when journal is empty
+         */
+        uint64_t lastSequence() const;
+
+        /**
+         * @brief Bytes of data used by records
+         */
+        uint64_t used() const;
+
+        uint64_t capacity() const;
+
+        /**
+         * @brief Number of truncate calls made through this mapping
+         */
+        uint64_t truncations() const;
+
+    private:
+
+        RedisChangeJournal(const RedisChangeJournal&);
+        RedisChangeJournal& operator=(const RedisChangeJournal&);
+
+        sai_redis_journal_entry_t& entry(
+                _In_ uint64_t sequence) const
+        {
+            return m_index[sequence & (m_entries - 1)];
+        }
+
+        std::atomic<uint64_t>& word(
+                _In_ uint64_t position) const
+        {
+            return *reinterpret_cast<std::atomic<uint64_t>*>(m_data + (position & (m_capacity - 1)));
+        }
+
+        uint64_t allocate(
+                _In_ uint64_t size);
+
+        void trimHead(
+                _In_ uint64_t head);
+
+        void raiseFirst(
+                _In_ uint64_t sequence);
+
+        void advance();
+
+        bool store(
+                _In_ uint64_t sequence,
+                _In_ uint64_t position);
+
+        bool publish(
+                _In_ uint64_t sequence,
+                _In_ uint64_t position);
+
+        sai_redis_journal_header_t *m_header;
+
+        sai_redis_journal_entry_t *m_index;
+
+        char *m_data;
+
+        uint64_t m_capacity;
+
+        uint64_t m_entries;
+
+        size_t m_mappedSize;
+
+        std::atomic<uint64_t> m_truncations;
+
+        std::string m_record;
+};
+
+#endif // __SAI_REDIS_JOURNAL__
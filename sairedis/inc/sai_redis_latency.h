@@ -0,0 +1,61 @@
+#ifndef __SAI_REDIS_LATENCY__
+#define __SAI_REDIS_LATENCY__
+
+#include "sai.h"
+#include "sairedis.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Latency recording enabled, SAI_REDIS_LATENCY_STATS profile key
+ */
+extern std::atomic<bool> g_latencyEnabled;
+
+/**
+ * @brief Returns monotonic time in nanoseconds, 0 when recording is
+ * disabled, so disabled recording costs single load
+ */
+inline uint64_t redis_latency_now()
+{
+    if (!g_latencyEnabled.load(std::memory_order_relaxed))
+    {
+        return 0;
+    }
+
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Records sample into histogram shard of calling thread, takes
+ * no locks, start of 0 (recording was disabled) is ignored
+ */
+void redis_latency_record(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_common_api_t api,
+        _In_ bool bulk,
+        _In_ sai_redis_latency_phase_t phase,
+        _In_ uint64_t start,
+        _In_ uint64_t end);
+
+/**
+ * @brief Merges shards of all threads into summary of each histogram
+ * with samples
+ */
+void redis_latency_snapshot(
+        _Out_ std::vector<sai_redis_latency_stats_t> &stats);
+
+/**
+ * @brief Starts thread writing snapshot to file every interval, file
+ * is replaced atomically, empty path stops dump
+ */
+void redis_latency_start_dump(
+        _In_ const std::string &path,
+        _In_ uint64_t interval_ms);
+
+void redis_latency_stop_dump();
+
+#endif // __SAI_REDIS_LATENCY__
@@ -0,0 +1,85 @@
+#ifndef __SAI_REDIS_LOG__
+#define __SAI_REDIS_LOG__
+
+#include <atomic>
+
+#include "sai.h"
+
+/**
+ * @brief Number of entries in log level table, indexed by sai_api_t
+ */
+#define SAI_REDIS_LOG_API_COUNT     (SAI_API_TUNNEL + 1)
+
+/**
+ * @brief Max length of single message, longer messages are truncated
+ */
+#define SAI_REDIS_LOG_MESSAGE_SIZE  240
+
+/**
+ * @brief Log level of each api, set by sai_log_set, SAI_API_UNSPECIFIED
+ * is used by code shared between apis (default SAI_LOG_WARN)
+ */
+extern std::atomic<int> g_logLevel[SAI_REDIS_LOG_API_COUNT];
+
+/*
+ * Api of messages logged in translation unit, defined before including
+ * sai_redis.h, for example:
+ *
+ * #define REDIS_LOG_API SAI_API_ROUTE
+ */
+#ifndef REDIS_LOG_API
+#define REDIS_LOG_API SAI_API_UNSPECIFIED
+#endif
+
+inline bool redis_log_enabled(
+        _In_ sai_api_t api,
+        _In_ sai_log_level_t level)
+{
+    return (int)level >= g_logLevel[api].load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Formats message into log ring buffer, never blocks, message
+ * is dropped when buffer is full
+ */
+void redis_log_write(
+        _In_ sai_api_t api,
+        _In_ sai_log_level_t level,
+        _In_ const char *format,
+        ...) __attribute__ ((format (printf, 3, 4)));
+
+/**
+ * @brief Starts thread writing log ring buffer to stderr, until then
+ * messages are written by logging thread itself
+ */
+void redis_log_start();
+
+/**
+ * @brief Stops log thread and writes remaining messages
+ */
+void redis_log_stop();
+
+#define UTILS_LOG(level, fmt, arg ...) do {\
+    if (redis_log_enabled(REDIS_LOG_API, level)) \
+        redis_log_write(REDIS_LOG_API, level, fmt, ##arg); } while (0)
+
+// configure --disable-debug-log removes debug messages at compile time,
+// arguments are still checked, but code is eliminated
+
+#ifdef SAI_REDIS_NO_DEBUG_LOG
+#define REDIS_LOG_ENTER()
+#define REDIS_LOG_EXIT()
+#define REDIS_LOG_DBG(fmt, arg ...) do {\
+    if (0) redis_log_write(REDIS_LOG_API, SAI_LOG_DEBUG, fmt, ##arg); } while (0)
+#else
+#define REDIS_LOG_ENTER()   UTILS_LOG(SAI_LOG_DEBUG, "%s: >", __FUNCTION__)
+#define REDIS_LOG_EXIT()    UTILS_LOG(SAI_LOG_DEBUG, "%s: <", __FUNCTION__)
+#define REDIS_LOG_DBG(fmt, arg ...) UTILS_LOG(SAI_LOG_DEBUG, fmt, ##arg)
+#endif
+
+#define REDIS_LOG_INF(fmt, arg ...) UTILS_LOG(SAI_LOG_INFO, fmt, ##arg)
+#define REDIS_LOG_WRN(fmt, arg ...) UTILS_LOG(SAI_LOG_WARN, fmt, ##arg)
+#define REDIS_LOG_ERR(fmt, arg ...) UTILS_LOG(SAI_LOG_ERROR, fmt, ##arg)
+#define REDIS_LOG_NTC(fmt, arg ...) UTILS_LOG(SAI_LOG_NOTICE, fmt, ##arg)
+
+#endif // __SAI_REDIS_LOG__
@@ -0,0 +1,97 @@
+#ifndef __SAI_REDIS_MPSC_QUEUE__
+#define __SAI_REDIS_MPSC_QUEUE__
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief Lock-free multiple producer single consumer queue
+ *
+ * Unbounded linked list with stub node. Push is single atomic
+ * exchange and never blocks, pop may be called only from one thread.
+ * Pop can transiently see queue empty while push is in progress, item
+ * is visible after that push returns.
+ */
+template<typename T>
+class MpscQueue
+{
+    public:
+
+        MpscQueue():
+            m_head(new Node()),
+            m_tail(m_head.load(std::memory_order_relaxed))
+        {
+        }
+
+        ~MpscQueue()
+        {
+            T item;
+
+            while (pop(item))
+            {
+            }
+
+            delete m_tail;
+        }
+
+        void push(
+                _In_ T &&item)
+        {
+            Node *node = new Node(std::move(item));
+
+            Node *prev = m_head.exchange(node, std::memory_order_seq_cst);
+
+            prev->next.store(node, std::memory_order_seq_cst);
+        }
+
+        bool pop(
+                _Out_ T &item)
+        {
+            Node *next = m_tail->next.load(std::memory_order_seq_cst);
+
+            if (next == NULL)
+            {
+                return false;
+            }
+
+            item = std::move(next->item);
+
+            delete m_tail;
+
+            // next becomes new stub
+            m_tail = next;
+
+            return true;
+        }
+
+        bool empty() const
+        {
+            return m_tail->next.load(std::memory_order_seq_cst) == NULL;
+        }
+
+    private:
+
+        MpscQueue(const MpscQueue&);
+        MpscQueue& operator=(const MpscQueue&);
+
+        struct Node
+        {
+            Node(): next(NULL)
+            {
+            }
+
+            Node(T &&i): next(NULL), item(std::move(i))
+            {
+            }
+
+            std::atomic<Node*> next;
+
+            T item;
+        };
+
+        std::atomic<Node*> m_head;
+
+        Node *m_tail;
+};
+
+#endif // __SAI_REDIS_MPSC_QUEUE__
@@ -0,0 +1,111 @@
+#ifndef __SAI_REDIS_NOTIFICATIONS__
+#define __SAI_REDIS_NOTIFICATIONS__
+
+#include "sai.h"
+#include "sairedis.h"
+#include "sai_serialize.h"
+
+#include "sswcommon/dbconnector.h"
+#include "sswcommon/consumertable.h"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+/**
+ * Notifications are written by switch side to NOTIFICATIONS table with
+ * producer set, op is notification name:
+ *
+ *  "fdb_event"          key is serialized sai_fdb_event_t followed by
+ *                       sai_fdb_entry_t, fields are fdb attributes in
+ *                       same format as in ASIC_STATE
+ *
+ *  "port_state_change"  key is serialized
+ *                       sai_port_oper_status_notification_t
+ */
+#define SAI_REDIS_NOTIFICATION_FDB_EVENT            "fdb_event"
+#define SAI_REDIS_NOTIFICATION_PORT_STATE_CHANGE    "port_state_change"
+
+/**
+ * @brief Notification consumer thread
+ *
+ * Thread drains all pending notifications after each wakeup and calls
+ * switch notification callbacks with arrays of up to batch size events
+ * of same kind, order of events is kept. Event arrays, attributes and
+ * their lists are kept in buffers reused by all batches, so they are
+ * valid only during callback. Callbacks are called from consumer
+ * thread.
+ */
+class RedisNotificationConsumer
+{
+    public:
+
+        RedisNotificationConsumer(
+                _In_ ssw::DBConnector *db,
+                _In_ const std::string &table_name,
+                _In_ const sai_switch_notification_t &notifications,
+                _In_ size_t batch_size);
+
+        ~RedisNotificationConsumer();
+
+        void getStats(
+                _Out_ sai_redis_notification_stats_t &stats) const;
+
+    private:
+
+        RedisNotificationConsumer(const RedisNotificationConsumer&);
+        RedisNotificationConsumer& operator=(const RedisNotificationConsumer&);
+
+        void consumerThread();
+
+        void drain();
+
+        void handleFdbEvent(
+                _In_ const ssw::KeyOpFieldsValuesTuple &kco);
+
+        void handlePortStateChange(
+                _In_ const ssw::KeyOpFieldsValuesTuple &kco);
+
+        void deliverFdbEvents();
+
+        void deliverPortStateChanges();
+
+        void updateBatchHighWaterMark(
+                _In_ uint64_t count);
+
+        ssw::ConsumerTable m_consumer;
+
+        sai_switch_notification_t m_notifications;
+
+        size_t m_batchSize;
+
+        // buffers reused by all batches
+
+        ssw::KeyOpFieldsValuesTuple m_kco;
+
+        std::vector<sai_fdb_event_notification_data_t> m_fdbEvents;
+
+        // attributes of all events in batch, contiguous in event order
+        std::vector<sai_attribute_t> m_fdbAttributes;
+
+        std::vector<sai_serialized_view_t> m_views;
+
+        SaiDeserializeContext m_context;
+
+        std::vector<sai_port_oper_status_notification_t> m_portEvents;
+
+        std::atomic<uint64_t> m_fdbEventCount;
+        std::atomic<uint64_t> m_portEventCount;
+        std::atomic<uint64_t> m_batches;
+        std::atomic<uint64_t> m_batchHighWaterMark;
+        std::atomic<uint64_t> m_backlogHighWaterMark;
+        std::atomic<uint64_t> m_droppedMalformed;
+        std::atomic<uint64_t> m_droppedUnhandled;
+
+        std::atomic<bool> m_running;
+
+        std::thread m_thread;
+};
+
+#endif // __SAI_REDIS_NOTIFICATIONS__
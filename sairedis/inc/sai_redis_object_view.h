@@ -0,0 +1,170 @@
+#ifndef __SAI_REDIS_OBJECT_VIEW__
+#define __SAI_REDIS_OBJECT_VIEW__
+
+#include "sai.h"
+#include "sairedis.h"
+#include "sai_serialize.h"
+
+#include "sswcommon/table.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+// must be power of 2
+#define SAI_REDIS_OBJECT_VIEW_SHARDS 16
+
+/**
+ * @brief View of every object written to ASIC_STATE
+ *
+ * Objects are keyed by serialized ASIC_STATE key and keep serialized
+ * fields and values exactly as they were written. Create and set which
+ * would write what is already in view are reported as identical, so
+ * caller can skip the write.
+ *
+ * View is saved to snapshot file and loaded back on warm boot. Objects
+ * with virtual id loaded from snapshot are not known to caller until
+ * it replays their create, claim() hands out restored id of object of
+ * same type with identical attributes. Attributes are the only thing
+ * which tells objects apart, so claim is limited to object types whose
+ * restored objects all have unique attributes. Type with two restored
+ * objects of identical attributes, like next hops of same ip, is not
+ * claimed at all and its replayed creates get new ids.
+ *
+ * Snapshot file is header followed by records, each record carries
+ * SAI_COMMON_API_CREATE, SET or REMOVE and is applied in order on load,
+ * so records can be appended to existing snapshot. Save writes one
+ * create record per object.
+ */
+class RedisObjectView
+{
+    public:
+
+        RedisObjectView();
+
+        /**
+         * @brief Replaces object, vid is SAI_NULL_OBJECT_ID for objects
+         * not identified by object id
+         *
+         * @return true when identical object was already in view
+         */
+        bool create(
+                _In_ sai_object_type_t object_type,
+                _In_ sai_object_id_t vid,
+                _In_ const std::string &key,
+                _In_ const std::vector<ssw::FieldValueTuple> &entry);
+
+        /**
+         * @return true when object already had attribute with same value
+         */
+        bool set(
+                _In_ sai_object_type_t object_type,
+                _In_ const std::string &key,
+                _In_ const ssw::FieldValueTuple &value);
+
+        void remove(
+                _In_ const std::string &key);
+
+        bool hasUnclaimed(
+                _In_ sai_object_type_t object_type) const;
+
+        /**
+         * @brief Finds restored object with identical attributes which
+         * was not claimed yet, only for object types whose restored
+         * objects have unique attributes
+         *
+         * @return Virtual id of object, SAI_NULL_OBJECT_ID when none
+         */
+        sai_object_id_t claim(
+                _In_ sai_object_type_t object_type,
+                _In_ const std::vector<ssw::FieldValueTuple> &entry);
+
+        /**
+         * @brief Writes snapshot through memory mapping of temporary
+         * file, which then replaces path
+         */
+        sai_status_t save(
+                _In_ const std::string &path,
+                _In_ sai_serialization_format_t format);
+
+        /**
+         * @brief Loads snapshot into empty view, snapshot written in
+         * other serialization format is ignored
+         */
+        sai_status_t load(
+                _In_ const std::string &path,
+                _In_ sai_serialization_format_t format);
+
+        void getStats(
+                _Out_ sai_redis_view_stats_t &stats);
+
+    private:
+
+        RedisObjectView(const RedisObjectView&);
+        RedisObjectView& operator=(const RedisObjectView&);
+
+        typedef std::map<std::string, std::string> AttributeMap;
+
+        struct Object
+        {
+            sai_object_type_t objectType;
+
+            // SAI_NULL_OBJECT_ID when object was not created with id
+            sai_object_id_t vid;
+
+            AttributeMap attributes;
+        };
+
+        struct Shard
+        {
+            std::unordered_map<std::string, Object> objects;
+
+            std::mutex mutex;
+        };
+
+        Shard& shard(
+                _In_ const std::string &key);
+
+        static bool isIdentical(
+                _In_ const AttributeMap &attributes,
+                _In_ const std::vector<ssw::FieldValueTuple> &entry);
+
+        static void signature(
+                _In_ sai_object_type_t object_type,
+                _In_ const AttributeMap &attributes,
+                _Out_ std::string &str);
+
+        void apply(
+                _In_ sai_common_api_t api,
+                _In_ sai_object_type_t object_type,
+                _In_ sai_object_id_t vid,
+                _In_ const std::string &key,
+                _In_ const std::vector<ssw::FieldValueTuple> &entry);
+
+        struct Restored
+        {
+            sai_object_type_t objectType;
+
+            sai_object_id_t vid;
+
+            std::string key;
+        };
+
+        Shard m_shards[SAI_REDIS_OBJECT_VIEW_SHARDS];
+
+        // restored objects not claimed yet, by signature
+        std::unordered_map<std::string, Restored> m_unclaimed;
+
+        std::mutex m_unclaimedMutex;
+
+        std::atomic<uint64_t> m_unclaimedCount[SAI_OBJECT_TYPE_MAX];
+
+        std::atomic<uint64_t> m_restored;
+
+        std::atomic<uint64_t> m_absorbed;
+};
+
+#endif // __SAI_REDIS_OBJECT_VIEW__
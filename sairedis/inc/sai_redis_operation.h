@@ -0,0 +1,57 @@
+#ifndef __SAI_REDIS_OPERATION__
+#define __SAI_REDIS_OPERATION__
+
+#include "sai.h"
+
+#include <string>
+
+/**
+ * @brief ASIC_STATE operation framed as by ProducerTable set/del, key,
+ * value and op strings, with description used by write combining and
+ * latency statistics
+ */
+struct RedisOperation
+{
+    std::string key;
+    std::string value;
+    std::string op;
+
+    // describes operation for write combining, api is
+    // SAI_COMMON_API_MAX when operation can't be combined
+
+    sai_object_type_t objectType;
+    sai_common_api_t api;
+    sai_attr_id_t attrId;
+
+    bool dropped;
+
+    // for latency statistics, 0 when recording is disabled
+    uint64_t enqueueTime;
+
+    bool bulk;
+
+    // change journal sequence stamped in op, 0 when not journaled
+    uint64_t sequence;
+};
+
+/**
+ * @brief Gets every operation transport took, once it is written or
+ * writing it failed
+ *
+ * Operation combined away is reported with dropped set, it is never
+ * written. Operations bulk leaves to its caller are not reported.
+ */
+class RedisWriteListener
+{
+    public:
+
+        virtual ~RedisWriteListener()
+        {
+        }
+
+        virtual void written(
+                _In_ const RedisOperation &operation,
+                _In_ sai_status_t status) = 0;
+};
+
+#endif // __SAI_REDIS_OPERATION__
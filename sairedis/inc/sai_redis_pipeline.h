@@ -0,0 +1,213 @@
+#ifndef __SAI_REDIS_PIPELINE__
+#define __SAI_REDIS_PIPELINE__
+
+#include "sai.h"
+#include "sairedis.h"
+#include "sai_redis_mpsc_queue.h"
+#include "sai_redis_write_combiner.h"
+
+#include "sswcommon/dbconnector.h"
+#include "sswcommon/producertable.h"
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * @brief Batching layer in front of ProducerTable
+ *
+ * Operations are accumulated in order and written as one MULTI/EXEC
+ * pipeline, using same queues and framing as ProducerTable set/del,
+ * so consumer side does not see any difference. Batch is written when
+ * it reaches batch size (by caller), when oldest operation waited for
+ * flush latency (by flush thread) or on explicit flush().
+ *
+ * In async mode callers only push serialized operations to lock-free
+ * queue and return, writer thread drains queue and writes batches when
+ * queue becomes empty or batch is full. Write errors are reported
+ * through error notification, sync() waits for everything queued
+ * before it to be written.
+ *
+ * With write combining enabled pending batch is combined by
+ * RedisWriteCombiner, only dropped operations change, all other keep
+ * their order.
+ */
+class RedisPipeline
+{
+    public:
+
+        RedisPipeline(
+                _In_ ssw::DBConnector *db,
+                _In_ ssw::ProducerTable *table,
+                _In_ size_t batch_size,
+                _In_ uint64_t flush_latency_us,
+                _In_ bool async);
+
+        ~RedisPipeline();
+
+        typedef RedisOperation Operation;
+
+        static Operation setOperation(
+                _In_ const std::string &key,
+                _In_ std::vector<ssw::FieldValueTuple> &values,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL,
+                _In_ sai_common_api_t api = SAI_COMMON_API_MAX,
+                _In_ sai_attr_id_t attr_id = 0);
+
+        static Operation delOperation(
+                _In_ const std::string &key,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL);
+
+        sai_status_t set(
+                _In_ const std::string &key,
+                _In_ std::vector<ssw::FieldValueTuple> &values,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL,
+                _In_ sai_common_api_t api = SAI_COMMON_API_MAX,
+                _In_ sai_attr_id_t attr_id = 0);
+
+        sai_status_t del(
+                _In_ const std::string &key,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL);
+
+        /**
+         * @brief Appends operation built by setOperation or
+         * delOperation, same as set or del with its arguments
+         *
+         * @return status of batch write when operation filled batch
+         */
+        sai_status_t enqueue(
+                _In_ Operation &&operation);
+
+        /**
+         * @brief Appends operations in order and writes them together
+         * with already pending ones as single pipeline
+         *
+         * @return error when write failed, operations of this call
+         * which were not combined away are left in operations, in async
+         * mode all are taken and failures go to error notification
+         */
+        sai_status_t bulk(
+                _In_ std::vector<Operation> &operations);
+
+        sai_status_t flush();
+
+        /**
+         * @brief Waits until all operations queued before this call
+         * are written, same as flush() when not in async mode
+         */
+        sai_status_t sync();
+
+        void setErrorNotification(
+                _In_ sai_redis_error_notification_fn notification);
+
+        /**
+         * @brief Listener is called from thread which writes operations,
+         * under pipeline lock
+         */
+        void setWriteListener(
+                _In_ RedisWriteListener *listener);
+
+        /**
+         * @brief Enables write combining, operations are kept pending
+         * at least window_us so repeated sets can be combined, 0
+         * disables it
+         */
+        void setWriteCombiningWindow(
+                _In_ uint64_t window_us);
+
+        /**
+         * @brief Number of operations dropped by write combining
+         */
+        uint64_t getCoalescedCount() const;
+
+    private:
+
+        RedisPipeline(const RedisPipeline&);
+        RedisPipeline& operator=(const RedisPipeline&);
+
+        struct SyncBarrier;
+
+        struct Request
+        {
+            Request():
+                operation(),
+                barrier(NULL)
+            {
+            }
+
+            Operation operation;
+
+            std::vector<Operation> bulk;
+
+            SyncBarrier *barrier;
+        };
+
+        void push(
+                _In_ Request &&request);
+
+        void appendLocked(
+                _In_ Operation &&operation);
+
+        std::chrono::steady_clock::time_point deadlineLocked() const;
+
+        /**
+         * @brief Writes pending operations, when write fails pending
+         * operations from first on are moved to unwritten instead of
+         * being reported by error notification
+         */
+        sai_status_t flushLocked(
+                _Out_ std::vector<Operation> *unwritten = NULL,
+                _In_ size_t first = 0);
+
+        void flushThread();
+
+        void writerThread();
+
+        ssw::DBConnector *m_db;
+
+        std::string m_keyQueue;
+        std::string m_valueQueue;
+        std::string m_opQueue;
+        std::string m_channel;
+
+        size_t m_batchSize;
+
+        std::chrono::microseconds m_flushLatency;
+
+        std::vector<Operation> m_operations;
+
+        std::chrono::steady_clock::time_point m_firstOperationTime;
+
+        std::mutex m_mutex;
+
+        std::condition_variable m_cv;
+
+        bool m_running;
+
+        std::thread m_thread;
+
+        bool m_async;
+
+        MpscQueue<Request> m_queue;
+
+        std::atomic<bool> m_writerSleeping;
+
+        sai_status_t m_asyncStatus;
+
+        std::atomic<sai_redis_error_notification_fn> m_errorNotification;
+
+        std::atomic<RedisWriteListener*> m_writeListener;
+
+        std::chrono::microseconds m_combiningWindow;
+
+        RedisWriteCombiner m_combiner;
+};
+
+#endif // __SAI_REDIS_PIPELINE__
@@ -0,0 +1,101 @@
+#ifndef __SAI_REDIS_PIPELINE_POOL__
+#define __SAI_REDIS_PIPELINE_POOL__
+
+#include "sai.h"
+#include "sairedis.h"
+#include "sai_redis_pipeline.h"
+#include "sai_redis_transport.h"
+
+#include "sswcommon/dbconnector.h"
+#include "sswcommon/producertable.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Pool of ASIC_STATE pipelines, each with own redis connection
+ *
+ * Operation goes to pipeline selected by hash of its key, so all
+ * operations of one object are written in order through one
+ * connection, while threads programming different objects write in
+ * parallel. Operations of different objects in different pipelines
+ * can reach ASIC_STATE in different order than they were made, caller
+ * which depends on order of objects (for example next hop created
+ * before route using it) must call flush() or sync() in between.
+ * Pool of size 1 behaves exactly as single pipeline.
+ */
+class RedisPipelinePool:
+    public RedisTransport
+{
+    public:
+
+        RedisPipelinePool(
+                _In_ size_t pool_size,
+                _In_ size_t batch_size,
+                _In_ uint64_t flush_latency_us,
+                _In_ bool async);
+
+        virtual ~RedisPipelinePool();
+
+        virtual sai_status_t set(
+                _In_ const std::string &key,
+                _In_ std::vector<ssw::FieldValueTuple> &values,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL,
+                _In_ sai_common_api_t api = SAI_COMMON_API_MAX,
+                _In_ sai_attr_id_t attr_id = 0);
+
+        virtual sai_status_t del(
+                _In_ const std::string &key,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL);
+
+        virtual sai_status_t enqueue(
+                _In_ RedisPipeline::Operation &&operation);
+
+        /**
+         * @brief Splits operations by pipeline and writes each part as
+         * bulk, first failure is returned
+         *
+         * Operations not written are left in operations in their order,
+         * operations of other pipelines after them may be written.
+         */
+        virtual sai_status_t bulk(
+                _In_ std::vector<RedisPipeline::Operation> &operations);
+
+        virtual sai_status_t flush();
+
+        virtual sai_status_t sync();
+
+        virtual void setErrorNotification(
+                _In_ sai_redis_error_notification_fn notification);
+
+        virtual void setWriteListener(
+                _In_ RedisWriteListener *listener);
+
+        virtual void setWriteCombiningWindow(
+                _In_ uint64_t window_us);
+
+        virtual uint64_t getCoalescedCount() const;
+
+    private:
+
+        RedisPipelinePool(const RedisPipelinePool&);
+        RedisPipelinePool& operator=(const RedisPipelinePool&);
+
+        size_t shardIndex(
+                _In_ const std::string &key) const;
+
+        struct Shard
+        {
+            ssw::DBConnector *db;
+
+            ssw::ProducerTable *table;
+
+            RedisPipeline *pipeline;
+        };
+
+        std::vector<Shard> m_shards;
+};
+
+#endif // __SAI_REDIS_PIPELINE_POOL__
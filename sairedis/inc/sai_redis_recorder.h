@@ -0,0 +1,207 @@
+#ifndef __SAI_REDIS_RECORDER__
+#define __SAI_REDIS_RECORDER__
+
+#include "sai.h"
+#include "sairedis.h"
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+#define SAI_REDIS_RECORD_MAGIC      "SRRECORD"
+#define SAI_REDIS_RECORD_VERSION    1
+
+/*
+ * Record file layout, integers in header and record length in host
+ * byte order, v is varint of binary serialization format:
+ *
+ * header:  char magic[8], uint32_t version, uint32_t reserved
+ * record:  uint32_t length, length bytes of:
+ *          v timestamp_ns, v duration_ns, v thread, v api,
+ *          v method, v object_type, v common_api, v status,
+ *          string key, v attr_count,
+ *          attr_count times string attr_id, string attr_value
+ * string:  v length, length bytes
+ *
+ * Timestamp is monotonic time of call start since recording started.
+ * Method is index of function in method table of api. Key, attribute
+ * ids and values are in binary serialization format, key is object id,
+ * entry or vlan id, empty for switch. Get records carry attribute ids
+ * with empty values. Records of different threads are not ordered in
+ * file, reader orders them by timestamp.
+ */
+
+typedef struct _sai_redis_record_header_t
+{
+    char magic[8];
+
+    uint32_t version;
+
+    uint32_t reserved;
+
+} sai_redis_record_header_t;
+
+/**
+ * @brief Records create, remove, set and get calls made through method
+ * tables returned by sai_api_query
+ *
+ * Every thread writes records to own lock-free ring, writer thread
+ * drains rings to file. Caller is never blocked by file writes, only
+ * when its ring is full it waits for writer.
+ */
+class RedisRecorder
+{
+    public:
+
+        RedisRecorder();
+
+        ~RedisRecorder();
+
+        sai_status_t start(
+                _In_ const std::string &path);
+
+        /**
+         * @brief Writes all records and closes file
+         */
+        void stop();
+
+        /**
+         * @param attr_count - attributes, for get only ids are recorded
+         */
+        void record(
+                _In_ uint64_t start,
+                _In_ uint64_t end,
+                _In_ sai_api_t api,
+                _In_ uint32_t method,
+                _In_ sai_object_type_t object_type,
+                _In_ sai_common_api_t common_api,
+                _In_ sai_status_t status,
+                _In_ const std::string &key,
+                _In_ uint32_t attr_count,
+                _In_ const sai_attribute_t *attr_list);
+
+        void getStats(
+                _Out_ sai_redis_recorder_stats_t &stats) const;
+
+        /**
+         * @brief Monotonic time in nanoseconds
+         */
+        static uint64_t now();
+
+    private:
+
+        RedisRecorder(const RedisRecorder&);
+        RedisRecorder& operator=(const RedisRecorder&);
+
+        /**
+         * @brief Single producer single consumer ring of records
+         */
+        struct Buffer
+        {
+            Buffer(
+                    _In_ uint32_t index);
+
+            bool push(
+                    _In_ const std::string &record);
+
+            uint32_t thread;
+
+            std::vector<char> data;
+
+            // written by producer
+
+            std::atomic<uint64_t> tail;
+
+            std::atomic<uint64_t> records;
+
+            // pushes which waited for writer
+            std::atomic<uint64_t> stalls;
+
+            // keeps head on other cache line, buffers are heap allocated
+            // so alignas would not be honored by new in C++11
+            char padding[64];
+
+            // written by writer
+            std::atomic<uint64_t> head;
+        };
+
+        Buffer* threadBuffer();
+
+        void writerThread();
+
+        void drain();
+
+        uint64_t m_generation;
+
+        uint64_t m_start;
+
+        FILE *m_file;
+
+        mutable std::mutex m_buffersMutex;
+
+        std::vector<std::unique_ptr<Buffer>> m_buffers;
+
+        // writer copy of buffers
+        std::vector<Buffer*> m_drainBuffers;
+
+        std::mutex m_writerMutex;
+
+        std::condition_variable m_writerCv;
+
+        bool m_running;
+
+        std::thread m_thread;
+
+        std::atomic<uint64_t> m_bytes;
+
+        // records or attributes not recorded
+        std::atomic<uint64_t> m_unrecorded;
+};
+
+/**
+ * @brief Pins recorder used by wrapped tables for lifetime of reference,
+ * get() is NULL when not recording
+ */
+class RedisRecorderReference
+{
+    public:
+
+        RedisRecorderReference();
+
+        ~RedisRecorderReference();
+
+        RedisRecorder* get() const
+        {
+            return m_recorder;
+        }
+
+    private:
+
+        RedisRecorderReference(const RedisRecorderReference&);
+        RedisRecorderReference& operator=(const RedisRecorderReference&);
+
+        RedisRecorder *m_recorder;
+};
+
+/**
+ * @brief Makes recorder used by wrapped tables, previous one is deleted
+ * once calls which pinned it return
+ */
+void redis_recorder_replace(
+        _In_ RedisRecorder *recorder);
+
+/**
+ * @brief Returns method table which records calls and forwards them
+ * to table, tables are wrapped once and shared by all recorders
+ */
+void* redis_recorder_wrap_api(
+        _In_ sai_api_t api,
+        _In_ void *table);
+
+#endif // __SAI_REDIS_RECORDER__
@@ -0,0 +1,65 @@
+#ifndef __SAI_REDIS_SHM_CONSUMER__
+#define __SAI_REDIS_SHM_CONSUMER__
+
+#include "sai.h"
+#include "sai_redis_shm_ring.h"
+
+#include "sswcommon/table.h"
+
+#include <string>
+
+// key, value and op of operation
+#define SAI_REDIS_SHM_PARTS     3
+
+/**
+ * @brief Decodes framed operation to same tuple as ConsumerTable pop
+ * of ASIC_STATE: op without set/del prefix, fields of set
+ */
+bool redis_transport_decode(
+        _In_ const char *key,
+        _In_ size_t key_size,
+        _In_ const char *value,
+        _In_ size_t value_size,
+        _In_ const char *op,
+        _In_ size_t op_size,
+        _Out_ ssw::KeyOpFieldsValuesTuple &kco);
+
+/**
+ * @brief Consumer of operations written by RedisShmTransport, same
+ * interface as ConsumerTable
+ *
+ * Does not depend on rest of sairedis, so consumer process links it
+ * with ring alone.
+ */
+class ShmConsumerTable
+{
+    public:
+
+        ShmConsumerTable();
+
+        sai_status_t open(
+                _In_ const std::string &name,
+                _In_ uint64_t size);
+
+        /**
+         * @brief Pops oldest operation, kco is cleared when there is
+         * none
+         *
+         * @return false when there is no operation or it is malformed
+         */
+        bool pop(
+                _Out_ ssw::KeyOpFieldsValuesTuple &kco);
+
+        bool empty() const;
+
+    private:
+
+        ShmConsumerTable(const ShmConsumerTable&);
+        ShmConsumerTable& operator=(const ShmConsumerTable&);
+
+        ShmRing m_ring;
+
+        std::string m_record;
+};
+
+#endif // __SAI_REDIS_SHM_CONSUMER__
@@ -0,0 +1,166 @@
+#ifndef __SAI_REDIS_SHM_RING__
+#define __SAI_REDIS_SHM_RING__
+
+#include "sai.h"
+#include "sai_serialize.h"
+
+#include <string>
+#include <atomic>
+
+#define SAI_REDIS_SHM_RING_MAGIC    0x474e495248535253ULL   // "SRSHRING"
+#define SAI_REDIS_SHM_RING_VERSION  1
+
+/*
+ * Shared memory segment layout, header followed by data of capacity
+ * bytes, capacity is power of 2:
+ *
+ * header:  u64 magic, u32 version, u32 reserved, u64 capacity,
+ *          u64 tail on own cache line, u64 head on own cache line
+ * record:  u32 word, then parts, aligned to 8 bytes
+ * part:    u32 length, length bytes
+ *
+ * Word is 0 until record is committed, then it is record size with
+ * SAI_REDIS_SHM_RING_PAD set for padding which skips to start of data
+ * when record does not fit in rest of it. Consumer zeroes consumed
+ * records, so free space always reads 0.
+ */
+
+#define SAI_REDIS_SHM_RING_PAD      0x80000000u
+
+#define SAI_REDIS_SHM_RING_ALIGN    8
+
+typedef struct _sai_redis_shm_ring_header_t
+{
+    uint64_t magic;
+
+    uint32_t version;
+
+    uint32_t reserved;
+
+    uint64_t capacity;
+
+    char padding0[40];
+
+    // bytes reserved by producers
+    std::atomic<uint64_t> tail;
+
+    char padding1[56];
+
+    // bytes consumed by consumer
+    std::atomic<uint64_t> head;
+
+    char padding2[56];
+
+} sai_redis_shm_ring_header_t;
+
+/**
+ * @brief Lock-free multiple producer single consumer ring of records in
+ * POSIX shared memory
+ *
+ * Producers reserve space by compare and swap of tail, so single
+ * producer never retries, write record in place and commit it by store
+ * of its word. Records are consumed in reservation order, consumer
+ * waits on record which is reserved but not committed yet. Producers
+ * may be threads of different processes.
+ */
+class ShmRing
+{
+    public:
+
+        ShmRing();
+
+        ~ShmRing();
+
+        /**
+         * @brief Maps segment, creates and initializes it when it does
+         * not exist yet
+         *
+         * @param size - data size of created segment, rounded up to
+         * power of 2, existing segment keeps its size
+         */
+        sai_status_t open(
+                _In_ const std::string &name,
+                _In_ uint64_t size);
+
+        void close();
+
+        /**
+         * @brief Removes segment name, mapped segments stay valid
+         */
+        static void unlink(
+                _In_ const std::string &name);
+
+        /**
+         * @brief Appends record, thread safe
+         *
+         * @return false when ring does not have space for record now,
+         * or record is larger than half of ring
+         */
+        bool push(
+                _In_ uint32_t count,
+                _In_ const sai_serialized_view_t *parts);
+
+        /**
+         * @brief Returns true when record is not larger than half of
+         * ring, push of it succeeds once consumer frees space
+         */
+        bool fits(
+                _In_ uint32_t count,
+                _In_ const sai_serialized_view_t *parts) const;
+
+        /**
+         * @brief Copies oldest committed record to record, single
+         * consumer only
+         *
+         * @return false when there is no committed record
+         */
+        bool pop(
+                _Out_ std::string &record);
+
+        /**
+         * @brief Splits record returned by pop to parts, views point
+         * to record
+         */
+        static bool parse(
+                _In_ const std::string &record,
+                _In_ uint32_t count,
+                _Out_ sai_serialized_view_t *parts);
+
+        /**
+         * @brief Returns true when all reserved records were consumed
+         */
+        bool empty() const;
+
+        uint64_t capacity() const;
+
+        /**
+         * @brief Position after last reserved record, grows forever
+         */
+        uint64_t reserved() const;
+
+        /**
+         * @brief Position after last consumed record
+         */
+        uint64_t consumed() const;
+
+    private:
+
+        ShmRing(const ShmRing&);
+        ShmRing& operator=(const ShmRing&);
+
+        std::atomic<uint32_t>& word(
+                _In_ uint64_t position)
+        {
+            return *reinterpret_cast<std::atomic<uint32_t>*>(m_data + (position & (m_capacity - 1)));
+        }
+
+        sai_redis_shm_ring_header_t *m_header;
+
+        char *m_data;
+
+        uint64_t m_capacity;
+
+        size_t m_mappedSize;
+};
+
+#endif // __SAI_REDIS_SHM_RING__
@@ -0,0 +1,253 @@
+#ifndef __SAI_REDIS_TRANSPORT__
+#define __SAI_REDIS_TRANSPORT__
+
+#include "sai.h"
+#include "sairedis.h"
+#include "sai_redis_pipeline.h"
+#include "sai_redis_shm_ring.h"
+#include "sai_redis_shm_consumer.h"
+#include "sai_redis_journal.h"
+
+#include "sswcommon/table.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+/**
+ * @brief Transport of ASIC_STATE operations to switch side
+ *
+ * Every transport carries same operation framing, key, value and op
+ * strings as built by RedisPipeline::setOperation and delOperation,
+ * so consumer decodes operations of any transport by
+ * redis_transport_decode.
+ */
+class RedisTransport
+{
+    public:
+
+        virtual ~RedisTransport()
+        {
+        }
+
+        virtual sai_status_t set(
+                _In_ const std::string &key,
+                _In_ std::vector<ssw::FieldValueTuple> &values,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL,
+                _In_ sai_common_api_t api = SAI_COMMON_API_MAX,
+                _In_ sai_attr_id_t attr_id = 0) = 0;
+
+        virtual sai_status_t del(
+                _In_ const std::string &key,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL) = 0;
+
+        /**
+         * @brief Writes operation built by RedisPipeline::setOperation
+         * or delOperation, same as set or del with its arguments
+         *
+         * @return error when operation is not written, operations
+         * which fail after return are reported through error
+         * notification
+         */
+        virtual sai_status_t enqueue(
+                _In_ RedisPipeline::Operation &&operation) = 0;
+
+        /**
+         * @brief Writes operations in order
+         *
+         * @return error when some operation is not written, operations
+         * not written are left in operations in their order
+         */
+        virtual sai_status_t bulk(
+                _In_ std::vector<RedisPipeline::Operation> &operations) = 0;
+
+        virtual sai_status_t flush() = 0;
+
+        virtual sai_status_t sync() = 0;
+
+        virtual void setErrorNotification(
+                _In_ sai_redis_error_notification_fn notification) = 0;
+
+        virtual void setWriteListener(
+                _In_ RedisWriteListener *listener) = 0;
+
+        virtual void setWriteCombiningWindow(
+                _In_ uint64_t window_us) = 0;
+
+        virtual uint64_t getCoalescedCount() const = 0;
+};
+
+/**
+ * @brief ASIC_STATE transport over shared memory ring to local consumer
+ *
+ * Operation is framed into ring by calling thread, there is no batch,
+ * flush thread or redis round trip, consumer sees it as soon as enqueue
+ * returns. When ring is full caller waits for consumer, operation which
+ * does not fit in time is dropped, caller gets
+ * SAI_STATUS_INSUFFICIENT_RESOURCES and it is also reported through
+ * error notification. Bulk stops at first dropped operation and leaves
+ * it and operations after it in vector. Write combining is not
+ * supported.
+ */
+class RedisShmTransport:
+    public RedisTransport
+{
+    public:
+
+        RedisShmTransport();
+
+        virtual ~RedisShmTransport();
+
+        sai_status_t open(
+                _In_ const std::string &name,
+                _In_ uint64_t size);
+
+        virtual sai_status_t set(
+                _In_ const std::string &key,
+                _In_ std::vector<ssw::FieldValueTuple> &values,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL,
+                _In_ sai_common_api_t api = SAI_COMMON_API_MAX,
+                _In_ sai_attr_id_t attr_id = 0);
+
+        virtual sai_status_t del(
+                _In_ const std::string &key,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL);
+
+        virtual sai_status_t enqueue(
+                _In_ RedisPipeline::Operation &&operation);
+
+        virtual sai_status_t bulk(
+                _In_ std::vector<RedisPipeline::Operation> &operations);
+
+        /**
+         * @brief Operations are visible to consumer on enqueue, nothing
+         * to flush
+         */
+        virtual sai_status_t flush();
+
+        /**
+         * @brief Waits until consumer took all operations enqueued
+         * before this call
+         */
+        virtual sai_status_t sync();
+
+        virtual void setErrorNotification(
+                _In_ sai_redis_error_notification_fn notification);
+
+        virtual void setWriteListener(
+                _In_ RedisWriteListener *listener);
+
+        virtual void setWriteCombiningWindow(
+                _In_ uint64_t window_us);
+
+        virtual uint64_t getCoalescedCount() const;
+
+    private:
+
+        RedisShmTransport(const RedisShmTransport&);
+        RedisShmTransport& operator=(const RedisShmTransport&);
+
+        sai_status_t push(
+                _In_ const RedisPipeline::Operation &operation);
+
+        ShmRing m_ring;
+
+        std::atomic<sai_redis_error_notification_fn> m_errorNotification;
+
+        std::atomic<RedisWriteListener*> m_writeListener;
+};
+
+/**
+ * @brief Transport which stamps every operation with sequence number
+ * and appends it to change journal once transport wrote it
+ *
+ * Journal is appended by write listener of wrapped transport, so
+ * batched and async operations are appended when they are written.
+ * Sequence is appended to op after common api, in ASIC_STATE
+ * serialization format. Sequences are reserved without lock, so they
+ * follow order of operations of one thread, operations of different
+ * threads may reach consumer in other order than their sequences.
+ * Sequence of operation transport did not write is skipped in journal.
+ * Operation which does not fit in journal truncates it, readers behind
+ * it resync. Write combining is not supported, sequence of combined
+ * operation would never reach consumer.
+ */
+class RedisJournalTransport:
+    public RedisTransport,
+    public RedisWriteListener
+{
+    public:
+
+        /**
+         * @brief Takes ownership of transport, journal is owned by
+         * caller and must outlive this
+         */
+        RedisJournalTransport(
+                _In_ RedisTransport *transport,
+                _In_ RedisChangeJournal *journal);
+
+        virtual ~RedisJournalTransport();
+
+        virtual sai_status_t set(
+                _In_ const std::string &key,
+                _In_ std::vector<ssw::FieldValueTuple> &values,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL,
+                _In_ sai_common_api_t api = SAI_COMMON_API_MAX,
+                _In_ sai_attr_id_t attr_id = 0);
+
+        virtual sai_status_t del(
+                _In_ const std::string &key,
+                _In_ const std::string &op,
+                _In_ sai_object_type_t object_type = SAI_OBJECT_TYPE_NULL);
+
+        virtual sai_status_t enqueue(
+                _In_ RedisPipeline::Operation &&operation);
+
+        virtual sai_status_t bulk(
+                _In_ std::vector<RedisPipeline::Operation> &operations);
+
+        virtual sai_status_t flush();
+
+        virtual sai_status_t sync();
+
+        virtual void setErrorNotification(
+                _In_ sai_redis_error_notification_fn notification);
+
+        virtual void setWriteListener(
+                _In_ RedisWriteListener *listener);
+
+        virtual void setWriteCombiningWindow(
+                _In_ uint64_t window_us);
+
+        virtual uint64_t getCoalescedCount() const;
+
+    private:
+
+        RedisJournalTransport(const RedisJournalTransport&);
+        RedisJournalTransport& operator=(const RedisJournalTransport&);
+
+        static void stamp(
+                _Inout_ RedisPipeline::Operation &operation,
+                _In_ uint64_t sequence);
+
+        /**
+         * @brief Appends written operation to journal, skips sequence
+         * of operation which was not written
+         */
+        virtual void written(
+                _In_ const RedisPipeline::Operation &operation,
+                _In_ sai_status_t status);
+
+        RedisTransport *m_transport;
+
+        RedisChangeJournal *m_journal;
+
+        std::atomic<RedisWriteListener*> m_writeListener;
+};
+
+#endif // __SAI_REDIS_TRANSPORT__
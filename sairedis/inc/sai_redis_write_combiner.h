@@ -0,0 +1,69 @@
+#ifndef __SAI_REDIS_WRITE_COMBINER__
+#define __SAI_REDIS_WRITE_COMBINER__
+
+#include "sai.h"
+#include "sai_redis_operation.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+
+/**
+ * @brief Write combining of pending ASIC_STATE operations
+ *
+ * Set of attribute which is already set in pending operations replaces
+ * earlier set, create followed by remove of route, neighbor or fdb
+ * entry drops both (and sets in between). Combined operations are only
+ * marked dropped, all other keep their order. Sets are not combined
+ * across remove of other object, since remove may depend on value they
+ * set (for example next hop is removed after route moved to other one).
+ *
+ * Does not depend on redis, pipeline calls it under its lock.
+ */
+class RedisWriteCombiner
+{
+    public:
+
+        RedisWriteCombiner();
+
+        /**
+         * @brief Marks pending operations made redundant by operation
+         * as dropped, called before operation is appended to pending
+         *
+         * @return true when operation itself is dropped and must not be
+         * appended
+         */
+        bool combine(
+                _Inout_ std::vector<RedisOperation> &pending,
+                _In_ const RedisOperation &operation);
+
+        /**
+         * @brief Forgets pending operations, called when they are written
+         */
+        void clear();
+
+        /**
+         * @brief Number of operations dropped
+         */
+        uint64_t getCoalescedCount() const;
+
+    private:
+
+        RedisWriteCombiner(const RedisWriteCombiner&);
+        RedisWriteCombiner& operator=(const RedisWriteCombiner&);
+
+        // key + attr id -> index of last pending set
+        std::unordered_map<std::string, size_t> m_pendingSets;
+
+        // key -> index of pending create
+        std::unordered_map<std::string, size_t> m_pendingCreates;
+
+        // index after last pending remove, sets before it are not
+        // combined
+        size_t m_lastRemove;
+
+        std::atomic<uint64_t> m_coalesced;
+};
+
+#endif // __SAI_REDIS_WRITE_COMBINER__
@@ -3,6 +3,8 @@
 
 #include "sai.h"
 
+#include <string.h>
+
 #include <iostream>
 #include <fstream>
 #include <ostream>
@@ -11,6 +13,7 @@
 #include <iomanip>
 #include <map>
 #include <tuple>
+#include <vector>
 
 #define TO_STR(x) #x
 
@@ -69,21 +72,67 @@ typedef enum _sai_attr_serialization_type_t
     SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_LIST,
 
     SAI_SERIALIZATION_TYPE_PORT_BREAKOUT,
-    SAI_SERIALIZATION_TYPE_QOS_MAP_LIST
+    SAI_SERIALIZATION_TYPE_QOS_MAP_LIST,
+    SAI_SERIALIZATION_TYPE_TUNNEL_MAP_LIST,
+
+    /** Hole in attribute metadata table, attribute not serializable */
+    SAI_SERIALIZATION_TYPE_NONE
 
 } sai_attr_serialization_type_t;
 
-typedef std::map<sai_object_type_t, std::string> sai_object_type_to_string_map_t;
+typedef enum _sai_serialization_format_t
+{
+    /** Hex dump of memory, default ASIC_STATE format */
+    SAI_SERIALIZATION_FORMAT_HEX,
+
+    /** Versioned binary format, lists and chardata are length prefixed */
+    SAI_SERIALIZATION_FORMAT_BINARY
+
+} sai_serialization_format_t;
+
+/**
+ * @brief Binary format version
+ *
+ * Binary keys start with this byte, hex keys contain only hex digits
+ * so consumer can tell the format from the first byte of the key.
+ */
+#define SAI_BINARY_FORMAT_VERSION ((char)0x01)
+
+/**
+ * @brief Attribute is listed in READ-ONLY section of SAI header
+ */
+#define SAI_ATTR_FLAG_READ_ONLY (1 << 0)
+
+/**
+ * @brief Contiguous range of attribute ids
+ *
+ * Serialization type of attribute is types[attr_id - start] and its
+ * SAI_ATTR_FLAG_* flags are flags[attr_id - start].
+ */
+typedef struct _sai_attr_serialization_range_t
+{
+    uint32_t start;
+    uint32_t count;
+    const sai_attr_serialization_type_t *types;
+    const uint8_t *flags;
 
-typedef std::map<sai_object_type_t, std::map<sai_attr_id_t, sai_attr_serialization_type_t>> sai_serialization_map_t;
+} sai_attr_serialization_range_t;
 
-sai_serialization_map_t sai_get_serialization_map();
-sai_object_type_to_string_map_t sai_get_object_type_map();
+typedef struct _sai_attr_serialization_table_t
+{
+    uint32_t count;
+    const sai_attr_serialization_range_t *ranges;
 
-sai_status_t sai_get_object_type_string(sai_object_type_t object_type, std::string &str_object_type);
+} sai_attr_serialization_table_t;
+
+/**
+ * Tables below are generated from SAI headers at build time by
+ * sai_serialize_gen.py and are indexed directly by object type.
+ */
+extern const sai_attr_serialization_table_t g_attr_serialization_table[SAI_OBJECT_TYPE_MAX];
+extern const char* const g_object_type_name_table[SAI_OBJECT_TYPE_MAX];
 
-extern sai_serialization_map_t g_serialization_map;
-extern sai_object_type_to_string_map_t g_object_type_map;
+sai_status_t sai_get_object_type_string(sai_object_type_t object_type, std::string &str_object_type);
 
 template<typename T>
 void sai_dealloc_list(
@@ -92,21 +141,60 @@ void sai_dealloc_list(
     delete[] element.list;
 }
 
+void sai_hex_encode(
+        _In_ const void *mem,
+        _In_ size_t size,
+        _Out_ char *buffer);
+
+bool sai_hex_decode(
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _Out_ void *mem);
+
+template<typename T>
+char* sai_serialize_primitive(
+        _In_ const T &element,
+        _Out_ char *buffer)
+{
+    sai_hex_encode(&element, sizeof(T), buffer);
+
+    return buffer + 2 * sizeof(T);
+}
+
 template<typename T>
 void sai_serialize_primitive(
         _In_ const T &element,
         _Out_ std::string &s)
 {
-    std::stringstream ss;
+    size_t offset = s.size();
+
+    s.resize(offset + 2 * sizeof(T));
 
-    unsigned const char* mem = reinterpret_cast<const unsigned char*>(&element);
+    sai_serialize_primitive(element, &s[offset]);
+}
 
-    for (size_t i = 0; i < sizeof(T); i++)
+template<typename T>
+void sai_binary_serialize_primitive(
+        _In_ const T &element,
+        _Out_ std::string &s)
+{
+    s.append(reinterpret_cast<const char*>(&element), sizeof(T));
+}
+
+template<typename T>
+void sai_serialize_primitive(
+        _In_ const sai_serialization_format_t format,
+        _In_ const T &element,
+        _Out_ std::string &s)
+{
+    if (format == SAI_SERIALIZATION_FORMAT_BINARY)
     {
-        ss << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)mem[i];
+        sai_binary_serialize_primitive(element, s);
+    }
+    else
+    {
+        sai_serialize_primitive(element, s);
     }
-
-    s += ss.str();
 }
 
 template<typename T>
@@ -114,14 +202,99 @@ void sai_serialize_list(
         _In_ const T &element,
         _Out_ std::string &s)
 {
-    sai_serialize_primitive(element.count, s);
+    size_t size = sizeof(*element.list) * element.count;
 
-    for (size_t i = 0; i < element.count; i++)
-    {
-        sai_serialize_primitive(element.list[i], s);
-    }
+    size_t offset = s.size();
+
+    s.resize(offset + 2 * (sizeof(element.count) + size));
+
+    char *buffer = sai_serialize_primitive(element.count, &s[offset]);
+
+    // list is contiguous so it's encoded in one pass
+    sai_hex_encode(element.list, size, buffer);
 }
 
+#define SAI_DESERIALIZE_CONTEXT_BLOCK_SIZE  (64 * 1024)
+
+/**
+ * @brief Deserialization context
+ *
+ * Owns arena from which all lists deserialized with this context are
+ * allocated. Lists from one message or batch are released together by
+ * reset() or destructor, sai_deserialize_free_attribute_value must not
+ * be called on attributes deserialized with context.
+ *
+ * Memory blocks are kept on reset(), so after first few messages
+ * deserialization does not allocate at all. Context is not thread safe.
+ */
+class SaiDeserializeContext
+{
+    public:
+
+        SaiDeserializeContext(
+                _In_ size_t block_size = SAI_DESERIALIZE_CONTEXT_BLOCK_SIZE);
+
+        ~SaiDeserializeContext();
+
+        void* allocate(
+                _In_ size_t size,
+                _In_ size_t align)
+        {
+            uintptr_t ptr = ((uintptr_t)m_ptr + align - 1) & ~(uintptr_t)(align - 1);
+
+            if (ptr > (uintptr_t)m_end || size > (uintptr_t)m_end - ptr)
+            {
+                return allocate_slow(size, align);
+            }
+
+            m_ptr = (char*)ptr + size;
+
+            return (void*)ptr;
+        }
+
+        template<class T>
+        T* allocate_n(
+                _In_ size_t count)
+        {
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        /**
+         * @brief Releases all lists allocated from context in O(1)
+         */
+        void reset();
+
+        /**
+         * @brief Number of bytes reserved by arena blocks
+         */
+        size_t capacity() const;
+
+    private:
+
+        SaiDeserializeContext(const SaiDeserializeContext&);
+        SaiDeserializeContext& operator=(const SaiDeserializeContext&);
+
+        void* allocate_slow(
+                _In_ size_t size,
+                _In_ size_t align);
+
+        struct Block
+        {
+            char *data;
+            size_t size;
+        };
+
+        std::vector<Block> m_blocks;
+
+        size_t m_block_size;
+
+        size_t m_current;
+
+        char *m_ptr;
+
+        char *m_end;
+};
+
 template<typename T>
 void sai_free_list(
         _In_ T &element)
@@ -136,18 +309,37 @@ T* sai_alloc_n_of_ptr_type(int count, T*)
     return new T[count];
 }
 
+template<class T>
+T* sai_alloc_n_of_ptr_type(int count, T*, SaiDeserializeContext &context)
+{
+    return context.allocate_n<T>(count);
+}
+
 template<typename T, typename U>
 void sai_alloc_list(
         _In_ T count,
-        _In_ U &element)
+        _In_ U &element,
+        _In_ SaiDeserializeContext *context = NULL)
 {
     element.count = count;
-    element.list = sai_alloc_n_of_ptr_type(count, element.list);
+
+    if (context == NULL)
+    {
+        element.list = sai_alloc_n_of_ptr_type(count, element.list);
+    }
+    else
+    {
+        element.list = sai_alloc_n_of_ptr_type(count, element.list, *context);
+    }
 }
 
 int char_to_int(
         _In_ const char c);
 
+void sai_hex_decode_error(
+        _In_ const char *buffer,
+        _In_ size_t size);
+
 template<typename  T>
 void sai_deserialize_primitive(
         _In_ std::string & s,
@@ -156,18 +348,11 @@ void sai_deserialize_primitive(
 {
     size_t count = sizeof(T);
 
-    unsigned char *mem = reinterpret_cast<unsigned char*>(&element);
-
     const char *ptr = s.c_str() + index;
 
-    for (size_t i = 0; i < count; i ++)
+    if (!sai_hex_decode(ptr, count, &element))
     {
-        int u = char_to_int(ptr[2 * i]);
-        int l = char_to_int(ptr[2 * i + 1]);
-
-        unsigned char c = (u << 4) | l;
-
-        mem[i] = c;
+        sai_hex_decode_error(ptr, count);
     }
 
     index += count * 2;
@@ -177,16 +362,23 @@ template<typename T>
 void sai_deserialize_list(
         _In_ std::string &s,
         _In_ int &index,
-        _Out_ T &element)
+        _Out_ T &element,
+        _In_ SaiDeserializeContext *context = NULL)
 {
     sai_deserialize_primitive(s, index, element.count);
 
-    sai_alloc_list(element.count, element);
+    sai_alloc_list(element.count, element, context);
+
+    size_t size = sizeof(*element.list) * element.count;
 
-    for (size_t i = 0; i < element.count; i++)
+    const char *ptr = s.c_str() + index;
+
+    if (!sai_hex_decode(ptr, size, element.list))
     {
-        sai_deserialize_primitive(s, index, element.list[i]);
+        sai_hex_decode_error(ptr, size);
     }
+
+    index += size * 2;
 }
 
 sai_status_t sai_deserialize_attr_value(
@@ -195,6 +387,17 @@ sai_status_t sai_deserialize_attr_value(
         _In_ const sai_attr_serialization_type_t type,
         _Out_ sai_attribute_t &attr);
 
+/**
+ * @brief Deserializes attribute value, lists are allocated from context
+ * and are released by context reset, not by sai_deserialize_free_attribute_value
+ */
+sai_status_t sai_deserialize_attr_value(
+        _In_ std::string &s,
+        _In_ int &index,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext &context);
+
 sai_status_t sai_deserialize_free_attribute_value(
         _In_ const sai_attr_serialization_type_t type,
         _In_ sai_attribute_t &attr);
@@ -213,11 +416,182 @@ sai_status_t sai_serialize_attr_value(
         _In_ const sai_attribute_t &attr,
         _Out_ std::string &s);
 
+sai_status_t sai_serialize_attr_id(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_attribute_t &attr,
+        _Out_ std::string &s);
+
+sai_status_t sai_serialize_attr_value(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_attr_serialization_type_t type,
+        _In_ const sai_attribute_t &attr,
+        _Out_ std::string &s);
+
+sai_status_t sai_serialize_object_key(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_object_type_t object_type,
+        _In_ const std::string &serialized_object_id,
+        _Out_ std::string &key);
+
+/**
+ * @brief Serializes entry which identifies object, same layout as
+ * sai_serialize_primitive of entry, but struct padding and address
+ * bytes not used by address family are zero, so equal entries always
+ * give equal keys
+ */
+void sai_serialize_entry(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_fdb_entry_t &entry,
+        _Out_ std::string &s);
+
+void sai_serialize_entry(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_neighbor_entry_t &entry,
+        _Out_ std::string &s);
+
+void sai_serialize_entry(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_unicast_route_entry_t &entry,
+        _Out_ std::string &s);
+
+void sai_binary_serialize_varint(
+        _In_ uint64_t value,
+        _Out_ std::string &s);
+
+bool sai_binary_deserialize_varint(
+        _In_ const std::string &s,
+        _Inout_ int &index,
+        _Out_ uint64_t &value);
+
+bool sai_binary_deserialize_varint(
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _Inout_ size_t &offset,
+        _Out_ uint64_t &value);
+
+sai_status_t sai_binary_serialize_attr_value(
+        _In_ const sai_attr_serialization_type_t type,
+        _In_ const sai_attribute_t &attr,
+        _Out_ std::string &s);
+
+sai_status_t sai_binary_deserialize_attr_value(
+        _In_ const std::string &s,
+        _Inout_ int &index,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr);
+
+sai_status_t sai_binary_deserialize_attr_value(
+        _In_ const std::string &s,
+        _Inout_ int &index,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext &context);
+
 sai_status_t sai_get_serialization_type(
         _In_ const sai_object_type_t object_type,
         _In_ const sai_attr_id_t attr_id,
         _Out_ sai_attr_serialization_type_t &serialization_type);
 
+/**
+ * @brief Returns true for attributes which are only reported by
+ * switch, like status or capability, and are never written
+ */
+bool sai_is_attr_read_only(
+        _In_ const sai_object_type_t object_type,
+        _In_ const sai_attr_id_t attr_id);
+
+/**
+ * @brief Copies attribute value to attribute provided by get caller
+ *
+ * Lists are copied to buffers of dst, when list does not fit dst
+ * count is set to required count and SAI_STATUS_BUFFER_OVERFLOW is
+ * returned. NULL list with non zero count is SAI_STATUS_INVALID_PARAMETER.
+ */
+sai_status_t sai_copy_attr_value(
+        _In_ const sai_attr_serialization_type_t type,
+        _In_ const sai_attribute_t &src,
+        _Inout_ sai_attribute_t &dst);
+
+/**
+ * @brief View of serialized field or value, for example element of
+ * redis reply, data does not need to be null terminated.
+ */
+typedef struct _sai_serialized_view_t
+{
+    const char *data;
+    size_t size;
+
+} sai_serialized_view_t;
+
+/**
+ * @brief Deserializes fixed size primitive at offset, bounds checked
+ *
+ * Returns false when buffer is too short, offset is advanced past
+ * element on success.
+ */
+template<typename T>
+bool sai_deserialize_primitive(
+        _In_ const sai_serialization_format_t format,
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _Inout_ size_t &offset,
+        _Out_ T &element)
+{
+    size_t count = (format == SAI_SERIALIZATION_FORMAT_BINARY) ? sizeof(T) : 2 * sizeof(T);
+
+    if (offset > size || count > size - offset)
+    {
+        return false;
+    }
+
+    if (format == SAI_SERIALIZATION_FORMAT_BINARY)
+    {
+        memcpy(&element, buffer + offset, sizeof(T));
+    }
+    else if (!sai_hex_decode(buffer + offset, sizeof(T), &element))
+    {
+        return false;
+    }
+
+    offset += count;
+
+    return true;
+}
+
+/**
+ * @brief Deserializes attribute value occupying whole buffer
+ *
+ * Every read is bounds checked, truncated or malformed input returns
+ * SAI_STATUS_INVALID_PARAMETER or SAI_STATUS_BUFFER_OVERFLOW.
+ */
+sai_status_t sai_deserialize_attr_value(
+        _In_ const sai_serialization_format_t format,
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext &context);
+
+sai_status_t sai_deserialize_attr_id(
+        _In_ const sai_serialization_format_t format,
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _Out_ sai_attr_id_t &attr_id);
+
+/**
+ * @brief Deserializes field/value vector of one object in single pass
+ *
+ * fvs contains 2 * count views, field followed by value, same layout
+ * as HGETALL reply. Lists are allocated from context.
+ */
+sai_status_t sai_deserialize_attr_list(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const sai_serialized_view_t *fvs,
+        _Out_ sai_attribute_t *attr_list,
+        _In_ SaiDeserializeContext &context);
+
 #endif // __SAI_SERIALIZE__
 
 
@@ -0,0 +1,538 @@
+#ifndef __SAIREDIS__
+#define __SAIREDIS__
+
+#include "sai.h"
+
+/*
+ * Extensions specific to sairedis, not part of SAI API.
+ */
+
+/**
+ * @brief Flag for sai_api_initialize, enables async mode
+ *
+ * In async mode create/remove/set are validated and serialized on
+ * caller thread and queued for background writer thread, caller does
+ * not wait for redis. Async mode can be also enabled by profile key
+ * SAI_REDIS_ASYNC_MODE set to "true".
+ */
+#define SAI_REDIS_INITIALIZE_FLAG_ASYNC     (1 << 0)
+
+/**
+ * @brief Notification of operation which failed to be written to redis
+ *
+ * @param[in] key - serialized ASIC_STATE key of operation
+ * @param[in] key_length - length of key, key may contain binary data
+ * @param[in] status - error status
+ */
+typedef void (*sai_redis_error_notification_fn)(
+        _In_ const char *key,
+        _In_ size_t key_length,
+        _In_ sai_status_t status);
+
+/**
+ * @brief Attribute cache statistics
+ */
+typedef struct _sai_redis_attr_cache_stats_t
+{
+    /** Get attributes served from cache */
+    uint64_t hits;
+
+    /** Cacheable get attributes read from redis */
+    uint64_t misses;
+
+    /** Objects currently cached */
+    uint64_t objects;
+
+} sai_redis_attr_cache_stats_t;
+
+/**
+ * @brief Statistics of view of objects written to ASIC_STATE
+ */
+typedef struct _sai_redis_view_stats_t
+{
+    /** Objects currently in view */
+    uint64_t objects;
+
+    /** Objects loaded from snapshot on warm boot */
+    uint64_t restored;
+
+    /** Restored objects with id whose create was not replayed yet */
+    uint64_t unclaimed;
+
+    /** Creates and sets identical to view, not written */
+    uint64_t absorbed;
+
+} sai_redis_view_stats_t;
+
+/**
+ * @brief Counter poller statistics
+ */
+typedef struct _sai_redis_counter_stats_t
+{
+    /** Objects whose counters are polled */
+    uint64_t objects;
+
+    /** Completed polls */
+    uint64_t polls;
+
+    /** Polls which failed, previous snapshot was kept */
+    uint64_t poll_errors;
+
+    /** Duration of last completed poll in nanoseconds */
+    uint64_t last_poll_ns;
+
+    /** Counter reads served from snapshot */
+    uint64_t snapshot_reads;
+
+    /** Counter reads from redis, polling disabled or object not polled yet */
+    uint64_t direct_reads;
+
+} sai_redis_counter_stats_t;
+
+/**
+ * @brief Statistics of recording of calls
+ */
+typedef struct _sai_redis_recorder_stats_t
+{
+    /** Calls recorded */
+    uint64_t records;
+
+    /** Bytes of records written to file */
+    uint64_t bytes;
+
+    /** Threads which made recorded calls */
+    uint64_t threads;
+
+    /** Calls which waited for full thread buffer to be written */
+    uint64_t stalls;
+
+    /** Records and attributes which could not be recorded */
+    uint64_t unrecorded;
+
+} sai_redis_recorder_stats_t;
+
+/**
+ * @brief Statistics of change journal of ASIC_STATE operations
+ */
+typedef struct _sai_redis_journal_stats_t
+{
+    /** Oldest sequence consumer can catch up from */
+    uint64_t first_sequence;
+
+    /** Newest sequence consumer can read, operations before it are
+     * written or skipped */
+    uint64_t last_sequence;
+
+    /** Bytes used by operations in journal */
+    uint64_t bytes;
+
+    /** Data size of journal */
+    uint64_t capacity;
+
+    /** Times journal was emptied, on cold boot or by operation too
+     * large for it */
+    uint64_t truncations;
+
+} sai_redis_journal_stats_t;
+
+/**
+ * @brief Notification consumer statistics
+ */
+typedef struct _sai_redis_notification_stats_t
+{
+    /** Fdb events delivered to on_fdb_event */
+    uint64_t fdb_events;
+
+    /** Port state changes delivered to on_port_state_change */
+    uint64_t port_state_change_events;
+
+    /** Number of callback calls */
+    uint64_t batches;
+
+    /** Most events delivered in single callback call */
+    uint64_t batch_high_water_mark;
+
+    /** Most notifications drained after single wakeup */
+    uint64_t backlog_high_water_mark;
+
+    /** Notifications which could not be deserialized */
+    uint64_t dropped_malformed;
+
+    /** Unknown notifications and notifications without callback */
+    uint64_t dropped_unhandled;
+
+} sai_redis_notification_stats_t;
+
+/**
+ * @brief Phase of operation measured by latency statistics
+ */
+typedef enum _sai_redis_latency_phase_t
+{
+    /** Whole api call, as seen by caller */
+    SAI_REDIS_LATENCY_PHASE_TOTAL,
+
+    /** Serialization of key and attributes, deserialization for get */
+    SAI_REDIS_LATENCY_PHASE_SERIALIZE,
+
+    /** Time operation waited in pipeline before its batch was written */
+    SAI_REDIS_LATENCY_PHASE_QUEUE,
+
+    /** Redis round trip of batch with operation, HMGET for get */
+    SAI_REDIS_LATENCY_PHASE_WRITE,
+
+    SAI_REDIS_LATENCY_PHASE_MAX
+
+} sai_redis_latency_phase_t;
+
+/**
+ * @brief Latency histogram summary of one object type, api and phase
+ *
+ * Percentiles are upper bounds of histogram buckets, within 12.5% of
+ * recorded value.
+ */
+typedef struct _sai_redis_latency_stats_t
+{
+    sai_object_type_t object_type;
+
+    sai_common_api_t api;
+
+    /** Operations of bulk api, total and serialize are per bulk call */
+    bool bulk;
+
+    sai_redis_latency_phase_t phase;
+
+    /** Number of recorded samples */
+    uint64_t count;
+
+    uint64_t total_ns;
+
+    uint64_t min_ns;
+
+    uint64_t max_ns;
+
+    uint64_t p50_ns;
+
+    uint64_t p90_ns;
+
+    uint64_t p99_ns;
+
+    uint64_t p999_ns;
+
+} sai_redis_latency_stats_t;
+
+/**
+ * Routine Description:
+ *     @brief Writes all operations buffered by sairedis to redis.
+ *
+ *     Operations are sent in batches when batch size or flush latency
+ *     configured in profile is reached, this call forces write of
+ *     current batch and returns after redis accepted it.
+ *
+ * Arguments:
+ *     None
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             Failure status code on error
+ */
+sai_status_t sai_redis_flush(
+        void);
+
+/**
+ * Routine Description:
+ *     @brief Waits until all operations queued by sairedis before this
+ *     call are committed to redis. In async mode this is the barrier
+ *     for caller which needs data in redis, otherwise same as flush.
+ *
+ * Arguments:
+ *     None
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             Failure status code when write of last batch failed
+ */
+sai_status_t sai_redis_sync(
+        void);
+
+/**
+ * Routine Description:
+ *     @brief Registers notification called from writer thread for
+ *     every operation which could not be written to redis.
+ *
+ * Arguments:
+ *     @param[in] notification - notification, NULL to unregister
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             Failure status code on error
+ */
+sai_status_t sai_redis_set_error_notification(
+        _In_ sai_redis_error_notification_fn notification);
+
+/*
+ * Bulk operations on route, neighbor and fdb entries. Whole batch is
+ * serialized in one pass and written to redis as single pipeline,
+ * each entry gets its own status. Bulk set takes one attribute per
+ * entry. Return value is SAI_STATUS_FAILURE when any entry failed.
+ *
+ * Bulk get serves attributes from cache when possible and reads rest
+ * of each entry with HMGET, HMGETs are pipelined in chunks of 1024
+ * entries. Status of entry is same as get of single entry would
+ * return. Bulk get of objects works for any object type identified by
+ * object id.
+ */
+
+sai_status_t redis_bulk_create_routes(
+        _In_ uint32_t count,
+        _In_ const sai_unicast_route_entry_t *unicast_route_entries,
+        _In_ const uint32_t *attr_counts,
+        _In_ const sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_remove_routes(
+        _In_ uint32_t count,
+        _In_ const sai_unicast_route_entry_t *unicast_route_entries,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_set_routes(
+        _In_ uint32_t count,
+        _In_ const sai_unicast_route_entry_t *unicast_route_entries,
+        _In_ const sai_attribute_t *attr_list,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_get_routes(
+        _In_ uint32_t count,
+        _In_ const sai_unicast_route_entry_t *unicast_route_entries,
+        _In_ const uint32_t *attr_counts,
+        _Inout_ sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_create_neighbor_entries(
+        _In_ uint32_t count,
+        _In_ const sai_neighbor_entry_t *neighbor_entries,
+        _In_ const uint32_t *attr_counts,
+        _In_ const sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_remove_neighbor_entries(
+        _In_ uint32_t count,
+        _In_ const sai_neighbor_entry_t *neighbor_entries,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_set_neighbor_entries(
+        _In_ uint32_t count,
+        _In_ const sai_neighbor_entry_t *neighbor_entries,
+        _In_ const sai_attribute_t *attr_list,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_get_neighbor_entries(
+        _In_ uint32_t count,
+        _In_ const sai_neighbor_entry_t *neighbor_entries,
+        _In_ const uint32_t *attr_counts,
+        _Inout_ sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_create_fdb_entries(
+        _In_ uint32_t count,
+        _In_ const sai_fdb_entry_t *fdb_entries,
+        _In_ const uint32_t *attr_counts,
+        _In_ const sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_remove_fdb_entries(
+        _In_ uint32_t count,
+        _In_ const sai_fdb_entry_t *fdb_entries,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_set_fdb_entries(
+        _In_ uint32_t count,
+        _In_ const sai_fdb_entry_t *fdb_entries,
+        _In_ const sai_attribute_t *attr_list,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_get_fdb_entries(
+        _In_ uint32_t count,
+        _In_ const sai_fdb_entry_t *fdb_entries,
+        _In_ const uint32_t *attr_counts,
+        _Inout_ sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+sai_status_t redis_bulk_get_objects(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const sai_object_id_t *object_ids,
+        _In_ const uint32_t *attr_counts,
+        _Inout_ sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses);
+
+/**
+ * Routine Description:
+ *     @brief Returns attribute cache hit/miss counters.
+ *
+ * Arguments:
+ *     @param[out] stats - cache statistics
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_NOT_SUPPORTED when cache is disabled in profile
+ */
+sai_status_t sai_redis_get_attr_cache_stats(
+        _Out_ sai_redis_attr_cache_stats_t *stats);
+
+/**
+ * Routine Description:
+ *     @brief Returns number of operations dropped by write combining,
+ *     sets replaced by later set of same attribute and creates removed
+ *     before they were written, including the removes.
+ *
+ * Arguments:
+ *     @param[out] count - number of coalesced writes
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             Failure status code on error
+ */
+sai_status_t sai_redis_get_coalesced_writes(
+        _Out_ uint64_t *count);
+
+/**
+ * Routine Description:
+ *     @brief Returns statistics of notification consumer started by
+ *     initialize or connect switch.
+ *
+ * Arguments:
+ *     @param[out] stats - notification statistics
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_UNINITIALIZED when switch is not initialized
+ */
+sai_status_t sai_redis_get_notification_stats(
+        _Out_ sai_redis_notification_stats_t *stats);
+
+/**
+ * Routine Description:
+ *     @brief Returns snapshot of latency histograms, one entry for each
+ *     object type, api and phase which has recorded samples.
+ *
+ * Arguments:
+ *     @param[inout] count - in: number of entries in stats,
+ *                           out: number of entries in snapshot
+ *     @param[out] stats - latency statistics
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_BUFFER_OVERFLOW when stats is too small,
+ *             count is set to required size
+ *             SAI_STATUS_NOT_SUPPORTED when disabled in profile
+ */
+sai_status_t sai_redis_get_latency_stats(
+        _Inout_ uint32_t *count,
+        _Out_ sai_redis_latency_stats_t *stats);
+
+/**
+ * Routine Description:
+ *     @brief Waits for pending operations and writes view of objects
+ *     to snapshot file set by SAI_REDIS_SNAPSHOT_FILE profile key.
+ *     Snapshot is also written by sai_api_uninitialize.
+ *
+ * Arguments:
+ *     None
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_NOT_SUPPORTED when snapshot file is not set
+ *             Failure status code on error
+ */
+sai_status_t sai_redis_checkpoint(
+        void);
+
+/**
+ * Routine Description:
+ *     @brief Returns statistics of view of objects, absorbed count
+ *     shows how much of warm boot replay was not written again.
+ *
+ * Arguments:
+ *     @param[out] stats - view statistics
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_NOT_SUPPORTED when snapshot file is not set
+ */
+sai_status_t sai_redis_get_view_stats(
+        _Out_ sai_redis_view_stats_t *stats);
+
+/**
+ * Routine Description:
+ *     @brief Gets statistics counters of object together with time they
+ *     were read at, so caller can compute rates from consecutive reads.
+ *     Counters are served from snapshot polled each
+ *     SAI_SWITCH_ATTR_COUNTER_REFRESH_INTERVAL, same as get stats
+ *     methods of port, vlan, queue and ingress priority group.
+ *
+ * Arguments:
+ *     @param[in] object_type - object type
+ *     @param[in] object_id - object id, vlan id for vlan
+ *     @param[in] number_of_counters - number of counters in the array
+ *     @param[in] counter_ids - counter ids of object type
+ *     @param[out] counters - counter values
+ *     @param[out] timestamp_ns - monotonic time counters were read at
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_ITEM_NOT_FOUND when counter is not in COUNTERS
+ *             Failure status code on error
+ */
+sai_status_t sai_redis_get_counters(
+        _In_ sai_object_type_t object_type,
+        _In_ uint64_t object_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids,
+        _Out_ uint64_t *counters,
+        _Out_ uint64_t *timestamp_ns);
+
+/**
+ * Routine Description:
+ *     @brief Returns statistics of counter poller.
+ *
+ * Arguments:
+ *     @param[out] stats - counter poller statistics
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_UNINITIALIZED when SAI API is not initialized
+ */
+sai_status_t sai_redis_get_counter_stats(
+        _Out_ sai_redis_counter_stats_t *stats);
+
+/**
+ * Routine Description:
+ *     @brief Returns statistics of recording of calls to file set by
+ *     SAI_REDIS_RECORD_FILE.
+ *
+ * Arguments:
+ *     @param[out] stats - recorder statistics
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_NOT_SUPPORTED when record file is not set
+ */
+sai_status_t sai_redis_get_recorder_stats(
+        _Out_ sai_redis_recorder_stats_t *stats);
+
+/**
+ * Routine Description:
+ *     @brief Returns statistics of change journal set by
+ *     SAI_REDIS_JOURNAL_NAME.
+ *
+ * Arguments:
+ *     @param[out] stats - journal statistics
+ *
+ * Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_NOT_SUPPORTED when journal name is not set
+ */
+sai_status_t sai_redis_get_journal_stats(
+        _Out_ sai_redis_journal_stats_t *stats);
+
+#endif // __SAIREDIS__
@@ -1,3 +1,5 @@
+#define REDIS_LOG_API SAI_API_ACL
+
 #include "sai_redis.h"
 
 /**
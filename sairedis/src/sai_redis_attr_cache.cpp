@@ -0,0 +1,135 @@
+#include "sai_redis.h"
+#include "sai_redis_attr_cache.h"
+
+RedisAttributeCache::RedisAttributeCache()
+{
+}
+
+RedisAttributeCache::Shard& RedisAttributeCache::shard(
+        _In_ const std::string &key)
+{
+    size_t hash = std::hash<std::string>()(key);
+
+    return m_shards[hash & (SAI_REDIS_ATTR_CACHE_SHARDS - 1)];
+}
+
+bool RedisAttributeCache::isCacheable(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_attr_id_t attr_id)
+{
+    return !sai_is_attr_read_only(object_type, attr_id);
+}
+
+void RedisAttributeCache::create(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::string &key,
+        _In_ uint32_t attr_count,
+        _In_ const sai_attribute_t *attr_list,
+        _In_ const std::vector<ssw::FieldValueTuple> &entry)
+{
+    Shard &s = shard(key);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    // create of existing key replaces whole object in ASIC_STATE
+    AttributeMap &attributes = s.objects[key];
+
+    attributes.clear();
+
+    for (uint32_t i = 0; i < attr_count; ++i)
+    {
+        if (isCacheable(object_type, attr_list[i].id))
+        {
+            attributes[attr_list[i].id] = fvValue(entry[i]);
+        }
+    }
+}
+
+void RedisAttributeCache::set(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::string &key,
+        _In_ sai_attr_id_t attr_id,
+        _In_ const std::string &value)
+{
+    if (!isCacheable(object_type, attr_id))
+    {
+        return;
+    }
+
+    Shard &s = shard(key);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    s.objects[key][attr_id] = value;
+}
+
+void RedisAttributeCache::remove(
+        _In_ const std::string &key)
+{
+    Shard &s = shard(key);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    s.objects.erase(key);
+}
+
+bool RedisAttributeCache::get(
+        _In_ const std::string &key,
+        _In_ sai_attr_id_t attr_id,
+        _Out_ std::string &value)
+{
+    Shard &s = shard(key);
+
+    std::unique_lock<std::mutex> lock(s.mutex);
+
+    auto object = s.objects.find(key);
+
+    if (object != s.objects.end())
+    {
+        auto attribute = object->second.find(attr_id);
+
+        if (attribute != object->second.end())
+        {
+            value = attribute->second;
+
+            lock.unlock();
+
+            s.hits.fetch_add(1, std::memory_order_relaxed);
+
+            return true;
+        }
+    }
+
+    lock.unlock();
+
+    s.misses.fetch_add(1, std::memory_order_relaxed);
+
+    return false;
+}
+
+void RedisAttributeCache::clear()
+{
+    for (auto &s: m_shards)
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        s.objects.clear();
+    }
+}
+
+void RedisAttributeCache::getStats(
+        _Out_ sai_redis_attr_cache_stats_t &stats)
+{
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.objects = 0;
+
+    for (auto &s: m_shards)
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        stats.hits += s.hits.load(std::memory_order_relaxed);
+        stats.misses += s.misses.load(std::memory_order_relaxed);
+        stats.objects += s.objects.size();
+    }
+}
@@ -1,3 +1,5 @@
+#define REDIS_LOG_API SAI_API_BUFFERS
+
 #include "sai_redis.h"
 
 /**
@@ -70,9 +72,16 @@ sai_status_t redis_get_ingress_priority_group_stats(
 {
     REDIS_LOG_ENTER();
 
+    sai_status_t status = redis_generic_get_stats(
+            SAI_OBJECT_TYPE_PRIORITY_GROUP,
+            ingress_pg_id,
+            number_of_counters,
+            (const int32_t*)counter_ids,
+            counters);
+
     REDIS_LOG_EXIT();
 
-    return SAI_STATUS_NOT_IMPLEMENTED;
+    return status;
 }
 
 /**
@@ -92,9 +101,15 @@ sai_status_t redis_clear_ingress_priority_group_stats(
 {
     REDIS_LOG_ENTER();
 
+    sai_status_t status = redis_generic_clear_stats(
+            SAI_OBJECT_TYPE_PRIORITY_GROUP,
+            ingress_pg_id,
+            number_of_counters,
+            (const int32_t*)counter_ids);
+
     REDIS_LOG_EXIT();
 
-    return SAI_STATUS_NOT_IMPLEMENTED;
+    return status;
 }
 
 /**
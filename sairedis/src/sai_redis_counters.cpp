@@ -0,0 +1,705 @@
+#include "sai_redis.h"
+#include "sai_redis_counters.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+// commands written to connection before replies are read
+#define SAI_REDIS_COUNTERS_POLL_CHUNK 1024
+
+static_assert(SAI_PORT_STAT_ETHER_OUT_PKTS_9217_TO_16383_OCTETS < SAI_REDIS_COUNTERS_MAX, "port counters don't fit in snapshot");
+static_assert(SAI_QUEUE_STAT_WATERMARK_BYTES < SAI_REDIS_COUNTERS_MAX, "queue counters don't fit in snapshot");
+
+static uint64_t redis_counters_now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RedisCounterPoller::RedisCounterPoller(
+        _In_ ssw::DBConnector *db,
+        _In_ uint64_t interval_ms):
+    m_db(db),
+    m_published(0),
+    m_intervalMs(interval_ms),
+    m_running(true),
+    m_polls(0),
+    m_pollErrors(0),
+    m_lastPollNs(0),
+    m_snapshotReads(0),
+    m_directReads(0)
+{
+    for (auto &snapshot: m_snapshots)
+    {
+        snapshot.timestamp = 0;
+        snapshot.readers = 0;
+    }
+
+    m_thread = std::thread(&RedisCounterPoller::pollerThread, this);
+}
+
+RedisCounterPoller::~RedisCounterPoller()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_intervalMutex);
+
+        m_running = false;
+    }
+
+    m_intervalCv.notify_one();
+
+    m_thread.join();
+
+    delete m_db;
+}
+
+void RedisCounterPoller::setInterval(
+        _In_ uint64_t interval_ms)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_intervalMutex);
+
+        m_intervalMs = interval_ms;
+    }
+
+    // poller starts new interval right away
+    m_intervalCv.notify_one();
+}
+
+void RedisCounterPoller::getStats(
+        _Out_ sai_redis_counter_stats_t &stats) const
+{
+    stats.polls = m_polls.load(std::memory_order_relaxed);
+    stats.poll_errors = m_pollErrors.load(std::memory_order_relaxed);
+    stats.last_poll_ns = m_lastPollNs.load(std::memory_order_relaxed);
+    stats.snapshot_reads = m_snapshotReads.load(std::memory_order_relaxed);
+    stats.direct_reads = m_directReads.load(std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(m_objectsMutex);
+
+        stats.objects = m_slots.size();
+    }
+}
+
+RedisCounterPoller::Object* RedisCounterPoller::getObject(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::string &serialized_object_id)
+{
+    static thread_local std::string key;
+
+    key = COUNTERS_TABLE ":";
+
+    sai_serialize_object_key(g_serialization_format, object_type, serialized_object_id, key);
+
+    std::lock_guard<std::mutex> lock(m_objectsMutex);
+
+    auto it = m_objects.find(key);
+
+    if (it != m_objects.end())
+    {
+        return it->second.get();
+    }
+
+    Object *object = new Object();
+
+    object->tableKey = key;
+    object->slot = m_slots.size();
+
+    for (auto &baseline: object->baseline)
+    {
+        baseline = 0;
+    }
+
+    m_objects[key].reset(object);
+    m_slots.push_back(object);
+
+    return object;
+}
+
+bool RedisCounterPoller::parseReply(
+        _In_ const redisReply *reply,
+        _Out_ Values &values)
+{
+    memset(values.present, 0, sizeof(values.present));
+
+    // missing hash is empty array
+    if (reply == NULL || reply->type != REDIS_REPLY_ARRAY || reply->elements % 2 != 0)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < reply->elements; i += 2)
+    {
+        const redisReply *field = reply->element[i];
+        const redisReply *value = reply->element[i + 1];
+
+        if (field->type != REDIS_REPLY_STRING || value->type != REDIS_REPLY_STRING)
+        {
+            return false;
+        }
+
+        char *end;
+
+        unsigned long id = strtoul(field->str, &end, 10);
+
+        if (*end != 0 || end == field->str || id >= SAI_REDIS_COUNTERS_MAX)
+        {
+            // custom range counters are not supported
+            continue;
+        }
+
+        values.counters[id] = strtoull(value->str, NULL, 10);
+        values.present[id / 64] |= (1ULL << (id % 64));
+    }
+
+    return true;
+}
+
+sai_status_t RedisCounterPoller::pick(
+        _In_ const Values &values,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids,
+        _Out_ uint64_t *counters)
+{
+    if (counter_ids == NULL)
+    {
+        for (uint32_t id = 0; id < SAI_REDIS_COUNTERS_MAX; ++id)
+        {
+            bool present = (values.present[id / 64] & (1ULL << (id % 64))) != 0;
+
+            counters[id] = present ? values.counters[id] : 0;
+        }
+
+        return SAI_STATUS_SUCCESS;
+    }
+
+    for (uint32_t i = 0; i < number_of_counters; ++i)
+    {
+        int32_t id = counter_ids[i];
+
+        if ((values.present[id / 64] & (1ULL << (id % 64))) == 0)
+        {
+            return SAI_STATUS_ITEM_NOT_FOUND;
+        }
+
+        counters[i] = values.counters[id];
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t RedisCounterPoller::readDirect(
+        _In_ const Object &object,
+        _Out_ Values &values)
+{
+    REDIS_LOG_ENTER();
+
+    const char *argv[] = { "HGETALL", object.tableKey.data() };
+    size_t argvlen[] = { 7, object.tableKey.size() };
+
+    redisReply *reply;
+
+    {
+        std::lock_guard<std::mutex> lock(m_dbMutex);
+
+        reply = (redisReply*)redisCommandArgv(m_db->getContext(), 2, argv, argvlen);
+
+        if (reply == NULL)
+        {
+            redis_reconnect_db(m_db);
+        }
+    }
+
+    m_directReads.fetch_add(1, std::memory_order_relaxed);
+
+    if (reply == NULL)
+    {
+        REDIS_LOG_ERR("Failed to read counters from %s", object.tableKey.c_str());
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    bool ok = parseReply(reply, values);
+
+    freeReplyObject(reply);
+
+    if (!ok)
+    {
+        REDIS_LOG_ERR("Unexpected counters reply of %s", object.tableKey.c_str());
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t RedisCounterPoller::read(
+        _In_ const Object &object,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids,
+        _Out_ uint64_t *values,
+        _Out_ uint64_t &timestamp)
+{
+    if (m_intervalMs.load(std::memory_order_relaxed) != 0)
+    {
+        while (true)
+        {
+            uint32_t index = m_published.load();
+
+            Snapshot &snapshot = m_snapshots[index];
+
+            snapshot.readers.fetch_add(1);
+
+            // poller may have started to fill this snapshot before
+            // reader was counted, it then publishes other one first
+            if (m_published.load() != index)
+            {
+                snapshot.readers.fetch_sub(1);
+                continue;
+            }
+
+            bool found = (snapshot.timestamp != 0 && object.slot < snapshot.values.size());
+
+            sai_status_t status = SAI_STATUS_SUCCESS;
+
+            if (found)
+            {
+                status = pick(snapshot.values[object.slot], number_of_counters, counter_ids, values);
+
+                timestamp = snapshot.timestamp;
+            }
+
+            snapshot.readers.fetch_sub(1);
+
+            if (found)
+            {
+                m_snapshotReads.fetch_add(1, std::memory_order_relaxed);
+
+                return status;
+            }
+
+            // object registered after last poll
+            break;
+        }
+    }
+
+    static thread_local Values direct;
+
+    timestamp = redis_counters_now();
+
+    sai_status_t status = readDirect(object, direct);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    return pick(direct, number_of_counters, counter_ids, values);
+}
+
+sai_status_t RedisCounterPoller::get(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::string &serialized_object_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids,
+        _Out_ uint64_t *counters,
+        _Out_ uint64_t *timestamp_ns)
+{
+    REDIS_LOG_ENTER();
+
+    if (counter_ids == NULL || counters == NULL)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    for (uint32_t i = 0; i < number_of_counters; ++i)
+    {
+        if (counter_ids[i] < 0 || counter_ids[i] >= SAI_REDIS_COUNTERS_MAX)
+        {
+            REDIS_LOG_ERR("Counter id %d is not supported", counter_ids[i]);
+
+            REDIS_LOG_EXIT();
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    Object *object = getObject(object_type, serialized_object_id);
+
+    uint64_t timestamp;
+
+    sai_status_t status = read(*object, number_of_counters, counter_ids, counters, timestamp);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    for (uint32_t i = 0; i < number_of_counters; ++i)
+    {
+        uint64_t baseline = object->baseline[counter_ids[i]].load(std::memory_order_relaxed);
+
+        // counter went below cleared value when switch side restarted
+        if (counters[i] >= baseline)
+        {
+            counters[i] -= baseline;
+        }
+    }
+
+    if (timestamp_ns != NULL)
+    {
+        *timestamp_ns = timestamp;
+    }
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t RedisCounterPoller::clear(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::string &serialized_object_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids)
+{
+    REDIS_LOG_ENTER();
+
+    if (counter_ids != NULL)
+    {
+        for (uint32_t i = 0; i < number_of_counters; ++i)
+        {
+            if (counter_ids[i] < 0 || counter_ids[i] >= SAI_REDIS_COUNTERS_MAX)
+            {
+                REDIS_LOG_ERR("Counter id %d is not supported", counter_ids[i]);
+
+                REDIS_LOG_EXIT();
+                return SAI_STATUS_INVALID_PARAMETER;
+            }
+        }
+    }
+    else
+    {
+        number_of_counters = SAI_REDIS_COUNTERS_MAX;
+    }
+
+    Object *object = getObject(object_type, serialized_object_id);
+
+    uint64_t values[SAI_REDIS_COUNTERS_MAX];
+
+    uint64_t timestamp;
+
+    // cleared to value of same snapshot gets are served from, so get
+    // right after clear returns 0
+    sai_status_t status = read(*object, number_of_counters, counter_ids, values, timestamp);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    for (uint32_t i = 0; i < number_of_counters; ++i)
+    {
+        int32_t id = (counter_ids == NULL) ? (int32_t)i : counter_ids[i];
+
+        object->baseline[id].store(values[i], std::memory_order_relaxed);
+    }
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void RedisCounterPoller::pollerThread()
+{
+    std::unique_lock<std::mutex> lock(m_intervalMutex);
+
+    while (m_running)
+    {
+        uint64_t interval = m_intervalMs;
+
+        if (interval == 0)
+        {
+            m_intervalCv.wait(lock);
+            continue;
+        }
+
+        m_intervalCv.wait_for(lock, std::chrono::milliseconds(interval));
+
+        if (!m_running || m_intervalMs == 0)
+        {
+            continue;
+        }
+
+        lock.unlock();
+
+        poll();
+
+        lock.lock();
+    }
+}
+
+sai_status_t RedisCounterPoller::poll()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_objectsMutex);
+
+        m_pollSlots = m_slots;
+    }
+
+    if (m_pollSlots.empty())
+    {
+        return SAI_STATUS_SUCCESS;
+    }
+
+    uint32_t index = 1 - m_published.load();
+
+    Snapshot &snapshot = m_snapshots[index];
+
+    // readers which counted themselves before last publish
+    while (snapshot.readers.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+
+    uint64_t start = redis_counters_now();
+
+    snapshot.values.resize(m_pollSlots.size());
+
+    bool ok = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_dbMutex);
+
+        redisContext *ctx = m_db->getContext();
+
+        for (size_t base = 0; ok && base < m_pollSlots.size(); base += SAI_REDIS_COUNTERS_POLL_CHUNK)
+        {
+            size_t chunk = std::min((size_t)SAI_REDIS_COUNTERS_POLL_CHUNK, m_pollSlots.size() - base);
+
+            size_t pending = 0;
+
+            for (size_t i = 0; i < chunk; ++i)
+            {
+                const std::string &key = m_pollSlots[base + i]->tableKey;
+
+                const char *argv[] = { "HGETALL", key.data() };
+                size_t argvlen[] = { 7, key.size() };
+
+                if (redisAppendCommandArgv(ctx, 2, argv, argvlen) != REDIS_OK)
+                {
+                    ok = false;
+                    break;
+                }
+
+                pending++;
+            }
+
+            // replies come in order of commands, all are read so
+            // connection stays usable
+
+            for (size_t i = 0; i < pending; ++i)
+            {
+                void *reply = NULL;
+
+                if (redisGetReply(ctx, &reply) != REDIS_OK)
+                {
+                    REDIS_LOG_ERR("Failed to read counters: %s", ctx->errstr);
+
+                    // replies still pending are lost with context
+                    redis_reconnect_db(m_db);
+
+                    ok = false;
+                    break;
+                }
+
+                Values &values = snapshot.values[base + i];
+
+                if (!parseReply((redisReply*)reply, values))
+                {
+                    REDIS_LOG_WRN("Unexpected counters reply of %s", m_pollSlots[base + i]->tableKey.c_str());
+                }
+
+                freeReplyObject(reply);
+            }
+        }
+    }
+
+    if (!ok)
+    {
+        // previous snapshot stays published
+        m_pollErrors.fetch_add(1, std::memory_order_relaxed);
+        return SAI_STATUS_FAILURE;
+    }
+
+    snapshot.timestamp = start;
+
+    m_published.store(index);
+
+    m_polls.fetch_add(1, std::memory_order_relaxed);
+    m_lastPollNs.store(redis_counters_now() - start, std::memory_order_relaxed);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+/**
+ * Routine Description:
+ *   @brief Generic get statistics counters
+ *
+ * Arguments:
+ *    @param[in] object_type - the object type
+ *    @param[in] object_id - the object id
+ *    @param[in] number_of_counters - number of counters in the array
+ *    @param[in] counter_ids - specifies the array of counter ids
+ *    @param[out] counters - array of resulting counter values
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS on success
+ *            SAI_STATUS_ITEM_NOT_FOUND when counter is not in COUNTERS
+ *            Failure status code on error
+ */
+sai_status_t redis_generic_get_stats(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_object_id_t object_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids,
+        _Out_ uint64_t *counters)
+{
+    REDIS_LOG_ENTER();
+
+    if (g_counterPoller == NULL)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    static thread_local std::string str_object_id;
+
+    str_object_id.clear();
+    sai_serialize_primitive(g_serialization_format, object_id, str_object_id);
+
+    sai_status_t status = g_counterPoller->get(
+            object_type,
+            str_object_id,
+            number_of_counters,
+            counter_ids,
+            counters,
+            NULL);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+sai_status_t redis_generic_get_stats_vlan(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_vlan_id_t vlan_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids,
+        _Out_ uint64_t *counters)
+{
+    REDIS_LOG_ENTER();
+
+    if (g_counterPoller == NULL)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    static thread_local std::string str_vlan_id;
+
+    str_vlan_id.clear();
+    sai_serialize_primitive(g_serialization_format, vlan_id, str_vlan_id);
+
+    sai_status_t status = g_counterPoller->get(
+            object_type,
+            str_vlan_id,
+            number_of_counters,
+            counter_ids,
+            counters,
+            NULL);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ * Routine Description:
+ *   @brief Generic clear statistics counters, counters keep running in
+ *   COUNTERS and cleared values are subtracted on get
+ *
+ * Arguments:
+ *    @param[in] object_type - the object type
+ *    @param[in] object_id - the object id
+ *    @param[in] number_of_counters - number of counters in the array
+ *    @param[in] counter_ids - specifies the array of counter ids, NULL
+ *                             clears all counters
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS on success
+ *            Failure status code on error
+ */
+sai_status_t redis_generic_clear_stats(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_object_id_t object_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids)
+{
+    REDIS_LOG_ENTER();
+
+    if (g_counterPoller == NULL)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    std::string str_object_id;
+    sai_serialize_primitive(g_serialization_format, object_id, str_object_id);
+
+    sai_status_t status = g_counterPoller->clear(
+            object_type,
+            str_object_id,
+            number_of_counters,
+            counter_ids);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+sai_status_t redis_generic_clear_stats_vlan(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_vlan_id_t vlan_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids)
+{
+    REDIS_LOG_ENTER();
+
+    if (g_counterPoller == NULL)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    std::string str_vlan_id;
+    sai_serialize_primitive(g_serialization_format, vlan_id, str_vlan_id);
+
+    sai_status_t status = g_counterPoller->clear(
+            object_type,
+            str_vlan_id,
+            number_of_counters,
+            counter_ids);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
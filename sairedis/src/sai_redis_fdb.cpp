@@ -1,3 +1,5 @@
+#define REDIS_LOG_API SAI_API_FDB
+
 #include "sai_redis.h"
 
 /**
@@ -156,6 +158,146 @@ void  redis_fdb_event_notification(
     REDIS_LOG_EXIT();
 }
 
+/**
+ * Routine Description:
+ *    @brief Bulk create fdb entries
+ *
+ * Arguments:
+ *    @param[in] count - number of entries
+ *    @param[in] fdb_entries - array of entries
+ *    @param[in] attr_counts - number of attributes of each entry
+ *    @param[in] attr_lists - attributes of each entry
+ *    @param[out] statuses - status of each entry
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS when all entries succeeded
+ *            SAI_STATUS_FAILURE when any entry failed, see statuses
+ */
+sai_status_t redis_bulk_create_fdb_entries(
+    _In_ uint32_t count,
+    _In_ const sai_fdb_entry_t *fdb_entries,
+    _In_ const uint32_t *attr_counts,
+    _In_ const sai_attribute_t **attr_lists,
+    _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_generic_create(
+            SAI_OBJECT_TYPE_FDB,
+            count,
+            fdb_entries,
+            attr_counts,
+            attr_lists,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ * Routine Description:
+ *    @brief Bulk remove fdb entries
+ *
+ * Arguments:
+ *    @param[in] count - number of entries
+ *    @param[in] fdb_entries - array of entries
+ *    @param[out] statuses - status of each entry
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS when all entries succeeded
+ *            SAI_STATUS_FAILURE when any entry failed, see statuses
+ */
+sai_status_t redis_bulk_remove_fdb_entries(
+    _In_ uint32_t count,
+    _In_ const sai_fdb_entry_t *fdb_entries,
+    _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_generic_remove(
+            SAI_OBJECT_TYPE_FDB,
+            count,
+            fdb_entries,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ * Routine Description:
+ *    @brief Bulk set attribute of fdb entries
+ *
+ * Arguments:
+ *    @param[in] count - number of entries
+ *    @param[in] fdb_entries - array of entries
+ *    @param[in] attr_list - attribute to set, one for each entry
+ *    @param[out] statuses - status of each entry
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS when all entries succeeded
+ *            SAI_STATUS_FAILURE when any entry failed, see statuses
+ */
+sai_status_t redis_bulk_set_fdb_entries(
+    _In_ uint32_t count,
+    _In_ const sai_fdb_entry_t *fdb_entries,
+    _In_ const sai_attribute_t *attr_list,
+    _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_generic_set(
+            SAI_OBJECT_TYPE_FDB,
+            count,
+            fdb_entries,
+            attr_list,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ * Routine Description:
+ *    @brief Bulk get attributes of fdb entries, reads of all entries
+ *    are pipelined
+ *
+ * Arguments:
+ *    @param[in] count - number of entries
+ *    @param[in] fdb_entries - array of entries
+ *    @param[in] attr_counts - number of attributes of each entry
+ *    @param[inout] attr_lists - attributes of each entry
+ *    @param[out] statuses - status of each entry
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS when all entries succeeded
+ *            SAI_STATUS_FAILURE when any entry failed, see statuses
+ */
+sai_status_t redis_bulk_get_fdb_entries(
+    _In_ uint32_t count,
+    _In_ const sai_fdb_entry_t *fdb_entries,
+    _In_ const uint32_t *attr_counts,
+    _Inout_ sai_attribute_t **attr_lists,
+    _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_generic_get(
+            SAI_OBJECT_TYPE_FDB,
+            count,
+            fdb_entries,
+            attr_counts,
+            attr_lists,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
 /**
  * @brief FDB method table retrieved with sai_api_query()
  */
@@ -0,0 +1,534 @@
+#include "sai_redis.h"
+
+#include <initializer_list>
+
+/*
+ * Bulk operations serialize whole batch in one pass into operations
+ * which are written to ASIC_STATE as single pipeline. Entry which
+ * fails to serialize gets its own status and is skipped, other
+ * entries are still written. Entry identical to view of objects is
+ * not written and succeeds.
+ */
+
+template<typename T>
+static void redis_serialize_entry(
+        _In_ const T &entry,
+        _Out_ std::string &s)
+{
+    // same key as single entry api builds
+    sai_serialize_entry(g_serialization_format, entry, s);
+}
+
+static void redis_serialize_entry(
+        _In_ const sai_object_id_t &object_id,
+        _Out_ std::string &s)
+{
+    sai_serialize_primitive(g_serialization_format, object_id, s);
+}
+
+template<typename T>
+static void redis_serialize_entries(
+        _In_ uint32_t count,
+        _In_ const T *entries,
+        _Out_ std::vector<std::string> &serialized_entries)
+{
+    serialized_entries.resize(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        redis_serialize_entry(entries[i], serialized_entries[i]);
+    }
+}
+
+/**
+ *   Routine Description:
+ *    @brief Checks arrays of bulk call, arrays may be NULL only when
+ *    count is 0
+ *
+ *  Arguments:
+ *  @param[in] count - number of objects
+ *  @param[in] arrays - every array call takes, entries, attributes and
+ *  statuses
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS when arrays are valid
+ *             SAI_STATUS_INVALID_PARAMETER otherwise
+ */
+static sai_status_t redis_bulk_check_arrays(
+        _In_ uint32_t count,
+        _In_ std::initializer_list<const void*> arrays)
+{
+    if (count == 0)
+    {
+        return SAI_STATUS_SUCCESS;
+    }
+
+    for (const void *array: arrays)
+    {
+        if (array == NULL)
+        {
+            REDIS_LOG_ERR("NULL array passed to bulk call of %u objects", count);
+
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Writes operations of bulk call, records its latency when
+ *    write succeeded
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of objects
+ *  @param[in] api - api of bulk call
+ *  @param[in] start - time bulk call started
+ *  @param[in] serialized - time objects were serialized
+ *  @param[in] operations - operations to write
+ *  @param[in] count - number of objects
+ *  @param[inout] statuses - status of each object, failed write fails
+ *  objects which succeeded so far
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS when all objects succeeded
+ *             SAI_STATUS_FAILURE when any object failed
+ */
+static sai_status_t redis_bulk_write(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_common_api_t api,
+        _In_ uint64_t start,
+        _In_ uint64_t serialized,
+        _In_ std::vector<RedisPipeline::Operation> &operations,
+        _In_ uint32_t count,
+        _Inout_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = g_asicStatePipeline->bulk(operations);
+
+    if (status == SAI_STATUS_SUCCESS)
+    {
+        redis_latency_record(object_type, api, true, SAI_REDIS_LATENCY_PHASE_SERIALIZE, start, serialized);
+        redis_latency_record(object_type, api, true, SAI_REDIS_LATENCY_PHASE_TOTAL, start, redis_latency_now());
+    }
+    else
+    {
+        REDIS_LOG_ERR("Failed to write %zu operations of bulk call to ASIC_STATE, status: %d", operations.size(), status);
+    }
+
+    // transport leaves operations it did not write
+    for (const auto &operation: operations)
+    {
+        redis_evict_unwritten_object(operation.key);
+    }
+
+    bool all_succeeded = true;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (status != SAI_STATUS_SUCCESS && statuses[i] == SAI_STATUS_SUCCESS)
+        {
+            statuses[i] = status;
+        }
+
+        all_succeeded &= (statuses[i] == SAI_STATUS_SUCCESS);
+    }
+
+    REDIS_LOG_EXIT();
+
+    return all_succeeded ? SAI_STATUS_SUCCESS : SAI_STATUS_FAILURE;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Internal bulk create
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of objects
+ *  @param[in] serialized_object_ids - serialized object ids
+ *  @param[in] attr_counts - number of attributes of each object
+ *  @param[in] attr_lists - attributes of each object
+ *  @param[out] statuses - status of each object
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS when all objects succeeded
+ *             SAI_STATUS_FAILURE when any object failed
+ */
+sai_status_t internal_redis_bulk_generic_create(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::vector<std::string> &serialized_object_ids,
+        _In_ const uint32_t *attr_counts,
+        _In_ const sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    uint64_t start = redis_latency_now();
+
+    uint32_t count = (uint32_t)serialized_object_ids.size();
+
+    std::string str_common_api;
+    sai_serialize_primitive(g_serialization_format, SAI_COMMON_API_CREATE, str_common_api);
+
+    std::vector<RedisPipeline::Operation> operations;
+
+    operations.reserve(count);
+
+    // buffers are reused for all entries
+    std::vector<ssw::FieldValueTuple> entry;
+    std::string key;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        statuses[i] = internal_redis_serialize_attr_list(object_type, attr_counts[i], attr_lists[i], entry);
+
+        if (statuses[i] != SAI_STATUS_SUCCESS)
+        {
+            continue;
+        }
+
+        key.clear();
+        sai_serialize_object_key(g_serialization_format, object_type, serialized_object_ids[i], key);
+
+        if (g_attrCache != NULL)
+        {
+            g_attrCache->create(object_type, key, attr_counts[i], attr_lists[i], entry);
+        }
+
+        if (g_objectView != NULL && g_objectView->create(object_type, SAI_NULL_OBJECT_ID, key, entry))
+        {
+            continue;
+        }
+
+        operations.push_back(RedisPipeline::setOperation(key, entry, str_common_api, object_type, SAI_COMMON_API_CREATE));
+    }
+
+    uint64_t serialized = redis_latency_now();
+
+    sai_status_t status = redis_bulk_write(object_type, SAI_COMMON_API_CREATE, start, serialized, operations, count, statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Internal bulk remove
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of objects
+ *  @param[in] serialized_object_ids - serialized object ids
+ *  @param[out] statuses - status of each object
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS when all objects succeeded
+ *             SAI_STATUS_FAILURE when any object failed
+ */
+sai_status_t internal_redis_bulk_generic_remove(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::vector<std::string> &serialized_object_ids,
+        _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    uint64_t start = redis_latency_now();
+
+    uint32_t count = (uint32_t)serialized_object_ids.size();
+
+    std::string str_common_api;
+    sai_serialize_primitive(g_serialization_format, SAI_COMMON_API_REMOVE, str_common_api);
+
+    std::vector<RedisPipeline::Operation> operations;
+
+    operations.reserve(count);
+
+    std::string key;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        key.clear();
+        sai_serialize_object_key(g_serialization_format, object_type, serialized_object_ids[i], key);
+
+        if (g_attrCache != NULL)
+        {
+            g_attrCache->remove(key);
+        }
+
+        if (g_objectView != NULL)
+        {
+            g_objectView->remove(key);
+        }
+
+        operations.push_back(RedisPipeline::delOperation(key, str_common_api, object_type));
+
+        statuses[i] = SAI_STATUS_SUCCESS;
+    }
+
+    uint64_t serialized = redis_latency_now();
+
+    sai_status_t status = redis_bulk_write(object_type, SAI_COMMON_API_REMOVE, start, serialized, operations, count, statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Internal bulk set, one attribute per object
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of objects
+ *  @param[in] serialized_object_ids - serialized object ids
+ *  @param[in] attr_list - attribute of each object
+ *  @param[out] statuses - status of each object
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS when all objects succeeded
+ *             SAI_STATUS_FAILURE when any object failed
+ */
+sai_status_t internal_redis_bulk_generic_set(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::vector<std::string> &serialized_object_ids,
+        _In_ const sai_attribute_t *attr_list,
+        _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    uint64_t start = redis_latency_now();
+
+    uint32_t count = (uint32_t)serialized_object_ids.size();
+
+    std::string str_common_api;
+    sai_serialize_primitive(g_serialization_format, SAI_COMMON_API_SET, str_common_api);
+
+    std::vector<RedisPipeline::Operation> operations;
+
+    operations.reserve(count);
+
+    std::vector<ssw::FieldValueTuple> entry;
+    std::string key;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        statuses[i] = internal_redis_serialize_attr_list(object_type, 1, &attr_list[i], entry);
+
+        if (statuses[i] != SAI_STATUS_SUCCESS)
+        {
+            continue;
+        }
+
+        key.clear();
+        sai_serialize_object_key(g_serialization_format, object_type, serialized_object_ids[i], key);
+
+        if (g_attrCache != NULL)
+        {
+            g_attrCache->set(object_type, key, attr_list[i].id, fvValue(entry[0]));
+        }
+
+        if (g_objectView != NULL && g_objectView->set(object_type, key, entry[0]))
+        {
+            continue;
+        }
+
+        operations.push_back(RedisPipeline::setOperation(key, entry, str_common_api, object_type, SAI_COMMON_API_SET, attr_list[i].id));
+    }
+
+    uint64_t serialized = redis_latency_now();
+
+    sai_status_t status = redis_bulk_write(object_type, SAI_COMMON_API_SET, start, serialized, operations, count, statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+template<typename T>
+sai_status_t redis_bulk_generic_create(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const T *entries,
+        _In_ const uint32_t *attr_counts,
+        _In_ const sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_check_arrays(count, { entries, attr_counts, attr_lists, statuses });
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    std::vector<std::string> serialized_entries;
+    redis_serialize_entries(count, entries, serialized_entries);
+
+    status = internal_redis_bulk_generic_create(
+            object_type,
+            serialized_entries,
+            attr_counts,
+            attr_lists,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+template<typename T>
+sai_status_t redis_bulk_generic_remove(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const T *entries,
+        _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_check_arrays(count, { entries, statuses });
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    std::vector<std::string> serialized_entries;
+    redis_serialize_entries(count, entries, serialized_entries);
+
+    status = internal_redis_bulk_generic_remove(
+            object_type,
+            serialized_entries,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+template<typename T>
+sai_status_t redis_bulk_generic_set(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const T *entries,
+        _In_ const sai_attribute_t *attr_list,
+        _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_check_arrays(count, { entries, attr_list, statuses });
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    std::vector<std::string> serialized_entries;
+    redis_serialize_entries(count, entries, serialized_entries);
+
+    status = internal_redis_bulk_generic_set(
+            object_type,
+            serialized_entries,
+            attr_list,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+template<typename T>
+sai_status_t redis_bulk_generic_get(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const T *entries,
+        _In_ const uint32_t *attr_counts,
+        _Inout_ sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_check_arrays(count, { entries, attr_counts, attr_lists, statuses });
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    std::vector<std::string> serialized_entries;
+    redis_serialize_entries(count, entries, serialized_entries);
+
+    status = internal_redis_bulk_generic_get(
+            object_type,
+            serialized_entries,
+            attr_counts,
+            attr_lists,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ * Routine Description:
+ *    @brief Bulk get attributes of objects identified by object id
+ *
+ * Arguments:
+ *    @param[in] object_type - type of objects
+ *    @param[in] count - number of objects
+ *    @param[in] object_ids - array of object ids
+ *    @param[in] attr_counts - number of attributes of each object
+ *    @param[inout] attr_lists - attributes of each object
+ *    @param[out] statuses - status of each object
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS when all objects succeeded
+ *            SAI_STATUS_FAILURE when any object failed, see statuses
+ */
+sai_status_t redis_bulk_get_objects(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const sai_object_id_t *object_ids,
+        _In_ const uint32_t *attr_counts,
+        _Inout_ sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_generic_get(
+            object_type,
+            count,
+            object_ids,
+            attr_counts,
+            attr_lists,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+// entry types which have bulk api
+
+template sai_status_t redis_bulk_generic_create(sai_object_type_t, uint32_t, const sai_fdb_entry_t*, const uint32_t*, const sai_attribute_t**, sai_status_t*);
+template sai_status_t redis_bulk_generic_create(sai_object_type_t, uint32_t, const sai_neighbor_entry_t*, const uint32_t*, const sai_attribute_t**, sai_status_t*);
+template sai_status_t redis_bulk_generic_create(sai_object_type_t, uint32_t, const sai_unicast_route_entry_t*, const uint32_t*, const sai_attribute_t**, sai_status_t*);
+
+template sai_status_t redis_bulk_generic_remove(sai_object_type_t, uint32_t, const sai_fdb_entry_t*, sai_status_t*);
+template sai_status_t redis_bulk_generic_remove(sai_object_type_t, uint32_t, const sai_neighbor_entry_t*, sai_status_t*);
+template sai_status_t redis_bulk_generic_remove(sai_object_type_t, uint32_t, const sai_unicast_route_entry_t*, sai_status_t*);
+
+template sai_status_t redis_bulk_generic_set(sai_object_type_t, uint32_t, const sai_fdb_entry_t*, const sai_attribute_t*, sai_status_t*);
+template sai_status_t redis_bulk_generic_set(sai_object_type_t, uint32_t, const sai_neighbor_entry_t*, const sai_attribute_t*, sai_status_t*);
+template sai_status_t redis_bulk_generic_set(sai_object_type_t, uint32_t, const sai_unicast_route_entry_t*, const sai_attribute_t*, sai_status_t*);
+
+template sai_status_t redis_bulk_generic_get(sai_object_type_t, uint32_t, const sai_fdb_entry_t*, const uint32_t*, sai_attribute_t**, sai_status_t*);
+template sai_status_t redis_bulk_generic_get(sai_object_type_t, uint32_t, const sai_neighbor_entry_t*, const uint32_t*, sai_attribute_t**, sai_status_t*);
+template sai_status_t redis_bulk_generic_get(sai_object_type_t, uint32_t, const sai_unicast_route_entry_t*, const uint32_t*, sai_attribute_t**, sai_status_t*);
@@ -1,14 +1,244 @@
 #include "sai_redis.h"
 
+/**
+ *   Routine Description:
+ *    @brief Serializes attribute list to field/value vector
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of object
+ *  @param[in] attr_count - number of attributes
+ *  @param[in] attr_list - array of attributes
+ *  @param[out] entry - serialized attributes, resized to attr_count,
+ *  strings already in entry are reused, so buffer kept by caller does
+ *  not allocate once it reached size of attributes
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             Failure status code on error
+ */
+sai_status_t internal_redis_serialize_attr_list(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t attr_count,
+        _In_ const sai_attribute_t *attr_list,
+        _Out_ std::vector<ssw::FieldValueTuple> &entry)
+{
+    REDIS_LOG_ENTER();
+
+    if (attr_count > 0 && attr_list == NULL)
+    {
+        entry.clear();
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    entry.resize(attr_count);
+
+    for (uint32_t i = 0; i < attr_count; ++i)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+
+        sai_attr_serialization_type_t serialization_type;
+
+        sai_status_t status = sai_get_serialization_type(object_type, attr.id, serialization_type);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            REDIS_LOG_ERR("Unable to find serialization type for object type: %u and attribute id: %u, status: %u",
+                    object_type,
+                    attr.id,
+                    status);
+
+            REDIS_LOG_EXIT();
+            return status;
+        }
+
+        std::string &str_attr_id = fvField(entry[i]);
+        str_attr_id.clear();
+        sai_serialize_attr_id(g_serialization_format, attr, str_attr_id);
+
+        std::string &str_attr_value = fvValue(entry[i]);
+        str_attr_value.clear();
+        status = sai_serialize_attr_value(g_serialization_format, serialization_type, attr, str_attr_value);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            REDIS_LOG_ERR("Unable to serialize attribute for object type: %u and attribute id: %u, status: %u",
+                    object_type,
+                    attr.id,
+                    status);
+
+            REDIS_LOG_EXIT();
+            return status;
+        }
+    }
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Internal create, serializes all attributes and writes
+ *    object to ASIC_STATE in single producer write
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of object
+ *  @param[in] vid - virtual object id, SAI_NULL_OBJECT_ID when object
+ *  is not identified by object id
+ *  @param[in] serialized_object_id - serialized object id
+ *  @param[in] attr_count - number of attributes
+ *  @param[in] attr_list - array of attributes
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             Failure status code on error
+ */
+sai_status_t internal_redis_generic_create(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_object_id_t vid,
+        _In_ const std::string &serialized_object_id,
+        _In_ uint32_t attr_count,
+        _In_ const sai_attribute_t *attr_list)
+{
+    REDIS_LOG_ENTER();
+
+    uint64_t start = redis_latency_now();
+
+    // per thread buffers, concurrent callers don't share anything
+    // until operation is queued to pipeline
+
+    static thread_local std::vector<ssw::FieldValueTuple> entry;
+    static thread_local std::string str_common_api;
+    static thread_local std::string key;
+
+    // everything is serialized before write, so failure on any
+    // attribute will not leave partially created object in ASIC_STATE
+
+    sai_status_t status = internal_redis_serialize_attr_list(object_type, attr_count, attr_list, entry);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    str_common_api.clear();
+    sai_serialize_primitive(g_serialization_format, SAI_COMMON_API_CREATE, str_common_api);
+
+    key.clear();
+    sai_serialize_object_key(g_serialization_format, object_type, serialized_object_id, key);
+
+    uint64_t serialized = redis_latency_now();
+
+    if (g_attrCache != NULL)
+    {
+        g_attrCache->create(object_type, key, attr_count, attr_list, entry);
+    }
+
+    // identical object is already in ASIC_STATE, typically replay
+    // after warm boot
+    bool identical = (g_objectView != NULL) && g_objectView->create(object_type, vid, key, entry);
+
+    if (!identical)
+    {
+        status = g_asicStatePipeline->set(key, entry, str_common_api, object_type, SAI_COMMON_API_CREATE);
+    }
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_ERR("Failed to write %s to ASIC_STATE, status: %d", key.c_str(), status);
+
+        redis_evict_unwritten_object(key);
+
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    redis_latency_record(object_type, SAI_COMMON_API_CREATE, false, SAI_REDIS_LATENCY_PHASE_SERIALIZE, start, serialized);
+    redis_latency_record(object_type, SAI_COMMON_API_CREATE, false, SAI_REDIS_LATENCY_PHASE_TOTAL, start, redis_latency_now());
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void redis_evict_unwritten_object(
+        _In_ const std::string &key)
+{
+    REDIS_LOG_ENTER();
+
+    if (g_attrCache != NULL)
+    {
+        g_attrCache->remove(key);
+    }
+
+    if (g_objectView != NULL)
+    {
+        g_objectView->remove(key);
+    }
+
+    REDIS_LOG_EXIT();
+}
+
+/**
+ *   Routine Description:
+ *    @brief Finds object restored from snapshot with same attributes,
+ *    whose create was not replayed yet
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of object
+ *  @param[in] attr_count - number of attributes
+ *  @param[in] attr_list - array of attributes
+ *
+ *  Return Values:
+ *    @return  Virtual id of restored object, SAI_NULL_OBJECT_ID when
+ *             there is none
+ */
+static sai_object_id_t redis_claim_restored_object_id(
+        _In_ sai_object_type_t object_type,
+        _In_ uint32_t attr_count,
+        _In_ const sai_attribute_t *attr_list)
+{
+    REDIS_LOG_ENTER();
+
+    // after all restored objects are claimed this is single load
+
+    if (g_objectView == NULL ||
+            object_type <= SAI_OBJECT_TYPE_NULL ||
+            object_type >= SAI_OBJECT_TYPE_MAX ||
+            !g_objectView->hasUnclaimed(object_type))
+    {
+        REDIS_LOG_EXIT();
+        return SAI_NULL_OBJECT_ID;
+    }
+
+    static thread_local std::vector<ssw::FieldValueTuple> entry;
+
+    if (internal_redis_serialize_attr_list(object_type, attr_count, attr_list, entry) != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_NULL_OBJECT_ID;
+    }
+
+    sai_object_id_t vid = g_objectView->claim(object_type, entry);
+
+    REDIS_LOG_EXIT();
+
+    return vid;
+}
+
 /**
  *   Routine Description:
  *    @brief Generic create method
- * 
+ *
  *  Arguments:
- *  @param[out] acl_table_id - the the acl table id
+ *  @param[in] object_type - type of object
+ *  @param[out] object_id - virtual object id of created object
  *  @param[in] attr_count - number of attributes
  *  @param[in] attr_list - array of attributes
- * 
+ *
  *  Return Values:
  *    @return  SAI_STATUS_SUCCESS on success
  *             Failure status code on error
@@ -21,11 +251,45 @@ sai_status_t redis_generic_create(
 {
     REDIS_LOG_ENTER();
 
-    // this method will need to return generated virtual ID
-    // since is't separated from syncd which whill make
-    // actual calls to switch
+    if (object_id == NULL)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    // replayed create of object restored from snapshot gets its
+    // original id back
+
+    sai_object_id_t vid = redis_claim_restored_object_id(object_type, attr_count, attr_list);
+
+    // virtual id is generated locally, syncd will map it to
+    // real id when it applies create on the switch
+
+    if (vid == SAI_NULL_OBJECT_ID)
+    {
+        vid = redis_create_virtual_object_id(object_type);
+    }
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    if (vid == SAI_NULL_OBJECT_ID)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    std::string str_vid;
+    sai_serialize_primitive(g_serialization_format, vid, str_vid);
+
+    sai_status_t status = internal_redis_generic_create(
+            object_type,
+            vid,
+            str_vid,
+            attr_count,
+            attr_list);
+
+    if (status == SAI_STATUS_SUCCESS)
+    {
+        *object_id = vid;
+    }
 
     REDIS_LOG_EXIT();
 
@@ -40,9 +304,26 @@ sai_status_t redis_generic_create(
 {
     REDIS_LOG_ENTER();
 
+    if (fdb_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL fdb entry passed to create");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
     // fdb entry is actual "key"
     // and attribute id is field:value (value is serialized attribute)
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+
+    std::string str_fdb_entry;
+    sai_serialize_entry(g_serialization_format, *fdb_entry, str_fdb_entry);
+
+    sai_status_t status = internal_redis_generic_create(
+            object_type,
+            SAI_NULL_OBJECT_ID,
+            str_fdb_entry,
+            attr_count,
+            attr_list);
 
     REDIS_LOG_EXIT();
 
@@ -57,8 +338,23 @@ sai_status_t redis_generic_create(
 {
     REDIS_LOG_ENTER();
 
-    // need 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    if (neighbor_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL neighbor entry passed to create");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    std::string str_neighbor_entry;
+    sai_serialize_entry(g_serialization_format, *neighbor_entry, str_neighbor_entry);
+
+    sai_status_t status = internal_redis_generic_create(
+            object_type,
+            SAI_NULL_OBJECT_ID,
+            str_neighbor_entry,
+            attr_count,
+            attr_list);
 
     REDIS_LOG_EXIT();
 
@@ -73,7 +369,23 @@ sai_status_t redis_generic_create(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    if (unicast_route_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL route entry passed to create");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    std::string str_route_entry;
+    sai_serialize_entry(g_serialization_format, *unicast_route_entry, str_route_entry);
+
+    sai_status_t status = internal_redis_generic_create(
+            object_type,
+            SAI_NULL_OBJECT_ID,
+            str_route_entry,
+            attr_count,
+            attr_list);
 
     REDIS_LOG_EXIT();
 
@@ -86,7 +398,15 @@ sai_status_t redis_generic_create_vlan(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    std::string str_vlan_id;
+    sai_serialize_primitive(g_serialization_format, vlan_id, str_vlan_id);
+
+    sai_status_t status = internal_redis_generic_create(
+            object_type,
+            SAI_NULL_OBJECT_ID,
+            str_vlan_id,
+            0,
+            NULL);
 
     REDIS_LOG_EXIT();
 
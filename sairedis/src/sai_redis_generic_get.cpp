@@ -1,5 +1,705 @@
 #include "sai_redis.h"
 
+#include <hiredis/hiredis.h>
+
+#include <algorithm>
+
+/**
+ *   Routine Description:
+ *    @brief Copies serialized attribute value to attribute of caller
+ *
+ *  Arguments:
+ *  @param[in] type - serialization type of attribute
+ *  @param[in] data - serialized value
+ *  @param[in] size - size of serialized value
+ *  @param[inout] attr - attribute of caller, lists use caller buffers
+ *  @param[in] context - arena for temporary lists
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_BUFFER_OVERFLOW when caller list is too small
+ *             Failure status code on error
+ */
+static sai_status_t internal_redis_get_attr_value(
+        _In_ sai_attr_serialization_type_t type,
+        _In_ const char *data,
+        _In_ size_t size,
+        _Inout_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext &context)
+{
+    sai_attribute_t value;
+
+    value.id = attr.id;
+
+    sai_status_t status = sai_deserialize_attr_value(g_serialization_format, data, size, type, value, context);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_ERR("Unable to deserialize attribute id: %u, status: %d", attr.id, status);
+
+        return status;
+    }
+
+    return sai_copy_attr_value(type, value, attr);
+}
+
+/**
+ *   Routine Description:
+ *    @brief Builds HMGET arguments, arguments point to key and fields
+ *
+ *  Arguments:
+ *  @param[in] table_key - ASIC_STATE hash key
+ *  @param[in] fields - serialized attribute ids
+ *  @param[out] argv - arguments
+ *  @param[out] argvlen - lengths of arguments
+ *
+ *  Return Values:
+ *    None
+ */
+static void internal_redis_hmget_args(
+        _In_ const std::string &table_key,
+        _In_ const std::vector<std::string> &fields,
+        _Out_ std::vector<const char*> &argv,
+        _Out_ std::vector<size_t> &argvlen)
+{
+    argv.clear();
+    argvlen.clear();
+
+    argv.reserve(fields.size() + 2);
+    argvlen.reserve(fields.size() + 2);
+
+    argv.push_back("HMGET");
+    argvlen.push_back(5);
+
+    argv.push_back(table_key.data());
+    argvlen.push_back(table_key.size());
+
+    for (const auto &field: fields)
+    {
+        argv.push_back(field.data());
+        argvlen.push_back(field.size());
+    }
+}
+
+/**
+ *   Routine Description:
+ *    @brief Reads attributes of one object from ASIC_STATE with HMGET
+ *
+ *  Arguments:
+ *  @param[in] key - serialized object key
+ *  @param[in] fields - serialized attribute ids
+ *  @param[out] reply - HMGET reply, freed by caller
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             Failure status code on error
+ */
+static sai_status_t internal_redis_hmget(
+        _In_ const std::string &key,
+        _In_ const std::vector<std::string> &fields,
+        _Out_ redisReply *&reply)
+{
+    REDIS_LOG_ENTER();
+
+    std::string table_key = ASIC_STATE_TABLE ":" + key;
+
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+
+    internal_redis_hmget_args(table_key, fields, argv, argvlen);
+
+    {
+        std::lock_guard<std::mutex> lock(g_dbReadMutex);
+
+        reply = (redisReply*)redisCommandArgv(g_dbRead->getContext(), (int)argv.size(), argv.data(), argvlen.data());
+
+        if (reply == NULL)
+        {
+            redis_reconnect_db(g_dbRead);
+        }
+    }
+
+    if (reply == NULL)
+    {
+        REDIS_LOG_ERR("Failed to read object from ASIC_STATE");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    if (reply->type != REDIS_REPLY_ARRAY || reply->elements != fields.size())
+    {
+        REDIS_LOG_ERR("Unexpected HMGET reply type: %d", reply->type);
+
+        freeReplyObject(reply);
+        reply = NULL;
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Writes operations still in pipeline before ASIC_STATE is
+ *    read, so get sees every create and set which returned before it
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             Failure status code of pending write which failed
+ */
+static sai_status_t internal_redis_sync_before_read()
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = g_asicStatePipeline->sync();
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_ERR("Failed to write pending operations before reading ASIC_STATE, status: %d", status);
+    }
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Internal get, attributes are served from attribute cache
+ *    when possible, rest is read from ASIC_STATE with single HMGET
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of object
+ *  @param[in] serialized_object_id - serialized object id
+ *  @param[in] attr_count - number of attributes
+ *  @param[inout] attr_list - array of attributes
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_BUFFER_OVERFLOW when some list did not fit,
+ *             count of such list is set to required size
+ *             Failure status code on error
+ */
+sai_status_t internal_redis_generic_get(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::string &serialized_object_id,
+        _In_ uint32_t attr_count,
+        _Inout_ sai_attribute_t *attr_list)
+{
+    REDIS_LOG_ENTER();
+
+    uint64_t start = redis_latency_now();
+
+    if (attr_count == 0 || attr_list == NULL)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    // per thread buffers, values are copied to caller before return,
+    // so arena of context is reused by next call
+
+    static thread_local std::string key;
+    static thread_local SaiDeserializeContext context(4096);
+    static thread_local std::vector<sai_attr_serialization_type_t> types;
+    static thread_local std::vector<uint32_t> missing;
+    static thread_local std::vector<std::string> fields;
+    static thread_local std::string value;
+
+    key.clear();
+    sai_serialize_object_key(g_serialization_format, object_type, serialized_object_id, key);
+
+    context.reset();
+
+    types.resize(attr_count);
+
+    // attributes not found in cache, read from redis in one command
+    missing.clear();
+    fields.clear();
+
+    sai_status_t result = SAI_STATUS_SUCCESS;
+
+    for (uint32_t i = 0; i < attr_count; ++i)
+    {
+        sai_attribute_t &attr = attr_list[i];
+
+        sai_status_t status = sai_get_serialization_type(object_type, attr.id, types[i]);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            REDIS_LOG_ERR("Unable to find serialization type for object type: %u and attribute id: %u, status: %u",
+                    object_type,
+                    attr.id,
+                    status);
+
+            REDIS_LOG_EXIT();
+            return status;
+        }
+
+        if (g_attrCache == NULL ||
+            !RedisAttributeCache::isCacheable(object_type, attr.id) ||
+            !g_attrCache->get(key, attr.id, value))
+        {
+            missing.push_back(i);
+
+            fields.emplace_back();
+            sai_serialize_attr_id(g_serialization_format, attr, fields.back());
+
+            continue;
+        }
+
+        status = internal_redis_get_attr_value(types[i], value.data(), value.size(), attr, context);
+
+        if (status == SAI_STATUS_BUFFER_OVERFLOW)
+        {
+            result = status;
+        }
+        else if (status != SAI_STATUS_SUCCESS)
+        {
+            REDIS_LOG_EXIT();
+            return status;
+        }
+    }
+
+    if (missing.empty())
+    {
+        redis_latency_record(object_type, SAI_COMMON_API_GET, false, SAI_REDIS_LATENCY_PHASE_TOTAL, start, redis_latency_now());
+
+        REDIS_LOG_EXIT();
+        return result;
+    }
+
+    // values read from redis are not cached, pipeline is written first
+    // so they are not older than what caller already set
+
+    redisReply *reply;
+
+    uint64_t write_start = redis_latency_now();
+
+    sai_status_t status = internal_redis_sync_before_read();
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    status = internal_redis_hmget(key, fields, reply);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    uint64_t write_end = redis_latency_now();
+
+    for (size_t n = 0; n < missing.size(); ++n)
+    {
+        const redisReply *element = reply->element[n];
+
+        sai_attribute_t &attr = attr_list[missing[n]];
+
+        if (element->type != REDIS_REPLY_STRING)
+        {
+            REDIS_LOG_ERR("Attribute id: %u not found in ASIC_STATE", attr.id);
+
+            result = SAI_STATUS_ITEM_NOT_FOUND;
+            break;
+        }
+
+        status = internal_redis_get_attr_value(types[missing[n]], element->str, element->len, attr, context);
+
+        if (status == SAI_STATUS_BUFFER_OVERFLOW)
+        {
+            result = status;
+        }
+        else if (status != SAI_STATUS_SUCCESS)
+        {
+            result = status;
+            break;
+        }
+    }
+
+    freeReplyObject(reply);
+
+    uint64_t end = redis_latency_now();
+
+    redis_latency_record(object_type, SAI_COMMON_API_GET, false, SAI_REDIS_LATENCY_PHASE_WRITE, write_start, write_end);
+    redis_latency_record(object_type, SAI_COMMON_API_GET, false, SAI_REDIS_LATENCY_PHASE_SERIALIZE, write_end, end);
+    redis_latency_record(object_type, SAI_COMMON_API_GET, false, SAI_REDIS_LATENCY_PHASE_TOTAL, start, end);
+
+    REDIS_LOG_EXIT();
+
+    return result;
+}
+
+/*
+ * Bulk get reads objects in chunks, attributes found in cache are
+ * copied right away, HMGETs of rest of chunk are written as one
+ * pipeline and replies are deserialized into caller attributes.
+ * Chunk bounds memory of pending replies and time single gets wait
+ * for read connection.
+ */
+
+#define SAI_REDIS_BULK_GET_CHUNK 1024
+
+/**
+ * @brief Read of one object in bulk get, buffers are reused by chunks
+ */
+typedef struct _redis_bulk_get_object_t
+{
+    std::string tableKey;
+
+    std::vector<sai_attr_serialization_type_t> types;
+
+    // indexes of attributes not found in cache
+    std::vector<uint32_t> missing;
+
+    std::vector<std::string> fields;
+
+    redisReply *reply;
+
+} redis_bulk_get_object_t;
+
+/**
+ *   Routine Description:
+ *    @brief Serves attributes of object from cache and collects fields
+ *    which need to be read from ASIC_STATE
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of object
+ *  @param[in] serialized_object_id - serialized object id
+ *  @param[in] attr_count - number of attributes
+ *  @param[inout] attr_list - array of attributes
+ *  @param[out] object - object read
+ *  @param[in] context - arena for temporary lists
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_BUFFER_OVERFLOW when some list did not fit
+ *             Failure status code on error
+ */
+static sai_status_t internal_redis_bulk_get_prepare(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::string &serialized_object_id,
+        _In_ uint32_t attr_count,
+        _Inout_ sai_attribute_t *attr_list,
+        _Out_ redis_bulk_get_object_t &object,
+        _In_ SaiDeserializeContext &context)
+{
+    static thread_local std::string key;
+    static thread_local std::string value;
+
+    object.missing.clear();
+    object.fields.clear();
+    object.reply = NULL;
+
+    if (attr_count == 0 || attr_list == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    key.clear();
+    sai_serialize_object_key(g_serialization_format, object_type, serialized_object_id, key);
+
+    object.tableKey = ASIC_STATE_TABLE ":" + key;
+
+    object.types.resize(attr_count);
+
+    sai_status_t result = SAI_STATUS_SUCCESS;
+
+    for (uint32_t i = 0; i < attr_count; ++i)
+    {
+        sai_attribute_t &attr = attr_list[i];
+
+        sai_status_t status = sai_get_serialization_type(object_type, attr.id, object.types[i]);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            REDIS_LOG_ERR("Unable to find serialization type for object type: %u and attribute id: %u, status: %u",
+                    object_type,
+                    attr.id,
+                    status);
+
+            return status;
+        }
+
+        if (g_attrCache == NULL ||
+            !RedisAttributeCache::isCacheable(object_type, attr.id) ||
+            !g_attrCache->get(key, attr.id, value))
+        {
+            object.missing.push_back(i);
+
+            object.fields.emplace_back();
+            sai_serialize_attr_id(g_serialization_format, attr, object.fields.back());
+
+            continue;
+        }
+
+        status = internal_redis_get_attr_value(object.types[i], value.data(), value.size(), attr, context);
+
+        if (status == SAI_STATUS_BUFFER_OVERFLOW)
+        {
+            result = status;
+        }
+        else if (status != SAI_STATUS_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    return result;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Copies HMGET reply of object into caller attributes
+ *
+ *  Arguments:
+ *  @param[in] object - object read with reply
+ *  @param[inout] attr_list - array of attributes
+ *  @param[in] context - arena for temporary lists
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             SAI_STATUS_BUFFER_OVERFLOW when some list did not fit
+ *             SAI_STATUS_ITEM_NOT_FOUND when attribute is not in ASIC_STATE
+ *             Failure status code on error
+ */
+static sai_status_t internal_redis_bulk_get_reply(
+        _In_ const redis_bulk_get_object_t &object,
+        _Inout_ sai_attribute_t *attr_list,
+        _In_ SaiDeserializeContext &context)
+{
+    const redisReply *reply = object.reply;
+
+    if (reply == NULL || reply->type != REDIS_REPLY_ARRAY || reply->elements != object.fields.size())
+    {
+        REDIS_LOG_ERR("Unexpected HMGET reply type: %d", reply == NULL ? -1 : reply->type);
+
+        return SAI_STATUS_FAILURE;
+    }
+
+    sai_status_t result = SAI_STATUS_SUCCESS;
+
+    for (size_t n = 0; n < object.missing.size(); ++n)
+    {
+        const redisReply *element = reply->element[n];
+
+        sai_attribute_t &attr = attr_list[object.missing[n]];
+
+        if (element->type != REDIS_REPLY_STRING)
+        {
+            REDIS_LOG_ERR("Attribute id: %u not found in ASIC_STATE", attr.id);
+
+            return SAI_STATUS_ITEM_NOT_FOUND;
+        }
+
+        sai_status_t status = internal_redis_get_attr_value(object.types[object.missing[n]], element->str, element->len, attr, context);
+
+        if (status == SAI_STATUS_BUFFER_OVERFLOW)
+        {
+            result = status;
+        }
+        else if (status != SAI_STATUS_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    return result;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Internal bulk get, HMGETs of objects are pipelined
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of objects
+ *  @param[in] serialized_object_ids - serialized object ids
+ *  @param[in] attr_counts - number of attributes of each object
+ *  @param[inout] attr_lists - attributes of each object
+ *  @param[out] statuses - status of each object
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS when all objects succeeded
+ *             SAI_STATUS_FAILURE when any object failed
+ */
+sai_status_t internal_redis_bulk_generic_get(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::vector<std::string> &serialized_object_ids,
+        _In_ const uint32_t *attr_counts,
+        _Inout_ sai_attribute_t **attr_lists,
+        _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    uint64_t start = redis_latency_now();
+    uint64_t write_time = 0;
+
+    uint32_t count = (uint32_t)serialized_object_ids.size();
+
+    static thread_local std::vector<redis_bulk_get_object_t> objects;
+    static thread_local SaiDeserializeContext context(4096);
+
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+
+    bool all_succeeded = true;
+
+    // pipeline is written once, before first object read from redis
+    bool synced = false;
+
+    for (uint32_t base = 0; base < count; base += SAI_REDIS_BULK_GET_CHUNK)
+    {
+        uint32_t chunk = std::min<uint32_t>(SAI_REDIS_BULK_GET_CHUNK, count - base);
+
+        objects.resize(chunk);
+
+        for (uint32_t i = 0; i < chunk; ++i)
+        {
+            context.reset();
+
+            statuses[base + i] = internal_redis_bulk_get_prepare(
+                    object_type,
+                    serialized_object_ids[base + i],
+                    attr_counts[base + i],
+                    attr_lists[base + i],
+                    objects[i],
+                    context);
+
+            if (statuses[base + i] != SAI_STATUS_SUCCESS && statuses[base + i] != SAI_STATUS_BUFFER_OVERFLOW)
+            {
+                // nothing is read for failed object
+                objects[i].fields.clear();
+            }
+        }
+
+        uint64_t write_start = redis_latency_now();
+
+        for (uint32_t i = 0; i < chunk && !synced; ++i)
+        {
+            if (objects[i].fields.empty())
+            {
+                continue;
+            }
+
+            sai_status_t status = internal_redis_sync_before_read();
+
+            if (status != SAI_STATUS_SUCCESS)
+            {
+                for (uint32_t n = base; n < count; ++n)
+                {
+                    statuses[n] = status;
+                }
+
+                REDIS_LOG_EXIT();
+                return SAI_STATUS_FAILURE;
+            }
+
+            synced = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_dbReadMutex);
+
+            redisContext *ctx = g_dbRead->getContext();
+
+            int pending = 0;
+
+            for (uint32_t i = 0; i < chunk; ++i)
+            {
+                if (objects[i].fields.empty())
+                {
+                    continue;
+                }
+
+                internal_redis_hmget_args(objects[i].tableKey, objects[i].fields, argv, argvlen);
+
+                if (redisAppendCommandArgv(ctx, (int)argv.size(), argv.data(), argvlen.data()) != REDIS_OK)
+                {
+                    // object without reply gets failure status
+                    objects[i].fields.clear();
+                    statuses[base + i] = SAI_STATUS_FAILURE;
+                    continue;
+                }
+
+                pending++;
+            }
+
+            // replies come in order of commands
+
+            for (uint32_t i = 0; i < chunk && pending > 0; ++i)
+            {
+                if (objects[i].fields.empty())
+                {
+                    continue;
+                }
+
+                void *reply = NULL;
+
+                if (redisGetReply(ctx, &reply) != REDIS_OK)
+                {
+                    REDIS_LOG_ERR("Failed to read objects from ASIC_STATE: %s", ctx->errstr);
+
+                    // objects without reply fail, next call reads
+                    // through new connection
+                    redis_reconnect_db(g_dbRead);
+                    break;
+                }
+
+                objects[i].reply = (redisReply*)reply;
+
+                pending--;
+            }
+        }
+
+        write_time += redis_latency_now() - write_start;
+
+        for (uint32_t i = 0; i < chunk; ++i)
+        {
+            redis_bulk_get_object_t &object = objects[i];
+
+            if (!object.fields.empty())
+            {
+                context.reset();
+
+                sai_status_t status = internal_redis_bulk_get_reply(object, attr_lists[base + i], context);
+
+                if (status != SAI_STATUS_SUCCESS)
+                {
+                    statuses[base + i] = status;
+                }
+
+                // hiredis before 0.14 does not take NULL
+                if (object.reply != NULL)
+                {
+                    freeReplyObject(object.reply);
+                    object.reply = NULL;
+                }
+            }
+
+            all_succeeded &= (statuses[base + i] == SAI_STATUS_SUCCESS);
+        }
+    }
+
+    uint64_t end = redis_latency_now();
+
+    // write phase is sum of round trips of all chunks
+    redis_latency_record(object_type, SAI_COMMON_API_GET, true, SAI_REDIS_LATENCY_PHASE_WRITE, start, start + write_time);
+    redis_latency_record(object_type, SAI_COMMON_API_GET, true, SAI_REDIS_LATENCY_PHASE_TOTAL, start, end);
+
+    REDIS_LOG_EXIT();
+
+    return all_succeeded ? SAI_STATUS_SUCCESS : SAI_STATUS_FAILURE;
+}
+
 /**
  * Routine Description:
  *   @brief Generic get attribute
@@ -22,7 +722,14 @@ sai_status_t redis_generic_get(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    std::string str_object_id;
+    sai_serialize_primitive(g_serialization_format, object_id, str_object_id);
+
+    sai_status_t status = internal_redis_generic_get(
+            object_type,
+            str_object_id,
+            attr_count,
+            attr_list);
 
     REDIS_LOG_EXIT();
 
@@ -37,7 +744,22 @@ sai_status_t redis_generic_get(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    if (fdb_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL fdb entry passed to get");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    std::string str_fdb_entry;
+    sai_serialize_entry(g_serialization_format, *fdb_entry, str_fdb_entry);
+
+    sai_status_t status = internal_redis_generic_get(
+            object_type,
+            str_fdb_entry,
+            attr_count,
+            attr_list);
 
     REDIS_LOG_EXIT();
 
@@ -52,7 +774,22 @@ sai_status_t redis_generic_get(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    if (neighbor_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL neighbor entry passed to get");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    std::string str_neighbor_entry;
+    sai_serialize_entry(g_serialization_format, *neighbor_entry, str_neighbor_entry);
+
+    sai_status_t status = internal_redis_generic_get(
+            object_type,
+            str_neighbor_entry,
+            attr_count,
+            attr_list);
 
     REDIS_LOG_EXIT();
 
@@ -67,7 +804,22 @@ sai_status_t redis_generic_get(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    if (unicast_route_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL route entry passed to get");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    std::string str_route_entry;
+    sai_serialize_entry(g_serialization_format, *unicast_route_entry, str_route_entry);
+
+    sai_status_t status = internal_redis_generic_get(
+            object_type,
+            str_route_entry,
+            attr_count,
+            attr_list);
 
     REDIS_LOG_EXIT();
 
@@ -82,7 +834,14 @@ sai_status_t redis_generic_get_vlan(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    std::string str_vlan_id;
+    sai_serialize_primitive(g_serialization_format, vlan_id, str_vlan_id);
+
+    sai_status_t status = internal_redis_generic_get(
+            object_type,
+            str_vlan_id,
+            attr_count,
+            attr_list);
 
     REDIS_LOG_EXIT();
 
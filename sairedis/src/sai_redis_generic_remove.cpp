@@ -1,5 +1,67 @@
 #include "sai_redis.h"
 
+/**
+ *  Routine Description:
+ *    @brief Internal remove, object is removed from ASIC_STATE with
+ *    single producer delete of its key
+ *
+ *  Arguments:
+ *    @param[in] object_type - the object type
+ *    @param[in] serialized_object_id - serialized object id
+ *
+ *  Return Values:
+ *    @return  SAI_STATUS_SUCCESS on success
+ *             Failure status code on error
+ */
+sai_status_t internal_redis_generic_remove(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::string &serialized_object_id)
+{
+    REDIS_LOG_ENTER();
+
+    uint64_t start = redis_latency_now();
+
+    static thread_local std::string str_common_api;
+    static thread_local std::string key;
+
+    str_common_api.clear();
+    sai_serialize_primitive(g_serialization_format, SAI_COMMON_API_REMOVE, str_common_api);
+
+    key.clear();
+    sai_serialize_object_key(g_serialization_format, object_type, serialized_object_id, key);
+
+    uint64_t serialized = redis_latency_now();
+
+    if (g_attrCache != NULL)
+    {
+        g_attrCache->remove(key);
+    }
+
+    if (g_objectView != NULL)
+    {
+        g_objectView->remove(key);
+    }
+
+    sai_status_t status = g_asicStatePipeline->del(key, str_common_api, object_type);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        // cache and view already forgot object, get reads redis and
+        // replay writes it again
+        REDIS_LOG_ERR("Failed to write remove of %s to ASIC_STATE, status: %d", key.c_str(), status);
+
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    redis_latency_record(object_type, SAI_COMMON_API_REMOVE, false, SAI_REDIS_LATENCY_PHASE_SERIALIZE, start, serialized);
+    redis_latency_record(object_type, SAI_COMMON_API_REMOVE, false, SAI_REDIS_LATENCY_PHASE_TOTAL, start, redis_latency_now());
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
 /**
  *  Routine Description:
  *    @brief Removes specified object
@@ -18,7 +80,12 @@ sai_status_t redis_generic_remove(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    std::string str_object_id;
+    sai_serialize_primitive(g_serialization_format, object_id, str_object_id);
+
+    sai_status_t status = internal_redis_generic_remove(
+            object_type,
+            str_object_id);
 
     REDIS_LOG_EXIT();
 
@@ -31,7 +98,20 @@ sai_status_t redis_generic_remove(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    if (fdb_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL fdb entry passed to remove");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    std::string str_fdb_entry;
+    sai_serialize_entry(g_serialization_format, *fdb_entry, str_fdb_entry);
+
+    sai_status_t status = internal_redis_generic_remove(
+            object_type,
+            str_fdb_entry);
 
     REDIS_LOG_EXIT();
 
@@ -44,7 +124,20 @@ sai_status_t redis_generic_remove(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    if (neighbor_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL neighbor entry passed to remove");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    std::string str_neighbor_entry;
+    sai_serialize_entry(g_serialization_format, *neighbor_entry, str_neighbor_entry);
+
+    sai_status_t status = internal_redis_generic_remove(
+            object_type,
+            str_neighbor_entry);
 
     REDIS_LOG_EXIT();
 
@@ -57,7 +150,20 @@ sai_status_t redis_generic_remove(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    if (unicast_route_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL route entry passed to remove");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    std::string str_route_entry;
+    sai_serialize_entry(g_serialization_format, *unicast_route_entry, str_route_entry);
+
+    sai_status_t status = internal_redis_generic_remove(
+            object_type,
+            str_route_entry);
 
     REDIS_LOG_EXIT();
 
@@ -70,11 +176,14 @@ sai_status_t redis_generic_remove_vlan(
 {
     REDIS_LOG_ENTER();
 
-    sai_status_t status = SAI_STATUS_NOT_IMPLEMENTED;
+    std::string str_vlan_id;
+    sai_serialize_primitive(g_serialization_format, vlan_id, str_vlan_id);
+
+    sai_status_t status = internal_redis_generic_remove(
+            object_type,
+            str_vlan_id);
 
     REDIS_LOG_EXIT();
 
     return status;
 }
-
-
@@ -20,6 +20,8 @@ sai_status_t internal_redis_generic_set(
 {
     REDIS_LOG_ENTER();
 
+    uint64_t start = redis_latency_now();
+
     if (attr == NULL)
     {
         REDIS_LOG_EXIT();
@@ -41,11 +43,13 @@ sai_status_t internal_redis_generic_set(
         return status;
     }
 
-    std::string str_object_type;
-    sai_serialize_primitive(object_type, str_object_type);
+    // per thread buffers, as in create
+    static thread_local std::vector<ssw::FieldValueTuple> entry(1);
+    static thread_local std::string str_common_api;
+    static thread_local std::string key;
 
-    std::string str_common_api;
-    sai_serialize_primitive(SAI_COMMON_API_SET, str_common_api);
+    str_common_api.clear();
+    sai_serialize_primitive(g_serialization_format, SAI_COMMON_API_SET, str_common_api);
 
     //std::string str_object_type;
     //status = sai_get_object_type_string(object_type, str_object_type);
@@ -60,11 +64,13 @@ sai_status_t internal_redis_generic_set(
     //    return status;
     //}
 
-    std::string str_attr_id;
-    sai_serialize_attr_id(*attr, str_attr_id);
-    
-    std::string str_attr_value;
-    status = sai_serialize_attr_value(serialization_type, *attr, str_attr_value);
+    std::string &str_attr_id = fvField(entry[0]);
+    str_attr_id.clear();
+    sai_serialize_attr_id(g_serialization_format, *attr, str_attr_id);
+
+    std::string &str_attr_value = fvValue(entry[0]);
+    str_attr_value.clear();
+    status = sai_serialize_attr_value(g_serialization_format, serialization_type, *attr, str_attr_value);
 
     if (status != SAI_STATUS_SUCCESS)
     {
@@ -77,13 +83,35 @@ sai_status_t internal_redis_generic_set(
         return status;
     }
 
-    ssw::FieldValueTuple fvt(str_attr_id, str_attr_value);
+    key.clear();
+    sai_serialize_object_key(g_serialization_format, object_type, serialized_object_id, key);
 
-    std::vector<ssw::FieldValueTuple> entry = { fvt };
+    uint64_t serialized = redis_latency_now();
 
-    std::string key = str_object_type + ":" + serialized_object_id;
+    if (g_attrCache != NULL)
+    {
+        g_attrCache->set(object_type, key, attr->id, str_attr_value);
+    }
 
-    g_asicState->set(key, entry); // TODO set needs extra param op = str_common_api;
+    bool identical = (g_objectView != NULL) && g_objectView->set(object_type, key, entry[0]);
+
+    if (!identical)
+    {
+        status = g_asicStatePipeline->set(key, entry, str_common_api, object_type, SAI_COMMON_API_SET, attr->id);
+    }
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_ERR("Failed to write %s to ASIC_STATE, status: %d", key.c_str(), status);
+
+        redis_evict_unwritten_object(key);
+
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    redis_latency_record(object_type, SAI_COMMON_API_SET, false, SAI_REDIS_LATENCY_PHASE_SERIALIZE, start, serialized);
+    redis_latency_record(object_type, SAI_COMMON_API_SET, false, SAI_REDIS_LATENCY_PHASE_TOTAL, start, redis_latency_now());
 
     REDIS_LOG_EXIT();
 
@@ -99,7 +127,7 @@ sai_status_t redis_generic_set(
     REDIS_LOG_ENTER();
 
     std::string str_object_id;
-    sai_serialize_primitive(object_id, str_object_id);
+    sai_serialize_primitive(g_serialization_format, object_id, str_object_id);
 
     sai_status_t status = internal_redis_generic_set(
             object_type, 
@@ -118,8 +146,16 @@ sai_status_t redis_generic_set(
 {
     REDIS_LOG_ENTER();
 
+    if (fdb_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL fdb entry passed to set");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
     std::string str_fdb_entry;
-    sai_serialize_primitive(*fdb_entry, str_fdb_entry);
+    sai_serialize_entry(g_serialization_format, *fdb_entry, str_fdb_entry);
 
     sai_status_t status = internal_redis_generic_set(
             object_type, 
@@ -138,8 +174,16 @@ sai_status_t redis_generic_set(
 {
     REDIS_LOG_ENTER();
 
+    if (neighbor_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL neighbor entry passed to set");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
     std::string str_neighbor_entry;
-    sai_serialize_primitive(*neighbor_entry, str_neighbor_entry);
+    sai_serialize_entry(g_serialization_format, *neighbor_entry, str_neighbor_entry);
 
     sai_status_t status = internal_redis_generic_set(
             object_type, 
@@ -158,8 +202,16 @@ sai_status_t redis_generic_set(
 {
     REDIS_LOG_ENTER();
 
+    if (unicast_route_entry == NULL)
+    {
+        REDIS_LOG_ERR("NULL route entry passed to set");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
     std::string str_route_entry;
-    sai_serialize_primitive(*unicast_route_entry, str_route_entry);
+    sai_serialize_entry(g_serialization_format, *unicast_route_entry, str_route_entry);
 
     sai_status_t status = internal_redis_generic_set(
             object_type, 
@@ -179,7 +231,7 @@ sai_status_t redis_generic_set_vlan(
     REDIS_LOG_ENTER();
 
     std::string str_vlan_id;
-    sai_serialize_primitive(vlan_id, str_vlan_id);
+    sai_serialize_primitive(g_serialization_format, vlan_id, str_vlan_id);
 
     sai_status_t status = internal_redis_generic_set(
             object_type, 
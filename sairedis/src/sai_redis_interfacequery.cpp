@@ -1,17 +1,195 @@
 #include "sai_redis.h"
 
 #include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#include <algorithm>
 
 service_method_table_t g_services;
-bool                   g_initialized = false;
+std::atomic<bool>      g_initialized(false);
+
+// serializes initialize/uninitialize, api calls only check g_initialized
+std::mutex             g_apiMutex;
+
+RedisTransport        *g_asicStatePipeline = NULL;
+ssw::DBConnector      *g_dbRead = NULL;
+std::mutex             g_dbReadMutex;
+RedisAttributeCache   *g_attrCache = NULL;
+RedisObjectView       *g_objectView = NULL;
+ssw::DBConnector      *g_dbNotifications = NULL;
+RedisNotificationConsumer *g_notificationConsumer = NULL;
+RedisCounterPoller    *g_counterPoller = NULL;
+std::atomic<RedisRecorder*> g_recorder(NULL);
+RedisChangeJournal    *g_changeJournal = NULL;
+
+sai_serialization_format_t g_serialization_format = SAI_SERIALIZATION_FORMAT_HEX;
+
+sai_redis_error_notification_fn g_error_notification = NULL;
+
+// redis endpoint, read from profile in sai_api_initialize
+std::string g_redisHost = SAI_REDIS_DEFAULT_HOST;
+uint64_t    g_redisPort = SAI_REDIS_DEFAULT_PORT;
+std::string g_redisUnixSocket;
+uint64_t    g_redisDb = 0;
+
+// view snapshot, empty when view is disabled
+std::string g_snapshotFile;
+
+sai_status_t redis_profile_get_serialization_format(
+        _Out_ sai_serialization_format_t &format)
+{
+    const char *value = g_services.profile_get_value(0, SAI_REDIS_KEY_SERIALIZATION_FORMAT);
+
+    if (value == NULL || strcmp(value, "hex") == 0)
+    {
+        format = SAI_SERIALIZATION_FORMAT_HEX;
+        return SAI_STATUS_SUCCESS;
+    }
+
+    if (strcmp(value, "binary") == 0)
+    {
+        format = SAI_SERIALIZATION_FORMAT_BINARY;
+        return SAI_STATUS_SUCCESS;
+    }
+
+    REDIS_LOG_ERR("Invalid %s value: %s\n", SAI_REDIS_KEY_SERIALIZATION_FORMAT, value);
+
+    return SAI_STATUS_INVALID_PARAMETER;
+}
+
+sai_status_t redis_profile_get_uint64(
+        _In_ const char *key,
+        _In_ uint64_t default_value,
+        _Out_ uint64_t &value)
+{
+    const char *str = g_services.profile_get_value(0, key);
+
+    if (str == NULL)
+    {
+        value = default_value;
+        return SAI_STATUS_SUCCESS;
+    }
+
+    char *end = NULL;
+
+    errno = 0;
+
+    unsigned long long v = strtoull(str, &end, 0);
+
+    if (errno != 0 || end == str || *end != 0 || *str == '-')
+    {
+        REDIS_LOG_ERR("Invalid %s value: %s\n", key, str);
+
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
 
-ssw::DBConnector      *g_db = NULL;
-ssw::ProducerTable    *g_asicState = NULL;
+    value = v;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+static sai_status_t redis_profile_get_endpoint()
+{
+    const char *host = g_services.profile_get_value(0, SAI_REDIS_KEY_HOST);
+    const char *unix_socket = g_services.profile_get_value(0, SAI_REDIS_KEY_UNIX_SOCKET);
+
+    g_redisHost = (host == NULL) ? SAI_REDIS_DEFAULT_HOST : host;
+    g_redisUnixSocket = (unix_socket == NULL) ? "" : unix_socket;
+
+    sai_status_t status = redis_profile_get_uint64(SAI_REDIS_KEY_PORT, SAI_REDIS_DEFAULT_PORT, g_redisPort);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    if (g_redisPort == 0 || g_redisPort > 65535)
+    {
+        REDIS_LOG_ERR("Invalid %s value: %lu\n", SAI_REDIS_KEY_PORT, g_redisPort);
+
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    status = redis_profile_get_uint64(SAI_REDIS_KEY_DB, 0, g_redisDb);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    if (g_redisDb > INT32_MAX)
+    {
+        REDIS_LOG_ERR("Invalid %s value: %lu\n", SAI_REDIS_KEY_DB, g_redisDb);
+
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+ssw::DBConnector* redis_create_db_connector()
+{
+    if (!g_redisUnixSocket.empty())
+    {
+        return new ssw::DBConnector((int)g_redisDb, g_redisUnixSocket, 0);
+    }
+
+    return new ssw::DBConnector((int)g_redisDb, g_redisHost, (int)g_redisPort, 0);
+}
+
+void redis_reconnect_db(
+        _Inout_ ssw::DBConnector *&db)
+{
+    REDIS_LOG_WRN("Reconnecting to redis after failed reply");
+
+    ssw::DBConnector *connector = redis_create_db_connector();
+
+    delete db;
+
+    db = connector;
+}
+
+sai_status_t redis_profile_get_bool(
+        _In_ const char *key,
+        _In_ bool default_value,
+        _Out_ bool &value)
+{
+    const char *str = g_services.profile_get_value(0, key);
+
+    if (str == NULL)
+    {
+        value = default_value;
+        return SAI_STATUS_SUCCESS;
+    }
+
+    if (strcmp(str, "true") == 0)
+    {
+        value = true;
+        return SAI_STATUS_SUCCESS;
+    }
+
+    if (strcmp(str, "false") == 0)
+    {
+        value = false;
+        return SAI_STATUS_SUCCESS;
+    }
+
+    REDIS_LOG_ERR("Invalid %s value: %s\n", key, str);
+
+    return SAI_STATUS_INVALID_PARAMETER;
+}
 
 sai_status_t sai_api_initialize(
         _In_ uint64_t flags,
         _In_ const service_method_table_t* services)
 {
+    std::lock_guard<std::mutex> lock(g_apiMutex);
+
+    // re-initialize replaces globals of previous one, api calls must
+    // not see them until initialize succeeds, also when it fails
+    g_initialized = false;
+
     if ((NULL == services) || (NULL == services->profile_get_next_value) || (NULL == services->profile_get_value))
     {
         REDIS_LOG_ERR("Invalid services handle passed to SAI API initialize\n");
@@ -20,130 +198,672 @@ sai_status_t sai_api_initialize(
 
     memcpy(&g_services, services, sizeof(g_services));
 
-    if (0 != flags)
+    redis_log_start();
+
+    if (0 != (flags & ~(uint64_t)SAI_REDIS_INITIALIZE_FLAG_ASYNC))
     {
         REDIS_LOG_ERR("Invalid flags passed to SAI API initialize\n");
         return SAI_STATUS_INVALID_PARAMETER;
     }
 
-    if (g_db != NULL)
-        delete g_db;
+    sai_status_t status = redis_profile_get_serialization_format(g_serialization_format);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    uint64_t batch_size;
+    uint64_t flush_latency;
 
-    g_db = new ssw::DBConnector(0, "localhost", 6379, 0);
+    status = redis_profile_get_uint64(SAI_REDIS_KEY_BATCH_SIZE, SAI_REDIS_DEFAULT_BATCH_SIZE, batch_size);
 
-    if (g_asicState != NULL)
-        delete g_asicState;
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    status = redis_profile_get_uint64(SAI_REDIS_KEY_FLUSH_LATENCY, SAI_REDIS_DEFAULT_FLUSH_LATENCY, flush_latency);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    uint64_t combining_window;
+
+    status = redis_profile_get_uint64(SAI_REDIS_KEY_WRITE_COMBINING_WINDOW, 0, combining_window);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    bool async;
+
+    status = redis_profile_get_bool(SAI_REDIS_KEY_ASYNC_MODE, false, async);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    async = async || (flags & SAI_REDIS_INITIALIZE_FLAG_ASYNC);
+
+    bool attr_cache;
+
+    status = redis_profile_get_bool(SAI_REDIS_KEY_ATTR_CACHE, true, attr_cache);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    status = redis_profile_get_endpoint();
 
-    g_asicState = new ssw::ProducerTable(g_db, "ASIC_STATE");
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    uint64_t pool_size;
+
+    status = redis_profile_get_uint64(SAI_REDIS_KEY_CONNECTION_POOL_SIZE, 1, pool_size);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    bool latency_stats;
+
+    status = redis_profile_get_bool(SAI_REDIS_KEY_LATENCY_STATS, true, latency_stats);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    uint64_t latency_dump_interval;
+
+    status = redis_profile_get_uint64(SAI_REDIS_KEY_LATENCY_DUMP_INTERVAL, SAI_REDIS_DEFAULT_LATENCY_DUMP_INTERVAL, latency_dump_interval);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    const char *latency_dump_file = g_services.profile_get_value(0, SAI_REDIS_KEY_LATENCY_DUMP_FILE);
+
+    const char *snapshot_file = g_services.profile_get_value(0, SAI_REDIS_KEY_SNAPSHOT_FILE);
+
+    const char *record_file = g_services.profile_get_value(0, SAI_REDIS_KEY_RECORD_FILE);
+
+    const char *transport = g_services.profile_get_value(0, SAI_REDIS_KEY_TRANSPORT);
+
+    bool shm_transport = (transport != NULL && strcmp(transport, "shm") == 0);
+
+    if (transport != NULL && !shm_transport && strcmp(transport, "redis") != 0)
+    {
+        REDIS_LOG_ERR("Invalid %s value: %s\n", SAI_REDIS_KEY_TRANSPORT, transport);
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    const char *shm_name = g_services.profile_get_value(0, SAI_REDIS_KEY_SHM_NAME);
+
+    uint64_t shm_size;
+
+    status = redis_profile_get_uint64(SAI_REDIS_KEY_SHM_SIZE, SAI_REDIS_DEFAULT_SHM_SIZE, shm_size);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    const char *journal_name = g_services.profile_get_value(0, SAI_REDIS_KEY_JOURNAL_NAME);
+
+    uint64_t journal_size;
+
+    status = redis_profile_get_uint64(SAI_REDIS_KEY_JOURNAL_SIZE, SAI_REDIS_DEFAULT_JOURNAL_SIZE, journal_size);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    uint64_t warm_boot;
+
+    status = redis_profile_get_uint64(SAI_KEY_WARM_BOOT, 0, warm_boot);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    g_latencyEnabled = latency_stats;
+
+    redis_latency_start_dump(latency_dump_file == NULL ? "" : latency_dump_file, latency_dump_interval);
+
+    // pool flushes pending operations before it closes connections
+    if (g_asicStatePipeline != NULL)
+        delete g_asicStatePipeline;
+
+    g_asicStatePipeline = NULL;
+
+    if (shm_transport)
+    {
+        RedisShmTransport *shm = new RedisShmTransport();
+
+        status = shm->open(shm_name == NULL ? SAI_REDIS_DEFAULT_SHM_NAME : shm_name, shm_size);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            delete shm;
+            return status;
+        }
+
+        g_asicStatePipeline = shm;
+    }
+    else
+    {
+        g_asicStatePipeline = new RedisPipelinePool(pool_size, batch_size, flush_latency, async);
+    }
+
+    // journal outlives pipeline which writes to it
+
+    if (g_changeJournal != NULL)
+        delete g_changeJournal;
+
+    g_changeJournal = NULL;
+
+    if (journal_name != NULL)
+    {
+        g_changeJournal = new RedisChangeJournal();
+
+        status = g_changeJournal->open(journal_name, journal_size);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            REDIS_LOG_ERR("Failed to open change journal %s", journal_name);
+
+            delete g_changeJournal;
+            g_changeJournal = NULL;
+
+            return status;
+        }
+
+        // on cold boot ASIC_STATE starts empty, consumers must not
+        // catch up from operations made before
+        if (warm_boot != 1)
+        {
+            g_changeJournal->truncate(g_changeJournal->reserve(1));
+        }
+
+        REDIS_LOG_NTC("Change journal %s of %lu bytes, next sequence %lu",
+                journal_name, g_changeJournal->capacity(), g_changeJournal->nextSequence());
+
+        g_asicStatePipeline = new RedisJournalTransport(g_asicStatePipeline, g_changeJournal);
+    }
+
+    g_asicStatePipeline->setErrorNotification(g_error_notification);
+
+    g_asicStatePipeline->setWriteCombiningWindow(combining_window);
+
+    // gets use own connection, so they don't interleave with replies
+    // of batches written by flush thread
+
+    if (g_dbRead != NULL)
+        delete g_dbRead;
+
+    g_dbRead = redis_create_db_connector();
+
+    if (g_attrCache != NULL)
+        delete g_attrCache;
+
+    g_attrCache = attr_cache ? new RedisAttributeCache() : NULL;
+
+    // poller reads COUNTERS on own connection, so polls don't delay gets
+
+    if (g_counterPoller != NULL)
+        delete g_counterPoller;
+
+    g_counterPoller = new RedisCounterPoller(redis_create_db_connector(), SAI_REDIS_DEFAULT_COUNTER_REFRESH_INTERVAL * 1000);
+
+    if (g_objectView != NULL)
+        delete g_objectView;
+
+    g_objectView = NULL;
+
+    g_snapshotFile = (snapshot_file == NULL) ? "" : snapshot_file;
+
+    if (!g_snapshotFile.empty())
+    {
+        g_objectView = new RedisObjectView();
+
+        // on cold boot ASIC_STATE starts empty, old snapshot would
+        // absorb writes which are not there
+        if (warm_boot == 1)
+        {
+            status = g_objectView->load(g_snapshotFile, g_serialization_format);
+
+            if (status != SAI_STATUS_SUCCESS)
+            {
+                return status;
+            }
+        }
+    }
+
+    redis_recorder_replace(NULL);
+
+    if (record_file != NULL)
+    {
+        RedisRecorder *recorder = new RedisRecorder();
+
+        status = recorder->start(record_file);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            delete recorder;
+
+            return status;
+        }
+
+        redis_recorder_replace(recorder);
+    }
 
     g_initialized = true;
 
     return SAI_STATUS_SUCCESS;
 }
 
-sai_status_t sai_log_set(
-        _In_ sai_api_t sai_api_id, 
-        _In_ sai_log_level_t log_level)
+sai_status_t sai_api_uninitialize(
+        void)
 {
-    switch (log_level)
+    std::lock_guard<std::mutex> lock(g_apiMutex);
+
+    if (!g_initialized)
     {
-        case SAI_LOG_DEBUG:
-            break;
+        return SAI_STATUS_UNINITIALIZED;
+    }
 
-        case SAI_LOG_INFO:
-            break;
+    g_initialized = false;
 
-        case SAI_LOG_NOTICE:
-            break;
+    redis_stop_notification_consumer();
 
-        case SAI_LOG_WARN:
-            break;
+    // writes all pending operations
+    delete g_asicStatePipeline;
+    g_asicStatePipeline = NULL;
 
-        case SAI_LOG_ERROR:
-            break;
+    delete g_changeJournal;
+    g_changeJournal = NULL;
 
-        case SAI_LOG_CRITICAL:
-            break;
+    delete g_dbRead;
+    g_dbRead = NULL;
 
-        default:
-            REDIS_LOG_ERR("Invalid log level %d\n", log_level);
-            return SAI_STATUS_INVALID_PARAMETER;
+    delete g_attrCache;
+    g_attrCache = NULL;
+
+    delete g_counterPoller;
+    g_counterPoller = NULL;
+
+    // pipeline is gone, so view holds everything that was written
+    if (g_objectView != NULL)
+    {
+        g_objectView->save(g_snapshotFile, g_serialization_format);
+
+        delete g_objectView;
+        g_objectView = NULL;
     }
 
-    switch (sai_api_id) 
+    // writes final snapshot
+    redis_latency_stop_dump();
+
+    // waits for wrapped calls still recording, then writes all records
+    redis_recorder_replace(NULL);
+
+    // last, so messages of pipeline shutdown are written
+    redis_log_stop();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sai_redis_flush(
+        void)
+{
+    if (!g_initialized)
     {
-        case SAI_API_SWITCH:
-            break;
+        REDIS_LOG_ERR("SAI API not initialized before calling flush\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
 
-        case SAI_API_PORT:
-            break;
+    return g_asicStatePipeline->flush();
+}
 
-        case SAI_API_FDB:
-            break;
+sai_status_t sai_redis_sync(
+        void)
+{
+    if (!g_initialized)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling sync\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
 
-        case SAI_API_VLAN:
-            break;
+    return g_asicStatePipeline->sync();
+}
 
-        case SAI_API_VIRTUAL_ROUTER:
-            break;
+sai_status_t sai_redis_set_error_notification(
+        _In_ sai_redis_error_notification_fn notification)
+{
+    std::lock_guard<std::mutex> lock(g_apiMutex);
 
-        case SAI_API_ROUTE:
-            break;
+    // kept for pipelines created by later sai_api_initialize
+    g_error_notification = notification;
 
-        case SAI_API_NEXT_HOP:
-            break;
+    if (g_initialized)
+    {
+        g_asicStatePipeline->setErrorNotification(notification);
+    }
 
-        case SAI_API_NEXT_HOP_GROUP:
-            break;
+    return SAI_STATUS_SUCCESS;
+}
 
-        case SAI_API_ROUTER_INTERFACE:
-            break;
+sai_status_t sai_redis_get_coalesced_writes(
+        _Out_ uint64_t *count)
+{
+    if (count == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
 
-        case SAI_API_NEIGHBOR:
-            break;
+    if (!g_initialized)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling get coalesced writes\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
 
-        case SAI_API_ACL:
+    *count = g_asicStatePipeline->getCoalescedCount();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sai_redis_get_notification_stats(
+        _Out_ sai_redis_notification_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (g_notificationConsumer == NULL)
+    {
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    g_notificationConsumer->getStats(*stats);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sai_redis_get_attr_cache_stats(
+        _Out_ sai_redis_attr_cache_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (!g_initialized)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling get attr cache stats\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    if (g_attrCache == NULL)
+    {
+        return SAI_STATUS_NOT_SUPPORTED;
+    }
+
+    g_attrCache->getStats(*stats);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sai_redis_get_latency_stats(
+        _Inout_ uint32_t *count,
+        _Out_ sai_redis_latency_stats_t *stats)
+{
+    if (count == NULL || (*count != 0 && stats == NULL))
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (!g_latencyEnabled)
+    {
+        return SAI_STATUS_NOT_SUPPORTED;
+    }
+
+    std::vector<sai_redis_latency_stats_t> snapshot;
+
+    redis_latency_snapshot(snapshot);
+
+    if (snapshot.size() > *count)
+    {
+        *count = (uint32_t)snapshot.size();
+
+        return SAI_STATUS_BUFFER_OVERFLOW;
+    }
+
+    std::copy(snapshot.begin(), snapshot.end(), stats);
+
+    *count = (uint32_t)snapshot.size();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sai_redis_checkpoint(
+        void)
+{
+    // view is not deleted by uninitialize while it is saved
+    std::lock_guard<std::mutex> lock(g_apiMutex);
+
+    if (!g_initialized)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling checkpoint\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    if (g_objectView == NULL)
+    {
+        return SAI_STATUS_NOT_SUPPORTED;
+    }
+
+    // snapshot should not contain objects redis doesn't have yet
+    sai_status_t status = g_asicStatePipeline->sync();
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    return g_objectView->save(g_snapshotFile, g_serialization_format);
+}
+
+sai_status_t sai_redis_get_view_stats(
+        _Out_ sai_redis_view_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (!g_initialized)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling get view stats\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    if (g_objectView == NULL)
+    {
+        return SAI_STATUS_NOT_SUPPORTED;
+    }
+
+    g_objectView->getStats(*stats);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sai_redis_get_counters(
+        _In_ sai_object_type_t object_type,
+        _In_ uint64_t object_id,
+        _In_ uint32_t number_of_counters,
+        _In_ const int32_t *counter_ids,
+        _Out_ uint64_t *counters,
+        _Out_ uint64_t *timestamp_ns)
+{
+    if (!g_initialized)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling get counters\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    std::string str_object_id;
+
+    if (object_type == SAI_OBJECT_TYPE_VLAN)
+    {
+        sai_serialize_primitive(g_serialization_format, (sai_vlan_id_t)object_id, str_object_id);
+    }
+    else
+    {
+        sai_serialize_primitive(g_serialization_format, (sai_object_id_t)object_id, str_object_id);
+    }
+
+    return g_counterPoller->get(
+            object_type,
+            str_object_id,
+            number_of_counters,
+            counter_ids,
+            counters,
+            timestamp_ns);
+}
+
+sai_status_t sai_redis_get_counter_stats(
+        _Out_ sai_redis_counter_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (!g_initialized)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling get counter stats\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    g_counterPoller->getStats(*stats);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sai_redis_get_recorder_stats(
+        _Out_ sai_redis_recorder_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (!g_initialized)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling get recorder stats\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    RedisRecorderReference recorder;
+
+    if (recorder.get() == NULL)
+    {
+        return SAI_STATUS_NOT_SUPPORTED;
+    }
+
+    recorder.get()->getStats(*stats);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sai_redis_get_journal_stats(
+        _Out_ sai_redis_journal_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (!g_initialized)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling get journal stats\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    if (g_changeJournal == NULL)
+    {
+        return SAI_STATUS_NOT_SUPPORTED;
+    }
+
+    stats->first_sequence = g_changeJournal->firstSequence();
+    stats->last_sequence = g_changeJournal->lastSequence();
+    stats->bytes = g_changeJournal->used();
+    stats->capacity = g_changeJournal->capacity();
+    stats->truncations = g_changeJournal->truncations();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t sai_log_set(
+        _In_ sai_api_t sai_api_id, 
+        _In_ sai_log_level_t log_level)
+{
+    switch (log_level)
+    {
+        case SAI_LOG_DEBUG:
             break;
 
-        case SAI_API_HOST_INTERFACE:
+        case SAI_LOG_INFO:
             break;
 
-        case SAI_API_MIRROR:
+        case SAI_LOG_NOTICE:
             break;
 
-        case SAI_API_SAMPLEPACKET:
+        case SAI_LOG_WARN:
             break;
 
-        case SAI_API_STP:
+        case SAI_LOG_ERROR:
             break;
 
-        case SAI_API_LAG:
+        case SAI_LOG_CRITICAL:
             break;
 
         default:
-            REDIS_LOG_ERR("Invalid API type %d\n", sai_api_id);
+            REDIS_LOG_ERR("Invalid log level %d\n", log_level);
             return SAI_STATUS_INVALID_PARAMETER;
     }
 
-    return SAI_STATUS_SUCCESS;
-}
-
-sai_status_t sai_api_query(
-        _In_ sai_api_t sai_api_id, 
-        _Out_ void** api_method_table)
-{
-    if (NULL == api_method_table) 
+    if ((int)sai_api_id < 0 || (int)sai_api_id >= SAI_REDIS_LOG_API_COUNT)
     {
-        REDIS_LOG_ERR("NULL method table passed to SAI API initialize\n");
+        REDIS_LOG_ERR("Invalid API type %d\n", sai_api_id);
         return SAI_STATUS_INVALID_PARAMETER;
     }
 
-    if (!g_initialized) 
-    {
-        REDIS_LOG_ERR("SAI API not initialized before calling API query\n");
-        return SAI_STATUS_UNINITIALIZED;
-    }
+    // checked by every log macro before message is formatted
+    g_logLevel[sai_api_id].store(log_level, std::memory_order_relaxed);
 
+    return SAI_STATUS_SUCCESS;
+}
+
+static sai_status_t redis_api_query(
+        _In_ sai_api_t sai_api_id,
+        _Out_ void** api_method_table)
+{
     switch (sai_api_id) {
         case SAI_API_BUFFERS:
             *(const sai_buffer_api_t**)api_method_table = &redis_buffer_api;
@@ -251,3 +971,30 @@ sai_status_t sai_api_query(
     }
 }
 
+sai_status_t sai_api_query(
+        _In_ sai_api_t sai_api_id, 
+        _Out_ void** api_method_table)
+{
+    if (NULL == api_method_table) 
+    {
+        REDIS_LOG_ERR("NULL method table passed to SAI API initialize\n");
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (!g_initialized) 
+    {
+        REDIS_LOG_ERR("SAI API not initialized before calling API query\n");
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    sai_status_t status = redis_api_query(sai_api_id, api_method_table);
+
+    // tables queried while recording record calls for process lifetime,
+    // recording itself ends with uninitialize
+    if (status == SAI_STATUS_SUCCESS && g_recorder.load() != NULL)
+    {
+        *api_method_table = redis_recorder_wrap_api(sai_api_id, *api_method_table);
+    }
+
+    return status;
+}
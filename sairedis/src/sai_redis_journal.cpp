@@ -0,0 +1,644 @@
+#include "sai_redis_journal.h"
+#include "sai_redis_shm_ring.h"
+#include "sai_redis_shm_consumer.h"
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <chrono>
+#include <thread>
+
+#define SAI_REDIS_JOURNAL_MIN_CAPACITY      4096
+
+// index has entry for every this many bytes of data, journal of small
+// records is bounded by index instead of data
+#define SAI_REDIS_JOURNAL_BYTES_PER_ENTRY   64
+
+// u64 marker, u64 sequence, u32 length, u32 flags
+#define SAI_REDIS_JOURNAL_RECORD_HEADER     24
+
+// record pads rest of data, it has no sequence
+#define SAI_REDIS_JOURNAL_FLAG_PAD          1
+
+// index positions of sequences which have no record
+#define SAI_REDIS_JOURNAL_SKIPPED           (~(uint64_t)0)
+#define SAI_REDIS_JOURNAL_TRUNCATED         (~(uint64_t)1)
+
+// set in index sequence while writer which claimed entry stores it
+#define SAI_REDIS_JOURNAL_BUSY              ((uint64_t)1 << 63)
+
+// time writer waits for older sequence before it gives up on its writer
+#define SAI_REDIS_JOURNAL_PUBLISH_TIMEOUT_MS    1000
+
+// time other process may take between creating and initializing segment
+#define SAI_REDIS_JOURNAL_OPEN_TIMEOUT_MS   1000
+
+static_assert(sizeof(sai_redis_journal_header_t) % SAI_REDIS_JOURNAL_ALIGN == 0, "index must start aligned");
+static_assert(sizeof(sai_redis_journal_entry_t) == 2 * sizeof(uint64_t), "index entry must be plain 64 bit words");
+
+static inline uint64_t journal_align(
+        _In_ uint64_t size)
+{
+    return (size + SAI_REDIS_JOURNAL_ALIGN - 1) & ~(uint64_t)(SAI_REDIS_JOURNAL_ALIGN - 1);
+}
+
+static inline size_t journal_mapped_size(
+        _In_ uint64_t capacity,
+        _In_ uint64_t entries)
+{
+    return sizeof(sai_redis_journal_header_t) + entries * sizeof(sai_redis_journal_entry_t) + capacity;
+}
+
+RedisChangeJournal::RedisChangeJournal():
+    m_header(NULL),
+    m_index(NULL),
+    m_data(NULL),
+    m_capacity(0),
+    m_entries(0),
+    m_mappedSize(0),
+    m_truncations(0)
+{
+}
+
+RedisChangeJournal::~RedisChangeJournal()
+{
+    close();
+}
+
+sai_status_t RedisChangeJournal::open(
+        _In_ const std::string &name,
+        _In_ uint64_t size)
+{
+    close();
+
+    uint64_t capacity = SAI_REDIS_JOURNAL_MIN_CAPACITY;
+
+    while (capacity < size)
+    {
+        capacity <<= 1;
+    }
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (fd >= 0)
+    {
+        uint64_t entries = capacity / SAI_REDIS_JOURNAL_BYTES_PER_ENTRY;
+
+        size_t mapped_size = journal_mapped_size(capacity, entries);
+
+        if (ftruncate(fd, (off_t)mapped_size) != 0)
+        {
+            ::close(fd);
+            shm_unlink(name.c_str());
+
+            return SAI_STATUS_FAILURE;
+        }
+
+        void *addr = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        ::close(fd);
+
+        if (addr == MAP_FAILED)
+        {
+            shm_unlink(name.c_str());
+
+            return SAI_STATUS_FAILURE;
+        }
+
+        m_header = (sai_redis_journal_header_t*)addr;
+
+        m_header->version = SAI_REDIS_JOURNAL_VERSION;
+        m_header->capacity = capacity;
+        m_header->entries = entries;
+
+        uint64_t now = (uint64_t)std::chrono::system_clock::now().time_since_epoch().count();
+
+        m_header->id = (now ^ ((uint64_t)getpid() << 32)) | 1;
+
+        // reader of sequence 0 gets everything
+        m_header->sequence.store(1, std::memory_order_relaxed);
+        m_header->first.store(1, std::memory_order_relaxed);
+        m_header->next.store(1, std::memory_order_relaxed);
+
+        // publishes initialized header to processes waiting in open
+        __atomic_store_n(&m_header->magic, SAI_REDIS_JOURNAL_MAGIC, __ATOMIC_RELEASE);
+
+        m_mappedSize = mapped_size;
+    }
+    else if (errno == EEXIST)
+    {
+        fd = shm_open(name.c_str(), O_RDWR, 0600);
+
+        if (fd < 0)
+        {
+            return SAI_STATUS_FAILURE;
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAI_REDIS_JOURNAL_OPEN_TIMEOUT_MS);
+
+        while (m_header == NULL && std::chrono::steady_clock::now() < deadline)
+        {
+            struct stat st;
+
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size > sizeof(sai_redis_journal_header_t))
+            {
+                void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+                if (addr != MAP_FAILED)
+                {
+                    sai_redis_journal_header_t *header = (sai_redis_journal_header_t*)addr;
+
+                    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == SAI_REDIS_JOURNAL_MAGIC)
+                    {
+                        m_header = header;
+                        m_mappedSize = (size_t)st.st_size;
+                        break;
+                    }
+
+                    munmap(addr, (size_t)st.st_size);
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        ::close(fd);
+
+        if (m_header == NULL)
+        {
+            return SAI_STATUS_FAILURE;
+        }
+
+        if (m_header->version != SAI_REDIS_JOURNAL_VERSION ||
+                m_mappedSize != journal_mapped_size(m_header->capacity, m_header->entries))
+        {
+            close();
+
+            return SAI_STATUS_FAILURE;
+        }
+    }
+    else
+    {
+        return SAI_STATUS_FAILURE;
+    }
+
+    m_capacity = m_header->capacity;
+    m_entries = m_header->entries;
+
+    m_index = reinterpret_cast<sai_redis_journal_entry_t*>(m_header + 1);
+    m_data = (char*)(m_index + m_entries);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void RedisChangeJournal::close()
+{
+    if (m_header != NULL)
+    {
+        munmap(m_header, m_mappedSize);
+    }
+
+    m_header = NULL;
+    m_index = NULL;
+    m_data = NULL;
+    m_capacity = 0;
+    m_entries = 0;
+    m_mappedSize = 0;
+}
+
+void RedisChangeJournal::unlink(
+        _In_ const std::string &name)
+{
+    shm_unlink(name.c_str());
+}
+
+uint64_t RedisChangeJournal::reserve(
+        _In_ uint32_t count)
+{
+    return m_header->sequence.fetch_add(count);
+}
+
+uint64_t RedisChangeJournal::nextSequence() const
+{
+    return m_header->sequence.load(std::memory_order_relaxed);
+}
+
+void RedisChangeJournal::raiseFirst(
+        _In_ uint64_t sequence)
+{
+    uint64_t first = m_header->first.load();
+
+    while (first < sequence && !m_header->first.compare_exchange_weak(first, sequence))
+    {
+    }
+}
+
+void RedisChangeJournal::trimHead(
+        _In_ uint64_t h)
+{
+    uint64_t offset = h & (m_capacity - 1);
+
+    // rest of data shorter than record header was skipped by writer
+    if (m_capacity - offset < SAI_REDIS_JOURNAL_RECORD_HEADER)
+    {
+        m_header->head.compare_exchange_strong(h, h + m_capacity - offset);
+        return;
+    }
+
+    if (word(h).load(std::memory_order_acquire) != (h | 1))
+    {
+        // record is taken but not written yet, or head moved
+        std::this_thread::yield();
+        return;
+    }
+
+    const char *ptr = m_data + offset + sizeof(uint64_t);
+
+    uint64_t sequence;
+    uint32_t length;
+    uint32_t flags;
+
+    memcpy(&sequence, ptr, sizeof(sequence));
+    memcpy(&length, ptr + sizeof(sequence), sizeof(length));
+    memcpy(&flags, ptr + sizeof(sequence) + sizeof(length), sizeof(flags));
+
+    // other writer may have trimmed record and overwritten it meanwhile
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (m_header->head.load(std::memory_order_relaxed) != h)
+    {
+        return;
+    }
+
+    if ((flags & SAI_REDIS_JOURNAL_FLAG_PAD) == 0)
+    {
+        // readers see trim before any byte of record changes
+        raiseFirst(sequence + 1);
+    }
+
+    m_header->head.compare_exchange_strong(h, h + journal_align(SAI_REDIS_JOURNAL_RECORD_HEADER + length));
+}
+
+uint64_t RedisChangeJournal::allocate(
+        _In_ uint64_t size)
+{
+    for (;;)
+    {
+        // head first, so it is never past tail
+        uint64_t h = m_header->head.load(std::memory_order_acquire);
+        uint64_t t = m_header->tail.load(std::memory_order_acquire);
+
+        uint64_t rest = m_capacity - (t & (m_capacity - 1));
+
+        uint64_t start = (rest < size) ? t + rest : t;
+
+        if (start + size - h > m_capacity)
+        {
+            trimHead(h);
+            continue;
+        }
+
+        if (!m_header->tail.compare_exchange_weak(t, start + size))
+        {
+            continue;
+        }
+
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // record is never split, rest of data is padded instead
+        if (start != t && rest >= SAI_REDIS_JOURNAL_RECORD_HEADER)
+        {
+            char *ptr = m_data + (t & (m_capacity - 1)) + sizeof(uint64_t);
+
+            uint64_t sequence = 0;
+            uint32_t length = (uint32_t)(rest - SAI_REDIS_JOURNAL_RECORD_HEADER);
+            uint32_t flags = SAI_REDIS_JOURNAL_FLAG_PAD;
+
+            memcpy(ptr, &sequence, sizeof(sequence));
+            memcpy(ptr + sizeof(sequence), &length, sizeof(length));
+            memcpy(ptr + sizeof(sequence) + sizeof(length), &flags, sizeof(flags));
+
+            word(t).store(t | 1, std::memory_order_release);
+        }
+
+        return start;
+    }
+}
+
+void RedisChangeJournal::advance()
+{
+    // moves next past entries stored without gap, writer of any of
+    // them which stored it last sees all of them
+    uint64_t next = m_header->next.load();
+
+    while (entry(next).sequence.load() == next)
+    {
+        if (m_header->next.compare_exchange_weak(next, next + 1))
+        {
+            next++;
+        }
+    }
+}
+
+bool RedisChangeJournal::store(
+        _In_ uint64_t sequence,
+        _In_ uint64_t position)
+{
+    sai_redis_journal_entry_t &e = entry(sequence);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAI_REDIS_JOURNAL_PUBLISH_TIMEOUT_MS);
+
+    uint64_t tag = e.sequence.load();
+
+    for (;;)
+    {
+        if ((tag & ~SAI_REDIS_JOURNAL_BUSY) >= sequence)
+        {
+            // sequence was already decided by truncate
+            return false;
+        }
+
+        if ((tag & SAI_REDIS_JOURNAL_BUSY) != 0)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+
+            std::this_thread::yield();
+
+            tag = e.sequence.load();
+            continue;
+        }
+
+        // only writer which claimed entry stores position, so late
+        // writer of truncated sequence never overwrites newer one
+        if (e.sequence.compare_exchange_weak(tag, sequence | SAI_REDIS_JOURNAL_BUSY))
+        {
+            break;
+        }
+    }
+
+    // reader which sees new position sees raised first
+    e.position.store(position, std::memory_order_release);
+    e.sequence.store(sequence);
+
+    advance();
+
+    return true;
+}
+
+bool RedisChangeJournal::publish(
+        _In_ uint64_t sequence,
+        _In_ uint64_t position)
+{
+    if (sequence > m_entries)
+    {
+        uint64_t previous = sequence - m_entries;
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAI_REDIS_JOURNAL_PUBLISH_TIMEOUT_MS);
+
+        // entry is reused once its sequence is committed and trimmed
+        while (m_header->next.load(std::memory_order_acquire) <= previous)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                // writer of sequence at next died or is stuck, journal
+                // would never move past it
+                truncate(sequence);
+
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+
+        raiseFirst(previous + 1);
+    }
+
+    return store(sequence, position);
+}
+
+bool RedisChangeJournal::append(
+        _In_ uint64_t sequence,
+        _In_ uint32_t count,
+        _In_ const sai_serialized_view_t *parts)
+{
+    uint64_t length = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        length += sizeof(uint32_t) + parts[i].size;
+    }
+
+    uint64_t size = journal_align(SAI_REDIS_JOURNAL_RECORD_HEADER + length);
+
+    if (size > m_capacity / 2)
+    {
+        truncate(sequence);
+
+        return false;
+    }
+
+    uint64_t t = allocate(size);
+
+    char *ptr = m_data + (t & (m_capacity - 1)) + sizeof(uint64_t);
+
+    uint32_t record_length = (uint32_t)length;
+    uint32_t flags = 0;
+
+    memcpy(ptr, &sequence, sizeof(sequence));
+    memcpy(ptr + sizeof(sequence), &record_length, sizeof(record_length));
+    memcpy(ptr + sizeof(sequence) + sizeof(record_length), &flags, sizeof(flags));
+
+    ptr += SAI_REDIS_JOURNAL_RECORD_HEADER - sizeof(uint64_t);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t part_size = (uint32_t)parts[i].size;
+
+        memcpy(ptr, &part_size, sizeof(part_size));
+        memcpy(ptr + sizeof(part_size), parts[i].data, part_size);
+
+        ptr += sizeof(part_size) + part_size;
+    }
+
+    // record may be trimmed only after this
+    word(t).store(t | 1, std::memory_order_release);
+
+    return publish(sequence, t);
+}
+
+void RedisChangeJournal::skip(
+        _In_ uint64_t sequence)
+{
+    publish(sequence, SAI_REDIS_JOURNAL_SKIPPED);
+}
+
+void RedisChangeJournal::truncate(
+        _In_ uint64_t sequence)
+{
+    raiseFirst(sequence + 1);
+
+    // sequences still open, also of writers which died after reserve,
+    // are truncated too, so next moves past them, their writers find
+    // them decided
+    for (uint64_t s = m_header->next.load(); s <= sequence; s++)
+    {
+        store(s, SAI_REDIS_JOURNAL_TRUNCATED);
+    }
+
+    m_truncations++;
+}
+
+sai_status_t RedisChangeJournal::read(
+        _In_ uint64_t after,
+        _In_ size_t max_count,
+        _Out_ std::vector<ssw::KeyOpFieldsValuesTuple> &changes,
+        _Out_ uint64_t &last)
+{
+    changes.clear();
+
+    last = after;
+
+    uint64_t next = m_header->next.load(std::memory_order_acquire);
+
+    if (after + 1 < m_header->first.load(std::memory_order_acquire))
+    {
+        return SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    if (after >= next)
+    {
+        // sequence after may be reserved by writer which did not finish
+        return (after < m_header->sequence.load(std::memory_order_acquire)) ? SAI_STATUS_SUCCESS : SAI_STATUS_ITEM_NOT_FOUND;
+    }
+
+    sai_serialized_view_t parts[SAI_REDIS_SHM_PARTS];
+
+    for (uint64_t sequence = after + 1; sequence < next && changes.size() < max_count; sequence++)
+    {
+        const sai_redis_journal_entry_t &e = entry(sequence);
+
+        bool tagged = e.sequence.load(std::memory_order_acquire) == sequence;
+
+        uint64_t position = e.position.load(std::memory_order_relaxed);
+
+        bool in_bounds = false;
+
+        if (tagged && position < SAI_REDIS_JOURNAL_TRUNCATED)
+        {
+            uint64_t offset = position & (m_capacity - 1);
+
+            const char *ptr = m_data + offset + sizeof(uint64_t);
+
+            uint64_t record_sequence = 0;
+            uint32_t record_length = 0;
+
+            if (m_capacity - offset >= SAI_REDIS_JOURNAL_RECORD_HEADER &&
+                    word(position).load(std::memory_order_relaxed) == (position | 1))
+            {
+                memcpy(&record_sequence, ptr, sizeof(record_sequence));
+                memcpy(&record_length, ptr + sizeof(record_sequence), sizeof(record_length));
+            }
+
+            // record may be overwritten while it is read, it is validated
+            // by first below, copy of garbage must stay in bounds
+            in_bounds = record_sequence == sequence &&
+                record_length <= m_capacity - offset - SAI_REDIS_JOURNAL_RECORD_HEADER;
+
+            if (in_bounds)
+            {
+                m_record.assign(m_data + offset + SAI_REDIS_JOURNAL_RECORD_HEADER, record_length);
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (m_header->first.load(std::memory_order_relaxed) > sequence)
+        {
+            // entry or record was reused, or sequence was truncated
+            changes.clear();
+
+            last = after;
+
+            return SAI_STATUS_ITEM_NOT_FOUND;
+        }
+
+        if (tagged && position == SAI_REDIS_JOURNAL_SKIPPED)
+        {
+            last = sequence;
+            continue;
+        }
+
+        changes.emplace_back();
+
+        if (!in_bounds || !ShmRing::parse(m_record, SAI_REDIS_SHM_PARTS, parts) ||
+                !redis_transport_decode(
+                    parts[0].data, parts[0].size,
+                    parts[1].data, parts[1].size,
+                    parts[2].data, parts[2].size,
+                    changes.back()))
+        {
+            changes.pop_back();
+
+            return SAI_STATUS_FAILURE;
+        }
+
+        last = sequence;
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+bool RedisChangeJournal::isSkipped(
+        _In_ uint64_t sequence) const
+{
+    if (sequence >= m_header->next.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    const sai_redis_journal_entry_t &e = entry(sequence);
+
+    bool skipped = e.sequence.load(std::memory_order_acquire) == sequence &&
+        e.position.load(std::memory_order_relaxed) == SAI_REDIS_JOURNAL_SKIPPED;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return skipped && m_header->first.load(std::memory_order_relaxed) <= sequence;
+}
+
+uint64_t RedisChangeJournal::id() const
+{
+    return m_header->id;
+}
+
+uint64_t RedisChangeJournal::firstSequence() const
+{
+    return m_header->first.load(std::memory_order_acquire);
+}
+
+uint64_t RedisChangeJournal::lastSequence() const
+{
+    return m_header->next.load(std::memory_order_acquire) - 1;
+}
+
+uint64_t RedisChangeJournal::used() const
+{
+    return m_header->tail.load(std::memory_order_acquire) - m_header->head.load(std::memory_order_acquire);
+}
+
+uint64_t RedisChangeJournal::capacity() const
+{
+    return m_capacity;
+}
+
+uint64_t RedisChangeJournal::truncations() const
+{
+    return m_truncations.load();
+}
@@ -0,0 +1,462 @@
+#include "sai_redis.h"
+#include "sai_redis_latency.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+/*
+ * Log-linear histogram as in HDR histogram: values below 8ns have own
+ * bucket, each following power of 2 is split into 8 buckets, so bucket
+ * width is at most 1/8 of value. Values are capped at 2^40ns (~18 min).
+ */
+
+#define SAI_REDIS_LATENCY_SUB_BUCKET_BITS   3
+#define SAI_REDIS_LATENCY_SUB_BUCKETS       (1 << SAI_REDIS_LATENCY_SUB_BUCKET_BITS)
+#define SAI_REDIS_LATENCY_MAX_BITS          40
+#define SAI_REDIS_LATENCY_BUCKETS \
+    ((SAI_REDIS_LATENCY_MAX_BITS - SAI_REDIS_LATENCY_SUB_BUCKET_BITS + 1) * SAI_REDIS_LATENCY_SUB_BUCKETS)
+
+std::atomic<bool> g_latencyEnabled(true);
+
+namespace {
+
+/*
+ * Histogram is written only by thread owning its shard, so counters
+ * are updated by plain load and store, snapshot reads them with
+ * relaxed loads and may see sample partially recorded.
+ */
+struct RedisLatencyHistogram
+{
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> min;
+    std::atomic<uint64_t> max;
+    std::atomic<uint64_t> buckets[SAI_REDIS_LATENCY_BUCKETS];
+};
+
+struct RedisLatencyShard
+{
+    // allocated on first sample by owning thread
+    std::atomic<RedisLatencyHistogram*> histograms[SAI_OBJECT_TYPE_MAX][SAI_COMMON_API_MAX][2][SAI_REDIS_LATENCY_PHASE_MAX];
+
+    // guarded by registry mutex
+    bool inUse;
+};
+
+inline void redis_latency_add(
+        _Inout_ std::atomic<uint64_t> &counter,
+        _In_ uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+size_t redis_latency_bucket(
+        _In_ uint64_t value)
+{
+    if (value < SAI_REDIS_LATENCY_SUB_BUCKETS)
+    {
+        return (size_t)value;
+    }
+
+    int msb = 63 - __builtin_clzll(value);
+
+    int shift = msb - SAI_REDIS_LATENCY_SUB_BUCKET_BITS;
+
+    return (size_t)(shift + 1) * SAI_REDIS_LATENCY_SUB_BUCKETS +
+        (size_t)((value >> shift) & (SAI_REDIS_LATENCY_SUB_BUCKETS - 1));
+}
+
+uint64_t redis_latency_bucket_upper_bound(
+        _In_ size_t bucket)
+{
+    if (bucket < SAI_REDIS_LATENCY_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    int shift = (int)(bucket / SAI_REDIS_LATENCY_SUB_BUCKETS) - 1;
+
+    uint64_t lower = (uint64_t)(SAI_REDIS_LATENCY_SUB_BUCKETS + bucket % SAI_REDIS_LATENCY_SUB_BUCKETS) << shift;
+
+    return lower + (1ULL << shift) - 1;
+}
+
+const char *redis_latency_api_name(
+        _In_ sai_common_api_t api)
+{
+    static const char *names[] = { "create", "remove", "set", "get" };
+
+    return names[api];
+}
+
+const char *redis_latency_phase_name(
+        _In_ sai_redis_latency_phase_t phase)
+{
+    static const char *names[] = { "total", "serialize", "queue", "write" };
+
+    return names[phase];
+}
+
+class RedisLatencyRegistry
+{
+    public:
+
+        RedisLatencyRegistry():
+            m_dumpRunning(false)
+        {
+        }
+
+        RedisLatencyShard* acquire()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // shard of exited thread is reused, its samples are kept
+
+            for (auto shard: m_shards)
+            {
+                if (!shard->inUse)
+                {
+                    shard->inUse = true;
+                    return shard;
+                }
+            }
+
+            RedisLatencyShard *shard = new RedisLatencyShard();
+
+            shard->inUse = true;
+
+            m_shards.push_back(shard);
+
+            return shard;
+        }
+
+        void release(
+                _In_ RedisLatencyShard *shard)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            shard->inUse = false;
+        }
+
+        void snapshot(
+                _Out_ std::vector<sai_redis_latency_stats_t> &stats)
+        {
+            stats.clear();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            std::vector<uint64_t> buckets(SAI_REDIS_LATENCY_BUCKETS);
+
+            for (int ot = 0; ot < SAI_OBJECT_TYPE_MAX; ot++)
+            for (int api = 0; api < SAI_COMMON_API_MAX; api++)
+            for (int bulk = 0; bulk < 2; bulk++)
+            for (int phase = 0; phase < SAI_REDIS_LATENCY_PHASE_MAX; phase++)
+            {
+                sai_redis_latency_stats_t s = {};
+
+                std::fill(buckets.begin(), buckets.end(), 0);
+
+                uint64_t samples = 0;
+
+                for (auto shard: m_shards)
+                {
+                    const RedisLatencyHistogram *h = shard->histograms[ot][api][bulk][phase].load(std::memory_order_acquire);
+
+                    if (h == NULL)
+                    {
+                        continue;
+                    }
+
+                    uint64_t count = h->count.load(std::memory_order_relaxed);
+
+                    if (count == 0)
+                    {
+                        continue;
+                    }
+
+                    uint64_t min = h->min.load(std::memory_order_relaxed);
+                    uint64_t max = h->max.load(std::memory_order_relaxed);
+
+                    s.min_ns = (s.count == 0) ? min : std::min(s.min_ns, min);
+                    s.max_ns = std::max(s.max_ns, max);
+
+                    s.count += count;
+                    s.total_ns += h->total.load(std::memory_order_relaxed);
+
+                    for (size_t i = 0; i < SAI_REDIS_LATENCY_BUCKETS; i++)
+                    {
+                        uint64_t n = h->buckets[i].load(std::memory_order_relaxed);
+
+                        buckets[i] += n;
+                        samples += n;
+                    }
+                }
+
+                if (s.count == 0)
+                {
+                    continue;
+                }
+
+                s.object_type = (sai_object_type_t)ot;
+                s.api = (sai_common_api_t)api;
+                s.bulk = (bulk != 0);
+                s.phase = (sai_redis_latency_phase_t)phase;
+
+                s.p50_ns = percentile(buckets, samples, s.max_ns, 0.5);
+                s.p90_ns = percentile(buckets, samples, s.max_ns, 0.9);
+                s.p99_ns = percentile(buckets, samples, s.max_ns, 0.99);
+                s.p999_ns = percentile(buckets, samples, s.max_ns, 0.999);
+
+                stats.push_back(s);
+            }
+        }
+
+        void startDump(
+                _In_ const std::string &path,
+                _In_ uint64_t interval_ms)
+        {
+            stopDump();
+
+            if (path.empty())
+            {
+                return;
+            }
+
+            m_dumpPath = path;
+            m_dumpInterval = std::chrono::milliseconds(interval_ms == 0 ? 1 : interval_ms);
+            m_dumpRunning = true;
+
+            m_dumpThread = std::thread(&RedisLatencyRegistry::dumpThread, this);
+        }
+
+        void stopDump()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_dumpMutex);
+
+                if (!m_dumpRunning)
+                {
+                    return;
+                }
+
+                m_dumpRunning = false;
+            }
+
+            m_dumpCv.notify_one();
+
+            m_dumpThread.join();
+        }
+
+    private:
+
+        static uint64_t percentile(
+                _In_ const std::vector<uint64_t> &buckets,
+                _In_ uint64_t samples,
+                _In_ uint64_t max,
+                _In_ double quantile)
+        {
+            uint64_t rank = (uint64_t)(quantile * (double)samples + 0.5);
+
+            rank = std::max(rank, (uint64_t)1);
+
+            uint64_t seen = 0;
+
+            for (size_t i = 0; i < buckets.size(); i++)
+            {
+                seen += buckets[i];
+
+                if (seen >= rank)
+                {
+                    return std::min(redis_latency_bucket_upper_bound(i), max);
+                }
+            }
+
+            return max;
+        }
+
+        void dumpThread()
+        {
+            std::unique_lock<std::mutex> lock(m_dumpMutex);
+
+            while (m_dumpRunning)
+            {
+                m_dumpCv.wait_for(lock, m_dumpInterval);
+
+                // last snapshot is written also on stop
+                lock.unlock();
+
+                dump();
+
+                lock.lock();
+            }
+        }
+
+        void dump()
+        {
+            std::vector<sai_redis_latency_stats_t> stats;
+
+            snapshot(stats);
+
+            std::string tmp = m_dumpPath + ".tmp";
+
+            FILE *file = fopen(tmp.c_str(), "w");
+
+            if (file == NULL)
+            {
+                REDIS_LOG_ERR("Failed to open latency dump file %s", tmp.c_str());
+                return;
+            }
+
+            fprintf(file, "object_type api bulk phase count total_ns min_ns p50_ns p90_ns p99_ns p999_ns max_ns\n");
+
+            for (const auto &s: stats)
+            {
+                fprintf(file, "%d %s %d %s %lu %lu %lu %lu %lu %lu %lu %lu\n",
+                        s.object_type,
+                        redis_latency_api_name(s.api),
+                        s.bulk,
+                        redis_latency_phase_name(s.phase),
+                        s.count,
+                        s.total_ns,
+                        s.min_ns,
+                        s.p50_ns,
+                        s.p90_ns,
+                        s.p99_ns,
+                        s.p999_ns,
+                        s.max_ns);
+            }
+
+            bool ok = (fclose(file) == 0);
+
+            if (!ok || rename(tmp.c_str(), m_dumpPath.c_str()) != 0)
+            {
+                REDIS_LOG_ERR("Failed to write latency dump file %s", m_dumpPath.c_str());
+            }
+        }
+
+        std::mutex m_mutex;
+
+        std::vector<RedisLatencyShard*> m_shards;
+
+        std::mutex m_dumpMutex;
+
+        std::condition_variable m_dumpCv;
+
+        bool m_dumpRunning;
+
+        std::string m_dumpPath;
+
+        std::chrono::milliseconds m_dumpInterval;
+
+        std::thread m_dumpThread;
+};
+
+// never destroyed, threads may still record while process exits
+RedisLatencyRegistry& redis_latency_registry()
+{
+    static RedisLatencyRegistry *registry = new RedisLatencyRegistry();
+
+    return *registry;
+}
+
+struct RedisLatencyShardHolder
+{
+    RedisLatencyShardHolder():
+        shard(NULL)
+    {
+    }
+
+    ~RedisLatencyShardHolder()
+    {
+        if (shard != NULL)
+        {
+            redis_latency_registry().release(shard);
+        }
+    }
+
+    RedisLatencyShard *shard;
+};
+
+thread_local RedisLatencyShardHolder t_latencyShard;
+
+}
+
+void redis_latency_record(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_common_api_t api,
+        _In_ bool bulk,
+        _In_ sai_redis_latency_phase_t phase,
+        _In_ uint64_t start,
+        _In_ uint64_t end)
+{
+    if (start == 0 ||
+        object_type < 0 || object_type >= SAI_OBJECT_TYPE_MAX ||
+        api < 0 || api >= SAI_COMMON_API_MAX)
+    {
+        return;
+    }
+
+    RedisLatencyShard *shard = t_latencyShard.shard;
+
+    if (shard == NULL)
+    {
+        shard = redis_latency_registry().acquire();
+
+        t_latencyShard.shard = shard;
+    }
+
+    std::atomic<RedisLatencyHistogram*> &slot = shard->histograms[object_type][api][bulk][phase];
+
+    RedisLatencyHistogram *h = slot.load(std::memory_order_relaxed);
+
+    if (h == NULL)
+    {
+        // value initialization zeroes all counters
+        h = new RedisLatencyHistogram();
+
+        slot.store(h, std::memory_order_release);
+    }
+
+    uint64_t value = (end > start) ? end - start : 0;
+
+    value = std::min(value, (uint64_t)((1ULL << SAI_REDIS_LATENCY_MAX_BITS) - 1));
+
+    uint64_t count = h->count.load(std::memory_order_relaxed);
+
+    if (count == 0 || value < h->min.load(std::memory_order_relaxed))
+    {
+        h->min.store(value, std::memory_order_relaxed);
+    }
+
+    if (value > h->max.load(std::memory_order_relaxed))
+    {
+        h->max.store(value, std::memory_order_relaxed);
+    }
+
+    redis_latency_add(h->total, value);
+    redis_latency_add(h->buckets[redis_latency_bucket(value)], 1);
+
+    h->count.store(count + 1, std::memory_order_relaxed);
+}
+
+void redis_latency_snapshot(
+        _Out_ std::vector<sai_redis_latency_stats_t> &stats)
+{
+    redis_latency_registry().snapshot(stats);
+}
+
+void redis_latency_start_dump(
+        _In_ const std::string &path,
+        _In_ uint64_t interval_ms)
+{
+    redis_latency_registry().startDump(path, interval_ms);
+}
+
+void redis_latency_stop_dump()
+{
+    redis_latency_registry().stopDump();
+}
@@ -0,0 +1,269 @@
+#include "sai_redis.h"
+#include "sai_redis_log.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <chrono>
+
+// must be power of 2
+#define SAI_REDIS_LOG_RING_SIZE         4096
+
+// log thread polls ring this often when it is empty, producers never
+// wake it, so logging does not make syscalls on programming path
+#define SAI_REDIS_LOG_POLL_INTERVAL_MS  10
+
+// constant initialized, so level checks are valid before any constructor
+#define W { SAI_LOG_WARN }
+
+std::atomic<int> g_logLevel[SAI_REDIS_LOG_API_COUNT] = {
+    W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W, W
+};
+
+#undef W
+
+static_assert(SAI_REDIS_LOG_API_COUNT == 27, "log level table initializer must match sai_api_t");
+
+namespace {
+
+/**
+ * @brief Bounded lock-free ring of formatted messages
+ *
+ * Multiple producers claim slot by advancing head, message is
+ * formatted directly into the slot and published by slot sequence.
+ * Single consumer at a time, guarded by m_drainMutex.
+ */
+class RedisLogRing
+{
+    public:
+
+        RedisLogRing():
+            m_head(0),
+            m_tail(0),
+            m_dropped(0),
+            m_running(false)
+        {
+            for (size_t i = 0; i < SAI_REDIS_LOG_RING_SIZE; i++)
+            {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~RedisLogRing()
+        {
+            stop();
+        }
+
+        void write(
+                _In_ sai_log_level_t level,
+                _In_ const char *format,
+                _In_ va_list ap)
+        {
+            size_t pos = m_head.load(std::memory_order_relaxed);
+
+            Slot *slot;
+
+            while (true)
+            {
+                slot = &m_slots[pos & (SAI_REDIS_LOG_RING_SIZE - 1)];
+
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+
+                intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+                if (diff == 0)
+                {
+                    if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // full, consumer is behind
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                else
+                {
+                    pos = m_head.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->level = level;
+
+            int n = vsnprintf(slot->message, sizeof(slot->message), format, ap);
+
+            size_t length = (n < 0) ? 0 : std::min((size_t)n, sizeof(slot->message) - 1);
+
+            // many callers end format with new line, one is added on write
+            while (length > 0 && slot->message[length - 1] == '\n')
+            {
+                length--;
+            }
+
+            slot->length = length;
+
+            slot->sequence.store(pos + 1, std::memory_order_release);
+
+            if (!m_running.load(std::memory_order_relaxed))
+            {
+                drain();
+            }
+        }
+
+        void start()
+        {
+            std::lock_guard<std::mutex> lock(m_threadMutex);
+
+            if (m_running)
+            {
+                return;
+            }
+
+            m_running = true;
+
+            m_thread = std::thread(&RedisLogRing::logThread, this);
+        }
+
+        void stop()
+        {
+            std::lock_guard<std::mutex> lock(m_threadMutex);
+
+            if (!m_running)
+            {
+                return;
+            }
+
+            m_running = false;
+
+            m_thread.join();
+
+            drain();
+        }
+
+    private:
+
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+
+            sai_log_level_t level;
+
+            size_t length;
+
+            char message[SAI_REDIS_LOG_MESSAGE_SIZE];
+        };
+
+        void logThread()
+        {
+            while (m_running)
+            {
+                if (drain() == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(SAI_REDIS_LOG_POLL_INTERVAL_MS));
+                }
+            }
+        }
+
+        size_t drain()
+        {
+            std::unique_lock<std::mutex> lock(m_drainMutex, std::try_to_lock);
+
+            if (!lock.owns_lock())
+            {
+                // other thread is draining and will pick up this message
+                return 0;
+            }
+
+            size_t count = 0;
+
+            while (true)
+            {
+                Slot &slot = m_slots[m_tail & (SAI_REDIS_LOG_RING_SIZE - 1)];
+
+                if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1)
+                {
+                    break;
+                }
+
+                fprintf(stderr, "%d: %.*s\n", slot.level, (int)slot.length, slot.message);
+
+                slot.sequence.store(m_tail + SAI_REDIS_LOG_RING_SIZE, std::memory_order_release);
+
+                m_tail++;
+
+                count++;
+            }
+
+            uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+
+            if (dropped != 0)
+            {
+                fprintf(stderr, "%d: %lu log messages dropped\n", SAI_LOG_WARN, dropped);
+            }
+
+            if (count != 0)
+            {
+                fflush(stderr);
+            }
+
+            return count;
+        }
+
+        Slot m_slots[SAI_REDIS_LOG_RING_SIZE];
+
+        // producers and consumer on separate cache lines
+        alignas(64) std::atomic<size_t> m_head;
+
+        alignas(64) size_t m_tail;
+
+        std::atomic<uint64_t> m_dropped;
+
+        std::mutex m_drainMutex;
+
+        std::mutex m_threadMutex;
+
+        std::atomic<bool> m_running;
+
+        std::thread m_thread;
+};
+
+// created on first use, messages logged from static constructors of
+// other translation units go to constructed ring
+RedisLogRing& redis_log_ring()
+{
+    static RedisLogRing ring;
+
+    return ring;
+}
+
+}
+
+void redis_log_write(
+        _In_ sai_api_t api,
+        _In_ sai_log_level_t level,
+        _In_ const char *format,
+        ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+
+    redis_log_ring().write(level, format, ap);
+
+    va_end(ap);
+}
+
+void redis_log_start()
+{
+    redis_log_ring().start();
+}
+
+void redis_log_stop()
+{
+    redis_log_ring().stop();
+}
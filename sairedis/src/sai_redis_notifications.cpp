@@ -0,0 +1,287 @@
+#define REDIS_LOG_API SAI_API_SWITCH
+
+#include "sai_redis.h"
+#include "sai_redis_notifications.h"
+
+#include "sswcommon/select.h"
+
+// consumer thread checks for stop at least this often
+#define SAI_REDIS_NOTIFICATION_SELECT_TIMEOUT_MS 1000
+
+RedisNotificationConsumer::RedisNotificationConsumer(
+        _In_ ssw::DBConnector *db,
+        _In_ const std::string &table_name,
+        _In_ const sai_switch_notification_t &notifications,
+        _In_ size_t batch_size):
+    m_consumer(db, table_name),
+    m_notifications(notifications),
+    m_batchSize(batch_size == 0 ? 1 : batch_size),
+    m_fdbEventCount(0),
+    m_portEventCount(0),
+    m_batches(0),
+    m_batchHighWaterMark(0),
+    m_backlogHighWaterMark(0),
+    m_droppedMalformed(0),
+    m_droppedUnhandled(0),
+    m_running(true)
+{
+    m_fdbEvents.reserve(m_batchSize);
+    m_portEvents.reserve(m_batchSize);
+
+    m_thread = std::thread(&RedisNotificationConsumer::consumerThread, this);
+}
+
+RedisNotificationConsumer::~RedisNotificationConsumer()
+{
+    m_running = false;
+
+    m_thread.join();
+}
+
+void RedisNotificationConsumer::getStats(
+        _Out_ sai_redis_notification_stats_t &stats) const
+{
+    stats.fdb_events = m_fdbEventCount.load(std::memory_order_relaxed);
+    stats.port_state_change_events = m_portEventCount.load(std::memory_order_relaxed);
+    stats.batches = m_batches.load(std::memory_order_relaxed);
+    stats.batch_high_water_mark = m_batchHighWaterMark.load(std::memory_order_relaxed);
+    stats.backlog_high_water_mark = m_backlogHighWaterMark.load(std::memory_order_relaxed);
+    stats.dropped_malformed = m_droppedMalformed.load(std::memory_order_relaxed);
+    stats.dropped_unhandled = m_droppedUnhandled.load(std::memory_order_relaxed);
+}
+
+void RedisNotificationConsumer::consumerThread()
+{
+    ssw::Select select;
+
+    select.addSelectable(&m_consumer);
+
+    while (m_running)
+    {
+        ssw::Selectable *selectable;
+
+        int fd;
+
+        int result = select.select(&selectable, &fd, SAI_REDIS_NOTIFICATION_SELECT_TIMEOUT_MS);
+
+        if (result == ssw::Select::OBJECT)
+        {
+            drain();
+        }
+        else if (result == ssw::Select::ERROR)
+        {
+            REDIS_LOG_ERR("Notification select failed");
+        }
+    }
+}
+
+static void redis_update_max(
+        _Inout_ std::atomic<uint64_t> &max,
+        _In_ uint64_t value)
+{
+    // only consumer thread writes, readers just need atomic load
+    if (value > max.load(std::memory_order_relaxed))
+    {
+        max.store(value, std::memory_order_relaxed);
+    }
+}
+
+void RedisNotificationConsumer::drain()
+{
+    uint64_t backlog = 0;
+
+    // everything already queued is consumed before delivery of last
+    // partial batch, so storm is delivered in full batches
+
+    do
+    {
+        m_consumer.pop(m_kco);
+
+        backlog++;
+
+        const std::string &op = kfvOp(m_kco);
+
+        if (op == SAI_REDIS_NOTIFICATION_FDB_EVENT)
+        {
+            handleFdbEvent(m_kco);
+        }
+        else if (op == SAI_REDIS_NOTIFICATION_PORT_STATE_CHANGE)
+        {
+            handlePortStateChange(m_kco);
+        }
+        else
+        {
+            REDIS_LOG_ERR("Unknown notification: %s", op.c_str());
+
+            m_droppedUnhandled.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    while (!m_consumer.empty());
+
+    deliverFdbEvents();
+    deliverPortStateChanges();
+
+    redis_update_max(m_backlogHighWaterMark, backlog);
+}
+
+void RedisNotificationConsumer::handleFdbEvent(
+        _In_ const ssw::KeyOpFieldsValuesTuple &kco)
+{
+    if (m_notifications.on_fdb_event == NULL)
+    {
+        m_droppedUnhandled.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // events are delivered in order, so batch of other kind goes first
+    deliverPortStateChanges();
+
+    const std::string &key = kfvKey(kco);
+
+    sai_fdb_event_notification_data_t event;
+
+    size_t offset = 0;
+
+    if (!sai_deserialize_primitive(g_serialization_format, key.data(), key.size(), offset, event.event_type) ||
+        !sai_deserialize_primitive(g_serialization_format, key.data(), key.size(), offset, event.fdb_entry) ||
+        offset != key.size())
+    {
+        REDIS_LOG_ERR("Malformed fdb event notification");
+
+        m_droppedMalformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const std::vector<ssw::FieldValueTuple> &values = kfvFieldsValues(kco);
+
+    m_views.clear();
+
+    for (const auto &fv: values)
+    {
+        m_views.push_back({ fvField(fv).data(), fvField(fv).size() });
+        m_views.push_back({ fvValue(fv).data(), fvValue(fv).size() });
+    }
+
+    size_t first = m_fdbAttributes.size();
+
+    m_fdbAttributes.resize(first + values.size());
+
+    sai_status_t status = sai_deserialize_attr_list(
+            g_serialization_format,
+            SAI_OBJECT_TYPE_FDB,
+            (uint32_t)values.size(),
+            m_views.data(),
+            m_fdbAttributes.data() + first,
+            m_context);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_ERR("Malformed fdb event notification attributes, status: %d", status);
+
+        m_fdbAttributes.resize(first);
+
+        m_droppedMalformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // attribute pointers are set on delivery, vector may still grow
+    event.attr_count = (uint32_t)values.size();
+    event.attr = NULL;
+
+    m_fdbEvents.push_back(event);
+
+    if (m_fdbEvents.size() >= m_batchSize)
+    {
+        deliverFdbEvents();
+    }
+}
+
+void RedisNotificationConsumer::handlePortStateChange(
+        _In_ const ssw::KeyOpFieldsValuesTuple &kco)
+{
+    if (m_notifications.on_port_state_change == NULL)
+    {
+        m_droppedUnhandled.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    deliverFdbEvents();
+
+    const std::string &key = kfvKey(kco);
+
+    sai_port_oper_status_notification_t event;
+
+    size_t offset = 0;
+
+    if (!sai_deserialize_primitive(g_serialization_format, key.data(), key.size(), offset, event) ||
+        offset != key.size())
+    {
+        REDIS_LOG_ERR("Malformed port state change notification");
+
+        m_droppedMalformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_portEvents.push_back(event);
+
+    if (m_portEvents.size() >= m_batchSize)
+    {
+        deliverPortStateChanges();
+    }
+}
+
+void RedisNotificationConsumer::updateBatchHighWaterMark(
+        _In_ uint64_t count)
+{
+    m_batches.fetch_add(1, std::memory_order_relaxed);
+
+    redis_update_max(m_batchHighWaterMark, count);
+}
+
+void RedisNotificationConsumer::deliverFdbEvents()
+{
+    if (m_fdbEvents.empty())
+    {
+        return;
+    }
+
+    size_t offset = 0;
+
+    for (auto &event: m_fdbEvents)
+    {
+        event.attr = (event.attr_count == 0) ? NULL : &m_fdbAttributes[offset];
+
+        offset += event.attr_count;
+    }
+
+    uint32_t count = (uint32_t)m_fdbEvents.size();
+
+    m_notifications.on_fdb_event(count, m_fdbEvents.data());
+
+    m_fdbEventCount.fetch_add(count, std::memory_order_relaxed);
+
+    updateBatchHighWaterMark(count);
+
+    // capacity is kept for next batch
+    m_fdbEvents.clear();
+    m_fdbAttributes.clear();
+    m_context.reset();
+}
+
+void RedisNotificationConsumer::deliverPortStateChanges()
+{
+    if (m_portEvents.empty())
+    {
+        return;
+    }
+
+    uint32_t count = (uint32_t)m_portEvents.size();
+
+    m_notifications.on_port_state_change(count, m_portEvents.data());
+
+    m_portEventCount.fetch_add(count, std::memory_order_relaxed);
+
+    updateBatchHighWaterMark(count);
+
+    m_portEvents.clear();
+}
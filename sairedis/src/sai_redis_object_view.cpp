@@ -0,0 +1,665 @@
+#include "sai_redis.h"
+#include "sai_redis_object_view.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SAI_REDIS_SNAPSHOT_MAGIC    "SRVIEW\0\0"
+#define SAI_REDIS_SNAPSHOT_VERSION  1
+
+/*
+ * Snapshot layout, all integers in host byte order:
+ *
+ * header:  char magic[8], uint32_t version, uint32_t format
+ * record:  uint32_t api, uint32_t object_type, uint64_t vid,
+ *          string key, uint32_t field_count,
+ *          field_count times string field, string value
+ * string:  uint32_t length, length bytes
+ */
+
+typedef struct _sai_redis_snapshot_header_t
+{
+    char magic[8];
+
+    uint32_t version;
+
+    uint32_t format;
+
+} sai_redis_snapshot_header_t;
+
+static void snapshot_put(
+        _Inout_ uint8_t *&p,
+        _In_ const void *data,
+        _In_ size_t size)
+{
+    memcpy(p, data, size);
+
+    p += size;
+}
+
+static void snapshot_put_string(
+        _Inout_ uint8_t *&p,
+        _In_ const std::string &str)
+{
+    uint32_t length = (uint32_t)str.size();
+
+    snapshot_put(p, &length, sizeof(length));
+    snapshot_put(p, str.data(), str.size());
+}
+
+static bool snapshot_get(
+        _Inout_ const uint8_t *&p,
+        _In_ const uint8_t *end,
+        _Out_ void *data,
+        _In_ size_t size)
+{
+    if ((size_t)(end - p) < size)
+    {
+        return false;
+    }
+
+    memcpy(data, p, size);
+
+    p += size;
+
+    return true;
+}
+
+static bool snapshot_get_string(
+        _Inout_ const uint8_t *&p,
+        _In_ const uint8_t *end,
+        _Out_ std::string &str)
+{
+    uint32_t length;
+
+    if (!snapshot_get(p, end, &length, sizeof(length)) || (size_t)(end - p) < length)
+    {
+        return false;
+    }
+
+    str.assign((const char*)p, length);
+
+    p += length;
+
+    return true;
+}
+
+RedisObjectView::RedisObjectView():
+    m_restored(0),
+    m_absorbed(0)
+{
+    for (auto &count: m_unclaimedCount)
+    {
+        count = 0;
+    }
+}
+
+RedisObjectView::Shard& RedisObjectView::shard(
+        _In_ const std::string &key)
+{
+    size_t hash = std::hash<std::string>()(key);
+
+    return m_shards[hash & (SAI_REDIS_OBJECT_VIEW_SHARDS - 1)];
+}
+
+bool RedisObjectView::isIdentical(
+        _In_ const AttributeMap &attributes,
+        _In_ const std::vector<ssw::FieldValueTuple> &entry)
+{
+    // entry with duplicate field has different size, so it is never
+    // identical, it is just written again
+
+    if (attributes.size() != entry.size())
+    {
+        return false;
+    }
+
+    for (const auto &fv: entry)
+    {
+        auto it = attributes.find(fvField(fv));
+
+        if (it == attributes.end() || it->second != fvValue(fv))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void RedisObjectView::signature(
+        _In_ sai_object_type_t object_type,
+        _In_ const AttributeMap &attributes,
+        _Out_ std::string &str)
+{
+    // fields are sorted by map, lengths keep binary values unambiguous
+
+    str = std::to_string(object_type);
+
+    for (const auto &attribute: attributes)
+    {
+        str += "|" + std::to_string(attribute.first.size()) + ":" + attribute.first;
+        str += "|" + std::to_string(attribute.second.size()) + ":" + attribute.second;
+    }
+}
+
+bool RedisObjectView::create(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_object_id_t vid,
+        _In_ const std::string &key,
+        _In_ const std::vector<ssw::FieldValueTuple> &entry)
+{
+    Shard &s = shard(key);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto it = s.objects.find(key);
+
+    if (it != s.objects.end() && isIdentical(it->second.attributes, entry))
+    {
+        m_absorbed.fetch_add(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    // create of existing key replaces whole object in ASIC_STATE
+    Object &object = s.objects[key];
+
+    object.objectType = object_type;
+    object.vid = vid;
+    object.attributes.clear();
+
+    for (const auto &fv: entry)
+    {
+        object.attributes[fvField(fv)] = fvValue(fv);
+    }
+
+    return false;
+}
+
+bool RedisObjectView::set(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::string &key,
+        _In_ const ssw::FieldValueTuple &value)
+{
+    Shard &s = shard(key);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto it = s.objects.find(key);
+
+    if (it == s.objects.end())
+    {
+        // object created by switch, for example port, it is kept so
+        // replayed set of same value is absorbed too
+
+        Object &object = s.objects[key];
+
+        object.objectType = object_type;
+        object.vid = SAI_NULL_OBJECT_ID;
+        object.attributes[fvField(value)] = fvValue(value);
+
+        return false;
+    }
+
+    AttributeMap &attributes = it->second.attributes;
+
+    auto attribute = attributes.find(fvField(value));
+
+    if (attribute != attributes.end() && attribute->second == fvValue(value))
+    {
+        m_absorbed.fetch_add(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    attributes[fvField(value)] = fvValue(value);
+
+    return false;
+}
+
+void RedisObjectView::remove(
+        _In_ const std::string &key)
+{
+    Shard &s = shard(key);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    s.objects.erase(key);
+}
+
+bool RedisObjectView::hasUnclaimed(
+        _In_ sai_object_type_t object_type) const
+{
+    return m_unclaimedCount[object_type].load(std::memory_order_relaxed) != 0;
+}
+
+sai_object_id_t RedisObjectView::claim(
+        _In_ sai_object_type_t object_type,
+        _In_ const std::vector<ssw::FieldValueTuple> &entry)
+{
+    AttributeMap attributes;
+
+    for (const auto &fv: entry)
+    {
+        attributes[fvField(fv)] = fvValue(fv);
+    }
+
+    std::string str;
+
+    signature(object_type, attributes, str);
+
+    std::lock_guard<std::mutex> lock(m_unclaimedMutex);
+
+    auto candidate = m_unclaimed.find(str);
+
+    if (candidate == m_unclaimed.end())
+    {
+        return SAI_NULL_OBJECT_ID;
+    }
+
+    sai_object_id_t vid = SAI_NULL_OBJECT_ID;
+
+    // object could be removed or changed by set since it was
+    // restored, then it does not match anymore
+
+    Shard &s = shard(candidate->second.key);
+
+    {
+        std::lock_guard<std::mutex> shard_lock(s.mutex);
+
+        auto it = s.objects.find(candidate->second.key);
+
+        if (it != s.objects.end() && it->second.vid == candidate->second.vid && isIdentical(it->second.attributes, entry))
+        {
+            vid = candidate->second.vid;
+        }
+    }
+
+    m_unclaimed.erase(candidate);
+
+    m_unclaimedCount[object_type]--;
+
+    return vid;
+}
+
+void RedisObjectView::apply(
+        _In_ sai_common_api_t api,
+        _In_ sai_object_type_t object_type,
+        _In_ sai_object_id_t vid,
+        _In_ const std::string &key,
+        _In_ const std::vector<ssw::FieldValueTuple> &entry)
+{
+    switch (api)
+    {
+        case SAI_COMMON_API_CREATE:
+            create(object_type, vid, key, entry);
+            break;
+
+        case SAI_COMMON_API_SET:
+            for (const auto &fv: entry)
+            {
+                set(object_type, key, fv);
+            }
+            break;
+
+        case SAI_COMMON_API_REMOVE:
+            remove(key);
+            break;
+
+        default:
+            REDIS_LOG_WRN("Ignoring snapshot record with api %d", api);
+            break;
+    }
+}
+
+sai_status_t RedisObjectView::save(
+        _In_ const std::string &path,
+        _In_ sai_serialization_format_t format)
+{
+    REDIS_LOG_ENTER();
+
+    // all shards are locked, so snapshot is consistent across objects
+
+    std::vector<std::unique_lock<std::mutex>> locks;
+
+    for (auto &s: m_shards)
+    {
+        locks.emplace_back(s.mutex);
+    }
+
+    size_t size = sizeof(sai_redis_snapshot_header_t);
+
+    for (auto &s: m_shards)
+    {
+        for (const auto &it: s.objects)
+        {
+            size += 4 * sizeof(uint32_t) + sizeof(uint64_t) + it.first.size();
+
+            for (const auto &attribute: it.second.attributes)
+            {
+                size += 2 * sizeof(uint32_t) + attribute.first.size() + attribute.second.size();
+            }
+        }
+    }
+
+    std::string tmp = path + ".tmp";
+
+    int fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+    {
+        REDIS_LOG_ERR("Failed to open snapshot %s: %s", tmp.c_str(), strerror(errno));
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        REDIS_LOG_ERR("Failed to resize snapshot %s: %s", tmp.c_str(), strerror(errno));
+
+        close(fd);
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED)
+    {
+        REDIS_LOG_ERR("Failed to map snapshot %s: %s", tmp.c_str(), strerror(errno));
+
+        close(fd);
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    uint8_t *p = (uint8_t*)map;
+
+    sai_redis_snapshot_header_t header;
+
+    memcpy(header.magic, SAI_REDIS_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SAI_REDIS_SNAPSHOT_VERSION;
+    header.format = format;
+
+    snapshot_put(p, &header, sizeof(header));
+
+    uint64_t objects = 0;
+
+    for (auto &s: m_shards)
+    {
+        for (const auto &it: s.objects)
+        {
+            uint32_t api = SAI_COMMON_API_CREATE;
+            uint32_t object_type = it.second.objectType;
+            uint64_t vid = it.second.vid;
+            uint32_t field_count = (uint32_t)it.second.attributes.size();
+
+            snapshot_put(p, &api, sizeof(api));
+            snapshot_put(p, &object_type, sizeof(object_type));
+            snapshot_put(p, &vid, sizeof(vid));
+            snapshot_put_string(p, it.first);
+            snapshot_put(p, &field_count, sizeof(field_count));
+
+            for (const auto &attribute: it.second.attributes)
+            {
+                snapshot_put_string(p, attribute.first);
+                snapshot_put_string(p, attribute.second);
+            }
+
+            objects++;
+        }
+    }
+
+    locks.clear();
+
+    bool ok = (msync(map, size, MS_SYNC) == 0);
+
+    munmap(map, size);
+
+    ok = ok && (fsync(fd) == 0);
+
+    close(fd);
+
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        REDIS_LOG_ERR("Failed to write snapshot %s: %s", path.c_str(), strerror(errno));
+
+        unlink(tmp.c_str());
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    REDIS_LOG_NTC("Saved %lu objects to snapshot %s", objects, path.c_str());
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t RedisObjectView::load(
+        _In_ const std::string &path,
+        _In_ sai_serialization_format_t format)
+{
+    REDIS_LOG_ENTER();
+
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+        {
+            REDIS_LOG_NTC("No snapshot %s, starting with empty view", path.c_str());
+
+            REDIS_LOG_EXIT();
+            return SAI_STATUS_SUCCESS;
+        }
+
+        REDIS_LOG_ERR("Failed to open snapshot %s: %s", path.c_str(), strerror(errno));
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(sai_redis_snapshot_header_t))
+    {
+        REDIS_LOG_ERR("Invalid snapshot %s", path.c_str());
+
+        close(fd);
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    size_t size = (size_t)st.st_size;
+
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        REDIS_LOG_ERR("Failed to map snapshot %s: %s", path.c_str(), strerror(errno));
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    const uint8_t *p = (const uint8_t*)map;
+    const uint8_t *end = p + size;
+
+    sai_redis_snapshot_header_t header;
+
+    snapshot_get(p, end, &header, sizeof(header));
+
+    if (memcmp(header.magic, SAI_REDIS_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != SAI_REDIS_SNAPSHOT_VERSION)
+    {
+        REDIS_LOG_ERR("Invalid snapshot %s header", path.c_str());
+
+        munmap(map, size);
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_FAILURE;
+    }
+
+    if (header.format != (uint32_t)format)
+    {
+        // keys and values would never match what is written now
+
+        REDIS_LOG_WRN("Snapshot %s has different serialization format, ignoring it", path.c_str());
+
+        munmap(map, size);
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_SUCCESS;
+    }
+
+    std::vector<ssw::FieldValueTuple> entry;
+    std::string key;
+
+    uint64_t records = 0;
+
+    while (p < end)
+    {
+        uint32_t api;
+        uint32_t object_type;
+        uint64_t vid;
+        uint32_t field_count;
+
+        bool ok = snapshot_get(p, end, &api, sizeof(api)) &&
+            snapshot_get(p, end, &object_type, sizeof(object_type)) &&
+            snapshot_get(p, end, &vid, sizeof(vid)) &&
+            snapshot_get_string(p, end, key) &&
+            snapshot_get(p, end, &field_count, sizeof(field_count));
+
+        // field count is bounded by data left, so corrupted count does
+        // not allocate huge entry
+
+        ok = ok && field_count <= (size_t)(end - p) / (2 * sizeof(uint32_t)) && object_type < SAI_OBJECT_TYPE_MAX;
+
+        if (ok)
+        {
+            entry.resize(field_count);
+
+            for (uint32_t i = 0; ok && i < field_count; i++)
+            {
+                ok = snapshot_get_string(p, end, fvField(entry[i])) &&
+                    snapshot_get_string(p, end, fvValue(entry[i]));
+            }
+        }
+
+        if (!ok)
+        {
+            // torn append, records before it are still valid
+
+            REDIS_LOG_WRN("Snapshot %s truncated after %lu records", path.c_str(), records);
+            break;
+        }
+
+        apply((sai_common_api_t)api, (sai_object_type_t)object_type, vid, key, entry);
+
+        records++;
+    }
+
+    munmap(map, size);
+
+    // restored ids are indexed only after all records are applied,
+    // so removed and changed objects are not claimed
+
+    std::string str;
+
+    bool ambiguous[SAI_OBJECT_TYPE_MAX] = {};
+
+    std::lock_guard<std::mutex> lock(m_unclaimedMutex);
+
+    for (auto &s: m_shards)
+    {
+        std::lock_guard<std::mutex> shard_lock(s.mutex);
+
+        for (const auto &it: s.objects)
+        {
+            m_restored++;
+
+            if (it.second.vid == SAI_NULL_OBJECT_ID)
+            {
+                continue;
+            }
+
+            // new ids are allocated after restored ones
+            redis_restore_virtual_object_id(it.second.vid);
+
+            signature(it.second.objectType, it.second.attributes, str);
+
+            Restored restored = { it.second.objectType, it.second.vid, it.first };
+
+            if (!m_unclaimed.emplace(str, restored).second)
+            {
+                ambiguous[it.second.objectType] = true;
+            }
+        }
+    }
+
+    // replay can't tell which of identical objects it creates, so none
+    // of their type is claimed rather than some of them getting swapped
+
+    for (auto it = m_unclaimed.begin(); it != m_unclaimed.end();)
+    {
+        if (ambiguous[it->second.objectType])
+        {
+            it = m_unclaimed.erase(it);
+            continue;
+        }
+
+        m_unclaimedCount[it->second.objectType]++;
+
+        ++it;
+    }
+
+    for (int object_type = 0; object_type < SAI_OBJECT_TYPE_MAX; object_type++)
+    {
+        if (ambiguous[object_type])
+        {
+            REDIS_LOG_NTC("Restored objects of type %d have identical attributes, their creates get new ids", object_type);
+        }
+    }
+
+    REDIS_LOG_NTC("Loaded %lu objects from %lu records of snapshot %s", m_restored.load(), records, path.c_str());
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void RedisObjectView::getStats(
+        _Out_ sai_redis_view_stats_t &stats)
+{
+    stats.objects = 0;
+    stats.restored = m_restored.load(std::memory_order_relaxed);
+    stats.absorbed = m_absorbed.load(std::memory_order_relaxed);
+    stats.unclaimed = 0;
+
+    for (auto &s: m_shards)
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        stats.objects += s.objects.size();
+    }
+
+    for (const auto &count: m_unclaimedCount)
+    {
+        stats.unclaimed += count.load(std::memory_order_relaxed);
+    }
+}
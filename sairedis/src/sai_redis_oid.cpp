@@ -0,0 +1,126 @@
+#include "sai_redis.h"
+
+#include <atomic>
+
+/*
+ * Virtual object id layout:
+ *
+ *  63      56 55      48 47                                 0
+ * +----------+----------+------------------------------------+
+ * |    0     | obj type |              index                 |
+ * +----------+----------+------------------------------------+
+ *
+ * Index is allocated per object type from atomic counter, so create
+ * does not need to ask syncd for id and does not take any lock. Index
+ * starts from 1, so virtual id is never SAI_NULL_OBJECT_ID.
+ */
+
+static std::atomic<uint64_t> g_vid_index[SAI_OBJECT_TYPE_MAX];
+
+/**
+ *   Routine Description:
+ *    @brief Allocates virtual object id for given object type
+ *
+ *  Arguments:
+ *  @param[in] object_type - type of object
+ *
+ *  Return Values:
+ *    @return  Virtual object id, SAI_NULL_OBJECT_ID when object type
+ *             is invalid or index space is exhausted
+ */
+sai_object_id_t redis_create_virtual_object_id(
+        _In_ sai_object_type_t object_type)
+{
+    REDIS_LOG_ENTER();
+
+    if (object_type <= SAI_OBJECT_TYPE_NULL || object_type >= SAI_OBJECT_TYPE_MAX)
+    {
+        REDIS_LOG_ERR("Invalid object type: %d", object_type);
+
+        REDIS_LOG_EXIT();
+        return SAI_NULL_OBJECT_ID;
+    }
+
+    // relaxed is enough, only uniqueness of index is required
+    uint64_t index = g_vid_index[object_type].fetch_add(1, std::memory_order_relaxed) + 1;
+
+    if (index > SAI_REDIS_VID_INDEX_MASK)
+    {
+        REDIS_LOG_ERR("Virtual object id space exhausted for object type: %d", object_type);
+
+        REDIS_LOG_EXIT();
+        return SAI_NULL_OBJECT_ID;
+    }
+
+    sai_object_id_t vid = ((sai_object_id_t)object_type << SAI_REDIS_VID_OBJECT_TYPE_SHIFT) | index;
+
+    REDIS_LOG_EXIT();
+
+    return vid;
+}
+
+/**
+ * Routine Description:
+ *     @brief Query sai object type.
+ *
+ * Arguments:
+ *     @param[in] sai_object_id
+ *
+ * Return Values:
+ *    @return  Return SAI_OBJECT_TYPE_NULL when sai_object_id is not valid.
+ *             Otherwise, return a valid sai object type SAI_OBJECT_TYPE_XXX
+ */
+sai_object_type_t sai_object_type_query(
+        _In_ sai_object_id_t sai_object_id)
+{
+    REDIS_LOG_ENTER();
+
+    uint64_t object_type = sai_object_id >> SAI_REDIS_VID_OBJECT_TYPE_SHIFT;
+
+    if (object_type >= SAI_OBJECT_TYPE_MAX || (sai_object_id & SAI_REDIS_VID_INDEX_MASK) == 0)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_OBJECT_TYPE_NULL;
+    }
+
+    REDIS_LOG_EXIT();
+
+    return (sai_object_type_t)object_type;
+}
+
+/**
+ *   Routine Description:
+ *    @brief Moves allocation of object type of restored virtual id
+ *    past its index, so restored id is not allocated again
+ *
+ *  Arguments:
+ *  @param[in] vid - virtual object id loaded from snapshot
+ *
+ *  Return Values:
+ *    None
+ */
+void redis_restore_virtual_object_id(
+        _In_ sai_object_id_t vid)
+{
+    REDIS_LOG_ENTER();
+
+    sai_object_type_t object_type = sai_object_type_query(vid);
+
+    if (object_type == SAI_OBJECT_TYPE_NULL)
+    {
+        REDIS_LOG_ERR("Invalid restored virtual object id: 0x%lx", vid);
+
+        REDIS_LOG_EXIT();
+        return;
+    }
+
+    uint64_t index = vid & SAI_REDIS_VID_INDEX_MASK;
+
+    uint64_t current = g_vid_index[object_type].load(std::memory_order_relaxed);
+
+    while (current < index && !g_vid_index[object_type].compare_exchange_weak(current, index, std::memory_order_relaxed))
+    {
+    }
+
+    REDIS_LOG_EXIT();
+}
@@ -0,0 +1,597 @@
+#include "sai_redis.h"
+#include "sai_redis_pipeline.h"
+
+#include "sswcommon/json.h"
+
+#include <algorithm>
+
+RedisPipeline::RedisPipeline(
+        _In_ ssw::DBConnector *db,
+        _In_ ssw::ProducerTable *table,
+        _In_ size_t batch_size,
+        _In_ uint64_t flush_latency_us,
+        _In_ bool async):
+    m_db(db),
+    m_keyQueue(table->getKeyQueueTableName()),
+    m_valueQueue(table->getValueQueueTableName()),
+    m_opQueue(table->getOpQueueTableName()),
+    m_channel(table->getChannelTableName()),
+    m_batchSize(batch_size == 0 ? 1 : batch_size),
+    m_flushLatency(flush_latency_us),
+    m_running(true),
+    m_async(async),
+    m_writerSleeping(false),
+    m_asyncStatus(SAI_STATUS_SUCCESS),
+    m_errorNotification(NULL),
+    m_writeListener(NULL),
+    m_combiningWindow(0)
+{
+    m_operations.reserve(m_batchSize);
+
+    if (m_async)
+    {
+        m_thread = std::thread(&RedisPipeline::writerThread, this);
+    }
+    else
+    {
+        m_thread = std::thread(&RedisPipeline::flushThread, this);
+    }
+}
+
+RedisPipeline::~RedisPipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_running = false;
+    }
+
+    m_cv.notify_all();
+
+    // writer thread drains queue before it exits
+    m_thread.join();
+
+    flush();
+}
+
+struct RedisPipeline::SyncBarrier
+{
+    SyncBarrier(): done(false), status(SAI_STATUS_SUCCESS)
+    {
+    }
+
+    std::mutex mutex;
+
+    std::condition_variable cv;
+
+    bool done;
+
+    sai_status_t status;
+};
+
+RedisPipeline::Operation RedisPipeline::setOperation(
+        _In_ const std::string &key,
+        _In_ std::vector<ssw::FieldValueTuple> &values,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type,
+        _In_ sai_common_api_t api,
+        _In_ sai_attr_id_t attr_id)
+{
+    // same framing as ProducerTable::set
+    return { key, ssw::JSon::buildJson(values), "S" + op, object_type, api, attr_id, false, redis_latency_now(), false, 0 };
+}
+
+RedisPipeline::Operation RedisPipeline::delOperation(
+        _In_ const std::string &key,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type)
+{
+    // same framing as ProducerTable::del
+    return { key, "{}", "D" + op, object_type, SAI_COMMON_API_REMOVE, 0, false, redis_latency_now(), false, 0 };
+}
+
+sai_status_t RedisPipeline::set(
+        _In_ const std::string &key,
+        _In_ std::vector<ssw::FieldValueTuple> &values,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type,
+        _In_ sai_common_api_t api,
+        _In_ sai_attr_id_t attr_id)
+{
+    return enqueue(setOperation(key, values, op, object_type, api, attr_id));
+}
+
+sai_status_t RedisPipeline::del(
+        _In_ const std::string &key,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type)
+{
+    return enqueue(delOperation(key, op, object_type));
+}
+
+void RedisPipeline::setWriteCombiningWindow(
+        _In_ uint64_t window_us)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_combiningWindow = std::chrono::microseconds(window_us);
+}
+
+uint64_t RedisPipeline::getCoalescedCount() const
+{
+    return m_combiner.getCoalescedCount();
+}
+
+std::chrono::steady_clock::time_point RedisPipeline::deadlineLocked() const
+{
+    return m_firstOperationTime + std::max(m_flushLatency, m_combiningWindow);
+}
+
+void RedisPipeline::appendLocked(
+        _In_ Operation &&operation)
+{
+    if (m_combiningWindow.count() > 0 && m_combiner.combine(m_operations, operation))
+    {
+        return;
+    }
+
+    if (m_operations.empty())
+    {
+        m_firstOperationTime = std::chrono::steady_clock::now();
+    }
+
+    m_operations.push_back(std::move(operation));
+}
+
+sai_status_t RedisPipeline::enqueue(
+        _In_ Operation &&operation)
+{
+    if (m_async)
+    {
+        Request request;
+
+        request.operation = std::move(operation);
+
+        push(std::move(request));
+
+        return SAI_STATUS_SUCCESS;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_operations.empty())
+    {
+        m_cv.notify_one();
+    }
+
+    appendLocked(std::move(operation));
+
+    if (m_operations.size() >= m_batchSize)
+    {
+        // caller pays for full batch, this also limits memory when
+        // producer is faster than redis
+        return flushLocked();
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t RedisPipeline::bulk(
+        _In_ std::vector<Operation> &operations)
+{
+    for (auto &operation: operations)
+    {
+        operation.bulk = true;
+    }
+
+    if (m_async)
+    {
+        // errors are reported by notification, as for single operations
+
+        Request request;
+
+        request.bulk.swap(operations);
+
+        push(std::move(request));
+
+        return SAI_STATUS_SUCCESS;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // operations of this call follow pending ones
+    size_t first = m_operations.size();
+
+    if (m_operations.empty() && m_combiningWindow.count() == 0)
+    {
+        m_operations.swap(operations);
+    }
+    else
+    {
+        m_operations.reserve(m_operations.size() + operations.size());
+
+        for (auto &operation: operations)
+        {
+            appendLocked(std::move(operation));
+        }
+    }
+
+    operations.clear();
+
+    return flushLocked(&operations, first);
+}
+
+sai_status_t RedisPipeline::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return flushLocked();
+}
+
+sai_status_t RedisPipeline::sync()
+{
+    if (!m_async)
+    {
+        return flush();
+    }
+
+    SyncBarrier barrier;
+
+    Request request;
+
+    request.barrier = &barrier;
+
+    push(std::move(request));
+
+    std::unique_lock<std::mutex> lock(barrier.mutex);
+
+    barrier.cv.wait(lock, [&barrier]{ return barrier.done; });
+
+    return barrier.status;
+}
+
+void RedisPipeline::setErrorNotification(
+        _In_ sai_redis_error_notification_fn notification)
+{
+    m_errorNotification.store(notification);
+}
+
+void RedisPipeline::setWriteListener(
+        _In_ RedisWriteListener *listener)
+{
+    m_writeListener.store(listener);
+}
+
+void RedisPipeline::push(
+        _In_ Request &&request)
+{
+    m_queue.push(std::move(request));
+
+    // writer sets flag before it checks queue for last time, so either
+    // it sees this request or we see it sleeping, mutex makes sure
+    // notify is not lost before writer waits
+
+    if (m_writerSleeping.load())
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_cv.notify_one();
+    }
+}
+
+static bool redis_pipeline_append(
+        _In_ redisContext *context,
+        _In_ std::vector<const char*> &argv,
+        _In_ std::vector<size_t> &argvlen)
+{
+    return redisAppendCommandArgv(context, (int)argv.size(), argv.data(), argvlen.data()) == REDIS_OK;
+}
+
+sai_status_t RedisPipeline::flushLocked(
+        _Out_ std::vector<Operation> *unwritten,
+        _In_ size_t first)
+{
+    size_t count = 0;
+
+    for (const auto &operation: m_operations)
+    {
+        count += !operation.dropped;
+    }
+
+    m_combiner.clear();
+
+    RedisWriteListener *listener = m_writeListener.load();
+
+    if (count == 0)
+    {
+        // everything was combined away
+        if (listener != NULL)
+        {
+            for (const auto &operation: m_operations)
+            {
+                listener->written(operation, SAI_STATUS_SUCCESS);
+            }
+        }
+
+        m_operations.clear();
+
+        return SAI_STATUS_SUCCESS;
+    }
+
+    redisContext *context = m_db->getContext();
+
+    uint64_t write_start = redis_latency_now();
+
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+
+    argv.reserve(count + 2);
+    argvlen.reserve(count + 2);
+
+    int replies = 0;
+
+    bool ok = redisAppendCommand(context, "MULTI") == REDIS_OK;
+
+    replies++;
+
+    // LPUSH with many values pushes them in order, so one command per
+    // queue is same as LPUSH per operation, MULTI keeps queues in sync
+
+    const std::string *queues[] = { &m_keyQueue, &m_valueQueue, &m_opQueue };
+
+    for (int q = 0; q < 3 && ok; q++)
+    {
+        argv.clear();
+        argvlen.clear();
+
+        argv.push_back("LPUSH");
+        argvlen.push_back(5);
+
+        argv.push_back(queues[q]->data());
+        argvlen.push_back(queues[q]->size());
+
+        for (const auto &operation: m_operations)
+        {
+            if (operation.dropped)
+            {
+                continue;
+            }
+
+            const std::string &s = (q == 0) ? operation.key : (q == 1) ? operation.value : operation.op;
+
+            argv.push_back(s.data());
+            argvlen.push_back(s.size());
+        }
+
+        ok = redis_pipeline_append(context, argv, argvlen);
+
+        replies++;
+    }
+
+    // consumer is notified once per operation, as with ProducerTable
+
+    argv.clear();
+    argvlen.clear();
+
+    argv.push_back("PUBLISH");
+    argvlen.push_back(7);
+
+    argv.push_back(m_channel.data());
+    argvlen.push_back(m_channel.size());
+
+    argv.push_back("G");
+    argvlen.push_back(1);
+
+    for (size_t i = 0; i < count && ok; i++)
+    {
+        ok = redis_pipeline_append(context, argv, argvlen);
+
+        replies++;
+    }
+
+    ok = ok && redisAppendCommand(context, "EXEC") == REDIS_OK;
+
+    replies++;
+
+    // all replies must be read even on error, otherwise next batch
+    // would read replies of this one
+
+    sai_status_t status = ok ? SAI_STATUS_SUCCESS : SAI_STATUS_FAILURE;
+
+    for (int i = 0; i < replies; i++)
+    {
+        void *reply = NULL;
+
+        if (redisGetReply(context, &reply) != REDIS_OK)
+        {
+            REDIS_LOG_ERR("Failed to read redis reply: %s", context->errstr);
+
+            status = SAI_STATUS_FAILURE;
+            break;
+        }
+
+        redisReply *r = (redisReply*)reply;
+
+        if (r->type == REDIS_REPLY_ERROR)
+        {
+            REDIS_LOG_ERR("Redis error in pipeline: %s", r->str);
+
+            status = SAI_STATUS_FAILURE;
+        }
+
+        freeReplyObject(reply);
+    }
+
+    uint64_t write_end = redis_latency_now();
+
+    for (const auto &operation: m_operations)
+    {
+        if (operation.dropped)
+        {
+            continue;
+        }
+
+        redis_latency_record(operation.objectType, operation.api, operation.bulk, SAI_REDIS_LATENCY_PHASE_QUEUE, operation.enqueueTime, write_start);
+        redis_latency_record(operation.objectType, operation.api, operation.bulk, SAI_REDIS_LATENCY_PHASE_WRITE, write_start, write_end);
+    }
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_ERR("Failed to write %zu operations to ASIC_STATE", count);
+    }
+
+    sai_redis_error_notification_fn notification = m_errorNotification.load();
+
+    for (size_t i = 0; i < m_operations.size(); i++)
+    {
+        Operation &operation = m_operations[i];
+
+        if (status != SAI_STATUS_SUCCESS && !operation.dropped)
+        {
+            if (unwritten != NULL && i >= first)
+            {
+                // bulk caller gets them back
+                unwritten->push_back(std::move(operation));
+                continue;
+            }
+
+            // caller was told it succeeded, cache and view must not
+            // keep what ASIC_STATE does not have
+            redis_evict_unwritten_object(operation.key);
+
+            if (notification != NULL)
+            {
+                notification(operation.key.data(), operation.key.size(), status);
+            }
+        }
+
+        if (listener != NULL)
+        {
+            listener->written(operation, status);
+        }
+    }
+
+    m_operations.clear();
+
+    return status;
+}
+
+void RedisPipeline::flushThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (m_running)
+    {
+        if (m_operations.empty())
+        {
+            m_cv.wait(lock);
+            continue;
+        }
+
+        auto deadline = deadlineLocked();
+
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            flushLocked();
+            continue;
+        }
+
+        m_cv.wait_until(lock, deadline);
+    }
+}
+
+void RedisPipeline::writerThread()
+{
+    Request request;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        while (m_queue.pop(request))
+        {
+            if (request.barrier != NULL)
+            {
+                sai_status_t status = flushLocked();
+
+                if (m_asyncStatus == SAI_STATUS_SUCCESS)
+                {
+                    m_asyncStatus = status;
+                }
+
+                std::lock_guard<std::mutex> barrierLock(request.barrier->mutex);
+
+                request.barrier->status = m_asyncStatus;
+                request.barrier->done = true;
+                request.barrier->cv.notify_one();
+
+                m_asyncStatus = SAI_STATUS_SUCCESS;
+
+                request.barrier = NULL;
+                continue;
+            }
+
+            if (request.bulk.empty())
+            {
+                appendLocked(std::move(request.operation));
+            }
+            else
+            {
+                for (auto &operation: request.bulk)
+                {
+                    appendLocked(std::move(operation));
+                }
+
+                request.bulk.clear();
+            }
+
+            if (m_operations.size() >= m_batchSize)
+            {
+                if (flushLocked() != SAI_STATUS_SUCCESS)
+                {
+                    m_asyncStatus = SAI_STATUS_FAILURE;
+                }
+            }
+        }
+
+        if (!m_running)
+        {
+            if (flushLocked() != SAI_STATUS_SUCCESS)
+            {
+                m_asyncStatus = SAI_STATUS_FAILURE;
+            }
+
+            break;
+        }
+
+        // queue is drained, don't hold partial batch while idle unless
+        // write combining window is still open
+
+        auto deadline = deadlineLocked();
+
+        bool hold = m_combiningWindow.count() > 0 &&
+                    !m_operations.empty() &&
+                    std::chrono::steady_clock::now() < deadline;
+
+        if (!hold && flushLocked() != SAI_STATUS_SUCCESS)
+        {
+            m_asyncStatus = SAI_STATUS_FAILURE;
+        }
+
+        m_writerSleeping.store(true);
+
+        if (m_queue.empty() && m_running)
+        {
+            if (hold)
+            {
+                m_cv.wait_until(lock, deadline);
+            }
+            else
+            {
+                m_cv.wait(lock);
+            }
+        }
+
+        m_writerSleeping.store(false);
+    }
+}
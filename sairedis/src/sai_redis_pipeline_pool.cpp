@@ -0,0 +1,212 @@
+#include "sai_redis.h"
+#include "sai_redis_pipeline_pool.h"
+
+#include <functional>
+
+RedisPipelinePool::RedisPipelinePool(
+        _In_ size_t pool_size,
+        _In_ size_t batch_size,
+        _In_ uint64_t flush_latency_us,
+        _In_ bool async)
+{
+    m_shards.resize(pool_size == 0 ? 1 : pool_size);
+
+    for (auto &shard: m_shards)
+    {
+        shard.db = redis_create_db_connector();
+        shard.table = new ssw::ProducerTable(shard.db, ASIC_STATE_TABLE);
+        shard.pipeline = new RedisPipeline(shard.db, shard.table, batch_size, flush_latency_us, async);
+    }
+}
+
+RedisPipelinePool::~RedisPipelinePool()
+{
+    for (auto &shard: m_shards)
+    {
+        // pipeline writes pending operations, so it goes before connection
+        delete shard.pipeline;
+        delete shard.table;
+        delete shard.db;
+    }
+}
+
+size_t RedisPipelinePool::shardIndex(
+        _In_ const std::string &key) const
+{
+    if (m_shards.size() == 1)
+    {
+        return 0;
+    }
+
+    return std::hash<std::string>()(key) % m_shards.size();
+}
+
+sai_status_t RedisPipelinePool::set(
+        _In_ const std::string &key,
+        _In_ std::vector<ssw::FieldValueTuple> &values,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type,
+        _In_ sai_common_api_t api,
+        _In_ sai_attr_id_t attr_id)
+{
+    return m_shards[shardIndex(key)].pipeline->set(key, values, op, object_type, api, attr_id);
+}
+
+sai_status_t RedisPipelinePool::del(
+        _In_ const std::string &key,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type)
+{
+    return m_shards[shardIndex(key)].pipeline->del(key, op, object_type);
+}
+
+sai_status_t RedisPipelinePool::enqueue(
+        _In_ RedisPipeline::Operation &&operation)
+{
+    return m_shards[shardIndex(operation.key)].pipeline->enqueue(std::move(operation));
+}
+
+sai_status_t RedisPipelinePool::bulk(
+        _In_ std::vector<RedisPipeline::Operation> &operations)
+{
+    if (m_shards.size() == 1)
+    {
+        return m_shards[0].pipeline->bulk(operations);
+    }
+
+    std::vector<std::vector<RedisPipeline::Operation>> parts(m_shards.size());
+
+    // index in operations of each operation of part
+    std::vector<std::vector<size_t>> indexes(m_shards.size());
+
+    for (size_t i = 0; i < operations.size(); i++)
+    {
+        size_t shard = shardIndex(operations[i].key);
+
+        parts[shard].push_back(std::move(operations[i]));
+        indexes[shard].push_back(i);
+    }
+
+    std::vector<bool> unwritten(operations.size(), false);
+
+    sai_status_t result = SAI_STATUS_SUCCESS;
+
+    for (size_t i = 0; i < m_shards.size(); i++)
+    {
+        if (parts[i].empty())
+        {
+            continue;
+        }
+
+        size_t count = parts[i].size();
+
+        sai_status_t status = m_shards[i].pipeline->bulk(parts[i]);
+
+        // pipeline leaves operations not written at end of part, they
+        // go back to their place
+        for (size_t j = 0; j < parts[i].size(); j++)
+        {
+            size_t index = indexes[i][count - parts[i].size() + j];
+
+            operations[index] = std::move(parts[i][j]);
+            unwritten[index] = true;
+        }
+
+        if (result == SAI_STATUS_SUCCESS)
+        {
+            result = status;
+        }
+    }
+
+    size_t left = 0;
+
+    for (size_t i = 0; i < operations.size(); i++)
+    {
+        if (unwritten[i])
+        {
+            if (left != i)
+            {
+                operations[left] = std::move(operations[i]);
+            }
+
+            left++;
+        }
+    }
+
+    operations.resize(left);
+
+    return result;
+}
+
+sai_status_t RedisPipelinePool::flush()
+{
+    sai_status_t result = SAI_STATUS_SUCCESS;
+
+    for (auto &shard: m_shards)
+    {
+        sai_status_t status = shard.pipeline->flush();
+
+        if (result == SAI_STATUS_SUCCESS)
+        {
+            result = status;
+        }
+    }
+
+    return result;
+}
+
+sai_status_t RedisPipelinePool::sync()
+{
+    sai_status_t result = SAI_STATUS_SUCCESS;
+
+    for (auto &shard: m_shards)
+    {
+        sai_status_t status = shard.pipeline->sync();
+
+        if (result == SAI_STATUS_SUCCESS)
+        {
+            result = status;
+        }
+    }
+
+    return result;
+}
+
+void RedisPipelinePool::setErrorNotification(
+        _In_ sai_redis_error_notification_fn notification)
+{
+    for (auto &shard: m_shards)
+    {
+        shard.pipeline->setErrorNotification(notification);
+    }
+}
+
+void RedisPipelinePool::setWriteListener(
+        _In_ RedisWriteListener *listener)
+{
+    for (auto &shard: m_shards)
+    {
+        shard.pipeline->setWriteListener(listener);
+    }
+}
+
+void RedisPipelinePool::setWriteCombiningWindow(
+        _In_ uint64_t window_us)
+{
+    for (auto &shard: m_shards)
+    {
+        shard.pipeline->setWriteCombiningWindow(window_us);
+    }
+}
+
+uint64_t RedisPipelinePool::getCoalescedCount() const
+{
+    uint64_t count = 0;
+
+    for (const auto &shard: m_shards)
+    {
+        count += shard.pipeline->getCoalescedCount();
+    }
+
+    return count;
+}
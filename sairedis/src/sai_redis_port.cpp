@@ -1,3 +1,5 @@
+#define REDIS_LOG_API SAI_API_PORT
+
 #include "sai_redis.h"
 
 
@@ -82,9 +84,16 @@ sai_status_t  redis_get_port_stats(
 {
     REDIS_LOG_ENTER();
 
+    sai_status_t status = redis_generic_get_stats(
+            SAI_OBJECT_TYPE_PORT,
+            port_id,
+            number_of_counters,
+            (const int32_t*)counter_ids,
+            counters);
+
     REDIS_LOG_EXIT();
 
-    return SAI_STATUS_NOT_IMPLEMENTED;
+    return status;
 }
 
 /**
@@ -107,9 +116,15 @@ sai_status_t  redis_clear_port_stats(
 {
     REDIS_LOG_ENTER();
 
+    sai_status_t status = redis_generic_clear_stats(
+            SAI_OBJECT_TYPE_PORT,
+            port_id,
+            number_of_counters,
+            (const int32_t*)counter_ids);
+
     REDIS_LOG_EXIT();
 
-    return SAI_STATUS_NOT_IMPLEMENTED;
+    return status;
 }
 
 /**
@@ -128,9 +143,15 @@ sai_status_t  redis_clear_port_all_stats(
 {
     REDIS_LOG_ENTER();
 
+    sai_status_t status = redis_generic_clear_stats(
+            SAI_OBJECT_TYPE_PORT,
+            port_id,
+            0,
+            NULL);
+
     REDIS_LOG_EXIT();
 
-    return SAI_STATUS_NOT_IMPLEMENTED;
+    return status;
 }
 
 /**
@@ -0,0 +1,938 @@
+#include "sai_redis.h"
+#include "sai_redis_recorder.h"
+
+#include <string.h>
+
+#include <chrono>
+
+// must be power of 2
+#define SAI_REDIS_RECORD_BUFFER_SIZE        (1 << 20)
+
+// writer drains thread buffers this often, producers never wake it
+#define SAI_REDIS_RECORD_DRAIN_INTERVAL_MS  10
+
+#define SAI_REDIS_RECORD_API_COUNT          (SAI_API_TUNNEL + 1)
+
+// distinguishes buffers of recorders created by later initialize
+static std::atomic<uint64_t> g_recorderGeneration(0);
+
+// wrapper calls which pinned g_recorder
+static std::atomic<uint64_t> g_recorderReferences(0);
+
+RedisRecorder::Buffer::Buffer(
+        _In_ uint32_t index):
+    thread(index),
+    data(SAI_REDIS_RECORD_BUFFER_SIZE),
+    tail(0),
+    records(0),
+    stalls(0),
+    head(0)
+{
+}
+
+bool RedisRecorder::Buffer::push(
+        _In_ const std::string &record)
+{
+    uint32_t length = (uint32_t)record.size();
+
+    uint64_t size = sizeof(length) + length;
+
+    if (size > data.size())
+    {
+        return false;
+    }
+
+    uint64_t t = tail.load(std::memory_order_relaxed);
+
+    if (data.size() - (t - head.load(std::memory_order_acquire)) < size)
+    {
+        stalls.fetch_add(1, std::memory_order_relaxed);
+
+        // record is never dropped, stream must be complete for replay
+        while (data.size() - (t - head.load(std::memory_order_acquire)) < size)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    const char *parts[] = { (const char*)&length, record.data() };
+    size_t sizes[] = { sizeof(length), length };
+
+    uint64_t mask = data.size() - 1;
+
+    for (int i = 0; i < 2; i++)
+    {
+        size_t offset = (size_t)(t & mask);
+        size_t first = std::min(sizes[i], data.size() - offset);
+
+        memcpy(&data[offset], parts[i], first);
+        memcpy(&data[0], parts[i] + first, sizes[i] - first);
+
+        t += sizes[i];
+    }
+
+    tail.store(t, std::memory_order_release);
+
+    records.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+RedisRecorder::RedisRecorder():
+    m_generation(++g_recorderGeneration),
+    m_start(0),
+    m_file(NULL),
+    m_running(false),
+    m_bytes(0),
+    m_unrecorded(0)
+{
+}
+
+RedisRecorder::~RedisRecorder()
+{
+    stop();
+}
+
+uint64_t RedisRecorder::now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+sai_status_t RedisRecorder::start(
+        _In_ const std::string &path)
+{
+    m_file = fopen(path.c_str(), "wb");
+
+    if (m_file == NULL)
+    {
+        REDIS_LOG_ERR("Failed to open record file %s", path.c_str());
+        return SAI_STATUS_FAILURE;
+    }
+
+    sai_redis_record_header_t header;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SAI_REDIS_RECORD_MAGIC, sizeof(header.magic));
+    header.version = SAI_REDIS_RECORD_VERSION;
+
+    if (fwrite(&header, sizeof(header), 1, m_file) != 1)
+    {
+        REDIS_LOG_ERR("Failed to write record file %s", path.c_str());
+
+        fclose(m_file);
+        m_file = NULL;
+
+        return SAI_STATUS_FAILURE;
+    }
+
+    m_start = now();
+
+    m_running = true;
+
+    m_thread = std::thread(&RedisRecorder::writerThread, this);
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void RedisRecorder::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+
+        if (!m_running)
+        {
+            return;
+        }
+
+        m_running = false;
+    }
+
+    m_writerCv.notify_one();
+
+    m_thread.join();
+
+    // records of calls which returned before stop
+    drain();
+
+    if (fclose(m_file) != 0)
+    {
+        REDIS_LOG_ERR("Failed to close record file");
+    }
+
+    m_file = NULL;
+}
+
+void RedisRecorder::getStats(
+        _Out_ sai_redis_recorder_stats_t &stats) const
+{
+    stats.records = 0;
+    stats.stalls = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+        stats.threads = m_buffers.size();
+
+        for (const auto &buffer: m_buffers)
+        {
+            stats.records += buffer->records.load(std::memory_order_relaxed);
+            stats.stalls += buffer->stalls.load(std::memory_order_relaxed);
+        }
+    }
+
+    stats.bytes = m_bytes.load(std::memory_order_relaxed);
+    stats.unrecorded = m_unrecorded.load(std::memory_order_relaxed);
+}
+
+RedisRecorder::Buffer* RedisRecorder::threadBuffer()
+{
+    static thread_local uint64_t generation = 0;
+    static thread_local Buffer *buffer = NULL;
+
+    if (generation == m_generation)
+    {
+        return buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+    // buffer is kept after thread exits, it is drained on stop
+    m_buffers.emplace_back(new Buffer((uint32_t)m_buffers.size()));
+
+    buffer = m_buffers.back().get();
+    generation = m_generation;
+
+    return buffer;
+}
+
+static void redis_record_put_string(
+        _Inout_ std::string &s,
+        _In_ const std::string &str)
+{
+    sai_binary_serialize_varint(str.size(), s);
+
+    s += str;
+}
+
+void RedisRecorder::record(
+        _In_ uint64_t start,
+        _In_ uint64_t end,
+        _In_ sai_api_t api,
+        _In_ uint32_t method,
+        _In_ sai_object_type_t object_type,
+        _In_ sai_common_api_t common_api,
+        _In_ sai_status_t status,
+        _In_ const std::string &key,
+        _In_ uint32_t attr_count,
+        _In_ const sai_attribute_t *attr_list)
+{
+    Buffer *buffer = threadBuffer();
+
+    static thread_local std::string body;
+    static thread_local std::string attrs;
+    static thread_local std::string str;
+
+    // attributes are serialized first, so count is known
+
+    uint32_t count = 0;
+
+    attrs.clear();
+
+    for (uint32_t i = 0; attr_list != NULL && i < attr_count; ++i)
+    {
+        const sai_attribute_t &attr = attr_list[i];
+
+        str.clear();
+        sai_serialize_attr_id(SAI_SERIALIZATION_FORMAT_BINARY, attr, str);
+
+        size_t offset = attrs.size();
+
+        redis_record_put_string(attrs, str);
+
+        str.clear();
+
+        if (common_api != SAI_COMMON_API_GET)
+        {
+            sai_attr_serialization_type_t type;
+
+            if (sai_get_serialization_type(object_type, attr.id, type) != SAI_STATUS_SUCCESS ||
+                    sai_serialize_attr_value(SAI_SERIALIZATION_FORMAT_BINARY, type, attr, str) != SAI_STATUS_SUCCESS)
+            {
+                // replayed call won't have this attribute
+                m_unrecorded.fetch_add(1, std::memory_order_relaxed);
+
+                attrs.resize(offset);
+                continue;
+            }
+        }
+
+        redis_record_put_string(attrs, str);
+
+        count++;
+    }
+
+    body.clear();
+
+    sai_binary_serialize_varint(start - m_start, body);
+    sai_binary_serialize_varint(end - start, body);
+    sai_binary_serialize_varint(buffer->thread, body);
+    sai_binary_serialize_varint(api, body);
+    sai_binary_serialize_varint(method, body);
+    sai_binary_serialize_varint(object_type, body);
+    sai_binary_serialize_varint(common_api, body);
+    sai_binary_serialize_varint((uint32_t)status, body);
+
+    redis_record_put_string(body, key);
+
+    sai_binary_serialize_varint(count, body);
+
+    body += attrs;
+
+    if (!buffer->push(body))
+    {
+        REDIS_LOG_ERR("Record of %u bytes does not fit in thread buffer", (uint32_t)body.size());
+
+        m_unrecorded.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RedisRecorder::writerThread()
+{
+    std::unique_lock<std::mutex> lock(m_writerMutex);
+
+    while (m_running)
+    {
+        m_writerCv.wait_for(lock, std::chrono::milliseconds(SAI_REDIS_RECORD_DRAIN_INTERVAL_MS));
+
+        lock.unlock();
+
+        drain();
+
+        lock.lock();
+    }
+}
+
+void RedisRecorder::drain()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+        m_drainBuffers.clear();
+
+        for (const auto &buffer: m_buffers)
+        {
+            m_drainBuffers.push_back(buffer.get());
+        }
+    }
+
+    for (Buffer *buffer: m_drainBuffers)
+    {
+        uint64_t h = buffer->head.load(std::memory_order_relaxed);
+        uint64_t t = buffer->tail.load(std::memory_order_acquire);
+
+        if (h == t)
+        {
+            continue;
+        }
+
+        // only whole records are published, so file gets whole records
+
+        size_t size = buffer->data.size();
+        size_t offset = (size_t)(h & (size - 1));
+        size_t length = (size_t)(t - h);
+        size_t first = std::min(length, size - offset);
+
+        if (fwrite(&buffer->data[offset], 1, first, m_file) != first ||
+                fwrite(&buffer->data[0], 1, length - first, m_file) != length - first)
+        {
+            REDIS_LOG_ERR("Failed to write record file");
+        }
+
+        buffer->head.store(t, std::memory_order_release);
+
+        m_bytes.fetch_add(length, std::memory_order_relaxed);
+    }
+}
+
+// method tables
+
+typedef void (*redis_record_fn_t)();
+
+// tables returned by sai_api_query before wrapping
+static const redis_record_fn_t *g_recordOriginals[SAI_REDIS_RECORD_API_COUNT];
+
+template<typename F>
+static F redis_record_original(
+        _In_ sai_api_t api,
+        _In_ uint32_t method)
+{
+    return (F)g_recordOriginals[api][method];
+}
+
+template<typename T>
+static const std::string& redis_record_key(
+        _In_ const T &id)
+{
+    static thread_local std::string key;
+
+    key.clear();
+    sai_serialize_primitive(SAI_SERIALIZATION_FORMAT_BINARY, id, key);
+
+    return key;
+}
+
+static const std::string& redis_record_no_key()
+{
+    static const std::string key;
+
+    return key;
+}
+
+template<sai_object_type_t OT>
+struct RedisRecordEntry;
+
+template<>
+struct RedisRecordEntry<SAI_OBJECT_TYPE_FDB>
+{
+    typedef sai_fdb_entry_t type;
+};
+
+template<>
+struct RedisRecordEntry<SAI_OBJECT_TYPE_NEIGHBOR>
+{
+    typedef sai_neighbor_entry_t type;
+};
+
+template<>
+struct RedisRecordEntry<SAI_OBJECT_TYPE_ROUTE>
+{
+    typedef sai_unicast_route_entry_t type;
+};
+
+RedisRecorderReference::RedisRecorderReference():
+    m_recorder(g_recorder.load(std::memory_order_relaxed))
+{
+    if (m_recorder == NULL)
+    {
+        // not recording, calls don't touch shared counter
+        return;
+    }
+
+    // counter is raised before recorder is loaded again, so replace
+    // which cleared g_recorder before this load sees it raised
+
+    g_recorderReferences.fetch_add(1);
+
+    m_recorder = g_recorder.load();
+
+    if (m_recorder == NULL)
+    {
+        g_recorderReferences.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+RedisRecorderReference::~RedisRecorderReference()
+{
+    if (m_recorder != NULL)
+    {
+        g_recorderReferences.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void redis_recorder_replace(
+        _In_ RedisRecorder *recorder)
+{
+    RedisRecorder *previous = g_recorder.exchange(recorder);
+
+    if (previous == NULL)
+    {
+        return;
+    }
+
+    // calls are short, recorder blocks them only while its buffer is
+    // full, and writer keeps draining until stop
+    while (g_recorderReferences.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+
+    delete previous;
+}
+
+/*
+ * Wrappers pin recorder for whole call, so call which started before
+ * uninitialize is recorded by recorder it started with, which is not
+ * deleted until call returns. Tables stay wrapped after recording
+ * stops, calls are then only forwarded.
+ */
+
+template<sai_api_t A, uint32_t M, sai_object_type_t OT>
+static sai_status_t redis_record_create_oid(
+        _Out_ sai_object_id_t *object_id,
+        _In_ uint32_t attr_count,
+        _In_ const sai_attribute_t *attr_list)
+{
+    typedef sai_status_t (*fn_t)(sai_object_id_t*, uint32_t, const sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(A, M)(object_id, attr_count, attr_list);
+
+    if (recorder != NULL)
+    {
+        // replay maps recorded id to id it gets
+        sai_object_id_t id = (status == SAI_STATUS_SUCCESS && object_id != NULL) ? *object_id : SAI_NULL_OBJECT_ID;
+
+        recorder->record(start, RedisRecorder::now(), A, M, OT, SAI_COMMON_API_CREATE, status, redis_record_key(id), attr_count, attr_list);
+    }
+
+    return status;
+}
+
+template<sai_api_t A, uint32_t M, sai_object_type_t OT>
+static sai_status_t redis_record_remove_oid(
+        _In_ sai_object_id_t object_id)
+{
+    typedef sai_status_t (*fn_t)(sai_object_id_t);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(A, M)(object_id);
+
+    if (recorder != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), A, M, OT, SAI_COMMON_API_REMOVE, status, redis_record_key(object_id), 0, NULL);
+    }
+
+    return status;
+}
+
+template<sai_api_t A, uint32_t M, sai_object_type_t OT>
+static sai_status_t redis_record_set_oid(
+        _In_ sai_object_id_t object_id,
+        _In_ const sai_attribute_t *attr)
+{
+    typedef sai_status_t (*fn_t)(sai_object_id_t, const sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(A, M)(object_id, attr);
+
+    if (recorder != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), A, M, OT, SAI_COMMON_API_SET, status, redis_record_key(object_id), 1, attr);
+    }
+
+    return status;
+}
+
+template<sai_api_t A, uint32_t M, sai_object_type_t OT>
+static sai_status_t redis_record_get_oid(
+        _In_ sai_object_id_t object_id,
+        _In_ uint32_t attr_count,
+        _Inout_ sai_attribute_t *attr_list)
+{
+    typedef sai_status_t (*fn_t)(sai_object_id_t, uint32_t, sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(A, M)(object_id, attr_count, attr_list);
+
+    if (recorder != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), A, M, OT, SAI_COMMON_API_GET, status, redis_record_key(object_id), attr_count, attr_list);
+    }
+
+    return status;
+}
+
+template<sai_api_t A, uint32_t M, sai_object_type_t OT>
+static sai_status_t redis_record_create_entry(
+        _In_ const typename RedisRecordEntry<OT>::type *entry,
+        _In_ uint32_t attr_count,
+        _In_ const sai_attribute_t *attr_list)
+{
+    typedef sai_status_t (*fn_t)(const typename RedisRecordEntry<OT>::type*, uint32_t, const sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(A, M)(entry, attr_count, attr_list);
+
+    if (recorder != NULL && entry != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), A, M, OT, SAI_COMMON_API_CREATE, status, redis_record_key(*entry), attr_count, attr_list);
+    }
+
+    return status;
+}
+
+template<sai_api_t A, uint32_t M, sai_object_type_t OT>
+static sai_status_t redis_record_remove_entry(
+        _In_ const typename RedisRecordEntry<OT>::type *entry)
+{
+    typedef sai_status_t (*fn_t)(const typename RedisRecordEntry<OT>::type*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(A, M)(entry);
+
+    if (recorder != NULL && entry != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), A, M, OT, SAI_COMMON_API_REMOVE, status, redis_record_key(*entry), 0, NULL);
+    }
+
+    return status;
+}
+
+template<sai_api_t A, uint32_t M, sai_object_type_t OT>
+static sai_status_t redis_record_set_entry(
+        _In_ const typename RedisRecordEntry<OT>::type *entry,
+        _In_ const sai_attribute_t *attr)
+{
+    typedef sai_status_t (*fn_t)(const typename RedisRecordEntry<OT>::type*, const sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(A, M)(entry, attr);
+
+    if (recorder != NULL && entry != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), A, M, OT, SAI_COMMON_API_SET, status, redis_record_key(*entry), 1, attr);
+    }
+
+    return status;
+}
+
+template<sai_api_t A, uint32_t M, sai_object_type_t OT>
+static sai_status_t redis_record_get_entry(
+        _In_ const typename RedisRecordEntry<OT>::type *entry,
+        _In_ uint32_t attr_count,
+        _Inout_ sai_attribute_t *attr_list)
+{
+    typedef sai_status_t (*fn_t)(const typename RedisRecordEntry<OT>::type*, uint32_t, sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(A, M)(entry, attr_count, attr_list);
+
+    if (recorder != NULL && entry != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), A, M, OT, SAI_COMMON_API_GET, status, redis_record_key(*entry), attr_count, attr_list);
+    }
+
+    return status;
+}
+
+template<uint32_t M>
+static sai_status_t redis_record_create_vlan(
+        _In_ sai_vlan_id_t vlan_id)
+{
+    typedef sai_status_t (*fn_t)(sai_vlan_id_t);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(SAI_API_VLAN, M)(vlan_id);
+
+    if (recorder != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), SAI_API_VLAN, M, SAI_OBJECT_TYPE_VLAN, SAI_COMMON_API_CREATE, status, redis_record_key(vlan_id), 0, NULL);
+    }
+
+    return status;
+}
+
+template<uint32_t M>
+static sai_status_t redis_record_remove_vlan(
+        _In_ sai_vlan_id_t vlan_id)
+{
+    typedef sai_status_t (*fn_t)(sai_vlan_id_t);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(SAI_API_VLAN, M)(vlan_id);
+
+    if (recorder != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), SAI_API_VLAN, M, SAI_OBJECT_TYPE_VLAN, SAI_COMMON_API_REMOVE, status, redis_record_key(vlan_id), 0, NULL);
+    }
+
+    return status;
+}
+
+template<uint32_t M>
+static sai_status_t redis_record_set_vlan(
+        _In_ sai_vlan_id_t vlan_id,
+        _In_ const sai_attribute_t *attr)
+{
+    typedef sai_status_t (*fn_t)(sai_vlan_id_t, const sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(SAI_API_VLAN, M)(vlan_id, attr);
+
+    if (recorder != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), SAI_API_VLAN, M, SAI_OBJECT_TYPE_VLAN, SAI_COMMON_API_SET, status, redis_record_key(vlan_id), 1, attr);
+    }
+
+    return status;
+}
+
+template<uint32_t M>
+static sai_status_t redis_record_get_vlan(
+        _In_ sai_vlan_id_t vlan_id,
+        _In_ uint32_t attr_count,
+        _Inout_ sai_attribute_t *attr_list)
+{
+    typedef sai_status_t (*fn_t)(sai_vlan_id_t, uint32_t, sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(SAI_API_VLAN, M)(vlan_id, attr_count, attr_list);
+
+    if (recorder != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), SAI_API_VLAN, M, SAI_OBJECT_TYPE_VLAN, SAI_COMMON_API_GET, status, redis_record_key(vlan_id), attr_count, attr_list);
+    }
+
+    return status;
+}
+
+template<uint32_t M>
+static sai_status_t redis_record_set_switch(
+        _In_ const sai_attribute_t *attr)
+{
+    typedef sai_status_t (*fn_t)(const sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(SAI_API_SWITCH, M)(attr);
+
+    if (recorder != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), SAI_API_SWITCH, M, SAI_OBJECT_TYPE_SWITCH, SAI_COMMON_API_SET, status, redis_record_no_key(), 1, attr);
+    }
+
+    return status;
+}
+
+template<uint32_t M>
+static sai_status_t redis_record_get_switch(
+        _In_ sai_uint32_t attr_count,
+        _Inout_ sai_attribute_t *attr_list)
+{
+    typedef sai_status_t (*fn_t)(sai_uint32_t, sai_attribute_t*);
+
+    RedisRecorderReference reference;
+
+    RedisRecorder *recorder = reference.get();
+
+    uint64_t start = recorder ? RedisRecorder::now() : 0;
+
+    sai_status_t status = redis_record_original<fn_t>(SAI_API_SWITCH, M)(attr_count, attr_list);
+
+    if (recorder != NULL)
+    {
+        recorder->record(start, RedisRecorder::now(), SAI_API_SWITCH, M, SAI_OBJECT_TYPE_SWITCH, SAI_COMMON_API_GET, status, redis_record_no_key(), attr_count, attr_list);
+    }
+
+    return status;
+}
+
+typedef struct _redis_record_method_t
+{
+    sai_api_t api;
+
+    uint32_t method;
+
+    redis_record_fn_t fn;
+
+} redis_record_method_t;
+
+#define REDIS_RECORD_OID(api, ot, create, remove, set, get) \
+    { api, create, (redis_record_fn_t)&redis_record_create_oid<api, create, ot> }, \
+    { api, remove, (redis_record_fn_t)&redis_record_remove_oid<api, remove, ot> }, \
+    { api, set, (redis_record_fn_t)&redis_record_set_oid<api, set, ot> }, \
+    { api, get, (redis_record_fn_t)&redis_record_get_oid<api, get, ot> }
+
+#define REDIS_RECORD_OID_SET_GET(api, ot, set, get) \
+    { api, set, (redis_record_fn_t)&redis_record_set_oid<api, set, ot> }, \
+    { api, get, (redis_record_fn_t)&redis_record_get_oid<api, get, ot> }
+
+#define REDIS_RECORD_ENTRY(api, ot) \
+    { api, 0, (redis_record_fn_t)&redis_record_create_entry<api, 0, ot> }, \
+    { api, 1, (redis_record_fn_t)&redis_record_remove_entry<api, 1, ot> }, \
+    { api, 2, (redis_record_fn_t)&redis_record_set_entry<api, 2, ot> }, \
+    { api, 3, (redis_record_fn_t)&redis_record_get_entry<api, 3, ot> }
+
+/*
+ * Recorded methods by index in method table, other methods (stats,
+ * flush, packet send and receive, group membership) are forwarded
+ * without record.
+ */
+static const redis_record_method_t g_recordMethods[] = {
+    REDIS_RECORD_OID(SAI_API_ACL, SAI_OBJECT_TYPE_ACL_TABLE, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_ACL, SAI_OBJECT_TYPE_ACL_ENTRY, 4, 5, 6, 7),
+    REDIS_RECORD_OID(SAI_API_ACL, SAI_OBJECT_TYPE_ACL_COUNTER, 8, 9, 10, 11),
+    REDIS_RECORD_OID(SAI_API_BUFFERS, SAI_OBJECT_TYPE_BUFFER_POOL, 0, 1, 2, 3),
+    REDIS_RECORD_OID_SET_GET(SAI_API_BUFFERS, SAI_OBJECT_TYPE_PRIORITY_GROUP, 5, 6),
+    REDIS_RECORD_OID(SAI_API_BUFFERS, SAI_OBJECT_TYPE_BUFFER_PROFILE, 9, 10, 11, 12),
+    REDIS_RECORD_ENTRY(SAI_API_FDB, SAI_OBJECT_TYPE_FDB),
+    REDIS_RECORD_OID(SAI_API_HASH, SAI_OBJECT_TYPE_HASH, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_HOST_INTERFACE, SAI_OBJECT_TYPE_HOST_INTERFACE, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_HOST_INTERFACE, SAI_OBJECT_TYPE_TRAP_GROUP, 4, 5, 6, 7),
+    REDIS_RECORD_OID(SAI_API_LAG, SAI_OBJECT_TYPE_LAG, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_LAG, SAI_OBJECT_TYPE_LAG_MEMBER, 4, 5, 6, 7),
+    REDIS_RECORD_OID(SAI_API_MIRROR, SAI_OBJECT_TYPE_MIRROR, 0, 1, 2, 3),
+    REDIS_RECORD_ENTRY(SAI_API_NEIGHBOR, SAI_OBJECT_TYPE_NEIGHBOR),
+    REDIS_RECORD_OID(SAI_API_NEXT_HOP, SAI_OBJECT_TYPE_NEXT_HOP, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_NEXT_HOP_GROUP, SAI_OBJECT_TYPE_NEXT_HOP_GROUP, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_POLICER, SAI_OBJECT_TYPE_POLICER, 0, 1, 2, 3),
+    REDIS_RECORD_OID_SET_GET(SAI_API_PORT, SAI_OBJECT_TYPE_PORT, 0, 1),
+    REDIS_RECORD_OID(SAI_API_QOS_MAPS, SAI_OBJECT_TYPE_QOS_MAPS, 0, 1, 2, 3),
+    REDIS_RECORD_OID_SET_GET(SAI_API_QUEUE, SAI_OBJECT_TYPE_QUEUE, 0, 1),
+    REDIS_RECORD_ENTRY(SAI_API_ROUTE, SAI_OBJECT_TYPE_ROUTE),
+    REDIS_RECORD_OID(SAI_API_VIRTUAL_ROUTER, SAI_OBJECT_TYPE_VIRTUAL_ROUTER, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_ROUTER_INTERFACE, SAI_OBJECT_TYPE_ROUTER_INTERFACE, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_SAMPLEPACKET, SAI_OBJECT_TYPE_SAMPLEPACKET, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_SCHEDULER, SAI_OBJECT_TYPE_SCHEDULER, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_SCHEDULER_GROUP, SAI_OBJECT_TYPE_SCHEDULER_GROUP, 0, 1, 2, 3),
+    { SAI_API_SWITCH, 4, (redis_record_fn_t)&redis_record_set_switch<4> },
+    { SAI_API_SWITCH, 5, (redis_record_fn_t)&redis_record_get_switch<5> },
+    REDIS_RECORD_OID(SAI_API_UDF, SAI_OBJECT_TYPE_UDF, 0, 1, 2, 3),
+    REDIS_RECORD_OID(SAI_API_UDF, SAI_OBJECT_TYPE_UDF_MATCH, 4, 5, 6, 7),
+    REDIS_RECORD_OID(SAI_API_UDF, SAI_OBJECT_TYPE_UDF_GROUP, 8, 9, 10, 11),
+    { SAI_API_VLAN, 0, (redis_record_fn_t)&redis_record_create_vlan<0> },
+    { SAI_API_VLAN, 1, (redis_record_fn_t)&redis_record_remove_vlan<1> },
+    { SAI_API_VLAN, 2, (redis_record_fn_t)&redis_record_set_vlan<2> },
+    { SAI_API_VLAN, 3, (redis_record_fn_t)&redis_record_get_vlan<3> },
+    REDIS_RECORD_OID(SAI_API_WRED, SAI_OBJECT_TYPE_WRED, 0, 1, 2, 3),
+};
+
+static size_t redis_record_method_count(
+        _In_ sai_api_t api)
+{
+    switch (api)
+    {
+        case SAI_API_ACL:               return sizeof(sai_acl_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_BUFFERS:           return sizeof(sai_buffer_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_FDB:               return sizeof(sai_fdb_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_HASH:              return sizeof(sai_hash_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_HOST_INTERFACE:    return sizeof(sai_hostif_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_LAG:               return sizeof(sai_lag_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_MIRROR:            return sizeof(sai_mirror_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_NEIGHBOR:          return sizeof(sai_neighbor_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_NEXT_HOP:          return sizeof(sai_next_hop_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_NEXT_HOP_GROUP:    return sizeof(sai_next_hop_group_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_POLICER:           return sizeof(sai_policer_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_PORT:              return sizeof(sai_port_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_QOS_MAPS:          return sizeof(sai_qos_map_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_QUEUE:             return sizeof(sai_queue_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_ROUTE:             return sizeof(sai_route_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_VIRTUAL_ROUTER:    return sizeof(sai_virtual_router_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_ROUTER_INTERFACE:  return sizeof(sai_router_interface_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_SAMPLEPACKET:      return sizeof(sai_samplepacket_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_SCHEDULER:         return sizeof(sai_scheduler_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_SCHEDULER_GROUP:   return sizeof(sai_scheduler_group_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_SWITCH:            return sizeof(sai_switch_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_UDF:               return sizeof(sai_udf_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_VLAN:              return sizeof(sai_vlan_api_t) / sizeof(redis_record_fn_t);
+        case SAI_API_WRED:              return sizeof(sai_wred_api_t) / sizeof(redis_record_fn_t);
+
+        default:
+            return 0;
+    }
+}
+
+void* redis_recorder_wrap_api(
+        _In_ sai_api_t api,
+        _In_ void *table)
+{
+    static std::mutex mutex;
+
+    // never freed, callers keep tables for process lifetime
+    static redis_record_fn_t *wrapped[SAI_REDIS_RECORD_API_COUNT];
+
+    size_t count = redis_record_method_count(api);
+
+    if (count == 0 || table == NULL)
+    {
+        return table;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (wrapped[api] == NULL)
+    {
+        g_recordOriginals[api] = (const redis_record_fn_t*)table;
+
+        redis_record_fn_t *methods = new redis_record_fn_t[count];
+
+        memcpy(methods, table, count * sizeof(redis_record_fn_t));
+
+        for (const auto &method: g_recordMethods)
+        {
+            if (method.api == api)
+            {
+                methods[method.method] = method.fn;
+            }
+        }
+
+        wrapped[api] = methods;
+    }
+
+    return wrapped[api];
+}
@@ -1,3 +1,5 @@
+#define REDIS_LOG_API SAI_API_ROUTE
+
 #include "sai_redis.h"
 
 /**
@@ -121,6 +123,148 @@ sai_status_t  redis_get_route_attribute(
 }
 
 
+/**
+ * Routine Description:
+ *    @brief Bulk create route entries
+ *
+ * Arguments:
+ *    @param[in] count - number of entries
+ *    @param[in] unicast_route_entries - array of entries
+ *    @param[in] attr_counts - number of attributes of each entry
+ *    @param[in] attr_lists - attributes of each entry
+ *    @param[out] statuses - status of each entry
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS when all entries succeeded
+ *            SAI_STATUS_FAILURE when any entry failed, see statuses
+ *
+ * Note: IP prefix/mask expected in Network Byte Order.
+ */
+sai_status_t redis_bulk_create_routes(
+    _In_ uint32_t count,
+    _In_ const sai_unicast_route_entry_t *unicast_route_entries,
+    _In_ const uint32_t *attr_counts,
+    _In_ const sai_attribute_t **attr_lists,
+    _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_generic_create(
+            SAI_OBJECT_TYPE_ROUTE,
+            count,
+            unicast_route_entries,
+            attr_counts,
+            attr_lists,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ * Routine Description:
+ *    @brief Bulk remove route entries
+ *
+ * Arguments:
+ *    @param[in] count - number of entries
+ *    @param[in] unicast_route_entries - array of entries
+ *    @param[out] statuses - status of each entry
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS when all entries succeeded
+ *            SAI_STATUS_FAILURE when any entry failed, see statuses
+ */
+sai_status_t redis_bulk_remove_routes(
+    _In_ uint32_t count,
+    _In_ const sai_unicast_route_entry_t *unicast_route_entries,
+    _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_generic_remove(
+            SAI_OBJECT_TYPE_ROUTE,
+            count,
+            unicast_route_entries,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ * Routine Description:
+ *    @brief Bulk set attribute of route entries
+ *
+ * Arguments:
+ *    @param[in] count - number of entries
+ *    @param[in] unicast_route_entries - array of entries
+ *    @param[in] attr_list - attribute to set, one for each entry
+ *    @param[out] statuses - status of each entry
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS when all entries succeeded
+ *            SAI_STATUS_FAILURE when any entry failed, see statuses
+ */
+sai_status_t redis_bulk_set_routes(
+    _In_ uint32_t count,
+    _In_ const sai_unicast_route_entry_t *unicast_route_entries,
+    _In_ const sai_attribute_t *attr_list,
+    _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_generic_set(
+            SAI_OBJECT_TYPE_ROUTE,
+            count,
+            unicast_route_entries,
+            attr_list,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
+/**
+ * Routine Description:
+ *    @brief Bulk get attributes of route entries, reads of all entries
+ *    are pipelined
+ *
+ * Arguments:
+ *    @param[in] count - number of entries
+ *    @param[in] unicast_route_entries - array of entries
+ *    @param[in] attr_counts - number of attributes of each entry
+ *    @param[inout] attr_lists - attributes of each entry
+ *    @param[out] statuses - status of each entry
+ *
+ * Return Values:
+ *    @return SAI_STATUS_SUCCESS when all entries succeeded
+ *            SAI_STATUS_FAILURE when any entry failed, see statuses
+ */
+sai_status_t redis_bulk_get_routes(
+    _In_ uint32_t count,
+    _In_ const sai_unicast_route_entry_t *unicast_route_entries,
+    _In_ const uint32_t *attr_counts,
+    _Inout_ sai_attribute_t **attr_lists,
+    _Out_ sai_status_t *statuses)
+{
+    REDIS_LOG_ENTER();
+
+    sai_status_t status = redis_bulk_generic_get(
+            SAI_OBJECT_TYPE_ROUTE,
+            count,
+            unicast_route_entries,
+            attr_counts,
+            attr_lists,
+            statuses);
+
+    REDIS_LOG_EXIT();
+
+    return status;
+}
+
 /**
  *  @brief Router entry methods table retrieved with sai_api_query()
  */
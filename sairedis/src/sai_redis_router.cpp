@@ -1,3 +1,5 @@
+#define REDIS_LOG_API SAI_API_VIRTUAL_ROUTER
+
 #include "sai_redis.h"
 
 /**
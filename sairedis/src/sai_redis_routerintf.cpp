@@ -1,3 +1,5 @@
+#define REDIS_LOG_API SAI_API_ROUTER_INTERFACE
+
 #include "sai_redis.h"
 
 /**
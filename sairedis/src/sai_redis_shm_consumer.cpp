@@ -0,0 +1,68 @@
+#include "sai_redis_shm_consumer.h"
+
+#include "sswcommon/json.h"
+
+bool redis_transport_decode(
+        _In_ const char *key,
+        _In_ size_t key_size,
+        _In_ const char *value,
+        _In_ size_t value_size,
+        _In_ const char *op,
+        _In_ size_t op_size,
+        _Out_ ssw::KeyOpFieldsValuesTuple &kco)
+{
+    kfvKey(kco).assign(key, key_size);
+    kfvFieldsValues(kco).clear();
+
+    if (op_size == 0 || (op[0] != 'S' && op[0] != 'D'))
+    {
+        kfvOp(kco).clear();
+        return false;
+    }
+
+    kfvOp(kco).assign(op + 1, op_size - 1);
+
+    if (op[0] == 'S')
+    {
+        ssw::JSon::readJson(std::string(value, value_size), kfvFieldsValues(kco));
+    }
+
+    return true;
+}
+
+ShmConsumerTable::ShmConsumerTable()
+{
+}
+
+sai_status_t ShmConsumerTable::open(
+        _In_ const std::string &name,
+        _In_ uint64_t size)
+{
+    return m_ring.open(name, size);
+}
+
+bool ShmConsumerTable::pop(
+        _Out_ ssw::KeyOpFieldsValuesTuple &kco)
+{
+    sai_serialized_view_t parts[SAI_REDIS_SHM_PARTS];
+
+    if (!m_ring.pop(m_record) || !ShmRing::parse(m_record, SAI_REDIS_SHM_PARTS, parts))
+    {
+        kfvKey(kco).clear();
+        kfvOp(kco).clear();
+        kfvFieldsValues(kco).clear();
+
+        return false;
+    }
+
+    return redis_transport_decode(
+            parts[0].data, parts[0].size,
+            parts[1].data, parts[1].size,
+            parts[2].data, parts[2].size,
+            kco);
+}
+
+bool ShmConsumerTable::empty() const
+{
+    return m_ring.empty();
+}
@@ -0,0 +1,347 @@
+#include "sai_redis_shm_ring.h"
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <chrono>
+#include <thread>
+
+#define SAI_REDIS_SHM_RING_MIN_CAPACITY     4096
+
+// time other process may take between creating and initializing segment
+#define SAI_REDIS_SHM_RING_OPEN_TIMEOUT_MS  1000
+
+static_assert(sizeof(sai_redis_shm_ring_header_t) % SAI_REDIS_SHM_RING_ALIGN == 0, "data must start aligned");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "record word must be plain 32 bit");
+
+static inline uint64_t shm_ring_align(
+        _In_ uint64_t size)
+{
+    return (size + SAI_REDIS_SHM_RING_ALIGN - 1) & ~(uint64_t)(SAI_REDIS_SHM_RING_ALIGN - 1);
+}
+
+ShmRing::ShmRing():
+    m_header(NULL),
+    m_data(NULL),
+    m_capacity(0),
+    m_mappedSize(0)
+{
+}
+
+ShmRing::~ShmRing()
+{
+    close();
+}
+
+sai_status_t ShmRing::open(
+        _In_ const std::string &name,
+        _In_ uint64_t size)
+{
+    close();
+
+    uint64_t capacity = SAI_REDIS_SHM_RING_MIN_CAPACITY;
+
+    while (capacity < size)
+    {
+        capacity <<= 1;
+    }
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (fd >= 0)
+    {
+        size_t mapped_size = sizeof(sai_redis_shm_ring_header_t) + capacity;
+
+        // new segment reads 0, so all records are free
+        if (ftruncate(fd, (off_t)mapped_size) != 0)
+        {
+            ::close(fd);
+            shm_unlink(name.c_str());
+
+            return SAI_STATUS_FAILURE;
+        }
+
+        void *addr = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        ::close(fd);
+
+        if (addr == MAP_FAILED)
+        {
+            shm_unlink(name.c_str());
+
+            return SAI_STATUS_FAILURE;
+        }
+
+        m_header = (sai_redis_shm_ring_header_t*)addr;
+
+        m_header->version = SAI_REDIS_SHM_RING_VERSION;
+        m_header->capacity = capacity;
+
+        // publishes initialized header to processes waiting in open
+        __atomic_store_n(&m_header->magic, SAI_REDIS_SHM_RING_MAGIC, __ATOMIC_RELEASE);
+
+        m_mappedSize = mapped_size;
+    }
+    else if (errno == EEXIST)
+    {
+        fd = shm_open(name.c_str(), O_RDWR, 0600);
+
+        if (fd < 0)
+        {
+            return SAI_STATUS_FAILURE;
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAI_REDIS_SHM_RING_OPEN_TIMEOUT_MS);
+
+        while (m_header == NULL && std::chrono::steady_clock::now() < deadline)
+        {
+            struct stat st;
+
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size > sizeof(sai_redis_shm_ring_header_t))
+            {
+                void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+                if (addr != MAP_FAILED)
+                {
+                    sai_redis_shm_ring_header_t *header = (sai_redis_shm_ring_header_t*)addr;
+
+                    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == SAI_REDIS_SHM_RING_MAGIC)
+                    {
+                        m_header = header;
+                        m_mappedSize = (size_t)st.st_size;
+                        break;
+                    }
+
+                    munmap(addr, (size_t)st.st_size);
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        ::close(fd);
+
+        if (m_header == NULL)
+        {
+            return SAI_STATUS_FAILURE;
+        }
+
+        if (m_header->version != SAI_REDIS_SHM_RING_VERSION ||
+                m_mappedSize != sizeof(sai_redis_shm_ring_header_t) + m_header->capacity)
+        {
+            close();
+
+            return SAI_STATUS_FAILURE;
+        }
+    }
+    else
+    {
+        return SAI_STATUS_FAILURE;
+    }
+
+    m_data = (char*)(m_header + 1);
+    m_capacity = m_header->capacity;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void ShmRing::close()
+{
+    if (m_header != NULL)
+    {
+        munmap(m_header, m_mappedSize);
+    }
+
+    m_header = NULL;
+    m_data = NULL;
+    m_capacity = 0;
+    m_mappedSize = 0;
+}
+
+void ShmRing::unlink(
+        _In_ const std::string &name)
+{
+    shm_unlink(name.c_str());
+}
+
+static uint64_t shm_ring_record_length(
+        _In_ uint32_t count,
+        _In_ const sai_serialized_view_t *parts)
+{
+    uint64_t length = sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        length += sizeof(uint32_t) + parts[i].size;
+    }
+
+    return length;
+}
+
+bool ShmRing::fits(
+        _In_ uint32_t count,
+        _In_ const sai_serialized_view_t *parts) const
+{
+    uint64_t length = shm_ring_record_length(count, parts);
+
+    return length <= m_capacity / 2 && length < SAI_REDIS_SHM_RING_PAD;
+}
+
+bool ShmRing::push(
+        _In_ uint32_t count,
+        _In_ const sai_serialized_view_t *parts)
+{
+    if (!fits(count, parts))
+    {
+        return false;
+    }
+
+    uint64_t length = shm_ring_record_length(count, parts);
+
+    uint64_t size = shm_ring_align(length);
+
+    uint64_t t = m_header->tail.load(std::memory_order_relaxed);
+
+    uint64_t pad;
+
+    while (true)
+    {
+        uint64_t offset = t & (m_capacity - 1);
+
+        // record is never split, rest of data is skipped instead
+        pad = (m_capacity - offset < size) ? m_capacity - offset : 0;
+
+        uint64_t h = m_header->head.load(std::memory_order_acquire);
+
+        if (t + pad + size - h > m_capacity)
+        {
+            return false;
+        }
+
+        if (m_header->tail.compare_exchange_weak(t, t + pad + size, std::memory_order_relaxed, std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    if (pad != 0)
+    {
+        word(t).store(SAI_REDIS_SHM_RING_PAD | (uint32_t)pad, std::memory_order_release);
+
+        t += pad;
+    }
+
+    char *ptr = m_data + (t & (m_capacity - 1)) + sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t part_size = (uint32_t)parts[i].size;
+
+        memcpy(ptr, &part_size, sizeof(part_size));
+        memcpy(ptr + sizeof(part_size), parts[i].data, part_size);
+
+        ptr += sizeof(part_size) + part_size;
+    }
+
+    // commit, consumer reads record only after it sees word
+    word(t).store((uint32_t)length, std::memory_order_release);
+
+    return true;
+}
+
+bool ShmRing::pop(
+        _Out_ std::string &record)
+{
+    uint64_t h = m_header->head.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        uint32_t w = word(h).load(std::memory_order_acquire);
+
+        if (w == 0)
+        {
+            return false;
+        }
+
+        uint64_t size = shm_ring_align(w & ~SAI_REDIS_SHM_RING_PAD);
+
+        char *ptr = m_data + (h & (m_capacity - 1));
+
+        bool is_pad = (w & SAI_REDIS_SHM_RING_PAD) != 0;
+
+        if (!is_pad)
+        {
+            record.assign(ptr + sizeof(uint32_t), w - sizeof(uint32_t));
+        }
+
+        // zeroed before head moves, producers reserve only zeroed space
+        memset(ptr, 0, size);
+
+        h += size;
+
+        m_header->head.store(h, std::memory_order_release);
+
+        if (!is_pad)
+        {
+            return true;
+        }
+    }
+}
+
+bool ShmRing::parse(
+        _In_ const std::string &record,
+        _In_ uint32_t count,
+        _Out_ sai_serialized_view_t *parts)
+{
+    size_t offset = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t part_size;
+
+        if (record.size() - offset < sizeof(part_size))
+        {
+            return false;
+        }
+
+        memcpy(&part_size, record.data() + offset, sizeof(part_size));
+
+        offset += sizeof(part_size);
+
+        if (record.size() - offset < part_size)
+        {
+            return false;
+        }
+
+        parts[i].data = record.data() + offset;
+        parts[i].size = part_size;
+
+        offset += part_size;
+    }
+
+    return offset == record.size();
+}
+
+bool ShmRing::empty() const
+{
+    return m_header->head.load(std::memory_order_acquire) == m_header->tail.load(std::memory_order_acquire);
+}
+
+uint64_t ShmRing::capacity() const
+{
+    return m_capacity;
+}
+
+uint64_t ShmRing::reserved() const
+{
+    return m_header->tail.load(std::memory_order_acquire);
+}
+
+uint64_t ShmRing::consumed() const
+{
+    return m_header->head.load(std::memory_order_acquire);
+}
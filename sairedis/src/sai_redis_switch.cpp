@@ -1,5 +1,83 @@
+#define REDIS_LOG_API SAI_API_SWITCH
+
 #include "sai_redis.h"
 
+/**
+ * Routine Description:
+ *   @brief Starts notification consumer thread which calls switch
+ *   notifications, consumer of previous switch is stopped first
+ *
+ * Arguments:
+ *   @param[in] switch_notifications - switch notification table
+ *
+ * Return Values:
+ *   @return SAI_STATUS_SUCCESS on success
+ *           Failure status code on error
+ */
+sai_status_t redis_start_notification_consumer(
+    _In_ const sai_switch_notification_t *switch_notifications)
+{
+    REDIS_LOG_ENTER();
+
+    if (switch_notifications == NULL)
+    {
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    if (g_asicStatePipeline == NULL)
+    {
+        REDIS_LOG_ERR("SAI API not initialized before switch initialize");
+
+        REDIS_LOG_EXIT();
+        return SAI_STATUS_UNINITIALIZED;
+    }
+
+    uint64_t batch_size;
+
+    sai_status_t status = redis_profile_get_uint64(
+            SAI_REDIS_KEY_NOTIFICATION_BATCH_SIZE,
+            SAI_REDIS_DEFAULT_NOTIFICATION_BATCH_SIZE,
+            batch_size);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_EXIT();
+        return status;
+    }
+
+    redis_stop_notification_consumer();
+
+    g_dbNotifications = redis_create_db_connector();
+
+    g_notificationConsumer = new RedisNotificationConsumer(
+            g_dbNotifications,
+            NOTIFICATIONS_TABLE,
+            *switch_notifications,
+            batch_size);
+
+    REDIS_LOG_EXIT();
+
+    return SAI_STATUS_SUCCESS;
+}
+
+/**
+ * Routine Description:
+ *   @brief Stops notification consumer thread, no callback is called
+ *   after return
+ */
+void redis_stop_notification_consumer()
+{
+    REDIS_LOG_ENTER();
+
+    delete g_notificationConsumer;
+    g_notificationConsumer = NULL;
+
+    delete g_dbNotifications;
+    g_dbNotifications = NULL;
+
+    REDIS_LOG_EXIT();
+}
 
 /**
 * Routine Description:
@@ -24,9 +102,11 @@ sai_status_t redis_initialize_switch(
 {
     REDIS_LOG_ENTER();
 
+    sai_status_t status = redis_start_notification_consumer(switch_notifications);
+
     REDIS_LOG_EXIT();
 
-    return SAI_STATUS_NOT_IMPLEMENTED;
+    return status;
 }
 
 /**
@@ -47,6 +127,8 @@ void  redis_shutdown_switch(
 {
     REDIS_LOG_ENTER();
 
+    redis_stop_notification_consumer();
+
     REDIS_LOG_EXIT();
 }
 
@@ -71,9 +153,11 @@ sai_status_t redis_connect_switch(
 {
     REDIS_LOG_ENTER();
 
+    sai_status_t status = redis_start_notification_consumer(switch_notifications);
+
     REDIS_LOG_EXIT();
 
-    return SAI_STATUS_NOT_IMPLEMENTED;
+    return status;
 }
 
 /**
@@ -90,6 +174,8 @@ void  redis_disconnect_switch(
 {
     REDIS_LOG_ENTER();
 
+    redis_stop_notification_consumer();
+
     REDIS_LOG_EXIT();
 }
 
@@ -115,6 +201,14 @@ sai_status_t  redis_set_switch_attribute(
             (sai_object_id_t)0, // dummy sai_object_id_t for switch 
             attr);
 
+    if (status == SAI_STATUS_SUCCESS &&
+            attr->id == SAI_SWITCH_ATTR_COUNTER_REFRESH_INTERVAL &&
+            g_counterPoller != NULL)
+    {
+        // 0 means counters are read from redis on every get
+        g_counterPoller->setInterval((uint64_t)attr->value.u32 * 1000);
+    }
+
     REDIS_LOG_EXIT();
 
     return status;
@@ -0,0 +1,344 @@
+#include "sai_redis.h"
+#include "sai_redis_transport.h"
+
+#include <thread>
+
+// time caller waits for consumer to free space in full ring
+#define SAI_REDIS_SHM_FULL_TIMEOUT_MS   1000
+
+RedisShmTransport::RedisShmTransport():
+    m_errorNotification(NULL),
+    m_writeListener(NULL)
+{
+}
+
+RedisShmTransport::~RedisShmTransport()
+{
+    // operations stay in ring for consumer, segment is not removed
+}
+
+sai_status_t RedisShmTransport::open(
+        _In_ const std::string &name,
+        _In_ uint64_t size)
+{
+    sai_status_t status = m_ring.open(name, size);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        REDIS_LOG_ERR("Failed to open shared memory ring %s", name.c_str());
+        return status;
+    }
+
+    REDIS_LOG_NTC("ASIC_STATE transport is shared memory ring %s of %lu bytes", name.c_str(), m_ring.capacity());
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t RedisShmTransport::push(
+        _In_ const RedisPipeline::Operation &operation)
+{
+    const sai_serialized_view_t parts[SAI_REDIS_SHM_PARTS] = {
+        { operation.key.data(), operation.key.size() },
+        { operation.value.data(), operation.value.size() },
+        { operation.op.data(), operation.op.size() },
+    };
+
+    if (!m_ring.push(SAI_REDIS_SHM_PARTS, parts))
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAI_REDIS_SHM_FULL_TIMEOUT_MS);
+
+        while (!m_ring.push(SAI_REDIS_SHM_PARTS, parts))
+        {
+            // record larger than half of ring never fits
+            if (!m_ring.fits(SAI_REDIS_SHM_PARTS, parts) || std::chrono::steady_clock::now() >= deadline)
+            {
+                REDIS_LOG_ERR("Operation on %s dropped, shared memory ring is full or too small for it", operation.key.c_str());
+
+                sai_redis_error_notification_fn notification = m_errorNotification.load();
+
+                if (notification != NULL)
+                {
+                    notification(operation.key.data(), operation.key.size(), SAI_STATUS_INSUFFICIENT_RESOURCES);
+                }
+
+                return SAI_STATUS_INSUFFICIENT_RESOURCES;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    if (operation.enqueueTime != 0)
+    {
+        redis_latency_record(operation.objectType, operation.api, operation.bulk, SAI_REDIS_LATENCY_PHASE_WRITE, operation.enqueueTime, redis_latency_now());
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t RedisShmTransport::set(
+        _In_ const std::string &key,
+        _In_ std::vector<ssw::FieldValueTuple> &values,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type,
+        _In_ sai_common_api_t api,
+        _In_ sai_attr_id_t attr_id)
+{
+    return push(RedisPipeline::setOperation(key, values, op, object_type, api, attr_id));
+}
+
+sai_status_t RedisShmTransport::del(
+        _In_ const std::string &key,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type)
+{
+    return push(RedisPipeline::delOperation(key, op, object_type));
+}
+
+sai_status_t RedisShmTransport::enqueue(
+        _In_ RedisPipeline::Operation &&operation)
+{
+    sai_status_t status = push(operation);
+
+    RedisWriteListener *listener = m_writeListener.load();
+
+    if (listener != NULL)
+    {
+        listener->written(operation, status);
+    }
+
+    return status;
+}
+
+sai_status_t RedisShmTransport::bulk(
+        _In_ std::vector<RedisPipeline::Operation> &operations)
+{
+    size_t written = 0;
+
+    sai_status_t status = SAI_STATUS_SUCCESS;
+
+    for (; written < operations.size(); written++)
+    {
+        status = push(operations[written]);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            // operations after failed one are not written, so consumer
+            // never sees later operation without earlier one
+            break;
+        }
+    }
+
+    RedisWriteListener *listener = m_writeListener.load();
+
+    if (listener != NULL)
+    {
+        for (size_t i = 0; i < written; i++)
+        {
+            listener->written(operations[i], SAI_STATUS_SUCCESS);
+        }
+    }
+
+    operations.erase(operations.begin(), operations.begin() + written);
+
+    return status;
+}
+
+sai_status_t RedisShmTransport::flush()
+{
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t RedisShmTransport::sync()
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAI_REDIS_SHM_FULL_TIMEOUT_MS);
+
+    uint64_t reserved = m_ring.reserved();
+
+    while (m_ring.consumed() < reserved)
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            REDIS_LOG_ERR("Shared memory ring consumer did not take operations in %d ms", SAI_REDIS_SHM_FULL_TIMEOUT_MS);
+            return SAI_STATUS_FAILURE;
+        }
+
+        std::this_thread::yield();
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+void RedisShmTransport::setErrorNotification(
+        _In_ sai_redis_error_notification_fn notification)
+{
+    m_errorNotification.store(notification);
+}
+
+void RedisShmTransport::setWriteListener(
+        _In_ RedisWriteListener *listener)
+{
+    m_writeListener.store(listener);
+}
+
+void RedisShmTransport::setWriteCombiningWindow(
+        _In_ uint64_t window_us)
+{
+    if (window_us != 0)
+    {
+        REDIS_LOG_WRN("Write combining is not supported by shared memory transport");
+    }
+}
+
+uint64_t RedisShmTransport::getCoalescedCount() const
+{
+    return 0;
+}
+
+RedisJournalTransport::RedisJournalTransport(
+        _In_ RedisTransport *transport,
+        _In_ RedisChangeJournal *journal):
+    m_transport(transport),
+    m_journal(journal),
+    m_writeListener(NULL)
+{
+    m_transport->setWriteListener(this);
+}
+
+RedisJournalTransport::~RedisJournalTransport()
+{
+    // flushes pending operations
+    delete m_transport;
+}
+
+void RedisJournalTransport::stamp(
+        _Inout_ RedisPipeline::Operation &operation,
+        _In_ uint64_t sequence)
+{
+    operation.sequence = sequence;
+
+    sai_serialize_primitive(g_serialization_format, sequence, operation.op);
+}
+
+void RedisJournalTransport::written(
+        _In_ const RedisPipeline::Operation &operation,
+        _In_ sai_status_t status)
+{
+    if (status != SAI_STATUS_SUCCESS || operation.dropped)
+    {
+        // consumer never sees it, readers pass it
+        m_journal->skip(operation.sequence);
+    }
+    else
+    {
+        const sai_serialized_view_t parts[SAI_REDIS_SHM_PARTS] = {
+            { operation.key.data(), operation.key.size() },
+            { operation.value.data(), operation.value.size() },
+            { operation.op.data(), operation.op.size() },
+        };
+
+        if (!m_journal->append(operation.sequence, SAI_REDIS_SHM_PARTS, parts))
+        {
+            // readers which don't have it can't catch up past it
+            REDIS_LOG_WRN("Operation on %s is not in change journal, journal truncated", operation.key.c_str());
+        }
+    }
+
+    RedisWriteListener *listener = m_writeListener.load();
+
+    if (listener != NULL)
+    {
+        listener->written(operation, status);
+    }
+}
+
+sai_status_t RedisJournalTransport::set(
+        _In_ const std::string &key,
+        _In_ std::vector<ssw::FieldValueTuple> &values,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type,
+        _In_ sai_common_api_t api,
+        _In_ sai_attr_id_t attr_id)
+{
+    return enqueue(RedisPipeline::setOperation(key, values, op, object_type, api, attr_id));
+}
+
+sai_status_t RedisJournalTransport::del(
+        _In_ const std::string &key,
+        _In_ const std::string &op,
+        _In_ sai_object_type_t object_type)
+{
+    return enqueue(RedisPipeline::delOperation(key, op, object_type));
+}
+
+sai_status_t RedisJournalTransport::enqueue(
+        _In_ RedisPipeline::Operation &&operation)
+{
+    stamp(operation, m_journal->reserve(1));
+
+    return m_transport->enqueue(std::move(operation));
+}
+
+sai_status_t RedisJournalTransport::bulk(
+        _In_ std::vector<RedisPipeline::Operation> &operations)
+{
+    if (operations.empty())
+    {
+        return m_transport->bulk(operations);
+    }
+
+    uint64_t sequence = m_journal->reserve((uint32_t)operations.size());
+
+    for (auto &operation: operations)
+    {
+        stamp(operation, sequence++);
+    }
+
+    sai_status_t status = m_transport->bulk(operations);
+
+    // operations left by transport are not written and not reported
+    for (const auto &operation: operations)
+    {
+        m_journal->skip(operation.sequence);
+    }
+
+    return status;
+}
+
+sai_status_t RedisJournalTransport::flush()
+{
+    return m_transport->flush();
+}
+
+sai_status_t RedisJournalTransport::sync()
+{
+    return m_transport->sync();
+}
+
+void RedisJournalTransport::setErrorNotification(
+        _In_ sai_redis_error_notification_fn notification)
+{
+    m_transport->setErrorNotification(notification);
+}
+
+void RedisJournalTransport::setWriteListener(
+        _In_ RedisWriteListener *listener)
+{
+    m_writeListener.store(listener);
+}
+
+void RedisJournalTransport::setWriteCombiningWindow(
+        _In_ uint64_t window_us)
+{
+    // combined operation would leave sequence journal has but consumer
+    // never sees
+    if (window_us != 0)
+    {
+        REDIS_LOG_WRN("Write combining is not supported with change journal");
+    }
+}
+
+uint64_t RedisJournalTransport::getCoalescedCount() const
+{
+    return 0;
+}
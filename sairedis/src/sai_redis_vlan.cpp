@@ -1,3 +1,5 @@
+#define REDIS_LOG_API SAI_API_VLAN
+
 #include "sai_redis.h"
 
 /**
@@ -201,9 +203,16 @@ sai_status_t  redis_get_vlan_stats(
 {
     REDIS_LOG_ENTER();
 
+    sai_status_t status = redis_generic_get_stats_vlan(
+            SAI_OBJECT_TYPE_VLAN,
+            vlan_id,
+            number_of_counters,
+            (const int32_t*)counter_ids,
+            counters);
+
     REDIS_LOG_EXIT();
 
-    return SAI_STATUS_NOT_IMPLEMENTED;
+    return status;
 }
 
 /**
@@ -226,9 +235,15 @@ sai_status_t  redis_clear_vlan_stats(
 {
     REDIS_LOG_ENTER();
 
+    sai_status_t status = redis_generic_clear_stats_vlan(
+            SAI_OBJECT_TYPE_VLAN,
+            vlan_id,
+            number_of_counters,
+            (const int32_t*)counter_ids);
+
     REDIS_LOG_EXIT();
 
-    return SAI_STATUS_NOT_IMPLEMENTED;
+    return status;
 }
 
 /**
@@ -0,0 +1,109 @@
+#include "sai_redis_write_combiner.h"
+
+RedisWriteCombiner::RedisWriteCombiner():
+    m_lastRemove(0),
+    m_coalesced(0)
+{
+}
+
+static bool redis_write_combiner_is_entry_object_type(
+        _In_ sai_object_type_t object_type)
+{
+    // objects keyed by entry can't be referenced by other objects, so
+    // their create and remove can be dropped together
+    return object_type == SAI_OBJECT_TYPE_ROUTE ||
+           object_type == SAI_OBJECT_TYPE_NEIGHBOR ||
+           object_type == SAI_OBJECT_TYPE_FDB;
+}
+
+static void redis_write_combiner_key(
+        _In_ const std::string &key,
+        _In_ sai_attr_id_t attr_id,
+        _Out_ std::string &combining_key)
+{
+    // key may be binary, attr id is appended with fixed size
+    combining_key = key;
+    combining_key.append(reinterpret_cast<const char*>(&attr_id), sizeof(attr_id));
+}
+
+bool RedisWriteCombiner::combine(
+        _Inout_ std::vector<RedisOperation> &pending,
+        _In_ const RedisOperation &operation)
+{
+    if (operation.api == SAI_COMMON_API_SET)
+    {
+        std::string combining_key;
+        redis_write_combiner_key(operation.key, operation.attrId, combining_key);
+
+        auto it = m_pendingSets.find(combining_key);
+
+        if (it != m_pendingSets.end() && it->second >= m_lastRemove && !pending[it->second].dropped)
+        {
+            // last value wins, it is written at position of new set
+            pending[it->second].dropped = true;
+
+            m_coalesced.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        m_pendingSets[combining_key] = pending.size();
+
+        return false;
+    }
+
+    if (operation.api == SAI_COMMON_API_CREATE)
+    {
+        if (redis_write_combiner_is_entry_object_type(operation.objectType))
+        {
+            m_pendingCreates[operation.key] = pending.size();
+        }
+
+        return false;
+    }
+
+    if (operation.api != SAI_COMMON_API_REMOVE)
+    {
+        return false;
+    }
+
+    auto it = m_pendingCreates.find(operation.key);
+
+    if (it == m_pendingCreates.end() || pending[it->second].dropped)
+    {
+        m_lastRemove = pending.size() + 1;
+
+        return false;
+    }
+
+    // object never reaches ASIC_STATE, drop create, sets after it and
+    // remove itself
+
+    for (size_t i = it->second; i < pending.size(); ++i)
+    {
+        RedisOperation &candidate = pending[i];
+
+        if (!candidate.dropped && candidate.key == operation.key)
+        {
+            candidate.dropped = true;
+
+            m_coalesced.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    m_pendingCreates.erase(it);
+
+    m_coalesced.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+void RedisWriteCombiner::clear()
+{
+    m_pendingSets.clear();
+    m_pendingCreates.clear();
+    m_lastRemove = 0;
+}
+
+uint64_t RedisWriteCombiner::getCoalescedCount() const
+{
+    return m_coalesced.load(std::memory_order_relaxed);
+}
@@ -1,143 +1,101 @@
 
 #include "sai_serialize.h"
 
-sai_serialization_map_t g_serialization_map = sai_get_serialization_map();
-sai_object_type_to_string_map_t g_object_type_map = sai_get_object_type_map();
-
-sai_serialization_map_t sai_get_serialization_map()
-{
-    sai_serialization_map_t map;
-
-    map[SAI_OBJECT_TYPE_PORT][SAI_PORT_ATTR_SPEED] = SAI_SERIALIZATION_TYPE_UINT32;
-    map[SAI_OBJECT_TYPE_PORT][SAI_PORT_ATTR_OPER_STATUS] = SAI_SERIALIZATION_TYPE_INT32;
-    map[SAI_OBJECT_TYPE_PORT][SAI_PORT_ATTR_PORT_VLAN_ID] = SAI_SERIALIZATION_TYPE_UINT16;
-    map[SAI_OBJECT_TYPE_PORT][SAI_PORT_ATTR_FDB_LEARNING] = SAI_SERIALIZATION_TYPE_INT32;
-
-    map[SAI_OBJECT_TYPE_NEXT_HOP][SAI_NEXT_HOP_ATTR_TYPE] = SAI_SERIALIZATION_TYPE_INT32;
-    map[SAI_OBJECT_TYPE_NEXT_HOP][SAI_NEXT_HOP_ATTR_IP] = SAI_SERIALIZATION_TYPE_IP_ADDRESS;
-    map[SAI_OBJECT_TYPE_NEXT_HOP][SAI_NEXT_HOP_ATTR_ROUTER_INTERFACE_ID] = SAI_SERIALIZATION_TYPE_OBJECT_ID;
-
-    map[SAI_OBJECT_TYPE_NEXT_HOP_GROUP][SAI_NEXT_HOP_GROUP_ATTR_NEXT_HOP_COUNT] = SAI_SERIALIZATION_TYPE_UINT32;
-    map[SAI_OBJECT_TYPE_NEXT_HOP_GROUP][SAI_NEXT_HOP_GROUP_ATTR_TYPE] = SAI_SERIALIZATION_TYPE_INT32;
-    map[SAI_OBJECT_TYPE_NEXT_HOP_GROUP][SAI_NEXT_HOP_GROUP_ATTR_NEXT_HOP_LIST] = SAI_SERIALIZATION_TYPE_OBJECT_LIST;
-
-    map[SAI_OBJECT_TYPE_ROUTER_INTERFACE][SAI_ROUTER_INTERFACE_ATTR_VIRTUAL_ROUTER_ID] = SAI_SERIALIZATION_TYPE_OBJECT_ID;
-    map[SAI_OBJECT_TYPE_ROUTER_INTERFACE][SAI_ROUTER_INTERFACE_ATTR_TYPE] = SAI_SERIALIZATION_TYPE_INT32;
-    map[SAI_OBJECT_TYPE_ROUTER_INTERFACE][SAI_ROUTER_INTERFACE_ATTR_SRC_MAC_ADDRESS] = SAI_SERIALIZATION_TYPE_MAC;
-    map[SAI_OBJECT_TYPE_ROUTER_INTERFACE][SAI_ROUTER_INTERFACE_ATTR_VLAN_ID] = SAI_SERIALIZATION_TYPE_MAC;
-
-    map[SAI_OBJECT_TYPE_HOST_INTERFACE][SAI_HOSTIF_ATTR_TYPE] = SAI_SERIALIZATION_TYPE_INT32;
-    map[SAI_OBJECT_TYPE_HOST_INTERFACE][SAI_HOSTIF_ATTR_RIF_OR_PORT_ID] = SAI_SERIALIZATION_TYPE_OBJECT_ID;
-    map[SAI_OBJECT_TYPE_HOST_INTERFACE][SAI_HOSTIF_ATTR_NAME] = SAI_SERIALIZATION_TYPE_CHARDATA;
-
-    map[SAI_OBJECT_TYPE_NEIGHBOR][SAI_NEIGHBOR_ATTR_DST_MAC_ADDRESS] = SAI_SERIALIZATION_TYPE_MAC;
-
-    map[SAI_OBJECT_TYPE_ROUTE][SAI_ROUTE_ATTR_PACKET_ACTION] = SAI_SERIALIZATION_TYPE_INT32;
-    map[SAI_OBJECT_TYPE_ROUTE][SAI_ROUTE_ATTR_TRAP_PRIORITY] = SAI_SERIALIZATION_TYPE_UINT8;
-    map[SAI_OBJECT_TYPE_ROUTE][SAI_ROUTE_ATTR_NEXT_HOP_ID] = SAI_SERIALIZATION_TYPE_OBJECT_ID;
-    map[SAI_OBJECT_TYPE_ROUTE][SAI_ROUTE_ATTR_META_DATA] = SAI_SERIALIZATION_TYPE_UINT32;
-
-    map[SAI_OBJECT_TYPE_SWITCH][SAI_SWITCH_ATTR_SWITCHING_MODE] = SAI_SERIALIZATION_TYPE_BOOL;
-    map[SAI_OBJECT_TYPE_SWITCH][SAI_SWITCH_ATTR_PORT_NUMBER] = SAI_SERIALIZATION_TYPE_UINT32;
-    map[SAI_OBJECT_TYPE_SWITCH][SAI_SWITCH_ATTR_PORT_LIST] = SAI_SERIALIZATION_TYPE_OBJECT_LIST;
-    map[SAI_OBJECT_TYPE_SWITCH][SAI_SWITCH_ATTR_PORT_MAX_MTU] = SAI_SERIALIZATION_TYPE_UINT32;
-    map[SAI_OBJECT_TYPE_SWITCH][SAI_SWITCH_ATTR_CPU_PORT] = SAI_SERIALIZATION_TYPE_OBJECT_ID;
-
-    map[SAI_OBJECT_TYPE_FDB][SAI_FDB_ENTRY_ATTR_TYPE] = SAI_SERIALIZATION_TYPE_INT32;
-
-    map[SAI_OBJECT_TYPE_VLAN][SAI_VLAN_ATTR_MAX_LEARNED_ADDRESSES] = SAI_SERIALIZATION_TYPE_UINT32;
-
-    return map;
-}
-
-sai_object_type_to_string_map_t sai_get_object_type_map()
-{
-    sai_object_type_to_string_map_t map;
-
-    map[SAI_OBJECT_TYPE_NULL] = TO_STR(SAI_OBJECT_TYPE_NULL);
-    map[SAI_OBJECT_TYPE_PORT] = TO_STR(SAI_OBJECT_TYPE_PORT);
-    map[SAI_OBJECT_TYPE_LAG] = TO_STR(SAI_OBJECT_TYPE_LAG);
-    map[SAI_OBJECT_TYPE_VIRTUAL_ROUTER] = TO_STR(SAI_OBJECT_TYPE_VIRTUAL_ROUTER);
-    map[SAI_OBJECT_TYPE_NEXT_HOP] = TO_STR(SAI_OBJECT_TYPE_NEXT_HOP);
-    map[SAI_OBJECT_TYPE_NEXT_HOP_GROUP] = TO_STR(SAI_OBJECT_TYPE_NEXT_HOP_GROUP);
-    map[SAI_OBJECT_TYPE_ROUTER_INTERFACE] = TO_STR(SAI_OBJECT_TYPE_ROUTER_INTERFACE);
-    map[SAI_OBJECT_TYPE_ACL_TABLE] = TO_STR(SAI_OBJECT_TYPE_ACL_TABLE);
-    map[SAI_OBJECT_TYPE_ACL_ENTRY] = TO_STR(SAI_OBJECT_TYPE_ACL_ENTRY);
-    map[SAI_OBJECT_TYPE_ACL_COUNTER] = TO_STR(SAI_OBJECT_TYPE_ACL_COUNTER);
-    map[SAI_OBJECT_TYPE_HOST_INTERFACE] = TO_STR(SAI_OBJECT_TYPE_HOST_INTERFACE);
-    map[SAI_OBJECT_TYPE_MIRROR] = TO_STR(SAI_OBJECT_TYPE_MIRROR);
-    map[SAI_OBJECT_TYPE_SAMPLEPACKET] = TO_STR(SAI_OBJECT_TYPE_SAMPLEPACKET);
-    map[SAI_OBJECT_TYPE_STP_INSTANCE] = TO_STR(SAI_OBJECT_TYPE_STP_INSTANCE);
-    map[SAI_OBJECT_TYPE_TRAP_GROUP] = TO_STR(SAI_OBJECT_TYPE_TRAP_GROUP);
-    map[SAI_OBJECT_TYPE_ACL_TABLE_GROUP] = TO_STR(SAI_OBJECT_TYPE_ACL_TABLE_GROUP);
-    map[SAI_OBJECT_TYPE_POLICER] = TO_STR(SAI_OBJECT_TYPE_POLICER);
-    map[SAI_OBJECT_TYPE_WRED] = TO_STR(SAI_OBJECT_TYPE_WRED);
-    map[SAI_OBJECT_TYPE_QOS_MAPS] = TO_STR(SAI_OBJECT_TYPE_QOS_MAPS);
-    map[SAI_OBJECT_TYPE_QUEUE] = TO_STR(SAI_OBJECT_TYPE_QUEUE);
-    map[SAI_OBJECT_TYPE_SCHEDULER] = TO_STR(SAI_OBJECT_TYPE_SCHEDULER);
-    map[SAI_OBJECT_TYPE_SCHEDULER_GROUP] = TO_STR(SAI_OBJECT_TYPE_SCHEDULER_GROUP);
-    map[SAI_OBJECT_TYPE_BUFFER_POOL] = TO_STR(SAI_OBJECT_TYPE_BUFFER_POOL);
-    map[SAI_OBJECT_TYPE_BUFFER_PROFILE] = TO_STR(SAI_OBJECT_TYPE_BUFFER_PROFILE);
-    map[SAI_OBJECT_TYPE_PRIORITY_GROUP] = TO_STR(SAI_OBJECT_TYPE_PRIORITY_GROUP);
-    map[SAI_OBJECT_TYPE_LAG_MEMBER] = TO_STR(SAI_OBJECT_TYPE_LAG_MEMBER);
-    map[SAI_OBJECT_TYPE_HASH] = TO_STR(SAI_OBJECT_TYPE_HASH);
-    map[SAI_OBJECT_TYPE_UDF] = TO_STR(SAI_OBJECT_TYPE_UDF);
-    map[SAI_OBJECT_TYPE_UDF_MATCH] = TO_STR(SAI_OBJECT_TYPE_UDF_MATCH);
-    map[SAI_OBJECT_TYPE_UDF_GROUP] = TO_STR(SAI_OBJECT_TYPE_UDF_GROUP);
-    map[SAI_OBJECT_TYPE_FDB] = TO_STR(SAI_OBJECT_TYPE_FDB);
-    map[SAI_OBJECT_TYPE_SWITCH] = TO_STR(SAI_OBJECT_TYPE_SWITCH);
-    map[SAI_OBJECT_TYPE_TRAP] = TO_STR(SAI_OBJECT_TYPE_TRAP);
-    map[SAI_OBJECT_TYPE_TRAP_USER_DEF] = TO_STR(SAI_OBJECT_TYPE_TRAP_USER_DEF);
-    map[SAI_OBJECT_TYPE_NEIGHBOR] = TO_STR(SAI_OBJECT_TYPE_NEIGHBOR);
-    map[SAI_OBJECT_TYPE_ROUTE] = TO_STR(SAI_OBJECT_TYPE_ROUTE);
-    map[SAI_OBJECT_TYPE_VLAN] = TO_STR(SAI_OBJECT_TYPE_VLAN);
-
-    return map;
-}
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 sai_status_t sai_get_object_type_string(sai_object_type_t object_type, std::string &str_object_type)
 {
-    auto it = g_object_type_map.find(object_type);
-
-    if (it == g_object_type_map.end())
+    if (object_type < SAI_OBJECT_TYPE_NULL || object_type >= SAI_OBJECT_TYPE_MAX)
     {
         fprintf(stderr, "serialization object not found type not found");
         return SAI_STATUS_NOT_IMPLEMENTED;
     }
 
-    str_object_type = it->second;
+    str_object_type = g_object_type_name_table[object_type];
 
     return SAI_STATUS_SUCCESS;
 }
 
+static const sai_attr_serialization_range_t* sai_find_attr_range(
+        _In_ const sai_object_type_t object_type,
+        _In_ const sai_attr_id_t attr_id,
+        _Out_ uint32_t &offset)
+{
+    if (object_type < SAI_OBJECT_TYPE_NULL || object_type >= SAI_OBJECT_TYPE_MAX)
+    {
+        return NULL;
+    }
+
+    const sai_attr_serialization_table_t &table = g_attr_serialization_table[object_type];
+
+    // most object types have single range, custom ranges add one more
+
+    for (uint32_t i = 0; i < table.count; ++i)
+    {
+        const sai_attr_serialization_range_t &range = table.ranges[i];
+
+        offset = attr_id - range.start;
+
+        if (attr_id < range.start || offset >= range.count)
+        {
+            continue;
+        }
+
+        if (range.types[offset] == SAI_SERIALIZATION_TYPE_NONE)
+        {
+            break;
+        }
+
+        return &range;
+    }
+
+    return NULL;
+}
+
 sai_status_t sai_get_serialization_type(
         _In_ const sai_object_type_t object_type,
         _In_ const sai_attr_id_t attr_id,
         _Out_ sai_attr_serialization_type_t &serialization_type)
 {
-    auto it = g_serialization_map.find(object_type);
-
-    if (it == g_serialization_map.end())
+    if (object_type < SAI_OBJECT_TYPE_NULL || object_type >= SAI_OBJECT_TYPE_MAX)
     {
         fprintf(stderr, "serialization object not found type not found");
         return SAI_STATUS_NOT_IMPLEMENTED;
     }
 
-    std::map<sai_attr_id_t, sai_attr_serialization_type_t> &map = it->second;
+    uint32_t offset;
 
-    auto mit = map.find(attr_id);
+    const sai_attr_serialization_range_t *range = sai_find_attr_range(object_type, attr_id, offset);
 
-    if (mit == map.end())
+    if (range == NULL)
     {
         fprintf(stderr, "serialization attribute not found");
         return SAI_STATUS_NOT_IMPLEMENTED;
     }
 
-    serialization_type = mit->second;
+    serialization_type = range->types[offset];
 
     return SAI_STATUS_SUCCESS;
 }
 
+bool sai_is_attr_read_only(
+        _In_ const sai_object_type_t object_type,
+        _In_ const sai_attr_id_t attr_id)
+{
+    uint32_t offset;
+
+    const sai_attr_serialization_range_t *range = sai_find_attr_range(object_type, attr_id, offset);
+
+    return range != NULL && (range->flags[offset] & SAI_ATTR_FLAG_READ_ONLY);
+}
+
 sai_status_t sai_serialize_attr_id(
         _In_ const sai_attribute_t &attr,
         _Out_ std::string &s)
@@ -267,6 +225,10 @@ sai_status_t sai_serialize_attr_value(
             sai_serialize_list(attr.value.qosmap, s);
             break;
 
+        case SAI_SERIALIZATION_TYPE_TUNNEL_MAP_LIST:
+            sai_serialize_list(attr.value.tunnelmap, s);
+            break;
+
             /* ACL FIELD DATA */
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT8:
@@ -295,8 +257,8 @@ sai_status_t sai_serialize_attr_value(
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT32:
             sai_serialize_primitive(attr.value.aclfield.enable, s);
-            sai_serialize_primitive(attr.value.aclfield.mask.u16, s);
-            sai_serialize_primitive(attr.value.aclfield.data.u16, s);
+            sai_serialize_primitive(attr.value.aclfield.mask.u32, s);
+            sai_serialize_primitive(attr.value.aclfield.data.u32, s);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_INT32:
@@ -413,6 +375,166 @@ sai_status_t sai_serialize_attr(
     return sai_serialize_attr_value(type, attr, s);
 }
 
+// byte -> two lower case hex digits, same output as std::hex with setw(2)
+static const char g_hex_encode_table[] =
+    "000102030405060708090a0b0c0d0e0f"
+    "101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f"
+    "303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f"
+    "505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f"
+    "707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f"
+    "909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+    "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+    "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+    "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+// hex digit -> nibble, 0xff for characters which are not hex digits
+static const unsigned char g_hex_decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+#if defined(__AVX2__)
+
+static inline void sai_hex_encode_16(
+        _In_ const unsigned char *mem,
+        _Out_ char *buffer)
+{
+    // each byte is widened to 16 bits, high nibble goes to low byte
+    // so little endian store will put it first
+    __m256i w = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)mem));
+
+    __m256i n = _mm256_or_si256(
+            _mm256_and_si256(_mm256_srli_epi16(w, 4), _mm256_set1_epi16(0x000f)),
+            _mm256_and_si256(_mm256_slli_epi16(w, 8), _mm256_set1_epi16(0x0f00)));
+
+    __m256i a = _mm256_and_si256(_mm256_cmpgt_epi8(n, _mm256_set1_epi8(9)), _mm256_set1_epi8('a' - '0' - 10));
+
+    n = _mm256_add_epi8(_mm256_add_epi8(n, _mm256_set1_epi8('0')), a);
+
+    _mm256_storeu_si256((__m256i*)buffer, n);
+}
+
+#elif defined(__SSE2__)
+
+static inline __m128i sai_hex_nibbles_to_chars(
+        _In_ __m128i n)
+{
+    __m128i a = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+
+    return _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), a);
+}
+
+static inline void sai_hex_encode_16(
+        _In_ const unsigned char *mem,
+        _Out_ char *buffer)
+{
+    __m128i v = _mm_loadu_si128((const __m128i*)mem);
+
+    __m128i mask = _mm_set1_epi8(0x0f);
+
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+    __m128i lo = _mm_and_si128(v, mask);
+
+    _mm_storeu_si128((__m128i*)buffer, sai_hex_nibbles_to_chars(_mm_unpacklo_epi8(hi, lo)));
+    _mm_storeu_si128((__m128i*)(buffer + 16), sai_hex_nibbles_to_chars(_mm_unpackhi_epi8(hi, lo)));
+}
+
+#endif
+
+/**
+ * @brief Encode memory as hex string into provided buffer
+ *
+ * Buffer must have room for 2 * size characters, it's not null terminated.
+ */
+void sai_hex_encode(
+        _In_ const void *mem,
+        _In_ size_t size,
+        _Out_ char *buffer)
+{
+    const unsigned char *ptr = reinterpret_cast<const unsigned char*>(mem);
+
+    size_t i = 0;
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+    for (; i + 16 <= size; i += 16)
+    {
+        sai_hex_encode_16(ptr + i, buffer + 2 * i);
+    }
+
+#endif
+
+    for (; i < size; i++)
+    {
+        const char *hex = g_hex_encode_table + 2 * ptr[i];
+
+        buffer[2 * i] = hex[0];
+        buffer[2 * i + 1] = hex[1];
+    }
+}
+
+/**
+ * @brief Decode 2 * size hex characters from buffer into memory
+ *
+ * @return false if buffer contains non hex character
+ */
+bool sai_hex_decode(
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _Out_ void *mem)
+{
+    const unsigned char *in = reinterpret_cast<const unsigned char*>(buffer);
+
+    unsigned char *out = reinterpret_cast<unsigned char*>(mem);
+
+    unsigned char invalid = 0;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        unsigned char u = g_hex_decode_table[in[2 * i]];
+        unsigned char l = g_hex_decode_table[in[2 * i + 1]];
+
+        invalid |= u | l;
+
+        out[i] = (unsigned char)((u << 4) | (l & 0x0f));
+    }
+
+    return (invalid & 0xf0) == 0;
+}
+
+void sai_hex_decode_error(
+        _In_ const char *buffer,
+        _In_ size_t size)
+{
+    // char_to_int will throw on first invalid character
+
+    for (size_t i = 0; i < 2 * size; i++)
+    {
+        char_to_int(buffer[i]);
+    }
+}
+
 int char_to_int(
         _In_ const char c)
 {
@@ -431,254 +553,266 @@ int char_to_int(
     throw ss.str();
 }
 
-sai_status_t sai_deserialize_attr_value(
-        _In_ std::string &s,
-        _In_ int &index,
+SaiDeserializeContext::SaiDeserializeContext(
+        _In_ size_t block_size):
+    m_block_size(block_size),
+    m_current(0),
+    m_ptr(NULL),
+    m_end(NULL)
+{
+}
+
+SaiDeserializeContext::~SaiDeserializeContext()
+{
+    for (auto &block: m_blocks)
+    {
+        delete[] block.data;
+    }
+}
+
+void* SaiDeserializeContext::allocate_slow(
+        _In_ size_t size,
+        _In_ size_t align)
+{
+    // try blocks kept from previous messages first
+
+    size_t next = m_blocks.empty() ? 0 : m_current + 1;
+
+    for (; next < m_blocks.size(); ++next)
+    {
+        if (m_blocks[next].size >= size + align)
+        {
+            break;
+        }
+    }
+
+    if (next == m_blocks.size())
+    {
+        size_t block_size = m_blocks.empty() ? m_block_size : 2 * m_blocks.back().size;
+
+        if (block_size < size + align)
+        {
+            block_size = size + align;
+        }
+
+        Block block = { new char[block_size], block_size };
+
+        m_blocks.push_back(block);
+    }
+
+    m_current = next;
+    m_ptr = m_blocks[next].data;
+    m_end = m_blocks[next].data + m_blocks[next].size;
+
+    return allocate(size, align);
+}
+
+void SaiDeserializeContext::reset()
+{
+    if (m_blocks.empty())
+    {
+        return;
+    }
+
+    m_current = 0;
+    m_ptr = m_blocks[0].data;
+    m_end = m_blocks[0].data + m_blocks[0].size;
+}
+
+size_t SaiDeserializeContext::capacity() const
+{
+    size_t capacity = 0;
+
+    for (auto &block: m_blocks)
+    {
+        capacity += block.size;
+    }
+
+    return capacity;
+}
+
+sai_status_t sai_deserialize_free_attribute_value(
         _In_ const sai_attr_serialization_type_t type,
-        _Out_ sai_attribute_t &attr)
+        _In_ sai_attribute_t &attr)
 {
+    // if we allocated list, then we need to free it
+
     switch (type)
     {
         case SAI_SERIALIZATION_TYPE_BOOL:
-            sai_deserialize_primitive(s, index, attr.value.booldata);
             break;
 
         case SAI_SERIALIZATION_TYPE_CHARDATA:
-            sai_deserialize_primitive(s, index, attr.value.chardata);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT8:
-            sai_deserialize_primitive(s, index, attr.value.u8);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT8:
-            sai_deserialize_primitive(s, index, attr.value.s8);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT16:
-            sai_deserialize_primitive(s, index, attr.value.u16);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT16:
-            sai_deserialize_primitive(s, index, attr.value.s16);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT32:
-            sai_deserialize_primitive(s, index, attr.value.u32);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT32:
-            sai_deserialize_primitive(s, index, attr.value.s32);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT64:
-            sai_deserialize_primitive(s, index, attr.value.u64);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT64:
-            sai_deserialize_primitive(s, index, attr.value.s64);
             break;
 
         case SAI_SERIALIZATION_TYPE_MAC:
-            sai_deserialize_primitive(s, index, attr.value.mac);
             break;
 
         case SAI_SERIALIZATION_TYPE_IP4:
-            sai_deserialize_primitive(s, index, attr.value.ip4);
             break;
 
         case SAI_SERIALIZATION_TYPE_IP6:
-            sai_deserialize_primitive(s, index, attr.value.ip6);
             break;
 
         case SAI_SERIALIZATION_TYPE_IP_ADDRESS:
-            sai_deserialize_primitive(s, index, attr.value.ipaddr);
             break;
 
         case SAI_SERIALIZATION_TYPE_OBJECT_ID:
-            sai_deserialize_primitive(s, index, attr.value.oid);
             break;
 
         case SAI_SERIALIZATION_TYPE_OBJECT_LIST:
-            sai_deserialize_list(s, index, attr.value.objlist);
+            sai_free_list(attr.value.objlist);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT8_LIST:
-            sai_deserialize_list(s, index, attr.value.u8list);
+            sai_free_list(attr.value.u8list);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT8_LIST:
-            sai_deserialize_list(s, index, attr.value.s8list);
+            sai_free_list(attr.value.s8list);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT16_LIST:
-            sai_deserialize_list(s, index, attr.value.u16list);
+            sai_free_list(attr.value.u16list);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT16_LIST:
-            sai_deserialize_list(s, index, attr.value.s16list);
+            sai_free_list(attr.value.s16list);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT32_LIST:
-            sai_deserialize_list(s, index, attr.value.u32list);
+            sai_free_list(attr.value.u32list);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT32_LIST:
-            sai_deserialize_list(s, index, attr.value.s32list);
+            sai_free_list(attr.value.s32list);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT32_RANGE:
-            sai_deserialize_primitive(s, index, attr.value.u32range);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT32_RANGE:
-            sai_deserialize_primitive(s, index, attr.value.s32range);
             break;
 
         case SAI_SERIALIZATION_TYPE_VLAN_LIST:
-            sai_deserialize_list(s, index, attr.value.vlanlist);
+            sai_free_list(attr.value.vlanlist);
             break;
 
         case SAI_SERIALIZATION_TYPE_VLAN_PORT_LIST:
-            sai_deserialize_list(s, index, attr.value.vlanportlist);
+            sai_free_list(attr.value.vlanportlist);
             break;
 
         case SAI_SERIALIZATION_TYPE_PORT_BREAKOUT:
-            sai_deserialize_primitive(s, index, attr.value.portbreakout.breakout_mode);
-            sai_deserialize_list(s, index, attr.value.portbreakout.port_list);
+            sai_free_list(attr.value.portbreakout.port_list);
             break;
 
         case SAI_SERIALIZATION_TYPE_QOS_MAP_LIST:
-            sai_deserialize_list(s, index, attr.value.qosmap);
+            sai_free_list(attr.value.qosmap);
+            break;
+
+        case SAI_SERIALIZATION_TYPE_TUNNEL_MAP_LIST:
+            sai_free_list(attr.value.tunnelmap);
             break;
 
             /* ACL FIELD DATA */
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT8:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.mask.u8);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.u8);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_INT8:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.mask.s8);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.s8);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT16:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.mask.u16);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.u16);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_INT16:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.mask.s16);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.s16);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT32:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.mask.u16);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.u16);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_INT32:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.mask.s32);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.s32);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_MAC:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.mask.mac);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.mac);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_IP4:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.mask.ip4);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.ip4);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_IP6:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.mask.ip6);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.ip6);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_ID:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclfield.data.oid);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_LIST:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_list(s, index, attr.value.aclfield.data.objlist);
+            sai_free_list(attr.value.aclfield.data.objlist);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT8_LIST:
-            sai_deserialize_primitive(s, index, attr.value.aclfield.enable);
-            sai_deserialize_list(s, index, attr.value.aclfield.mask.u8list);
-            sai_deserialize_list(s, index, attr.value.aclfield.data.u8list);
+            sai_free_list(attr.value.aclfield.mask.u8list);
+            sai_free_list(attr.value.aclfield.data.u8list);
             break;
 
             /* ACL ACTION DATA */
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_UINT8:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.u8);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_INT8:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.s8);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_UINT16:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.u16);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_INT16:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.s16);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_UINT32:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.u32);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_INT32:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.s32);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_MAC:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.mac);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_IPV4:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.ip4);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_IPV6:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.ip6);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_ID:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_primitive(s, index, attr.value.aclaction.parameter.oid);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_LIST:
-            sai_deserialize_primitive(s, index, attr.value.aclaction.enable);
-            sai_deserialize_list(s, index, attr.value.aclaction.parameter.objlist);
+            sai_free_list(attr.value.aclaction.parameter.objlist);
             break;
 
         default:
@@ -688,189 +822,1042 @@ sai_status_t sai_deserialize_attr_value(
     return SAI_STATUS_SUCCESS;
 }
 
-sai_status_t sai_deserialize_free_attribute_value(
+sai_status_t sai_serialize_attr_id(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_attribute_t &attr,
+        _Out_ std::string &s)
+{
+    if (format == SAI_SERIALIZATION_FORMAT_BINARY)
+    {
+        sai_binary_serialize_varint(attr.id, s);
+
+        return SAI_STATUS_SUCCESS;
+    }
+
+    return sai_serialize_attr_id(attr, s);
+}
+
+sai_status_t sai_serialize_attr_value(
+        _In_ const sai_serialization_format_t format,
         _In_ const sai_attr_serialization_type_t type,
-        _In_ sai_attribute_t &attr)
+        _In_ const sai_attribute_t &attr,
+        _Out_ std::string &s)
 {
-    // if we allocated list, then we need to free it
+    if (format == SAI_SERIALIZATION_FORMAT_BINARY)
+    {
+        return sai_binary_serialize_attr_value(type, attr, s);
+    }
+
+    return sai_serialize_attr_value(type, attr, s);
+}
+
+sai_status_t sai_serialize_object_key(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_object_type_t object_type,
+        _In_ const std::string &serialized_object_id,
+        _Out_ std::string &key)
+{
+    if (format == SAI_SERIALIZATION_FORMAT_BINARY)
+    {
+        key += SAI_BINARY_FORMAT_VERSION;
+
+        sai_binary_serialize_varint(object_type, key);
+
+        key += serialized_object_id;
+
+        return SAI_STATUS_SUCCESS;
+    }
+
+    sai_serialize_primitive(object_type, key);
+
+    key += ":";
+    key += serialized_object_id;
+
+    return SAI_STATUS_SUCCESS;
+}
+
+static void sai_canonical_ip_address(
+        _In_ const sai_ip_address_t &address,
+        _Out_ sai_ip_address_t &canonical)
+{
+    canonical.addr_family = address.addr_family;
+
+    if (address.addr_family == SAI_IP_ADDR_FAMILY_IPV4)
+    {
+        canonical.addr.ip4 = address.addr.ip4;
+    }
+    else
+    {
+        memcpy(canonical.addr.ip6, address.addr.ip6, sizeof(canonical.addr.ip6));
+    }
+}
+
+static void sai_canonical_ip_prefix(
+        _In_ const sai_ip_prefix_t &prefix,
+        _Out_ sai_ip_prefix_t &canonical)
+{
+    canonical.addr_family = prefix.addr_family;
+
+    if (prefix.addr_family == SAI_IP_ADDR_FAMILY_IPV4)
+    {
+        canonical.addr.ip4 = prefix.addr.ip4;
+        canonical.mask.ip4 = prefix.mask.ip4;
+    }
+    else
+    {
+        memcpy(canonical.addr.ip6, prefix.addr.ip6, sizeof(canonical.addr.ip6));
+        memcpy(canonical.mask.ip6, prefix.mask.ip6, sizeof(canonical.mask.ip6));
+    }
+}
+
+// entries are copied field by field to zeroed struct, bytes which are
+// not part of any field are zero in key
+
+void sai_serialize_entry(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_fdb_entry_t &entry,
+        _Out_ std::string &s)
+{
+    sai_fdb_entry_t canonical;
+
+    memset(&canonical, 0, sizeof(canonical));
+
+    memcpy(canonical.mac_address, entry.mac_address, sizeof(canonical.mac_address));
+    canonical.vlan_id = entry.vlan_id;
+
+    sai_serialize_primitive(format, canonical, s);
+}
+
+void sai_serialize_entry(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_neighbor_entry_t &entry,
+        _Out_ std::string &s)
+{
+    sai_neighbor_entry_t canonical;
+
+    memset(&canonical, 0, sizeof(canonical));
+
+    canonical.rif_id = entry.rif_id;
+    sai_canonical_ip_address(entry.ip_address, canonical.ip_address);
+
+    sai_serialize_primitive(format, canonical, s);
+}
+
+void sai_serialize_entry(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_unicast_route_entry_t &entry,
+        _Out_ std::string &s)
+{
+    sai_unicast_route_entry_t canonical;
+
+    memset(&canonical, 0, sizeof(canonical));
+
+    canonical.vr_id = entry.vr_id;
+    sai_canonical_ip_prefix(entry.destination, canonical.destination);
+
+    sai_serialize_primitive(format, canonical, s);
+}
+
+void sai_binary_serialize_varint(
+        _In_ uint64_t value,
+        _Out_ std::string &s)
+{
+    // 7 bits per byte, high bit set when more bytes follow
+
+    while (value >= 0x80)
+    {
+        s += (char)((value & 0x7f) | 0x80);
+
+        value >>= 7;
+    }
+
+    s += (char)value;
+}
+
+bool sai_binary_deserialize_varint(
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _Inout_ size_t &offset,
+        _Out_ uint64_t &value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (offset >= size)
+        {
+            return false;
+        }
+
+        unsigned char c = (unsigned char)buffer[offset++];
+
+        value |= (uint64_t)(c & 0x7f) << shift;
+
+        if ((c & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool sai_binary_deserialize_varint(
+        _In_ const std::string &s,
+        _Inout_ int &index,
+        _Out_ uint64_t &value)
+{
+    if (index < 0)
+    {
+        return false;
+    }
+
+    size_t offset = index;
+
+    bool ok = sai_binary_deserialize_varint(s.data(), s.size(), offset, value);
+
+    index = (int)offset;
+
+    return ok;
+}
+
+/*
+ * Binary format is defined once as a walk over the attribute value and
+ * serializer and deserializer only differ in how they visit each member.
+ *
+ * Primitives are raw memory, lists are varint count followed by raw
+ * items and chardata is varint length followed by used characters.
+ */
+
+class SaiAttrValueVisitor
+{
+    public:
+
+        /**
+         * @brief Status of walk, visitor which failed was given data it
+         * can't decode
+         */
+        sai_status_t status(
+                _In_ bool ok) const
+        {
+            return ok ? SAI_STATUS_SUCCESS : SAI_STATUS_INVALID_PARAMETER;
+        }
+};
+
+class BinarySerializer:
+    public SaiAttrValueVisitor
+{
+    public:
+
+        BinarySerializer(
+                _Out_ std::string &s):
+            m_s(s)
+        {
+        }
+
+        template<typename T>
+        bool primitive(
+                _In_ T &element)
+        {
+            sai_binary_serialize_primitive(element, m_s);
+
+            return true;
+        }
+
+        template<typename T>
+        bool list(
+                _In_ T &element)
+        {
+            sai_binary_serialize_varint(element.count, m_s);
+
+            m_s.append(reinterpret_cast<const char*>(element.list), sizeof(*element.list) * element.count);
+
+            return true;
+        }
+
+        bool chardata(
+                _In_ char (&chardata)[32])
+        {
+            size_t len = strnlen(chardata, sizeof(chardata));
+
+            sai_binary_serialize_varint(len, m_s);
+
+            m_s.append(chardata, len);
+
+            return true;
+        }
+
+    private:
+
+        std::string &m_s;
+};
+
+/*
+ * Deserializers below read from buffer which does not need to be null
+ * terminated, every read is checked against buffer size, and list
+ * count is checked against remaining data before allocation.
+ */
+
+class BinaryDeserializer:
+    public SaiAttrValueVisitor
+{
+    public:
+
+        BinaryDeserializer(
+                _In_ const char *buffer,
+                _In_ size_t size,
+                _Inout_ size_t &offset,
+                _In_ SaiDeserializeContext *context):
+            m_buffer(buffer),
+            m_size(size),
+            m_offset(offset),
+            m_context(context)
+        {
+        }
+
+        template<typename T>
+        bool primitive(
+                _Out_ T &element)
+        {
+            if (!available(sizeof(T)))
+            {
+                return false;
+            }
+
+            memcpy(&element, m_buffer + m_offset, sizeof(T));
+
+            m_offset += sizeof(T);
+
+            return true;
+        }
+
+        template<typename T>
+        bool list(
+                _Out_ T &element)
+        {
+            uint64_t count;
+
+            if (!sai_binary_deserialize_varint(m_buffer, m_size, m_offset, count))
+            {
+                return false;
+            }
+
+            if (count > UINT32_MAX || !available(sizeof(*element.list) * count))
+            {
+                return false;
+            }
+
+            sai_alloc_list((uint32_t)count, element, m_context);
+
+            size_t size = sizeof(*element.list) * element.count;
+
+            memcpy(element.list, m_buffer + m_offset, size);
+
+            m_offset += size;
+
+            return true;
+        }
+
+        bool chardata(
+                _Out_ char (&chardata)[32])
+        {
+            uint64_t len;
+
+            if (!sai_binary_deserialize_varint(m_buffer, m_size, m_offset, len))
+            {
+                return false;
+            }
+
+            if (len > sizeof(chardata) || !available(len))
+            {
+                return false;
+            }
+
+            memset(chardata, 0, sizeof(chardata));
+            memcpy(chardata, m_buffer + m_offset, len);
+
+            m_offset += len;
+
+            return true;
+        }
+
+    private:
+
+        bool available(
+                _In_ uint64_t size) const
+        {
+            return m_offset <= m_size && size <= m_size - m_offset;
+        }
+
+        const char *m_buffer;
+
+        size_t m_size;
+
+        size_t &m_offset;
+
+        SaiDeserializeContext *m_context;
+};
+
+class HexDeserializer:
+    public SaiAttrValueVisitor
+{
+    public:
+
+        HexDeserializer(
+                _In_ const char *buffer,
+                _In_ size_t size,
+                _Inout_ size_t &offset,
+                _In_ SaiDeserializeContext *context):
+            m_buffer(buffer),
+            m_size(size),
+            m_offset(offset),
+            m_context(context)
+        {
+        }
+
+        template<typename T>
+        bool primitive(
+                _Out_ T &element)
+        {
+            return decode(&element, sizeof(T));
+        }
+
+        template<typename T>
+        bool list(
+                _Out_ T &element)
+        {
+            uint32_t count;
+
+            if (!primitive(count))
+            {
+                return false;
+            }
+
+            size_t size = sizeof(*element.list) * (size_t)count;
+
+            if (!available(size))
+            {
+                return false;
+            }
+
+            sai_alloc_list(count, element, m_context);
+
+            return decode(element.list, size);
+        }
+
+        bool chardata(
+                _Out_ char (&chardata)[32])
+        {
+            return decode(chardata, sizeof(chardata));
+        }
+
+    private:
+
+        bool available(
+                _In_ size_t size) const
+        {
+            return m_offset <= m_size && size <= (m_size - m_offset) / 2;
+        }
+
+        bool decode(
+                _Out_ void *mem,
+                _In_ size_t size)
+        {
+            if (!available(size) || !sai_hex_decode(m_buffer + m_offset, size, mem))
+            {
+                return false;
+            }
+
+            m_offset += 2 * size;
+
+            return true;
+        }
+
+        const char *m_buffer;
+
+        size_t m_size;
+
+        size_t &m_offset;
+
+        SaiDeserializeContext *m_context;
+};
+
+template<class V>
+sai_status_t sai_visit_attr_value(
+        _In_ const sai_attr_serialization_type_t type,
+        _Inout_ sai_attribute_value_t &value,
+        _In_ V &v)
+{
+    bool ok;
 
     switch (type)
     {
         case SAI_SERIALIZATION_TYPE_BOOL:
+            ok = v.primitive(value.booldata);
             break;
 
         case SAI_SERIALIZATION_TYPE_CHARDATA:
+            ok = v.chardata(value.chardata);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT8:
+            ok = v.primitive(value.u8);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT8:
+            ok = v.primitive(value.s8);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT16:
+            ok = v.primitive(value.u16);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT16:
+            ok = v.primitive(value.s16);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT32:
+            ok = v.primitive(value.u32);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT32:
+            ok = v.primitive(value.s32);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT64:
+            ok = v.primitive(value.u64);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT64:
+            ok = v.primitive(value.s64);
             break;
 
         case SAI_SERIALIZATION_TYPE_MAC:
+            ok = v.primitive(value.mac);
             break;
 
         case SAI_SERIALIZATION_TYPE_IP4:
+            ok = v.primitive(value.ip4);
             break;
 
         case SAI_SERIALIZATION_TYPE_IP6:
+            ok = v.primitive(value.ip6);
             break;
 
         case SAI_SERIALIZATION_TYPE_IP_ADDRESS:
+            ok = v.primitive(value.ipaddr);
             break;
 
         case SAI_SERIALIZATION_TYPE_OBJECT_ID:
+            ok = v.primitive(value.oid);
             break;
 
         case SAI_SERIALIZATION_TYPE_OBJECT_LIST:
-            sai_free_list(attr.value.objlist);
+            ok = v.list(value.objlist);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT8_LIST:
-            sai_free_list(attr.value.u8list);
+            ok = v.list(value.u8list);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT8_LIST:
-            sai_free_list(attr.value.s8list);
+            ok = v.list(value.s8list);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT16_LIST:
-            sai_free_list(attr.value.u16list);
+            ok = v.list(value.u16list);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT16_LIST:
-            sai_free_list(attr.value.s16list);
+            ok = v.list(value.s16list);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT32_LIST:
-            sai_free_list(attr.value.u32list);
+            ok = v.list(value.u32list);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT32_LIST:
-            sai_free_list(attr.value.s32list);
+            ok = v.list(value.s32list);
             break;
 
         case SAI_SERIALIZATION_TYPE_UINT32_RANGE:
+            ok = v.primitive(value.u32range);
             break;
 
         case SAI_SERIALIZATION_TYPE_INT32_RANGE:
+            ok = v.primitive(value.s32range);
             break;
 
         case SAI_SERIALIZATION_TYPE_VLAN_LIST:
-            sai_free_list(attr.value.vlanlist);
+            ok = v.list(value.vlanlist);
             break;
 
         case SAI_SERIALIZATION_TYPE_VLAN_PORT_LIST:
-            sai_free_list(attr.value.vlanportlist);
+            ok = v.list(value.vlanportlist);
             break;
 
         case SAI_SERIALIZATION_TYPE_PORT_BREAKOUT:
-            sai_free_list(attr.value.portbreakout.port_list);
+            ok = v.primitive(value.portbreakout.breakout_mode) &&
+                 v.list(value.portbreakout.port_list);
             break;
 
         case SAI_SERIALIZATION_TYPE_QOS_MAP_LIST:
-            sai_free_list(attr.value.qosmap);
+            ok = v.list(value.qosmap);
+            break;
+
+        case SAI_SERIALIZATION_TYPE_TUNNEL_MAP_LIST:
+            ok = v.list(value.tunnelmap);
             break;
 
             /* ACL FIELD DATA */
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT8:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.mask.u8) &&
+                 v.primitive(value.aclfield.data.u8);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_INT8:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.mask.s8) &&
+                 v.primitive(value.aclfield.data.s8);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT16:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.mask.u16) &&
+                 v.primitive(value.aclfield.data.u16);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_INT16:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.mask.s16) &&
+                 v.primitive(value.aclfield.data.s16);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT32:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.mask.u32) &&
+                 v.primitive(value.aclfield.data.u32);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_INT32:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.mask.s32) &&
+                 v.primitive(value.aclfield.data.s32);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_MAC:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.mask.mac) &&
+                 v.primitive(value.aclfield.data.mac);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_IP4:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.mask.ip4) &&
+                 v.primitive(value.aclfield.data.ip4);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_IP6:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.mask.ip6) &&
+                 v.primitive(value.aclfield.data.ip6);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_ID:
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.primitive(value.aclfield.data.oid);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_LIST:
-            sai_free_list(attr.value.aclfield.data.objlist);
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.list(value.aclfield.data.objlist);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT8_LIST:
-            sai_free_list(attr.value.aclfield.mask.u8list);
-            sai_free_list(attr.value.aclfield.data.u8list);
+            ok = v.primitive(value.aclfield.enable) &&
+                 v.list(value.aclfield.mask.u8list) &&
+                 v.list(value.aclfield.data.u8list);
             break;
 
             /* ACL ACTION DATA */
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_UINT8:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.u8);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_INT8:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.s8);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_UINT16:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.u16);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_INT16:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.s16);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_UINT32:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.u32);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_INT32:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.s32);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_MAC:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.mac);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_IPV4:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.ip4);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_IPV6:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.ip6);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_ID:
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.primitive(value.aclaction.parameter.oid);
             break;
 
         case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_LIST:
-            sai_free_list(attr.value.aclaction.parameter.objlist);
+            ok = v.primitive(value.aclaction.enable) &&
+                 v.list(value.aclaction.parameter.objlist);
             break;
 
         default:
             return SAI_STATUS_NOT_IMPLEMENTED;
     }
 
+    return v.status(ok);
+}
+
+/*
+ * Visited by destination value, member of source is found at the same
+ * offset in source value since both are sai_attribute_value_t.
+ */
+class UserCopier
+{
+    public:
+
+        UserCopier(
+                _In_ const sai_attribute_value_t &src,
+                _Inout_ sai_attribute_value_t &dst):
+            m_src(src),
+            m_dst(dst),
+            m_overflow(false)
+        {
+        }
+
+        sai_status_t status(
+                _In_ bool ok) const
+        {
+            if (m_overflow)
+            {
+                return SAI_STATUS_BUFFER_OVERFLOW;
+            }
+
+            return ok ? SAI_STATUS_SUCCESS : SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        template<typename T>
+        bool primitive(
+                _Out_ T &element)
+        {
+            // arrays like mac or ip6 can't be assigned
+            memcpy(&element, &source(element), sizeof(T));
+
+            return true;
+        }
+
+        template<typename T>
+        bool list(
+                _Inout_ T &element)
+        {
+            const T &src = source(element);
+
+            if (element.list == NULL && element.count > 0)
+            {
+                return false;
+            }
+
+            if (src.count > element.count)
+            {
+                // caller learns required size from count
+                element.count = src.count;
+
+                m_overflow = true;
+
+                return false;
+            }
+
+            if (src.count > 0)
+            {
+                memcpy(element.list, src.list, sizeof(*src.list) * src.count);
+            }
+
+            element.count = src.count;
+
+            return true;
+        }
+
+        bool chardata(
+                _Out_ char (&chardata)[32])
+        {
+            memcpy(chardata, source(chardata), sizeof(chardata));
+
+            return true;
+        }
+
+    private:
+
+        template<typename T>
+        const T& source(
+                _In_ const T &element) const
+        {
+            size_t offset = (const char*)&element - (const char*)&m_dst;
+
+            return *reinterpret_cast<const T*>((const char*)&m_src + offset);
+        }
+
+        const sai_attribute_value_t &m_src;
+
+        sai_attribute_value_t &m_dst;
+
+        bool m_overflow;
+};
+
+sai_status_t sai_copy_attr_value(
+        _In_ const sai_attr_serialization_type_t type,
+        _In_ const sai_attribute_t &src,
+        _Inout_ sai_attribute_t &dst)
+{
+    UserCopier copier(src.value, dst.value);
+
+    return sai_visit_attr_value(type, dst.value, copier);
+}
+
+sai_status_t sai_binary_serialize_attr_value(
+        _In_ const sai_attr_serialization_type_t type,
+        _In_ const sai_attribute_t &attr,
+        _Out_ std::string &s)
+{
+    BinarySerializer serializer(s);
+
+    // serializer only reads from value
+    sai_attribute_value_t &value = const_cast<sai_attribute_value_t&>(attr.value);
+
+    return sai_visit_attr_value(type, value, serializer);
+}
+
+template<class D>
+static sai_status_t sai_deserialize_attr_value(
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _Inout_ size_t &offset,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext *context)
+{
+    D deserializer(buffer, size, offset, context);
+
+    // lists not reached on failure must stay NULL so they can be freed
+    memset(&attr.value, 0, sizeof(attr.value));
+
+    sai_status_t status = sai_visit_attr_value(type, attr.value, deserializer);
+
+    if (status != SAI_STATUS_SUCCESS && context == NULL)
+    {
+        // lists decoded before failure are released here, caller
+        // frees attribute only when deserialize succeeded
+
+        sai_deserialize_free_attribute_value(type, attr);
+    }
+
+    return status;
+}
+
+static sai_status_t sai_deserialize_attr_value(
+        _In_ const sai_serialization_format_t format,
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _Inout_ size_t &offset,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext *context)
+{
+    if (format == SAI_SERIALIZATION_FORMAT_BINARY)
+    {
+        return sai_deserialize_attr_value<BinaryDeserializer>(buffer, size, offset, type, attr, context);
+    }
+
+    return sai_deserialize_attr_value<HexDeserializer>(buffer, size, offset, type, attr, context);
+}
+
+static sai_status_t sai_deserialize_attr_value(
+        _In_ const sai_serialization_format_t format,
+        _In_ const std::string &s,
+        _Inout_ int &index,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext *context)
+{
+    if (index < 0)
+    {
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    size_t offset = index;
+
+    sai_status_t status = sai_deserialize_attr_value(format, s.data(), s.size(), offset, type, attr, context);
+
+    index = (int)offset;
+
+    return status;
+}
+
+sai_status_t sai_deserialize_attr_value(
+        _In_ std::string &s,
+        _In_ int &index,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr)
+{
+    return sai_deserialize_attr_value(SAI_SERIALIZATION_FORMAT_HEX, s, index, type, attr, NULL);
+}
+
+sai_status_t sai_deserialize_attr_value(
+        _In_ std::string &s,
+        _In_ int &index,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext &context)
+{
+    return sai_deserialize_attr_value(SAI_SERIALIZATION_FORMAT_HEX, s, index, type, attr, &context);
+}
+
+sai_status_t sai_binary_deserialize_attr_value(
+        _In_ const std::string &s,
+        _Inout_ int &index,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr)
+{
+    return sai_deserialize_attr_value(SAI_SERIALIZATION_FORMAT_BINARY, s, index, type, attr, NULL);
+}
+
+sai_status_t sai_binary_deserialize_attr_value(
+        _In_ const std::string &s,
+        _Inout_ int &index,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext &context)
+{
+    return sai_deserialize_attr_value(SAI_SERIALIZATION_FORMAT_BINARY, s, index, type, attr, &context);
+}
+
+sai_status_t sai_deserialize_attr_value(
+        _In_ const sai_serialization_format_t format,
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _In_ const sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr,
+        _In_ SaiDeserializeContext &context)
+{
+    size_t offset = 0;
+
+    sai_status_t status = sai_deserialize_attr_value(format, buffer, size, offset, type, attr, &context);
+
+    if (status == SAI_STATUS_SUCCESS && offset != size)
+    {
+        // value must occupy whole field, trailing data means wrong type
+        return SAI_STATUS_INVALID_PARAMETER;
+    }
+
+    return status;
+}
+
+sai_status_t sai_deserialize_attr_id(
+        _In_ const sai_serialization_format_t format,
+        _In_ const char *buffer,
+        _In_ size_t size,
+        _Out_ sai_attr_id_t &attr_id)
+{
+    size_t offset = 0;
+
+    if (format == SAI_SERIALIZATION_FORMAT_BINARY)
+    {
+        uint64_t value;
+
+        if (!sai_binary_deserialize_varint(buffer, size, offset, value) || value > UINT32_MAX)
+        {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+
+        attr_id = (sai_attr_id_t)value;
+    }
+    else
+    {
+        HexDeserializer deserializer(buffer, size, offset, NULL);
+
+        if (!deserializer.primitive(attr_id))
+        {
+            return SAI_STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    return offset == size ? SAI_STATUS_SUCCESS : SAI_STATUS_INVALID_PARAMETER;
+}
+
+sai_status_t sai_deserialize_attr_list(
+        _In_ const sai_serialization_format_t format,
+        _In_ const sai_object_type_t object_type,
+        _In_ uint32_t count,
+        _In_ const sai_serialized_view_t *fvs,
+        _Out_ sai_attribute_t *attr_list,
+        _In_ SaiDeserializeContext &context)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const sai_serialized_view_t &field = fvs[2 * i];
+        const sai_serialized_view_t &value = fvs[2 * i + 1];
+
+        sai_attribute_t &attr = attr_list[i];
+
+        sai_status_t status = sai_deserialize_attr_id(format, field.data, field.size, attr.id);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            return status;
+        }
+
+        sai_attr_serialization_type_t serialization_type;
+
+        status = sai_get_serialization_type(object_type, attr.id, serialization_type);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            return status;
+        }
+
+        status = sai_deserialize_attr_value(format, value.data, value.size, serialization_type, attr, context);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            return status;
+        }
+    }
+
     return SAI_STATUS_SUCCESS;
 }
@@ -0,0 +1,379 @@
+#!/usr/bin/env python
+#
+# Generates attribute serialization tables from SAI headers.
+#
+# Every attribute enum sai_*_attr_t in inc/*.h is parsed and the type
+# annotation from attribute comment (for example [sai_object_id_t]) is
+# translated to sai_attr_serialization_type_t. Output contains direct
+# indexed constexpr arrays per object type so sai_get_serialization_type
+# is a table lookup and nothing needs to be built at library load time.
+#
+# usage: sai_serialize_gen.py <sai include dir> <output file>
+
+import glob
+import io
+import os
+import re
+import sys
+
+# attribute enum -> object type
+
+ATTR_ENUM_OBJECT_TYPE = {
+    'sai_acl_table_attr_t':                     'SAI_OBJECT_TYPE_ACL_TABLE',
+    'sai_acl_entry_attr_t':                     'SAI_OBJECT_TYPE_ACL_ENTRY',
+    'sai_acl_counter_attr_t':                   'SAI_OBJECT_TYPE_ACL_COUNTER',
+    'sai_ingress_priority_group_attr_t':        'SAI_OBJECT_TYPE_PRIORITY_GROUP',
+    'sai_buffer_pool_attr_t':                   'SAI_OBJECT_TYPE_BUFFER_POOL',
+    'sai_buffer_profile_attr_t':                'SAI_OBJECT_TYPE_BUFFER_PROFILE',
+    'sai_fdb_entry_attr_t':                     'SAI_OBJECT_TYPE_FDB',
+    'sai_hash_attr_t':                          'SAI_OBJECT_TYPE_HASH',
+    'sai_hostif_trap_group_attr_t':             'SAI_OBJECT_TYPE_TRAP_GROUP',
+    'sai_hostif_trap_attr_t':                   'SAI_OBJECT_TYPE_TRAP',
+    'sai_hostif_user_defined_trap_attr_t':      'SAI_OBJECT_TYPE_TRAP_USER_DEF',
+    'sai_hostif_attr_t':                        'SAI_OBJECT_TYPE_HOST_INTERFACE',
+    'sai_lag_attr_t':                           'SAI_OBJECT_TYPE_LAG',
+    'sai_lag_member_attr_t':                    'SAI_OBJECT_TYPE_LAG_MEMBER',
+    'sai_mirror_session_attr_t':                'SAI_OBJECT_TYPE_MIRROR',
+    'sai_neighbor_attr_t':                      'SAI_OBJECT_TYPE_NEIGHBOR',
+    'sai_next_hop_attr_t':                      'SAI_OBJECT_TYPE_NEXT_HOP',
+    'sai_next_hop_group_attr_t':                'SAI_OBJECT_TYPE_NEXT_HOP_GROUP',
+    'sai_policer_attr_t':                       'SAI_OBJECT_TYPE_POLICER',
+    'sai_port_attr_t':                          'SAI_OBJECT_TYPE_PORT',
+    'sai_qos_map_attr_t':                       'SAI_OBJECT_TYPE_QOS_MAPS',
+    'sai_queue_attr_t':                         'SAI_OBJECT_TYPE_QUEUE',
+    'sai_route_attr_t':                         'SAI_OBJECT_TYPE_ROUTE',
+    'sai_virtual_router_attr_t':                'SAI_OBJECT_TYPE_VIRTUAL_ROUTER',
+    'sai_router_interface_attr_t':              'SAI_OBJECT_TYPE_ROUTER_INTERFACE',
+    'sai_samplepacket_attr_t':                  'SAI_OBJECT_TYPE_SAMPLEPACKET',
+    'sai_scheduler_attr_t':                     'SAI_OBJECT_TYPE_SCHEDULER',
+    'sai_scheduler_group_attr_t':               'SAI_OBJECT_TYPE_SCHEDULER_GROUP',
+    'sai_stp_attr_t':                           'SAI_OBJECT_TYPE_STP_INSTANCE',
+    'sai_switch_attr_t':                        'SAI_OBJECT_TYPE_SWITCH',
+    'sai_tunnel_map_attr_t':                    'SAI_OBJECT_TYPE_TUNNEL_MAP',
+    'sai_tunnel_attr_t':                        'SAI_OBJECT_TYPE_TUNNEL',
+    'sai_tunnel_term_table_entry_attr_t':       'SAI_OBJECT_TYPE_TUNNEL_TABLE_ENTRY',
+    'sai_udf_attr_t':                           'SAI_OBJECT_TYPE_UDF',
+    'sai_udf_match_attr_t':                     'SAI_OBJECT_TYPE_UDF_MATCH',
+    'sai_udf_group_attr_t':                     'SAI_OBJECT_TYPE_UDF_GROUP',
+    'sai_vlan_attr_t':                          'SAI_OBJECT_TYPE_VLAN',
+    'sai_wred_attr_t':                          'SAI_OBJECT_TYPE_WRED',
+}
+
+# annotated C type -> serialization type suffix
+
+TYPE_SERIALIZATION = {
+    'bool':                     'BOOL',
+    'char':                     'CHARDATA',
+    'uint8_t':                  'UINT8',
+    'sai_uint8_t':              'UINT8',
+    'sai_cos_t':                'UINT8',
+    'sai_queue_index_t':        'UINT8',
+    'int8_t':                   'INT8',
+    'sai_int8_t':               'INT8',
+    'uint16_t':                 'UINT16',
+    'sai_uint16_t':             'UINT16',
+    'sai_vlan_id_t':            'UINT16',
+    'int16_t':                  'INT16',
+    'sai_int16_t':              'INT16',
+    'uint32_t':                 'UINT32',
+    'sai_uint32_t':             'UINT32',
+    'int32_t':                  'INT32',
+    'sai_int32_t':              'INT32',
+    'uint64_t':                 'UINT64',
+    'sai_uint64_t':             'UINT64',
+    'int64_t':                  'INT64',
+    'sai_int64_t':              'INT64',
+    'sai_mac_t':                'MAC',
+    'sai_ip4_t':                'IP4',
+    'sai_ip6_t':                'IP6',
+    'sai_ip_address_t':         'IP_ADDRESS',
+    'sai_object_id_t':          'OBJECT_ID',
+    'sai_object_list_t':        'OBJECT_LIST',
+    'sai_u8_list_t':            'UINT8_LIST',
+    'sai_s8_list_t':            'INT8_LIST',
+    'sai_u16_list_t':           'UINT16_LIST',
+    'sai_s16_list_t':           'INT16_LIST',
+    'sai_u32_list_t':           'UINT32_LIST',
+    'sai_s32_list_t':           'INT32_LIST',
+    'sai_u32_range_t':          'UINT32_RANGE',
+    'sai_s32_range_t':          'INT32_RANGE',
+    'sai_vlan_list_t':          'VLAN_LIST',
+    'sai_vlan_port_list_t':     'VLAN_PORT_LIST',
+    'sai_port_breakout_t':      'PORT_BREAKOUT',
+    'sai_qos_map_list_t':       'QOS_MAP_LIST',
+    'sai_tunnel_map_list_t':    'TUNNEL_MAP_LIST',
+}
+
+# ACL field and action data use own serialization types
+
+ACL_FIELD_SERIALIZATION = {
+    'BOOL': 'UINT8', 'UINT8': 'UINT8', 'INT8': 'INT8', 'UINT16': 'UINT16', 'INT16': 'INT16',
+    'UINT32': 'UINT32', 'INT32': 'INT32', 'MAC': 'MAC', 'IP4': 'IP4',
+    'IP6': 'IP6', 'OBJECT_ID': 'OBJECT_ID', 'OBJECT_LIST': 'OBJECT_LIST',
+    'UINT8_LIST': 'UINT8_LIST',
+}
+
+ACL_ACTION_SERIALIZATION = {
+    'UINT8': 'UINT8', 'INT8': 'INT8', 'UINT16': 'UINT16', 'INT16': 'INT16',
+    'UINT32': 'UINT32', 'INT32': 'INT32', 'MAC': 'MAC', 'IP4': 'IPV4',
+    'IP6': 'IPV6', 'OBJECT_ID': 'OBJECT_ID', 'OBJECT_LIST': 'OBJECT_LIST',
+}
+
+# attributes which have no usable type annotation in headers
+
+ATTR_SERIALIZATION_OVERRIDE = {
+    'SAI_ACL_TABLE_ATTR_FIELD_FDB_DST_USER_META':           'BOOL',
+    'SAI_ACL_ENTRY_ATTR_FIELD_FDB_DST_USER_META':           'ACL_FIELD_DATA_UINT32',
+    'SAI_ACL_ENTRY_ATTR_FIELD_ROUTE_DST_USER_META':         'ACL_FIELD_DATA_UINT32',
+    'SAI_ACL_ENTRY_ATTR_FIELD_NEIGHBOR_USER_META':          'ACL_FIELD_DATA_UINT32',
+    'SAI_ACL_ENTRY_ATTR_FIELD_PORT_USER_META':              'ACL_FIELD_DATA_UINT32',
+    'SAI_ACL_ENTRY_ATTR_FIELD_VLAN_USER_META':              'ACL_FIELD_DATA_UINT32',
+    'SAI_ACL_ENTRY_ATTR_FIELD_ACL_USER_META':               'ACL_FIELD_DATA_UINT32',
+    'SAI_ACL_ENTRY_ATTR_FIELD_NEIGHBOR_NPU_META_DST_HIT':   'ACL_FIELD_DATA_UINT8',
+    'SAI_ACL_ENTRY_ATTR_ACTION_FLOOD':                      'ACL_ACTION_DATA_UINT8',
+    'SAI_ACL_ENTRY_ATTR_ACTION_DECREMENT_TTL':              'ACL_ACTION_DATA_UINT8',
+    'SAI_BUFFER_POOL_ATTR_TH_MODE':                         'INT32',
+    'SAI_TUNNEL_TERM_TABLE_ENTRY_ATTR_TYPE':                'INT32',
+    'SAI_SAMPLEPACKET_ATTR_SAMPLE_RATE':                    'UINT32',
+    'SAI_SWITCH_ATTR_QOS_DEFAULT_TC':                       'UINT8',
+}
+
+# new range is started when ids are further apart than this
+RANGE_GAP = 16
+
+def strip_comments(text):
+    return re.sub(r'//[^\n]*', '', re.sub(r'/\*.*?\*/', '', text, flags=re.S))
+
+def parse_defines(text):
+    defines = {}
+    for m in re.finditer(r'^\s*#define\s+(\w+)\s+(0x[0-9a-fA-F]+|\d+)\s*$', text, re.M):
+        defines[m.group(1)] = int(m.group(2), 0)
+    return defines
+
+def parse_enum_types(text):
+    return set(m.group(1) for m in re.finditer(r'typedef\s+enum\s+\w*\s*\{.*?\}\s*(\w+)\s*;', text, re.S))
+
+def eval_value(expr, values, defines):
+    expr = expr.strip()
+    total = 0
+    for term in expr.split('+'):
+        term = term.strip()
+        if term in values:
+            total += values[term]
+        elif term in defines:
+            total += defines[term]
+        else:
+            total += int(term, 0)
+    return total
+
+def parse_annotation(comment, enum_types):
+    # first bracket which names a known type is the attribute type,
+    # type may be followed by bit width or element type, for example
+    # [sai_uint8_t : 3] or [sai_s32_list_t(sai_native_hash_field)]
+    for m in re.finditer(r'\[([^\[\]]*(?:\[[^\]]*\])?)\]', comment):
+        annotation = m.group(1).strip()
+        annotation = re.sub(r'\s*:\s*\d+$', '', annotation)
+        annotation = re.sub(r'\s+of\s+\w+$', '', annotation)
+        annotation = re.sub(r'\[.*\]$', '', annotation).strip()
+        inner = re.match(r'^(\w+)\s*\(\s*(\w+)\s*\)$', annotation)
+        if inner:
+            annotation = inner.group(1)
+            if annotation in ('sai_acl_field_data_t', 'sai_acl_action_data_t'):
+                annotation = inner.group(2)
+        if annotation in TYPE_SERIALIZATION:
+            return TYPE_SERIALIZATION[annotation]
+        if annotation in enum_types or annotation + '_t' in enum_types:
+            return 'INT32'
+    # some enum attributes name their type only in text
+    for word in re.findall(r'\bsai_\w+_t\b', comment):
+        if word in enum_types:
+            return 'INT32'
+    return None
+
+def parse_attr_enum(body, values, defines, enum_types):
+    attrs = []
+    pending_comment = ''
+    current = -1
+    pos = 0
+    token = re.compile(r'\s*(/\*.*?\*/|//[^\n]*|(\w+)\s*(?:=\s*([^,]+?))?\s*(?:,|$))', re.S)
+    while pos < len(body):
+        m = token.match(body, pos)
+        if not m or m.end() == pos:
+            break
+        pos = m.end()
+        if m.group(1).startswith('/'):
+            pending_comment += m.group(1)
+            continue
+        name = m.group(2)
+        if name is None:
+            continue
+        if m.group(3) is not None:
+            current = eval_value(m.group(3), values, defines)
+        else:
+            current += 1
+        values[name] = current
+        attrs.append((name, current, pending_comment))
+        pending_comment = ''
+    return attrs
+
+def is_marker(name):
+    return re.search(r'_(START|END|MIN|MAX|CUSTOM_RANGE_BASE)$', name) is not None
+
+def acl_serialization(enum_name, value, base, values):
+    if enum_name == 'sai_acl_entry_attr_t':
+        if values['SAI_ACL_ENTRY_ATTR_FIELD_START'] <= value <= values['SAI_ACL_ENTRY_ATTR_FIELD_END']:
+            return 'ACL_FIELD_DATA_' + ACL_FIELD_SERIALIZATION[base] if base in ACL_FIELD_SERIALIZATION else None
+        if values['SAI_ACL_ENTRY_ATTR_ACTION_START'] <= value <= values['SAI_ACL_ENTRY_ATTR_ACTION_END']:
+            return 'ACL_ACTION_DATA_' + ACL_ACTION_SERIALIZATION[base] if base in ACL_ACTION_SERIALIZATION else None
+    return base
+
+def attr_serializations(enum_name, attrs, values, enum_types):
+    # attribute without own type annotation takes type from group
+    # comment above *_START marker, or from previous attribute when
+    # it has no comment at all (several attributes documented once)
+    group = None
+    previous = None
+    read_only = False
+    for name, value, comment in attrs:
+        base = parse_annotation(comment, enum_types)
+        # READ-ONLY/READ-WRITE section comments are merged into comment
+        # of next attribute, some headers put create attributes under
+        # READ-ONLY so create flags win over section
+        if 'READ-WRITE' in comment:
+            read_only = False
+        elif 'READ-ONLY' in comment:
+            read_only = True
+        if is_marker(name):
+            if name.endswith('_START'):
+                group = base
+            elif name.endswith('_END'):
+                group = None
+            previous = None
+            continue
+        if name in ATTR_SERIALIZATION_OVERRIDE:
+            serialization = ATTR_SERIALIZATION_OVERRIDE[name]
+        else:
+            if base is None:
+                base = group if comment.strip() else previous
+            serialization = acl_serialization(enum_name, value, base, values) if base else None
+        previous = base
+        yield name, value, serialization, read_only and not re.search(r'CREATE_ONLY|CREATE_AND_SET|MANDATORY_ON_CREATE', comment)
+
+def parse_object_types(text):
+    m = re.search(r'typedef\s+enum\s+_sai_object_type_t\s*\{(.*?)\}', text, re.S)
+    types = []
+    for name, value in re.findall(r'(SAI_OBJECT_TYPE_\w+)\s*=\s*(\d+)', m.group(1)):
+        types.append((name, int(value)))
+    return types
+
+def split_ranges(entries):
+    ranges = []
+    for entry in sorted(entries, key=lambda e: e[1]):
+        if ranges and entry[1] - ranges[-1][-1][1] <= RANGE_GAP:
+            ranges[-1].append(entry)
+        else:
+            ranges.append([entry])
+    return ranges
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write('usage: %s <sai include dir> <output file>\n' % sys.argv[0])
+        return 1
+
+    headers = sorted(glob.glob(os.path.join(sys.argv[1], 'sai*.h')))
+
+    raw = dict((h, io.open(h, encoding="latin-1").read()) for h in headers)
+
+    defines = {}
+    enum_types = set()
+    for text in raw.values():
+        defines.update(parse_defines(text))
+        enum_types |= parse_enum_types(strip_comments(text))
+
+    values = {}
+    tables = {}
+    unsupported = []
+
+    for header in headers:
+        for m in re.finditer(r'typedef\s+enum\s+_(sai_\w+_attr_t)\s*\{(.*?)\}\s*(\w+)\s*;', raw[header], re.S):
+            enum_name = m.group(1)
+            if enum_name not in ATTR_ENUM_OBJECT_TYPE:
+                continue
+            entries = []
+            attrs = parse_attr_enum(m.group(2), values, defines, enum_types)
+            for name, value, serialization, read_only in attr_serializations(enum_name, attrs, values, enum_types):
+                if serialization is not None:
+                    entries.append((name, value, 'SAI_SERIALIZATION_TYPE_' + serialization, read_only))
+                elif not is_marker(name):
+                    unsupported.append(name)
+            tables[ATTR_ENUM_OBJECT_TYPE[enum_name]] = (enum_name, split_ranges(entries))
+
+    object_types = parse_object_types(raw[os.path.join(sys.argv[1], 'saitypes.h')])
+
+    out = []
+    out.append('// generated by sai_serialize_gen.py from SAI headers, do not edit')
+    out.append('')
+    out.append('#include "sai_serialize.h"')
+    out.append('')
+
+    for object_type, (enum_name, ranges) in sorted(tables.items()):
+        prefix = enum_name[:-2]
+        for index, entries in enumerate(ranges):
+            start = entries[0][1]
+            out.append('constexpr sai_attr_serialization_type_t %s_serialization_%d[] = {' % (prefix, index))
+            by_value = dict((value, serialization) for name, value, serialization, read_only in entries)
+            names = dict((value, name) for name, value, serialization, read_only in entries)
+            for value in range(start, entries[-1][1] + 1):
+                if value in by_value:
+                    out.append('    %s, // %s' % (by_value[value], names[value]))
+                else:
+                    out.append('    SAI_SERIALIZATION_TYPE_NONE,')
+            out.append('};')
+            out.append('')
+            flags = dict((value, 'SAI_ATTR_FLAG_READ_ONLY' if read_only else '0') for name, value, serialization, read_only in entries)
+            out.append('constexpr uint8_t %s_flags_%d[] = {' % (prefix, index))
+            for value in range(start, entries[-1][1] + 1):
+                out.append('    %s,' % flags.get(value, '0'))
+            out.append('};')
+            out.append('')
+            for name, value, serialization, read_only in entries:
+                out.append('static_assert(%s == 0x%x, "%s changed, regenerate table");' % (name, value, name))
+            out.append('')
+
+        out.append('constexpr sai_attr_serialization_range_t %s_serialization[] = {' % prefix)
+        for index, entries in enumerate(ranges):
+            out.append('    { 0x%x, %d, %s_serialization_%d, %s_flags_%d },' % (entries[0][1], entries[-1][1] - entries[0][1] + 1, prefix, index, prefix, index))
+        out.append('};')
+        out.append('')
+
+    out.append('const sai_attr_serialization_table_t g_attr_serialization_table[SAI_OBJECT_TYPE_MAX] = {')
+    for name, value in object_types:
+        if name == 'SAI_OBJECT_TYPE_MAX':
+            continue
+        if name in tables and tables[name][1]:
+            prefix = tables[name][0][:-2]
+            out.append('    { %d, %s_serialization }, // %s' % (len(tables[name][1]), prefix, name))
+        else:
+            out.append('    { 0, NULL }, // %s' % name)
+    out.append('};')
+    out.append('')
+
+    out.append('const char* const g_object_type_name_table[SAI_OBJECT_TYPE_MAX] = {')
+    for name, value in object_types:
+        if name != 'SAI_OBJECT_TYPE_MAX':
+            out.append('    "%s",' % name)
+    out.append('};')
+    out.append('')
+
+    for name in unsupported:
+        sys.stderr.write('%s: no serialization type annotation, attribute skipped\n' % name)
+
+    output = sys.argv[2]
+    with open(output + '.tmp', 'w') as f:
+        f.write('\n'.join(out))
+    os.rename(output + '.tmp', output)
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
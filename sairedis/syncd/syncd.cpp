@@ -0,0 +1,1410 @@
+// SAI library applied to is C, like stub SAI
+extern "C" {
+#include "sai.h"
+}
+
+#include "sai_redis.h"
+#include "sai_redis_shm_consumer.h"
+#include "sai_redis_journal.h"
+
+#include "syncd_vid_rid_map.h"
+
+#include "sswcommon/select.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <string>
+
+/*
+ * Consumer of ASIC_STATE which applies operations written by sairedis
+ * to SAI library it is linked with, stub SAI by default.
+ *
+ * syncd [-t redis|shm] [-b batch_size] [-i stats_interval_s] [-r]
+ *       [-w map_file] [-j journal_name] [-u unix_socket | -H host -P port]
+ *       [-d db] [-n shm_name] [-k key=value]...
+ *
+ * -t   transport sairedis writes with, SAI_REDIS_TRANSPORT
+ * -b   max number of operations popped and applied as one batch
+ * -i   interval of throughput and latency report, 0 disables it
+ * -r   before consuming, creates objects already in ASIC_STATE table,
+ *      as after restart of this daemon, needs redis for any transport
+ * -w   warm restart, id map is loaded from file at start and saved to
+ *      it on exit, replay does not create objects whose id is mapped
+ * -j   change journal sairedis writes, SAI_REDIS_JOURNAL_NAME, with -w
+ *      operations after position saved with id map are applied from
+ *      journal at start, table is replayed only when journal no longer
+ *      has them
+ * -k   profile value passed to sai_api_initialize
+ *
+ * Operations are popped in batches, all attributes of batch are
+ * deserialized into one arena which is reset per batch, and applied in
+ * order they were written. Format of every operation is taken from its
+ * key, so hex and binary producers may share table. Virtual ids in
+ * keys and attributes are translated to ids returned by SAI creates,
+ * ids which were not created through ASIC_STATE (ports, queues, switch
+ * defaults) are passed unchanged and counted as untranslated.
+ *
+ * Latency is measured per operation from start of pop of its batch to
+ * return of SAI call, so it includes wait behind earlier operations of
+ * batch but not time spent in transport, producer and consumer don't
+ * share timestamp.
+ */
+
+#define SYNCD_DEFAULT_STATS_INTERVAL    10
+
+// consumer checks for stop and report at least this often
+#define SYNCD_SELECT_TIMEOUT_MS         1000
+
+// empty shared memory ring is polled, first by yield then by sleep
+#define SYNCD_SHM_SPIN_COUNT            1000
+#define SYNCD_SHM_IDLE_US               50
+
+// every 16th operation is timed, keeps sample memory bounded at high rate
+#define SYNCD_LATENCY_SAMPLE_MASK       15
+
+// sequences consumed out of order kept before journal is asked about
+// gaps below them
+#define SYNCD_SEQUENCE_BACKLOG          1024
+
+#define SYNCD_METHOD_NONE               (-1)
+
+/*
+ * Indexes of create, remove and set in method table of api, by common
+ * api. Get is never written to ASIC_STATE, sairedis reads objects from
+ * table directly.
+ */
+typedef struct _syncd_object_methods_t
+{
+    sai_api_t api;
+    sai_object_type_t object_type;
+    int method[SAI_COMMON_API_GET];
+
+} syncd_object_methods_t;
+
+#define SYNCD_OBJECT(api, ot, c, r, s) { api, ot, { c, r, s } }
+
+static const syncd_object_methods_t g_objectMethods[] = {
+    SYNCD_OBJECT(SAI_API_ACL, SAI_OBJECT_TYPE_ACL_TABLE, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_ACL, SAI_OBJECT_TYPE_ACL_ENTRY, 4, 5, 6),
+    SYNCD_OBJECT(SAI_API_ACL, SAI_OBJECT_TYPE_ACL_COUNTER, 8, 9, 10),
+    SYNCD_OBJECT(SAI_API_BUFFERS, SAI_OBJECT_TYPE_BUFFER_POOL, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_BUFFERS, SAI_OBJECT_TYPE_PRIORITY_GROUP, SYNCD_METHOD_NONE, SYNCD_METHOD_NONE, 5),
+    SYNCD_OBJECT(SAI_API_BUFFERS, SAI_OBJECT_TYPE_BUFFER_PROFILE, 9, 10, 11),
+    SYNCD_OBJECT(SAI_API_FDB, SAI_OBJECT_TYPE_FDB, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_HASH, SAI_OBJECT_TYPE_HASH, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_HOST_INTERFACE, SAI_OBJECT_TYPE_HOST_INTERFACE, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_HOST_INTERFACE, SAI_OBJECT_TYPE_TRAP_GROUP, 4, 5, 6),
+    SYNCD_OBJECT(SAI_API_LAG, SAI_OBJECT_TYPE_LAG, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_LAG, SAI_OBJECT_TYPE_LAG_MEMBER, 4, 5, 6),
+    SYNCD_OBJECT(SAI_API_MIRROR, SAI_OBJECT_TYPE_MIRROR, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_NEIGHBOR, SAI_OBJECT_TYPE_NEIGHBOR, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_NEXT_HOP, SAI_OBJECT_TYPE_NEXT_HOP, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_NEXT_HOP_GROUP, SAI_OBJECT_TYPE_NEXT_HOP_GROUP, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_POLICER, SAI_OBJECT_TYPE_POLICER, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_PORT, SAI_OBJECT_TYPE_PORT, SYNCD_METHOD_NONE, SYNCD_METHOD_NONE, 0),
+    SYNCD_OBJECT(SAI_API_QOS_MAPS, SAI_OBJECT_TYPE_QOS_MAPS, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_QUEUE, SAI_OBJECT_TYPE_QUEUE, SYNCD_METHOD_NONE, SYNCD_METHOD_NONE, 0),
+    SYNCD_OBJECT(SAI_API_ROUTE, SAI_OBJECT_TYPE_ROUTE, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_VIRTUAL_ROUTER, SAI_OBJECT_TYPE_VIRTUAL_ROUTER, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_ROUTER_INTERFACE, SAI_OBJECT_TYPE_ROUTER_INTERFACE, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_SAMPLEPACKET, SAI_OBJECT_TYPE_SAMPLEPACKET, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_SCHEDULER, SAI_OBJECT_TYPE_SCHEDULER, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_SCHEDULER_GROUP, SAI_OBJECT_TYPE_SCHEDULER_GROUP, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_SWITCH, SAI_OBJECT_TYPE_SWITCH, SYNCD_METHOD_NONE, SYNCD_METHOD_NONE, 4),
+    SYNCD_OBJECT(SAI_API_UDF, SAI_OBJECT_TYPE_UDF, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_UDF, SAI_OBJECT_TYPE_UDF_MATCH, 4, 5, 6),
+    SYNCD_OBJECT(SAI_API_UDF, SAI_OBJECT_TYPE_UDF_GROUP, 8, 9, 10),
+    SYNCD_OBJECT(SAI_API_VLAN, SAI_OBJECT_TYPE_VLAN, 0, 1, 2),
+    SYNCD_OBJECT(SAI_API_WRED, SAI_OBJECT_TYPE_WRED, 0, 1, 2),
+};
+
+// methods of SAI library, NULL when library does not implement api
+static void *g_methods[SAI_OBJECT_TYPE_MAX][SAI_COMMON_API_GET];
+
+/*
+ * Operation decoded from ASIC_STATE key and op, id points to key.
+ */
+typedef struct _syncd_operation_t
+{
+    sai_serialization_format_t format;
+    sai_object_type_t object_type;
+    sai_common_api_t api;
+
+    const char *id;
+    size_t id_size;
+
+    // stamped by change journal of sairedis, 0 when op has none
+    uint64_t sequence;
+
+} syncd_operation_t;
+
+typedef enum _syncd_result_t
+{
+    SYNCD_APPLIED,
+
+    // malformed or SAI has no method for it
+    SYNCD_DROPPED,
+
+    // references object which startup replay did not create yet
+    SYNCD_DEFERRED,
+
+    // was applied from change journal at start
+    SYNCD_SKIPPED,
+
+} syncd_result_t;
+
+typedef struct _syncd_stats_t
+{
+    uint64_t applied;
+    uint64_t failed;
+    uint64_t malformed;
+    uint64_t unsupported;
+    uint64_t untranslated;
+    uint64_t skipped;
+    uint64_t batches;
+
+    // time spent applying batches, throughput while consumer is busy
+    uint64_t busy_ns;
+
+    // sampled, from pop of batch to applied and of SAI call alone
+    std::vector<uint64_t> latency;
+    std::vector<uint64_t> call;
+
+} syncd_stats_t;
+
+static syncd_stats_t g_stats;
+
+static volatile sig_atomic_t g_running = 1;
+
+static std::map<std::string, std::string> g_profile;
+
+// virtual id written by sairedis to real id returned by SAI
+static VidRidMap g_map;
+
+// during startup replay, virtual ids of objects not created yet
+static const std::unordered_set<sai_object_id_t> *g_pendingVids = NULL;
+
+// set when operation references object in g_pendingVids
+static bool g_deferred;
+
+// every sequence up to this one was consumed or skipped by sairedis,
+// saved with id map, 0 when not known
+static uint64_t g_sequence;
+
+// sequences above g_sequence consumed, threads of sairedis stamp and
+// write operations in different order
+static std::set<uint64_t> g_sequences;
+
+// journal which tells which sequences sairedis skipped
+static RedisChangeJournal *g_journal = NULL;
+
+// operations up to this sequence were applied from change journal at
+// start, when transport delivers them again they are skipped
+static uint64_t g_journalSequence;
+
+const char* syncd_profile_get_value(
+        _In_ sai_switch_profile_id_t profile_id,
+        _In_ const char* variable)
+{
+    auto it = g_profile.find(variable);
+
+    return (it == g_profile.end()) ? NULL : it->second.c_str();
+}
+
+int syncd_profile_get_next_value(
+        _In_ sai_switch_profile_id_t profile_id,
+        _Out_ const char** variable,
+        _Out_ const char** value)
+{
+    return -1;
+}
+
+static const service_method_table_t g_syncd_services = {
+    syncd_profile_get_value,
+    syncd_profile_get_next_value
+};
+
+static void syncd_signal_handler(
+        _In_ int signal)
+{
+    g_running = 0;
+}
+
+static inline uint64_t syncd_now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool syncd_is_pending(
+        _In_ const sai_object_id_t *ids,
+        _In_ uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (g_pendingVids->count(ids[i]) != 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Translates ids in place, ids of objects which replay did not create
+ * yet defer operation.
+ */
+static void syncd_translate(
+        _Inout_ sai_object_id_t *ids,
+        _In_ uint32_t count)
+{
+    if (g_pendingVids != NULL && syncd_is_pending(ids, count))
+    {
+        g_deferred = true;
+    }
+
+    g_stats.untranslated += g_map.translateVidToRid(ids, count);
+}
+
+static sai_object_id_t syncd_translate(
+        _In_ sai_object_id_t vid)
+{
+    syncd_translate(&vid, 1);
+
+    return vid;
+}
+
+/*
+ * Splits key to object type and serialized id, format is told by first
+ * byte, and decodes op in same format.
+ */
+static bool syncd_parse_operation(
+        _In_ const std::string &key,
+        _In_ const std::string &op,
+        _Out_ syncd_operation_t &operation)
+{
+    size_t offset = 0;
+
+    if (!key.empty() && key[0] == SAI_BINARY_FORMAT_VERSION)
+    {
+        uint64_t object_type;
+
+        offset = 1;
+
+        if (!sai_binary_deserialize_varint(key.data(), key.size(), offset, object_type))
+        {
+            return false;
+        }
+
+        operation.format = SAI_SERIALIZATION_FORMAT_BINARY;
+        operation.object_type = (sai_object_type_t)object_type;
+    }
+    else
+    {
+        operation.format = SAI_SERIALIZATION_FORMAT_HEX;
+
+        if (!sai_deserialize_primitive(operation.format, key.data(), key.size(), offset, operation.object_type) ||
+                offset >= key.size() || key[offset] != ':')
+        {
+            return false;
+        }
+
+        offset++;
+    }
+
+    operation.id = key.data() + offset;
+    operation.id_size = key.size() - offset;
+
+    size_t op_offset = 0;
+
+    operation.sequence = 0;
+
+    if (operation.object_type <= SAI_OBJECT_TYPE_NULL ||
+            operation.object_type >= SAI_OBJECT_TYPE_MAX ||
+            !sai_deserialize_primitive(operation.format, op.data(), op.size(), op_offset, operation.api))
+    {
+        return false;
+    }
+
+    // sequence follows common api when sairedis writes change journal
+    return op_offset == op.size() ||
+        (sai_deserialize_primitive(operation.format, op.data(), op.size(), op_offset, operation.sequence) &&
+         op_offset == op.size());
+}
+
+template<typename T>
+static bool syncd_get_key(
+        _In_ const syncd_operation_t &operation,
+        _Out_ T &key)
+{
+    size_t offset = 0;
+
+    return sai_deserialize_primitive(operation.format, operation.id, operation.id_size, offset, key) &&
+        offset == operation.id_size;
+}
+
+/*
+ * Deserializes fields of operation to attributes, lists are allocated
+ * from context, object ids are translated.
+ */
+static bool syncd_build_attrs(
+        _In_ const syncd_operation_t &operation,
+        _In_ const std::vector<ssw::FieldValueTuple> &values,
+        _Out_ std::vector<sai_attribute_t> &attrs,
+        _Inout_ SaiDeserializeContext &context)
+{
+    attrs.resize(values.size());
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        sai_attribute_t &attr = attrs[i];
+
+        const std::string &id = fvField(values[i]);
+        const std::string &value = fvValue(values[i]);
+
+        sai_attr_serialization_type_t type;
+
+        if (sai_deserialize_attr_id(operation.format, id.data(), id.size(), attr.id) != SAI_STATUS_SUCCESS ||
+                sai_get_serialization_type(operation.object_type, attr.id, type) != SAI_STATUS_SUCCESS ||
+                sai_deserialize_attr_value(operation.format, value.data(), value.size(), type, attr, context) != SAI_STATUS_SUCCESS)
+        {
+            return false;
+        }
+
+        sai_object_id_t *ids;
+        uint32_t count;
+
+        // lists are translated in arena they were deserialized to
+        if (VidRidMap::getObjectIds(type, attr, ids, count))
+        {
+            syncd_translate(ids, count);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Calls create, remove or set, set is called once per attribute.
+ * Key is entry passed by pointer or value, object id or vlan id.
+ */
+template<typename K>
+static sai_status_t syncd_call(
+        _In_ void *fn,
+        _In_ sai_common_api_t api,
+        _In_ K key,
+        _In_ const std::vector<sai_attribute_t> &attrs)
+{
+    switch (api)
+    {
+        case SAI_COMMON_API_CREATE:
+            return ((sai_status_t (*)(K, uint32_t, const sai_attribute_t*))fn)(key, (uint32_t)attrs.size(), attrs.data());
+
+        case SAI_COMMON_API_REMOVE:
+            return ((sai_status_t (*)(K))fn)(key);
+
+        case SAI_COMMON_API_SET:
+
+            for (const auto &attr: attrs)
+            {
+                sai_status_t status = ((sai_status_t (*)(K, const sai_attribute_t*))fn)(key, &attr);
+
+                if (status != SAI_STATUS_SUCCESS)
+                {
+                    return status;
+                }
+            }
+
+            return SAI_STATUS_SUCCESS;
+
+        default:
+            return SAI_STATUS_NOT_SUPPORTED;
+    }
+}
+
+static sai_status_t syncd_call_switch(
+        _In_ void *fn,
+        _In_ const std::vector<sai_attribute_t> &attrs)
+{
+    for (const auto &attr: attrs)
+    {
+        sai_status_t status = ((sai_status_t (*)(const sai_attribute_t*))fn)(&attr);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+/*
+ * Create of vlan takes only vlan id, attributes which table holds for
+ * replayed vlan are set after it.
+ */
+static sai_status_t syncd_call_vlan(
+        _In_ void *fn,
+        _In_ sai_common_api_t api,
+        _In_ sai_vlan_id_t vlan_id,
+        _In_ const std::vector<sai_attribute_t> &attrs)
+{
+    if (api != SAI_COMMON_API_CREATE)
+    {
+        return syncd_call(fn, api, vlan_id, attrs);
+    }
+
+    sai_status_t status = ((sai_status_t (*)(sai_vlan_id_t))fn)(vlan_id);
+
+    void *set = g_methods[SAI_OBJECT_TYPE_VLAN][SAI_COMMON_API_SET];
+
+    if (status != SAI_STATUS_SUCCESS || attrs.empty())
+    {
+        return status;
+    }
+
+    return set == NULL ? SAI_STATUS_NOT_SUPPORTED : syncd_call(set, SAI_COMMON_API_SET, vlan_id, attrs);
+}
+
+static sai_status_t syncd_call_object(
+        _In_ void *fn,
+        _In_ sai_common_api_t api,
+        _In_ sai_object_id_t vid,
+        _In_ const std::vector<sai_attribute_t> &attrs)
+{
+    if (api != SAI_COMMON_API_CREATE)
+    {
+        sai_status_t status = syncd_call(fn, api, syncd_translate(vid), attrs);
+
+        if (status == SAI_STATUS_SUCCESS && api == SAI_COMMON_API_REMOVE)
+        {
+            g_map.erase(vid);
+        }
+
+        return status;
+    }
+
+    sai_object_id_t rid = SAI_NULL_OBJECT_ID;
+
+    sai_status_t status = syncd_call(fn, api, &rid, attrs);
+
+    if (status == SAI_STATUS_SUCCESS)
+    {
+        sai_object_id_t other = g_map.getVid(rid);
+
+        if (other != SAI_NULL_OBJECT_ID && other != vid)
+        {
+            fprintf(stderr, "SAI returned id 0x%lx of object 0x%lx for object 0x%lx\n", rid, other, vid);
+        }
+
+        g_map.insert(vid, rid);
+    }
+
+    return status;
+}
+
+/*
+ * Returns virtual id of object which create of SAI returns id for,
+ * false for entries and objects which SAI does not create.
+ */
+static bool syncd_get_created_vid(
+        _In_ const syncd_operation_t &operation,
+        _Out_ sai_object_id_t &vid)
+{
+    switch (operation.object_type)
+    {
+        case SAI_OBJECT_TYPE_FDB:
+        case SAI_OBJECT_TYPE_NEIGHBOR:
+        case SAI_OBJECT_TYPE_ROUTE:
+        case SAI_OBJECT_TYPE_VLAN:
+        case SAI_OBJECT_TYPE_SWITCH:
+            return false;
+
+        default:
+            return g_methods[operation.object_type][SAI_COMMON_API_CREATE] != NULL &&
+                syncd_get_key(operation, vid);
+    }
+}
+
+/*
+ * Moves g_sequence over consumed sequences, and when journal is
+ * asked also over sequences sairedis skipped. Sequence trimmed from
+ * journal before it was consumed can't be caught up from, position is
+ * not known again until next stamped operation.
+ */
+static void syncd_advance_sequence(
+        _In_ bool ask_journal)
+{
+    while (g_sequence != 0)
+    {
+        uint64_t next = g_sequence + 1;
+
+        if (!g_sequences.empty() && *g_sequences.begin() == next)
+        {
+            g_sequences.erase(g_sequences.begin());
+        }
+        else if (!ask_journal || g_journal == NULL || !g_journal->isSkipped(next))
+        {
+            if (ask_journal && g_journal != NULL && !g_sequences.empty() && next < g_journal->firstSequence())
+            {
+                fprintf(stderr, "change journal trimmed sequence %lu before it was consumed\n", next);
+
+                g_sequence = 0;
+                g_sequences.clear();
+            }
+
+            break;
+        }
+
+        g_sequence = next;
+    }
+}
+
+static void syncd_consumed(
+        _In_ uint64_t sequence)
+{
+    if (sequence <= g_sequence)
+    {
+        return;
+    }
+
+    if (g_sequence == 0)
+    {
+        // not known where consumer started, earlier sequences still in
+        // transport are taken as consumed
+        g_sequence = sequence;
+        return;
+    }
+
+    g_sequences.insert(sequence);
+
+    syncd_advance_sequence(g_sequences.size() > SYNCD_SEQUENCE_BACKLOG);
+}
+
+/*
+ * Applies one operation, status of SAI call is returned in status.
+ * Operation is deferred before any SAI call.
+ */
+static syncd_result_t syncd_apply(
+        _In_ const ssw::KeyOpFieldsValuesTuple &kco,
+        _Inout_ std::vector<sai_attribute_t> &attrs,
+        _Inout_ SaiDeserializeContext &context,
+        _Out_ sai_status_t &status)
+{
+    syncd_operation_t operation;
+
+    g_deferred = false;
+
+    if (!syncd_parse_operation(kfvKey(kco), kfvOp(kco), operation))
+    {
+        g_stats.malformed++;
+        return SYNCD_DROPPED;
+    }
+
+    if (operation.sequence != 0 && operation.sequence <= g_journalSequence)
+    {
+        g_stats.skipped++;
+        return SYNCD_SKIPPED;
+    }
+
+    if (operation.sequence != 0)
+    {
+        syncd_consumed(operation.sequence);
+    }
+
+    if (!syncd_build_attrs(operation, kfvFieldsValues(kco), attrs, context))
+    {
+        g_stats.malformed++;
+        return SYNCD_DROPPED;
+    }
+
+    void *fn = (operation.api < SAI_COMMON_API_GET) ? g_methods[operation.object_type][operation.api] : NULL;
+
+    // objects without create, like ports, are replayed by set
+    if (fn == NULL && operation.api == SAI_COMMON_API_CREATE)
+    {
+        operation.api = SAI_COMMON_API_SET;
+
+        fn = g_methods[operation.object_type][SAI_COMMON_API_SET];
+    }
+
+    if (fn == NULL)
+    {
+        g_stats.unsupported++;
+        return SYNCD_DROPPED;
+    }
+
+    switch (operation.object_type)
+    {
+        case SAI_OBJECT_TYPE_FDB:
+            {
+                sai_fdb_entry_t entry;
+
+                if (!syncd_get_key(operation, entry))
+                    break;
+
+                if (g_deferred)
+                    return SYNCD_DEFERRED;
+
+                status = syncd_call(fn, operation.api, (const sai_fdb_entry_t*)&entry, attrs);
+            }
+            return SYNCD_APPLIED;
+
+        case SAI_OBJECT_TYPE_NEIGHBOR:
+            {
+                sai_neighbor_entry_t entry;
+
+                if (!syncd_get_key(operation, entry))
+                    break;
+
+                entry.rif_id = syncd_translate(entry.rif_id);
+
+                if (g_deferred)
+                    return SYNCD_DEFERRED;
+
+                status = syncd_call(fn, operation.api, (const sai_neighbor_entry_t*)&entry, attrs);
+            }
+            return SYNCD_APPLIED;
+
+        case SAI_OBJECT_TYPE_ROUTE:
+            {
+                sai_unicast_route_entry_t entry;
+
+                if (!syncd_get_key(operation, entry))
+                    break;
+
+                entry.vr_id = syncd_translate(entry.vr_id);
+
+                if (g_deferred)
+                    return SYNCD_DEFERRED;
+
+                status = syncd_call(fn, operation.api, (const sai_unicast_route_entry_t*)&entry, attrs);
+            }
+            return SYNCD_APPLIED;
+
+        case SAI_OBJECT_TYPE_VLAN:
+            {
+                sai_vlan_id_t vlan_id;
+
+                if (!syncd_get_key(operation, vlan_id))
+                    break;
+
+                if (g_deferred)
+                    return SYNCD_DEFERRED;
+
+                status = syncd_call_vlan(fn, operation.api, vlan_id, attrs);
+            }
+            return SYNCD_APPLIED;
+
+        case SAI_OBJECT_TYPE_SWITCH:
+
+            if (g_deferred)
+                return SYNCD_DEFERRED;
+
+            status = syncd_call_switch(fn, attrs);
+
+            return SYNCD_APPLIED;
+
+        default:
+            {
+                sai_object_id_t vid;
+
+                if (!syncd_get_key(operation, vid))
+                    break;
+
+                if (g_deferred)
+                    return SYNCD_DEFERRED;
+
+                status = syncd_call_object(fn, operation.api, vid, attrs);
+            }
+            return SYNCD_APPLIED;
+    }
+
+    g_stats.malformed++;
+
+    return SYNCD_DROPPED;
+}
+
+static void syncd_count(
+        _In_ const ssw::KeyOpFieldsValuesTuple &kco,
+        _In_ syncd_result_t result,
+        _In_ sai_status_t status)
+{
+    if (result == SYNCD_SKIPPED)
+    {
+        return;
+    }
+
+    if (result == SYNCD_DROPPED)
+    {
+        fprintf(stderr, "dropped malformed or unsupported operation %s\n", kfvKey(kco).c_str());
+    }
+    else if (status != SAI_STATUS_SUCCESS)
+    {
+        g_stats.failed++;
+
+        fprintf(stderr, "operation %s failed with status %d\n", kfvKey(kco).c_str(), status);
+    }
+    else
+    {
+        g_stats.applied++;
+    }
+}
+
+/*
+ * Applies batch in order, lists of whole batch share context.
+ */
+static void syncd_apply_batch(
+        _In_ const std::vector<ssw::KeyOpFieldsValuesTuple> &batch,
+        _In_ size_t count,
+        _In_ uint64_t start)
+{
+    static std::vector<sai_attribute_t> attrs;
+
+    static SaiDeserializeContext context;
+
+    context.reset();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        bool sampled = ((g_stats.applied + g_stats.failed) & SYNCD_LATENCY_SAMPLE_MASK) == 0;
+
+        uint64_t call_start = sampled ? syncd_now() : 0;
+
+        sai_status_t status = SAI_STATUS_SUCCESS;
+
+        syncd_result_t result = syncd_apply(batch[i], attrs, context, status);
+
+        syncd_count(batch[i], result, status);
+
+        if (sampled && result == SYNCD_APPLIED)
+        {
+            uint64_t end = syncd_now();
+
+            g_stats.latency.push_back(end - start);
+            g_stats.call.push_back(end - call_start);
+        }
+    }
+
+    g_stats.batches++;
+    g_stats.busy_ns += syncd_now() - start;
+}
+
+static void syncd_print_latency(
+        _In_ const char *name,
+        _Inout_ std::vector<uint64_t> &latencies)
+{
+    if (latencies.empty())
+    {
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))] / 1000.0;
+    };
+
+    printf("%-16s %10zu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+            name,
+            latencies.size(),
+            percentile(0.5),
+            percentile(0.9),
+            percentile(0.99),
+            percentile(0.999),
+            latencies.back() / 1000.0);
+}
+
+/*
+ * Prints counters since last report and resets them.
+ */
+static void syncd_report(
+        _In_ double seconds)
+{
+    uint64_t ops = g_stats.applied + g_stats.failed;
+
+    printf("%lu ops in %.1f s, %.0f ops/s, %.0f ops/s busy, %lu batches of %.1f\n",
+            ops,
+            seconds,
+            seconds > 0 ? ops / seconds : 0.0,
+            g_stats.busy_ns > 0 ? ops * 1e9 / g_stats.busy_ns : 0.0,
+            g_stats.batches,
+            g_stats.batches > 0 ? (double)ops / g_stats.batches : 0.0);
+
+    printf("%lu failed, %lu malformed, %lu unsupported, %lu untranslated ids, %zu objects\n",
+            g_stats.failed,
+            g_stats.malformed,
+            g_stats.unsupported,
+            g_stats.untranslated,
+            g_map.size());
+
+    if (g_sequence != 0)
+    {
+        printf("journal sequence %lu, %lu operations skipped as applied from journal\n",
+                g_sequence,
+                g_stats.skipped);
+    }
+
+    if (g_map.size() != 0)
+    {
+        printf("%-16s %10s %10s\n", "id map", "objects", "bytes");
+
+        for (int object_type = SAI_OBJECT_TYPE_NULL; object_type < SAI_OBJECT_TYPE_MAX; object_type++)
+        {
+            if (g_map.getCount((sai_object_type_t)object_type) != 0)
+            {
+                printf("%-16d %10lu %10zu\n",
+                        object_type,
+                        g_map.getCount((sai_object_type_t)object_type),
+                        g_map.getMemoryUsage((sai_object_type_t)object_type));
+            }
+        }
+
+        printf("%-16s %10zu %10zu\n", "all", g_map.size(), g_map.getMemoryUsage());
+    }
+
+    if (!g_stats.latency.empty())
+    {
+        printf("%-16s %10s %10s %10s %10s %10s %10s\n", "latency us", "sampled", "p50", "p90", "p99", "p99.9", "max");
+
+        syncd_print_latency("pop to applied", g_stats.latency);
+        syncd_print_latency("sai call", g_stats.call);
+    }
+
+    fflush(stdout);
+
+    std::vector<uint64_t> latency;
+    std::vector<uint64_t> call;
+
+    // keep sample capacity, report should not allocate at steady rate
+    latency.swap(g_stats.latency);
+    call.swap(g_stats.call);
+
+    latency.clear();
+    call.clear();
+
+    g_stats = syncd_stats_t();
+
+    g_stats.latency.swap(latency);
+    g_stats.call.swap(call);
+}
+
+/*
+ * Creates objects already in ASIC_STATE table. Table is unordered, so
+ * object which references object not created yet is deferred to next
+ * pass, until pass creates nothing.
+ */
+static void syncd_replay_table(
+        _In_ ssw::DBConnector *db)
+{
+    ssw::Table table(db, ASIC_STATE_TABLE);
+
+    std::vector<ssw::KeyOpFieldsValuesTuple> content;
+
+    table.getTableContent(content);
+
+    std::vector<ssw::KeyOpFieldsValuesTuple> pending;
+
+    std::unordered_set<sai_object_id_t> vids;
+
+    size_t restored = 0;
+
+    for (auto &kco: content)
+    {
+        // table holds every object in format of its key
+        sai_serialization_format_t format = (!kfvKey(kco).empty() && kfvKey(kco)[0] == SAI_BINARY_FORMAT_VERSION) ?
+            SAI_SERIALIZATION_FORMAT_BINARY : SAI_SERIALIZATION_FORMAT_HEX;
+
+        kfvOp(kco).clear();
+        sai_serialize_primitive(format, SAI_COMMON_API_CREATE, kfvOp(kco));
+
+        syncd_operation_t operation;
+
+        sai_object_id_t vid;
+
+        if (syncd_parse_operation(kfvKey(kco), kfvOp(kco), operation) && syncd_get_created_vid(operation, vid))
+        {
+            // object kept by SAI over warm restart, only id map was lost
+            if (g_map.getRid(vid) != SAI_NULL_OBJECT_ID)
+            {
+                restored++;
+                continue;
+            }
+
+            vids.insert(vid);
+        }
+
+        pending.push_back(std::move(kco));
+    }
+
+    size_t total = pending.size();
+
+    auto start = std::chrono::steady_clock::now();
+
+    g_pendingVids = &vids;
+
+    std::vector<sai_attribute_t> attrs;
+
+    SaiDeserializeContext context;
+
+    while (!pending.empty())
+    {
+        // pass is reported as batch
+        g_stats.batches++;
+
+        std::vector<ssw::KeyOpFieldsValuesTuple> deferred;
+
+        for (auto &kco: pending)
+        {
+            context.reset();
+
+            sai_status_t status = SAI_STATUS_SUCCESS;
+
+            syncd_result_t result = syncd_apply(kco, attrs, context, status);
+
+            if (result == SYNCD_DEFERRED)
+            {
+                deferred.push_back(std::move(kco));
+                continue;
+            }
+
+            syncd_count(kco, result, status);
+
+            syncd_operation_t operation;
+
+            sai_object_id_t vid;
+
+            // created or failed, either way nothing waits for it anymore
+            if (syncd_parse_operation(kfvKey(kco), kfvOp(kco), operation) && syncd_get_created_vid(operation, vid))
+            {
+                vids.erase(vid);
+            }
+        }
+
+        if (deferred.size() == pending.size())
+        {
+            // cycle or reference to object which is not in table
+            g_pendingVids = NULL;
+        }
+
+        pending.swap(deferred);
+    }
+
+    g_pendingVids = NULL;
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    g_stats.busy_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+
+    printf("replayed %zu objects of %s table, %zu already in id map\n", total, ASIC_STATE_TABLE, restored);
+
+    syncd_report(seconds);
+}
+
+/*
+ * Applies operations of change journal after sequence saved with id
+ * map, in batches. Returns false when journal no longer has all of
+ * them, table has to be replayed then.
+ */
+static bool syncd_catch_up(
+        _In_ RedisChangeJournal &journal,
+        _In_ size_t batch_size)
+{
+    std::vector<ssw::KeyOpFieldsValuesTuple> changes;
+
+    uint64_t after = g_sequence;
+
+    size_t total = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (g_running)
+    {
+        uint64_t batch_start = syncd_now();
+
+        uint64_t last;
+
+        sai_status_t status = journal.read(after, batch_size, changes, last);
+
+        if (status != SAI_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "change journal has no operations after sequence %lu, oldest is %lu\n",
+                    after, journal.firstSequence());
+
+            // not known until next stamped operation
+            g_sequence = 0;
+            g_sequences.clear();
+
+            return false;
+        }
+
+        // skipped sequences have no changes
+        if (last == after)
+        {
+            break;
+        }
+
+        if (!changes.empty())
+        {
+            syncd_apply_batch(changes, changes.size(), batch_start);
+        }
+
+        total += changes.size();
+
+        after = last;
+    }
+
+    g_journalSequence = after;
+
+    g_sequence = after;
+    g_sequences.clear();
+
+    printf("applied %zu operations of change journal up to sequence %lu\n", total, after);
+
+    syncd_report(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    return true;
+}
+
+/*
+ * Pops up to batch size operations, tuples of batch are reused so
+ * strings keep their capacity.
+ */
+static size_t syncd_pop_batch(
+        _In_ ssw::ConsumerTable &consumer,
+        _Inout_ std::vector<ssw::KeyOpFieldsValuesTuple> &batch)
+{
+    size_t count = 0;
+
+    while (count < batch.size() && !consumer.empty())
+    {
+        consumer.pop(batch[count++]);
+    }
+
+    return count;
+}
+
+static size_t syncd_pop_batch(
+        _In_ ShmConsumerTable &consumer,
+        _Inout_ std::vector<ssw::KeyOpFieldsValuesTuple> &batch)
+{
+    size_t count = 0;
+
+    while (count < batch.size())
+    {
+        if (consumer.pop(batch[count]))
+        {
+            count++;
+        }
+        else if (!kfvKey(batch[count]).empty())
+        {
+            g_stats.malformed++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return count;
+}
+
+template<typename C>
+static void syncd_drain(
+        _In_ C &consumer,
+        _Inout_ std::vector<ssw::KeyOpFieldsValuesTuple> &batch)
+{
+    while (g_running)
+    {
+        uint64_t start = syncd_now();
+
+        size_t count = syncd_pop_batch(consumer, batch);
+
+        if (count == 0)
+        {
+            break;
+        }
+
+        syncd_apply_batch(batch, count, start);
+    }
+}
+
+static void syncd_usage(
+        _In_ const char *name)
+{
+    fprintf(stderr, "usage: %s [-t redis|shm] [-b batch_size] [-i stats_interval_s] [-r] [-w map_file]\n"
+            "       [-j journal_name] [-u unix_socket | -H host -P port] [-d db] [-n shm_name]\n"
+            "       [-k key=value]...\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    std::string transport = "redis";
+    std::string host = SAI_REDIS_DEFAULT_HOST;
+    std::string unix_socket;
+    std::string shm_name = SAI_REDIS_DEFAULT_SHM_NAME;
+
+    int port = SAI_REDIS_DEFAULT_PORT;
+    int db_index = 0;
+
+    size_t batch_size = SAI_REDIS_DEFAULT_BATCH_SIZE;
+    uint64_t interval = SYNCD_DEFAULT_STATS_INTERVAL;
+
+    bool replay = false;
+
+    std::string map_file;
+    std::string journal_name;
+
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:b:i:rw:j:u:H:P:d:n:k:")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': transport = optarg; break;
+            case 'b': batch_size = (size_t)atoll(optarg); break;
+            case 'i': interval = (uint64_t)atoll(optarg); break;
+            case 'r': replay = true; break;
+            case 'w': map_file = optarg; break;
+            case 'j': journal_name = optarg; break;
+            case 'u': unix_socket = optarg; break;
+            case 'H': host = optarg; break;
+            case 'P': port = atoi(optarg); break;
+            case 'd': db_index = atoi(optarg); break;
+            case 'n': shm_name = optarg; break;
+
+            case 'k':
+                {
+                    const char *eq = strchr(optarg, '=');
+
+                    if (eq == NULL)
+                    {
+                        fprintf(stderr, "profile value must be key=value\n");
+                        return 1;
+                    }
+
+                    g_profile[std::string(optarg, eq - optarg)] = eq + 1;
+                }
+                break;
+
+            default:
+                syncd_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind != argc || batch_size == 0 || (transport != "redis" && transport != "shm"))
+    {
+        syncd_usage(argv[0]);
+        return 1;
+    }
+
+    if (sai_api_initialize(0, &g_syncd_services) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "sai_api_initialize failed\n");
+        return 1;
+    }
+
+    for (const auto &methods: g_objectMethods)
+    {
+        void **table = NULL;
+
+        if (sai_api_query(methods.api, (void**)&table) != SAI_STATUS_SUCCESS || table == NULL)
+        {
+            continue;
+        }
+
+        for (int api = SAI_COMMON_API_CREATE; api < SAI_COMMON_API_GET; api++)
+        {
+            if (methods.method[api] != SYNCD_METHOD_NONE)
+            {
+                g_methods[methods.object_type][api] = table[methods.method[api]];
+            }
+        }
+    }
+
+    sai_switch_api_t *switch_api = NULL;
+
+    sai_switch_notification_t notifications;
+
+    memset(&notifications, 0, sizeof(notifications));
+
+    char hardware_id[] = "";
+
+    if (sai_api_query(SAI_API_SWITCH, (void**)&switch_api) != SAI_STATUS_SUCCESS ||
+            switch_api->initialize_switch(0, hardware_id, NULL, &notifications) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "switch initialization failed\n");
+        return 1;
+    }
+
+    signal(SIGINT, syncd_signal_handler);
+    signal(SIGTERM, syncd_signal_handler);
+
+    ssw::DBConnector *db = NULL;
+
+    if (transport == "redis" || replay)
+    {
+        db = unix_socket.empty() ?
+            new ssw::DBConnector(db_index, host, port, 0) :
+            new ssw::DBConnector(db_index, unix_socket, 0);
+    }
+
+    if (!map_file.empty())
+    {
+        if (g_map.load(map_file) != SAI_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "failed to load id map %s\n", map_file.c_str());
+            return 1;
+        }
+
+        printf("loaded %zu ids from %s\n", g_map.size(), map_file.c_str());
+    }
+
+    RedisChangeJournal journal;
+
+    bool caught_up = false;
+
+    if (!journal_name.empty())
+    {
+        if (journal.open(journal_name, SAI_REDIS_DEFAULT_JOURNAL_SIZE) != SAI_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "failed to open change journal %s\n", journal_name.c_str());
+            return 1;
+        }
+
+        g_journal = &journal;
+
+        // sequences of other journal, or of map saved without journal,
+        // say nothing about this one
+        if (g_map.getJournalSequence() != 0 && g_map.getJournalId() == journal.id())
+        {
+            g_sequence = g_map.getJournalSequence();
+
+            caught_up = syncd_catch_up(journal, batch_size);
+        }
+    }
+
+    if (replay && !caught_up)
+    {
+        syncd_replay_table(db);
+    }
+
+    std::vector<ssw::KeyOpFieldsValuesTuple> batch(batch_size);
+
+    auto start = std::chrono::steady_clock::now();
+    auto report = start;
+
+    auto maybe_report = [&]() {
+
+        auto now = std::chrono::steady_clock::now();
+
+        if (interval != 0 && now - report >= std::chrono::seconds(interval))
+        {
+            syncd_report(std::chrono::duration<double>(now - report).count());
+
+            report = now;
+        }
+    };
+
+    int result = 0;
+
+    if (transport == "shm")
+    {
+        ShmConsumerTable consumer;
+
+        if (consumer.open(shm_name, SAI_REDIS_DEFAULT_SHM_SIZE) != SAI_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "failed to open shared memory ring %s\n", shm_name.c_str());
+            result = 1;
+        }
+
+        for (uint32_t idle = 0; g_running && result == 0; )
+        {
+            if (consumer.empty())
+            {
+                if (idle++ < SYNCD_SHM_SPIN_COUNT)
+                    std::this_thread::yield();
+                else
+                    std::this_thread::sleep_for(std::chrono::microseconds(SYNCD_SHM_IDLE_US));
+            }
+            else
+            {
+                idle = 0;
+
+                syncd_drain(consumer, batch);
+            }
+
+            maybe_report();
+        }
+    }
+    else
+    {
+        ssw::ConsumerTable consumer(db, ASIC_STATE_TABLE);
+
+        ssw::Select select;
+
+        select.addSelectable(&consumer);
+
+        while (g_running)
+        {
+            ssw::Selectable *selectable;
+
+            int fd;
+
+            int ret = select.select(&selectable, &fd, SYNCD_SELECT_TIMEOUT_MS);
+
+            if (ret == ssw::Select::OBJECT)
+            {
+                syncd_drain(consumer, batch);
+            }
+            else if (ret == ssw::Select::ERROR)
+            {
+                fprintf(stderr, "select on %s failed\n", ASIC_STATE_TABLE);
+            }
+
+            maybe_report();
+        }
+    }
+
+    syncd_report(std::chrono::duration<double>(std::chrono::steady_clock::now() - report).count());
+
+    // without journal consumed operations are not tracked, position
+    // loaded with map is stale
+    if (journal_name.empty())
+    {
+        g_map.setJournalPosition(0, 0);
+    }
+    else
+    {
+        syncd_advance_sequence(true);
+
+        g_map.setJournalPosition(journal.id(), g_sequence);
+    }
+
+    if (!map_file.empty() && g_map.save(map_file) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to save id map %s\n", map_file.c_str());
+        result = 1;
+    }
+
+    delete db;
+
+    switch_api->shutdown_switch(false);
+
+    sai_api_uninitialize();
+
+    return result;
+}
@@ -0,0 +1,468 @@
+#include "syncd_vid_rid_map.h"
+
+#include "sai_redis.h"
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SYNCD_VID_RID_MAP_MIN_CAPACITY  1024
+
+static inline sai_object_type_t vid_rid_map_object_type(
+        _In_ sai_object_id_t vid)
+{
+    uint64_t object_type = vid >> SAI_REDIS_VID_OBJECT_TYPE_SHIFT;
+
+    return object_type < SAI_OBJECT_TYPE_MAX ? (sai_object_type_t)object_type : SAI_OBJECT_TYPE_NULL;
+}
+
+VidRidMap::Table::Table():
+    m_slots(SYNCD_VID_RID_MAP_MIN_CAPACITY),
+    m_mask(SYNCD_VID_RID_MAP_MIN_CAPACITY - 1),
+    m_size(0)
+{
+}
+
+sai_object_id_t VidRidMap::Table::put(
+        _In_ sai_object_id_t key,
+        _In_ sai_object_id_t value)
+{
+    // at most half full, so probe sequences stay short
+    if (2 * (m_size + 1) > m_slots.size())
+    {
+        rehash(2 * m_slots.size());
+    }
+
+    for (size_t i = hash(key) & m_mask; ; i = (i + 1) & m_mask)
+    {
+        slot_t &slot = m_slots[i];
+
+        if (slot.key == key)
+        {
+            sai_object_id_t previous = slot.value;
+
+            slot.value = value;
+
+            return previous;
+        }
+
+        if (slot.key == SAI_NULL_OBJECT_ID)
+        {
+            slot.key = key;
+            slot.value = value;
+
+            m_size++;
+
+            return SAI_NULL_OBJECT_ID;
+        }
+    }
+}
+
+sai_object_id_t VidRidMap::Table::remove(
+        _In_ sai_object_id_t key)
+{
+    size_t i = hash(key) & m_mask;
+
+    while (m_slots[i].key != key)
+    {
+        if (m_slots[i].key == SAI_NULL_OBJECT_ID)
+        {
+            return SAI_NULL_OBJECT_ID;
+        }
+
+        i = (i + 1) & m_mask;
+    }
+
+    sai_object_id_t value = m_slots[i].value;
+
+    // backward shift, entry moves into hole when hole is on its
+    // probe sequence, between its home slot and its slot
+
+    for (size_t j = (i + 1) & m_mask; m_slots[j].key != SAI_NULL_OBJECT_ID; j = (j + 1) & m_mask)
+    {
+        size_t home = hash(m_slots[j].key) & m_mask;
+
+        if (((j - home) & m_mask) >= ((j - i) & m_mask))
+        {
+            m_slots[i] = m_slots[j];
+
+            i = j;
+        }
+    }
+
+    m_slots[i].key = SAI_NULL_OBJECT_ID;
+    m_slots[i].value = SAI_NULL_OBJECT_ID;
+
+    m_size--;
+
+    return value;
+}
+
+void VidRidMap::Table::reserve(
+        _In_ size_t count)
+{
+    size_t capacity = m_slots.size();
+
+    while (capacity < 2 * count)
+    {
+        capacity <<= 1;
+    }
+
+    if (capacity != m_slots.size())
+    {
+        rehash(capacity);
+    }
+}
+
+void VidRidMap::Table::clear()
+{
+    std::vector<slot_t>(SYNCD_VID_RID_MAP_MIN_CAPACITY).swap(m_slots);
+
+    m_mask = SYNCD_VID_RID_MAP_MIN_CAPACITY - 1;
+    m_size = 0;
+}
+
+void VidRidMap::Table::rehash(
+        _In_ size_t capacity)
+{
+    std::vector<slot_t> slots(capacity);
+
+    m_slots.swap(slots);
+
+    m_mask = capacity - 1;
+    m_size = 0;
+
+    for (const auto &slot: slots)
+    {
+        if (slot.key != SAI_NULL_OBJECT_ID)
+        {
+            put(slot.key, slot.value);
+        }
+    }
+}
+
+VidRidMap::VidRidMap():
+    m_journalId(0),
+    m_sequence(0)
+{
+    memset(m_counts, 0, sizeof(m_counts));
+}
+
+void VidRidMap::insert(
+        _In_ sai_object_id_t vid,
+        _In_ sai_object_id_t rid)
+{
+    sai_object_id_t previous_rid = m_vidToRid.put(vid, rid);
+
+    if (previous_rid == SAI_NULL_OBJECT_ID)
+    {
+        m_counts[vid_rid_map_object_type(vid)]++;
+    }
+    else if (previous_rid != rid)
+    {
+        m_ridToVid.remove(previous_rid);
+    }
+
+    sai_object_id_t previous_vid = m_ridToVid.put(rid, vid);
+
+    if (previous_vid != SAI_NULL_OBJECT_ID && previous_vid != vid)
+    {
+        m_vidToRid.remove(previous_vid);
+
+        m_counts[vid_rid_map_object_type(previous_vid)]--;
+    }
+}
+
+bool VidRidMap::erase(
+        _In_ sai_object_id_t vid)
+{
+    sai_object_id_t rid = m_vidToRid.remove(vid);
+
+    if (rid == SAI_NULL_OBJECT_ID)
+    {
+        return false;
+    }
+
+    m_ridToVid.remove(rid);
+
+    m_counts[vid_rid_map_object_type(vid)]--;
+
+    return true;
+}
+
+void VidRidMap::clear()
+{
+    m_vidToRid.clear();
+    m_ridToVid.clear();
+
+    memset(m_counts, 0, sizeof(m_counts));
+
+    m_journalId = 0;
+    m_sequence = 0;
+}
+
+void VidRidMap::setJournalPosition(
+        _In_ uint64_t journal_id,
+        _In_ uint64_t sequence)
+{
+    m_journalId = journal_id;
+    m_sequence = sequence;
+}
+
+uint32_t VidRidMap::translateVidToRid(
+        _Inout_ sai_object_id_t *ids,
+        _In_ uint32_t count) const
+{
+    uint32_t missing = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (ids[i] == SAI_NULL_OBJECT_ID)
+        {
+            continue;
+        }
+
+        sai_object_id_t rid = m_vidToRid.get(ids[i]);
+
+        if (rid == SAI_NULL_OBJECT_ID)
+        {
+            missing++;
+            continue;
+        }
+
+        ids[i] = rid;
+    }
+
+    return missing;
+}
+
+uint32_t VidRidMap::translateVidToRid(
+        _In_ sai_attr_serialization_type_t type,
+        _Inout_ sai_attribute_t &attr) const
+{
+    sai_object_id_t *ids;
+    uint32_t count;
+
+    if (!getObjectIds(type, attr, ids, count))
+    {
+        return 0;
+    }
+
+    return translateVidToRid(ids, count);
+}
+
+bool VidRidMap::getObjectIds(
+        _In_ sai_attr_serialization_type_t type,
+        _In_ sai_attribute_t &attr,
+        _Out_ sai_object_id_t *&ids,
+        _Out_ uint32_t &count)
+{
+    switch (type)
+    {
+        case SAI_SERIALIZATION_TYPE_OBJECT_ID:
+            ids = &attr.value.oid;
+            count = 1;
+            return true;
+
+        case SAI_SERIALIZATION_TYPE_OBJECT_LIST:
+            ids = attr.value.objlist.list;
+            count = attr.value.objlist.count;
+            return true;
+
+        case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_ID:
+            ids = &attr.value.aclfield.data.oid;
+            count = 1;
+            return true;
+
+        case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_LIST:
+            ids = attr.value.aclfield.data.objlist.list;
+            count = attr.value.aclfield.data.objlist.count;
+            return true;
+
+        case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_ID:
+            ids = &attr.value.aclaction.parameter.oid;
+            count = 1;
+            return true;
+
+        case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_LIST:
+            ids = attr.value.aclaction.parameter.objlist.list;
+            count = attr.value.aclaction.parameter.objlist.count;
+            return true;
+
+        default:
+            ids = NULL;
+            count = 0;
+            return false;
+    }
+}
+
+uint64_t VidRidMap::getCount(
+        _In_ sai_object_type_t object_type) const
+{
+    return object_type < SAI_OBJECT_TYPE_MAX ? m_counts[object_type] : 0;
+}
+
+size_t VidRidMap::getMemoryUsage() const
+{
+    return (m_vidToRid.capacity() + m_ridToVid.capacity()) * sizeof(slot_t);
+}
+
+size_t VidRidMap::getMemoryUsage(
+        _In_ sai_object_type_t object_type) const
+{
+    if (size() == 0)
+    {
+        return 0;
+    }
+
+    return (size_t)(getMemoryUsage() * (double)getCount(object_type) / size());
+}
+
+sai_status_t VidRidMap::save(
+        _In_ const std::string &path) const
+{
+    size_t size = sizeof(syncd_vid_rid_map_header_t) + m_vidToRid.size() * sizeof(slot_t);
+
+    std::string tmp = path + ".tmp";
+
+    int fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+    {
+        return SAI_STATUS_FAILURE;
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        unlink(tmp.c_str());
+
+        return SAI_STATUS_FAILURE;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        unlink(tmp.c_str());
+
+        return SAI_STATUS_FAILURE;
+    }
+
+    syncd_vid_rid_map_header_t *header = (syncd_vid_rid_map_header_t*)map;
+
+    memcpy(header->magic, SYNCD_VID_RID_MAP_MAGIC, sizeof(header->magic));
+    header->version = SYNCD_VID_RID_MAP_VERSION;
+    header->reserved = 0;
+    header->count = m_vidToRid.size();
+    header->journal_id = m_journalId;
+    header->sequence = m_sequence;
+
+    slot_t *record = (slot_t*)(header + 1);
+
+    m_vidToRid.forEach([&record](sai_object_id_t vid, sai_object_id_t rid) {
+            record->key = vid;
+            record->value = rid;
+            record++;
+    });
+
+    bool ok = (msync(map, size, MS_SYNC) == 0);
+
+    munmap(map, size);
+
+    ok = ok && (fsync(fd) == 0);
+
+    close(fd);
+
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        unlink(tmp.c_str());
+
+        return SAI_STATUS_FAILURE;
+    }
+
+    return SAI_STATUS_SUCCESS;
+}
+
+sai_status_t VidRidMap::load(
+        _In_ const std::string &path)
+{
+    clear();
+
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return errno == ENOENT ? SAI_STATUS_SUCCESS : SAI_STATUS_FAILURE;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(syncd_vid_rid_map_header_t))
+    {
+        close(fd);
+
+        return SAI_STATUS_FAILURE;
+    }
+
+    size_t size = (size_t)st.st_size;
+
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        return SAI_STATUS_FAILURE;
+    }
+
+    const syncd_vid_rid_map_header_t *header = (const syncd_vid_rid_map_header_t*)map;
+
+    if (memcmp(header->magic, SYNCD_VID_RID_MAP_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != SYNCD_VID_RID_MAP_VERSION ||
+            header->count > (size - sizeof(*header)) / sizeof(slot_t) ||
+            size != sizeof(*header) + header->count * sizeof(slot_t))
+    {
+        munmap(map, size);
+
+        return SAI_STATUS_FAILURE;
+    }
+
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    m_vidToRid.reserve(header->count);
+    m_ridToVid.reserve(header->count);
+
+    const slot_t *record = (const slot_t*)(header + 1);
+
+    sai_status_t status = SAI_STATUS_SUCCESS;
+
+    for (uint64_t i = 0; i < header->count; i++, record++)
+    {
+        if (record->key == SAI_NULL_OBJECT_ID || record->value == SAI_NULL_OBJECT_ID)
+        {
+            status = SAI_STATUS_FAILURE;
+            break;
+        }
+
+        insert(record->key, record->value);
+    }
+
+    if (status == SAI_STATUS_SUCCESS)
+    {
+        setJournalPosition(header->journal_id, header->sequence);
+    }
+
+    munmap(map, size);
+
+    if (status != SAI_STATUS_SUCCESS)
+    {
+        clear();
+    }
+
+    return status;
+}
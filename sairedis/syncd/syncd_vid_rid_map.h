@@ -0,0 +1,297 @@
+#ifndef __SYNCD_VID_RID_MAP__
+#define __SYNCD_VID_RID_MAP__
+
+extern "C" {
+#include "sai.h"
+}
+
+#include "sai_serialize.h"
+
+#include <string>
+#include <vector>
+
+#define SYNCD_VID_RID_MAP_MAGIC     "SRVIDRID"
+#define SYNCD_VID_RID_MAP_VERSION   2
+
+/*
+ * Map file layout, all integers in host byte order:
+ *
+ * header:  char magic[8], uint32_t version, uint32_t reserved,
+ *          uint64_t count, uint64_t journal_id, uint64_t sequence
+ * record:  uint64_t vid, uint64_t rid, count times
+ */
+
+typedef struct _syncd_vid_rid_map_header_t
+{
+    char magic[8];
+
+    uint32_t version;
+
+    uint32_t reserved;
+
+    uint64_t count;
+
+    // change journal position of state map belongs to
+    uint64_t journal_id;
+
+    uint64_t sequence;
+
+} syncd_vid_rid_map_header_t;
+
+/**
+ * @brief Bidirectional map of virtual ids written by sairedis to real
+ * ids returned by SAI
+ *
+ * Both directions are open addressing tables with linear probing, kept
+ * at most half full, SAI_NULL_OBJECT_ID marks empty slot. Lookup and
+ * translation never allocate, tables grow only on insert. Erase shifts
+ * following entries back, so there are no tombstones and lookup cost
+ * does not degrade with churn. Not thread safe.
+ */
+class VidRidMap
+{
+    public:
+
+        VidRidMap();
+
+        /**
+         * @brief Maps vid to rid, previous mapping of either id is
+         * replaced, SAI may reuse real id of removed object
+         */
+        void insert(
+                _In_ sai_object_id_t vid,
+                _In_ sai_object_id_t rid);
+
+        /**
+         * @brief Removes vid and its rid
+         *
+         * @return false when vid is not mapped
+         */
+        bool erase(
+                _In_ sai_object_id_t vid);
+
+        void clear();
+
+        /**
+         * @brief Returns SAI_NULL_OBJECT_ID when vid is not mapped
+         */
+        sai_object_id_t getRid(
+                _In_ sai_object_id_t vid) const
+        {
+            return m_vidToRid.get(vid);
+        }
+
+        /**
+         * @brief Returns SAI_NULL_OBJECT_ID when rid is not mapped
+         */
+        sai_object_id_t getVid(
+                _In_ sai_object_id_t rid) const
+        {
+            return m_ridToVid.get(rid);
+        }
+
+        size_t size() const
+        {
+            return m_vidToRid.size();
+        }
+
+        /**
+         * @brief Translates ids in place, null ids and ids which are
+         * not mapped are left unchanged
+         *
+         * @return number of ids which are not mapped
+         */
+        uint32_t translateVidToRid(
+                _Inout_ sai_object_id_t *ids,
+                _In_ uint32_t count) const;
+
+        /**
+         * @brief Translates object id or whole object list of
+         * attribute in place, attribute of other type is not changed
+         *
+         * @return number of ids which are not mapped
+         */
+        uint32_t translateVidToRid(
+                _In_ sai_attr_serialization_type_t type,
+                _Inout_ sai_attribute_t &attr) const;
+
+        /**
+         * @brief Points ids to object ids of attribute, single id is
+         * list of one
+         *
+         * @return false when attribute of type does not hold object ids
+         */
+        static bool getObjectIds(
+                _In_ sai_attr_serialization_type_t type,
+                _In_ sai_attribute_t &attr,
+                _Out_ sai_object_id_t *&ids,
+                _Out_ uint32_t &count);
+
+        /**
+         * @brief Number of mapped objects of type, type is taken from
+         * virtual id
+         */
+        uint64_t getCount(
+                _In_ sai_object_type_t object_type) const;
+
+        /**
+         * @brief Bytes of both tables, empty slots included
+         */
+        size_t getMemoryUsage() const;
+
+        /**
+         * @brief Bytes of both tables attributed to objects of type,
+         * empty slots are shared in proportion to number of objects
+         */
+        size_t getMemoryUsage(
+                _In_ sai_object_type_t object_type) const;
+
+        /**
+         * @brief Sets position in change journal of last operation
+         * applied, saved with map so both describe same state, 0 when
+         * not known
+         */
+        void setJournalPosition(
+                _In_ uint64_t journal_id,
+                _In_ uint64_t sequence);
+
+        uint64_t getJournalId() const
+        {
+            return m_journalId;
+        }
+
+        uint64_t getJournalSequence() const
+        {
+            return m_sequence;
+        }
+
+        /**
+         * @brief Writes map to file, replaced by rename, so crash during
+         * save keeps previous file
+         */
+        sai_status_t save(
+                _In_ const std::string &path) const;
+
+        /**
+         * @brief Replaces map by content of file, missing file is empty
+         * map
+         */
+        sai_status_t load(
+                _In_ const std::string &path);
+
+    private:
+
+        VidRidMap(const VidRidMap&);
+        VidRidMap& operator=(const VidRidMap&);
+
+        typedef struct _slot_t
+        {
+            sai_object_id_t key;
+            sai_object_id_t value;
+
+        } slot_t;
+
+        class Table
+        {
+            public:
+
+                Table();
+
+                sai_object_id_t get(
+                        _In_ sai_object_id_t key) const
+                {
+                    for (size_t i = hash(key) & m_mask; ; i = (i + 1) & m_mask)
+                    {
+                        const slot_t &slot = m_slots[i];
+
+                        if (slot.key == key)
+                        {
+                            return slot.value;
+                        }
+
+                        if (slot.key == SAI_NULL_OBJECT_ID)
+                        {
+                            return SAI_NULL_OBJECT_ID;
+                        }
+                    }
+                }
+
+                /**
+                 * @brief Returns previous value, SAI_NULL_OBJECT_ID
+                 * when key was not in table
+                 */
+                sai_object_id_t put(
+                        _In_ sai_object_id_t key,
+                        _In_ sai_object_id_t value);
+
+                sai_object_id_t remove(
+                        _In_ sai_object_id_t key);
+
+                void reserve(
+                        _In_ size_t count);
+
+                void clear();
+
+                size_t size() const
+                {
+                    return m_size;
+                }
+
+                size_t capacity() const
+                {
+                    return m_slots.size();
+                }
+
+                template<typename F>
+                void forEach(
+                        _In_ F fn) const
+                {
+                    for (const auto &slot: m_slots)
+                    {
+                        if (slot.key != SAI_NULL_OBJECT_ID)
+                        {
+                            fn(slot.key, slot.value);
+                        }
+                    }
+                }
+
+            private:
+
+                static size_t hash(
+                        _In_ sai_object_id_t key)
+                {
+                    // splitmix64 finalizer, virtual ids differ only in
+                    // low bits of index and high bits of type
+                    uint64_t x = key;
+
+                    x ^= x >> 30;
+                    x *= 0xbf58476d1ce4e5b9ULL;
+                    x ^= x >> 27;
+                    x *= 0x94d049bb133111ebULL;
+                    x ^= x >> 31;
+
+                    return (size_t)x;
+                }
+
+                void rehash(
+                        _In_ size_t capacity);
+
+                std::vector<slot_t> m_slots;
+
+                size_t m_mask;
+
+                size_t m_size;
+        };
+
+        Table m_vidToRid;
+
+        Table m_ridToVid;
+
+        uint64_t m_counts[SAI_OBJECT_TYPE_MAX];
+
+        uint64_t m_journalId;
+
+        uint64_t m_sequence;
+};
+
+#endif // __SYNCD_VID_RID_MAP__
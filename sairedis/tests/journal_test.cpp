@@ -0,0 +1,667 @@
+#include "sai_redis_journal.h"
+
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Checks change journal without redis: sequences stamped by reserve
+ * and read back in order, sequences appended out of order, skipped
+ * sequences, trimming while data wraps around many times, truncate
+ * after operation too large for journal, recovery from writer which
+ * died after reserve, reader in other mapping catching up from
+ * sequence it has, and writers appending from many threads while
+ * reader follows them.
+ */
+
+#define TEST_SMALL_SIZE         4096
+#define TEST_LARGE_SIZE         (16 * 1024 * 1024)
+#define TEST_SMALL_ENTRIES      (TEST_SMALL_SIZE / 64)
+#define TEST_WRAP_RECORDS       20000
+#define TEST_WRITERS            4
+#define TEST_WRITER_RECORDS     50000
+
+static const char *g_name = "/sairedis_journal_test";
+
+static std::string test_key(
+        _In_ uint64_t sequence)
+{
+    return "k" + std::to_string(sequence);
+}
+
+// delete op, consumer does not parse its value
+static std::string test_op(
+        _In_ uint64_t sequence)
+{
+    return "D" + std::to_string(sequence);
+}
+
+static bool test_append(
+        _In_ RedisChangeJournal &journal,
+        _In_ uint64_t sequence,
+        _In_ const std::string &key,
+        _In_ size_t value_size)
+{
+    std::string value(value_size, 'v');
+    std::string op = test_op(sequence);
+
+    const sai_serialized_view_t parts[3] = {
+        { key.data(), key.size() },
+        { value.data(), value.size() },
+        { op.data(), op.size() },
+    };
+
+    return journal.append(sequence, 3, parts);
+}
+
+// changes must be operations after sequence after, up to last
+static int test_changes(
+        _In_ const char *name,
+        _In_ const std::vector<ssw::KeyOpFieldsValuesTuple> &changes,
+        _In_ uint64_t after,
+        _In_ uint64_t last)
+{
+    if (changes.size() != last - after)
+    {
+        fprintf(stderr, "%s: %zu changes after %lu up to %lu\n", name, changes.size(), after, last);
+        return 1;
+    }
+
+    for (size_t i = 0; i < changes.size(); i++)
+    {
+        uint64_t sequence = after + 1 + i;
+
+        if (kfvKey(changes[i]) != test_key(sequence) || kfvOp(changes[i]) != std::to_string(sequence))
+        {
+            fprintf(stderr, "%s: change %s %s, expected sequence %lu\n",
+                    name, kfvKey(changes[i]).c_str(), kfvOp(changes[i]).c_str(), sequence);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_sequences()
+{
+    RedisChangeJournal::unlink(g_name);
+
+    RedisChangeJournal journal;
+
+    if (journal.open(g_name, TEST_SMALL_SIZE) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to create journal\n");
+        return 1;
+    }
+
+    std::vector<ssw::KeyOpFieldsValuesTuple> changes;
+
+    uint64_t last;
+
+    int errors = 0;
+
+    if (journal.read(0, 100, changes, last) != SAI_STATUS_SUCCESS || !changes.empty() || last != 0)
+    {
+        fprintf(stderr, "empty journal not read from 0\n");
+        errors++;
+    }
+
+    if (journal.read(1, 100, changes, last) != SAI_STATUS_ITEM_NOT_FOUND)
+    {
+        fprintf(stderr, "sequence never reserved was read\n");
+        errors++;
+    }
+
+    for (uint64_t sequence = 1; sequence <= 10; sequence++)
+    {
+        if (journal.reserve(1) != sequence || !test_append(journal, sequence, test_key(sequence), 10))
+        {
+            fprintf(stderr, "sequence %lu not stamped\n", sequence);
+            return errors + 1;
+        }
+    }
+
+    if (journal.read(3, 100, changes, last) != SAI_STATUS_SUCCESS || last != 10)
+    {
+        fprintf(stderr, "read after 3 failed\n");
+        errors++;
+    }
+
+    errors += test_changes("read after 3", changes, 3, 10);
+
+    if (journal.read(3, 2, changes, last) != SAI_STATUS_SUCCESS || last != 5)
+    {
+        fprintf(stderr, "read of 2 after 3 ended at %lu\n", last);
+        errors++;
+    }
+
+    // reserved sequences are appended out of order, readers see them
+    // only once all before them are appended
+    uint64_t first = journal.reserve(3);
+
+    test_append(journal, first + 2, test_key(first + 2), 10);
+    test_append(journal, first + 1, test_key(first + 1), 10);
+
+    if (journal.lastSequence() != 10 ||
+            journal.read(10, 100, changes, last) != SAI_STATUS_SUCCESS || !changes.empty() || last != 10)
+    {
+        fprintf(stderr, "sequences after gap visible before gap is appended\n");
+        errors++;
+    }
+
+    test_append(journal, first, test_key(first), 10);
+
+    if (journal.lastSequence() != first + 2 || journal.read(10, 100, changes, last) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "last sequence %lu after gap is appended\n", journal.lastSequence());
+        errors++;
+    }
+
+    errors += test_changes("read after gap", changes, 10, first + 2);
+
+    // skipped sequence is passed
+    uint64_t skipped = journal.reserve(1);
+
+    journal.skip(skipped);
+
+    uint64_t sequence = journal.reserve(1);
+
+    test_append(journal, sequence, test_key(sequence), 10);
+
+    if (journal.read(skipped - 1, 100, changes, last) != SAI_STATUS_SUCCESS ||
+            changes.size() != 1 || kfvKey(changes[0]) != test_key(sequence) || last != sequence)
+    {
+        fprintf(stderr, "skipped sequence %lu not passed\n", skipped);
+        errors++;
+    }
+
+    if (journal.read(skipped - 2, 1, changes, last) != SAI_STATUS_SUCCESS || last != skipped - 1)
+    {
+        fprintf(stderr, "read of 1 before skipped sequence ended at %lu\n", last);
+        errors++;
+    }
+
+    if (!journal.isSkipped(skipped) || journal.isSkipped(sequence) || journal.isSkipped(sequence + 1))
+    {
+        fprintf(stderr, "skipped sequences not reported\n");
+        errors++;
+    }
+
+    RedisChangeJournal::unlink(g_name);
+
+    return errors;
+}
+
+static int test_wraparound(
+        _In_ size_t max_value_size)
+{
+    RedisChangeJournal::unlink(g_name);
+
+    RedisChangeJournal journal;
+
+    if (journal.open(g_name, TEST_SMALL_SIZE) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to create journal\n");
+        return 1;
+    }
+
+    std::vector<ssw::KeyOpFieldsValuesTuple> changes;
+
+    uint64_t last;
+
+    int errors = 0;
+
+    for (uint64_t sequence = 1; sequence <= TEST_WRAP_RECORDS; sequence++)
+    {
+        // sizes which leave every remainder at end of data
+        journal.reserve(1);
+
+        test_append(journal, sequence, test_key(sequence), sequence % (max_value_size + 1));
+
+        if (journal.used() > journal.capacity())
+        {
+            fprintf(stderr, "%lu bytes used of %lu\n", journal.used(), journal.capacity());
+            return errors + 1;
+        }
+
+        if (sequence % 1000 != 0)
+        {
+            continue;
+        }
+
+        uint64_t after = journal.firstSequence() - 1;
+
+        if (journal.read(after, TEST_WRAP_RECORDS, changes, last) != SAI_STATUS_SUCCESS || last != sequence)
+        {
+            fprintf(stderr, "read after %lu of journal at %lu failed\n", after, sequence);
+            errors++;
+        }
+
+        errors += test_changes("read after wrap", changes, after, sequence);
+    }
+
+    if (journal.firstSequence() < TEST_WRAP_RECORDS - TEST_SMALL_SIZE / 32)
+    {
+        fprintf(stderr, "oldest sequence %lu, records not trimmed\n", journal.firstSequence());
+        errors++;
+    }
+
+    if (journal.read(journal.firstSequence() - 2, 100, changes, last) != SAI_STATUS_ITEM_NOT_FOUND ||
+            journal.read(0, 100, changes, last) != SAI_STATUS_ITEM_NOT_FOUND)
+    {
+        fprintf(stderr, "trimmed sequences were read\n");
+        errors++;
+    }
+
+    RedisChangeJournal::unlink(g_name);
+
+    return errors;
+}
+
+static int test_truncate()
+{
+    RedisChangeJournal::unlink(g_name);
+
+    RedisChangeJournal journal;
+
+    if (journal.open(g_name, TEST_SMALL_SIZE) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to create journal\n");
+        return 1;
+    }
+
+    std::vector<ssw::KeyOpFieldsValuesTuple> changes;
+
+    uint64_t last;
+
+    int errors = 0;
+
+    for (uint64_t sequence = 1; sequence <= 5; sequence++)
+    {
+        journal.reserve(1);
+
+        test_append(journal, sequence, test_key(sequence), 10);
+    }
+
+    uint64_t sequence = journal.reserve(1);
+
+    // journal is truncated instead
+    if (test_append(journal, sequence, test_key(sequence), TEST_SMALL_SIZE / 2))
+    {
+        fprintf(stderr, "record larger than half of journal appended\n");
+        errors++;
+    }
+
+    if (journal.truncations() != 1 || journal.lastSequence() != sequence || journal.firstSequence() != sequence + 1)
+    {
+        fprintf(stderr, "truncated journal has sequences %lu to %lu\n", journal.firstSequence(), journal.lastSequence());
+        errors++;
+    }
+
+    // reader which does not have truncated operation resyncs
+    if (journal.read(sequence - 1, 100, changes, last) != SAI_STATUS_ITEM_NOT_FOUND ||
+            journal.read(0, 100, changes, last) != SAI_STATUS_ITEM_NOT_FOUND)
+    {
+        fprintf(stderr, "read across truncated sequence succeeded\n");
+        errors++;
+    }
+
+    journal.reserve(1);
+
+    test_append(journal, sequence + 1, test_key(sequence + 1), 10);
+
+    if (journal.read(sequence, 100, changes, last) != SAI_STATUS_SUCCESS || last != sequence + 1)
+    {
+        fprintf(stderr, "read after truncated sequence failed\n");
+        errors++;
+    }
+
+    errors += test_changes("read after truncate", changes, sequence, sequence + 1);
+
+    RedisChangeJournal::unlink(g_name);
+
+    return errors;
+}
+
+static int test_dead_writer()
+{
+    RedisChangeJournal::unlink(g_name);
+
+    RedisChangeJournal journal;
+
+    if (journal.open(g_name, TEST_SMALL_SIZE) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to create journal\n");
+        return 1;
+    }
+
+    std::vector<ssw::KeyOpFieldsValuesTuple> changes;
+
+    uint64_t last;
+
+    int errors = 0;
+
+    // writer of this sequence never appends it
+    uint64_t dead = journal.reserve(1);
+
+    for (uint64_t sequence = dead + 1; sequence <= dead + 4; sequence++)
+    {
+        journal.reserve(1);
+
+        test_append(journal, sequence, test_key(sequence), 10);
+    }
+
+    if (journal.lastSequence() != dead - 1)
+    {
+        fprintf(stderr, "journal moved past open sequence to %lu\n", journal.lastSequence());
+        errors++;
+    }
+
+    // as on cold boot
+    uint64_t sequence = journal.reserve(1);
+
+    journal.truncate(sequence);
+
+    if (journal.lastSequence() != sequence || journal.firstSequence() != sequence + 1)
+    {
+        fprintf(stderr, "truncate left sequences %lu to %lu\n", journal.firstSequence(), journal.lastSequence());
+        errors++;
+    }
+
+    if (test_append(journal, dead, test_key(dead), 10) || journal.lastSequence() != sequence)
+    {
+        fprintf(stderr, "late writer appended truncated sequence\n");
+        errors++;
+    }
+
+    // writer which waits for open sequence to reuse its index entry
+    // gives up and truncates journal up to its own
+
+    dead = journal.reserve(1);
+
+    for (uint64_t i = 1; i <= TEST_SMALL_ENTRIES; i++)
+    {
+        sequence = journal.reserve(1);
+
+        if (test_append(journal, sequence, test_key(sequence), 10) != (i < TEST_SMALL_ENTRIES))
+        {
+            fprintf(stderr, "append of sequence %lu after open sequence %lu\n", sequence, dead);
+            errors++;
+        }
+    }
+
+    if (journal.lastSequence() != sequence || journal.truncations() != 2)
+    {
+        fprintf(stderr, "journal not truncated after open sequence, last %lu\n", journal.lastSequence());
+        errors++;
+    }
+
+    journal.reserve(1);
+
+    test_append(journal, sequence + 1, test_key(sequence + 1), 10);
+
+    if (journal.read(sequence, 100, changes, last) != SAI_STATUS_SUCCESS || last != sequence + 1)
+    {
+        fprintf(stderr, "read after recovered sequence failed\n");
+        errors++;
+    }
+
+    errors += test_changes("read after recovery", changes, sequence, sequence + 1);
+
+    RedisChangeJournal::unlink(g_name);
+
+    return errors;
+}
+
+static int test_catch_up()
+{
+    RedisChangeJournal::unlink(g_name);
+
+    RedisChangeJournal journal;
+
+    if (journal.open(g_name, TEST_LARGE_SIZE) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to create journal\n");
+        return 1;
+    }
+
+    for (uint64_t sequence = 1; sequence <= 1000; sequence++)
+    {
+        journal.reserve(1);
+
+        test_append(journal, sequence, test_key(sequence), 64);
+    }
+
+    // reader in other mapping, as consumer process, size is ignored
+    RedisChangeJournal reader;
+
+    if (reader.open(g_name, 0) != SAI_STATUS_SUCCESS || reader.id() != journal.id() || reader.capacity() != journal.capacity())
+    {
+        fprintf(stderr, "journal not shared by second mapping\n");
+        return 1;
+    }
+
+    std::vector<ssw::KeyOpFieldsValuesTuple> changes;
+
+    uint64_t after = 600;
+
+    int errors = 0;
+
+    for (;;)
+    {
+        uint64_t last;
+
+        if (reader.read(after, 64, changes, last) != SAI_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "catch up after %lu failed\n", after);
+            return errors + 1;
+        }
+
+        errors += test_changes("catch up", changes, after, last);
+
+        if (last == after)
+        {
+            break;
+        }
+
+        after = last;
+
+        // writer goes on while reader catches up
+        if (journal.nextSequence() <= 1200)
+        {
+            uint64_t sequence = journal.reserve(1);
+
+            test_append(journal, sequence, test_key(sequence), 64);
+        }
+    }
+
+    if (after != journal.lastSequence() || after != 1200)
+    {
+        fprintf(stderr, "caught up to %lu of %lu\n", after, journal.lastSequence());
+        errors++;
+    }
+
+    RedisChangeJournal::unlink(g_name);
+
+    return errors;
+}
+
+static void test_write(
+        _In_ RedisChangeJournal *journal,
+        _In_ uint32_t writer)
+{
+    for (uint32_t i = 0; i < TEST_WRITER_RECORDS; i++)
+    {
+        std::string key = std::to_string(writer) + ":" + std::to_string(i);
+
+        uint64_t sequence = journal->reserve(1);
+
+        // every 16th is skipped, as operation transport did not write
+        if (i % 16 == 15)
+        {
+            journal->skip(sequence);
+        }
+        else
+        {
+            test_append(*journal, sequence, key, i % 61);
+        }
+    }
+}
+
+static int test_writers(
+        _In_ uint64_t size)
+{
+    RedisChangeJournal::unlink(g_name);
+
+    RedisChangeJournal journal;
+
+    if (journal.open(g_name, size) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to create journal\n");
+        return 1;
+    }
+
+    std::atomic<bool> done(false);
+
+    uint64_t total = 0;
+    uint64_t resyncs = 0;
+
+    int errors = 0;
+
+    // records of every writer come in order, with gaps only on resync
+    // or where writer skipped its sequence
+    std::thread reader([&]() {
+
+            RedisChangeJournal mapping;
+
+            if (mapping.open(g_name, 0) != SAI_STATUS_SUCCESS)
+            {
+                errors++;
+                return;
+            }
+
+            std::vector<uint32_t> next(TEST_WRITERS, 0);
+
+            std::vector<ssw::KeyOpFieldsValuesTuple> changes;
+
+            uint64_t after = 0;
+
+            for (bool last_pass = false; !last_pass; )
+            {
+                last_pass = done.load();
+
+                uint64_t last;
+
+                sai_status_t status = mapping.read(after, 256, changes, last);
+
+                if (status == SAI_STATUS_ITEM_NOT_FOUND)
+                {
+                    resyncs++;
+
+                    after = mapping.firstSequence() - 1;
+
+                    next.assign(TEST_WRITERS, 0);
+
+                    last_pass = false;
+                    continue;
+                }
+
+                if (status != SAI_STATUS_SUCCESS)
+                {
+                    fprintf(stderr, "read after %lu failed\n", after);
+                    errors++;
+                    return;
+                }
+
+                for (const auto &change: changes)
+                {
+                    uint32_t writer = 0;
+                    uint32_t i = 0;
+
+                    if (sscanf(kfvKey(change).c_str(), "%u:%u", &writer, &i) != 2 || writer >= TEST_WRITERS || i < next[writer])
+                    {
+                        fprintf(stderr, "change %s out of order\n", kfvKey(change).c_str());
+                        errors++;
+                        return;
+                    }
+
+                    next[writer] = i + 1;
+                }
+
+                total += changes.size();
+
+                if (last != after)
+                {
+                    last_pass = false;
+                }
+
+                after = last;
+            }
+    });
+
+    std::vector<std::thread> writers;
+
+    for (uint32_t writer = 0; writer < TEST_WRITERS; writer++)
+    {
+        writers.emplace_back(test_write, &journal, writer);
+    }
+
+    for (auto &writer: writers)
+    {
+        writer.join();
+    }
+
+    done = true;
+
+    reader.join();
+
+    uint64_t records = (uint64_t)TEST_WRITERS * TEST_WRITER_RECORDS;
+
+    if (journal.lastSequence() != records)
+    {
+        fprintf(stderr, "last sequence %lu of %lu\n", journal.lastSequence(), records);
+        errors++;
+    }
+
+    // journal large enough for all records is read without resync
+    if (size == TEST_LARGE_SIZE && (resyncs != 0 || total != records - records / 16))
+    {
+        fprintf(stderr, "read %lu of %lu records with %lu resyncs\n", total, records - records / 16, resyncs);
+        errors++;
+    }
+
+    RedisChangeJournal::unlink(g_name);
+
+    return errors;
+}
+
+int main()
+{
+    int errors = test_sequences();
+
+    errors += test_wraparound(96);
+
+    // small records, journal is bounded by index instead of data
+    errors += test_wraparound(0);
+
+    errors += test_truncate();
+
+    errors += test_dead_writer();
+
+    errors += test_catch_up();
+
+    errors += test_writers(TEST_LARGE_SIZE);
+
+    // writers trim records while reader reads them
+    errors += test_writers(TEST_SMALL_SIZE);
+
+    if (errors != 0)
+    {
+        fprintf(stderr, "%d errors\n", errors);
+        return 1;
+    }
+
+    return 0;
+}
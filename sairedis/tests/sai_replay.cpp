@@ -0,0 +1,694 @@
+#include "sai.h"
+#include "sai_serialize.h"
+#include "sai_redis_recorder.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <string>
+
+/*
+ * Replays calls recorded by sairedis with SAI_REDIS_RECORD_FILE set,
+ * against any SAI library this tool is linked with, and reports
+ * throughput and latency of replayed calls next to recorded ones.
+ *
+ * sai_replay [-p] [-k key=value]... record_file
+ *
+ * -p   keeps recorded pacing, by default calls are issued back to back
+ * -k   profile value passed to sai_api_initialize
+ *
+ * Calls are replayed from single thread in order of start time. Object
+ * ids returned by replayed creates replace recorded ids in later keys
+ * and in object id attributes, ids which were not created in recording
+ * (ports, queues, switch defaults) are passed unchanged. Get replays
+ * ask for same attributes, lists are read into scratch buffers.
+ *
+ * Built against libsairedis by make check, to replay against other SAI,
+ * for example stub, link sai_replay.cpp, sai_serialize.cpp and generated
+ * sai_serialize_table.cpp with that library instead.
+ */
+
+#define REPLAY_LIST_SCRATCH_SIZE    (64 * 1024)
+
+// fits largest list element, qos map
+#define REPLAY_LIST_MAX_ELEMENT     64
+
+typedef struct _replay_record_t
+{
+    uint64_t timestamp;
+    uint64_t duration;
+    uint32_t api;
+    uint32_t method;
+    sai_object_type_t object_type;
+    sai_common_api_t common_api;
+    sai_status_t status;
+
+    std::string key;
+
+    // attribute id, value
+    std::vector<std::pair<std::string, std::string>> attrs;
+
+} replay_record_t;
+
+static std::map<std::string, std::string> g_profile;
+
+const char* replay_profile_get_value(
+        _In_ sai_switch_profile_id_t profile_id,
+        _In_ const char* variable)
+{
+    auto it = g_profile.find(variable);
+
+    return (it == g_profile.end()) ? NULL : it->second.c_str();
+}
+
+int replay_profile_get_next_value(
+        _In_ sai_switch_profile_id_t profile_id,
+        _Out_ const char** variable,
+        _Out_ const char** value)
+{
+    return -1;
+}
+
+static const service_method_table_t g_replay_services = {
+    replay_profile_get_value,
+    replay_profile_get_next_value
+};
+
+// recorded id to replayed id
+static std::unordered_map<sai_object_id_t, sai_object_id_t> g_oids;
+
+static bool replay_get_string(
+        _In_ const std::string &buffer,
+        _Inout_ size_t &offset,
+        _In_ size_t end,
+        _Out_ std::string &str)
+{
+    uint64_t length;
+
+    if (!sai_binary_deserialize_varint(buffer.data(), end, offset, length) || length > end - offset)
+    {
+        return false;
+    }
+
+    str.assign(buffer, offset, (size_t)length);
+
+    offset += (size_t)length;
+
+    return true;
+}
+
+static bool replay_parse_record(
+        _In_ const std::string &buffer,
+        _In_ size_t offset,
+        _In_ size_t end,
+        _Out_ replay_record_t &record)
+{
+    uint64_t v[8];
+
+    for (auto &value: v)
+    {
+        if (!sai_binary_deserialize_varint(buffer.data(), end, offset, value))
+        {
+            return false;
+        }
+    }
+
+    record.timestamp = v[0];
+    record.duration = v[1];
+    record.api = (uint32_t)v[3];
+    record.method = (uint32_t)v[4];
+    record.object_type = (sai_object_type_t)v[5];
+    record.common_api = (sai_common_api_t)v[6];
+    record.status = (sai_status_t)(uint32_t)v[7];
+
+    uint64_t count;
+
+    if (!replay_get_string(buffer, offset, end, record.key) ||
+            !sai_binary_deserialize_varint(buffer.data(), end, offset, count))
+    {
+        return false;
+    }
+
+    record.attrs.clear();
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        std::string id;
+        std::string value;
+
+        if (!replay_get_string(buffer, offset, end, id) || !replay_get_string(buffer, offset, end, value))
+        {
+            return false;
+        }
+
+        record.attrs.emplace_back(std::move(id), std::move(value));
+    }
+
+    return offset == end;
+}
+
+static bool replay_load(
+        _In_ const char *path,
+        _Out_ std::vector<replay_record_t> &records)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "failed to open %s\n", path);
+        return false;
+    }
+
+    std::string buffer;
+
+    char chunk[64 * 1024];
+
+    size_t n;
+
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) != 0)
+    {
+        buffer.append(chunk, n);
+    }
+
+    fclose(file);
+
+    sai_redis_record_header_t header;
+
+    if (buffer.size() < sizeof(header))
+    {
+        fprintf(stderr, "%s is not record file\n", path);
+        return false;
+    }
+
+    memcpy(&header, buffer.data(), sizeof(header));
+
+    if (memcmp(header.magic, SAI_REDIS_RECORD_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != SAI_REDIS_RECORD_VERSION)
+    {
+        fprintf(stderr, "%s is not record file of version %d\n", path, SAI_REDIS_RECORD_VERSION);
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+
+    while (offset < buffer.size())
+    {
+        uint32_t length;
+
+        // file of process which was killed may end with partial record
+        if (buffer.size() - offset < sizeof(length))
+        {
+            fprintf(stderr, "ignoring truncated record at end of file\n");
+            break;
+        }
+
+        memcpy(&length, buffer.data() + offset, sizeof(length));
+
+        offset += sizeof(length);
+
+        if (length > buffer.size() - offset)
+        {
+            fprintf(stderr, "ignoring truncated record at end of file\n");
+            break;
+        }
+
+        replay_record_t record;
+
+        if (!replay_parse_record(buffer, offset, offset + length, record))
+        {
+            fprintf(stderr, "malformed record at offset %zu\n", offset - sizeof(length));
+            return false;
+        }
+
+        records.push_back(std::move(record));
+
+        offset += length;
+    }
+
+    // threads wrote records to file in batches
+    std::stable_sort(records.begin(), records.end(),
+            [](const replay_record_t &a, const replay_record_t &b) { return a.timestamp < b.timestamp; });
+
+    return true;
+}
+
+static sai_object_id_t replay_translate(
+        _In_ sai_object_id_t id)
+{
+    auto it = g_oids.find(id);
+
+    return (it == g_oids.end()) ? id : it->second;
+}
+
+static void replay_translate_list(
+        _Inout_ sai_object_list_t &list)
+{
+    for (uint32_t i = 0; i < list.count; i++)
+    {
+        list.list[i] = replay_translate(list.list[i]);
+    }
+}
+
+/*
+ * Builds attribute list of call, values are translated for set and
+ * create, for get list attributes point to scratch buffers.
+ */
+static bool replay_build_attrs(
+        _In_ const replay_record_t &record,
+        _Out_ std::vector<sai_attribute_t> &attrs,
+        _Inout_ std::vector<std::vector<char>> &scratch,
+        _Inout_ SaiDeserializeContext &context)
+{
+    attrs.resize(record.attrs.size());
+
+    if (scratch.size() < attrs.size())
+    {
+        scratch.resize(attrs.size(), std::vector<char>(REPLAY_LIST_SCRATCH_SIZE));
+    }
+
+    for (size_t i = 0; i < attrs.size(); i++)
+    {
+        sai_attribute_t &attr = attrs[i];
+
+        memset(&attr, 0, sizeof(attr));
+
+        const std::string &id = record.attrs[i].first;
+        const std::string &value = record.attrs[i].second;
+
+        sai_attr_serialization_type_t type;
+
+        if (sai_deserialize_attr_id(SAI_SERIALIZATION_FORMAT_BINARY, id.data(), id.size(), attr.id) != SAI_STATUS_SUCCESS ||
+                sai_get_serialization_type(record.object_type, attr.id, type) != SAI_STATUS_SUCCESS)
+        {
+            return false;
+        }
+
+        if (record.common_api == SAI_COMMON_API_GET)
+        {
+            // all lists share layout of count followed by pointer
+            sai_object_list_t *list = &attr.value.objlist;
+
+            if (type == SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_LIST)
+            {
+                list = &attr.value.aclfield.data.objlist;
+            }
+            else if (type == SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_LIST)
+            {
+                list = &attr.value.aclaction.parameter.objlist;
+            }
+
+            list->count = REPLAY_LIST_SCRATCH_SIZE / REPLAY_LIST_MAX_ELEMENT;
+            list->list = (sai_object_id_t*)scratch[i].data();
+
+            continue;
+        }
+
+        if (sai_deserialize_attr_value(SAI_SERIALIZATION_FORMAT_BINARY, value.data(), value.size(), type, attr, context) != SAI_STATUS_SUCCESS)
+        {
+            return false;
+        }
+
+        switch (type)
+        {
+            case SAI_SERIALIZATION_TYPE_OBJECT_ID:
+                attr.value.oid = replay_translate(attr.value.oid);
+                break;
+
+            case SAI_SERIALIZATION_TYPE_OBJECT_LIST:
+                replay_translate_list(attr.value.objlist);
+                break;
+
+            case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_ID:
+                attr.value.aclfield.data.oid = replay_translate(attr.value.aclfield.data.oid);
+                break;
+
+            case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_LIST:
+                replay_translate_list(attr.value.aclfield.data.objlist);
+                break;
+
+            case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_ID:
+                attr.value.aclaction.parameter.oid = replay_translate(attr.value.aclaction.parameter.oid);
+                break;
+
+            case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_LIST:
+                replay_translate_list(attr.value.aclaction.parameter.objlist);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return true;
+}
+
+template<typename T>
+static bool replay_get_key(
+        _In_ const replay_record_t &record,
+        _Out_ T &key)
+{
+    size_t offset = 0;
+
+    return sai_deserialize_primitive(SAI_SERIALIZATION_FORMAT_BINARY, record.key.data(), record.key.size(), offset, key) &&
+        offset == record.key.size();
+}
+
+/*
+ * Calls method of entry object, key is entry struct passed by pointer.
+ */
+template<typename E>
+static sai_status_t replay_call_entry(
+        _In_ void *fn,
+        _In_ const replay_record_t &record,
+        _In_ const E &entry,
+        _Inout_ std::vector<sai_attribute_t> &attrs)
+{
+    uint32_t count = (uint32_t)attrs.size();
+
+    switch (record.common_api)
+    {
+        case SAI_COMMON_API_CREATE:
+            return ((sai_status_t (*)(const E*, uint32_t, const sai_attribute_t*))fn)(&entry, count, attrs.data());
+
+        case SAI_COMMON_API_REMOVE:
+            return ((sai_status_t (*)(const E*))fn)(&entry);
+
+        case SAI_COMMON_API_SET:
+            return count == 1 ? ((sai_status_t (*)(const E*, const sai_attribute_t*))fn)(&entry, attrs.data()) : SAI_STATUS_INVALID_PARAMETER;
+
+        case SAI_COMMON_API_GET:
+            return ((sai_status_t (*)(const E*, uint32_t, sai_attribute_t*))fn)(&entry, count, attrs.data());
+
+        default:
+            return SAI_STATUS_INVALID_PARAMETER;
+    }
+}
+
+/*
+ * Calls method of object keyed by value, object id or vlan id.
+ */
+template<typename K>
+static sai_status_t replay_call_value(
+        _In_ void *fn,
+        _In_ const replay_record_t &record,
+        _In_ K key,
+        _Inout_ std::vector<sai_attribute_t> &attrs)
+{
+    uint32_t count = (uint32_t)attrs.size();
+
+    switch (record.common_api)
+    {
+        case SAI_COMMON_API_REMOVE:
+            return ((sai_status_t (*)(K))fn)(key);
+
+        case SAI_COMMON_API_SET:
+            return count == 1 ? ((sai_status_t (*)(K, const sai_attribute_t*))fn)(key, attrs.data()) : SAI_STATUS_INVALID_PARAMETER;
+
+        case SAI_COMMON_API_GET:
+            return ((sai_status_t (*)(K, uint32_t, sai_attribute_t*))fn)(key, count, attrs.data());
+
+        default:
+            return SAI_STATUS_INVALID_PARAMETER;
+    }
+}
+
+/*
+ * Replays one call, returns false when record can't be replayed,
+ * status of call is returned in status.
+ */
+static bool replay_call(
+        _In_ void *fn,
+        _In_ const replay_record_t &record,
+        _Inout_ std::vector<sai_attribute_t> &attrs,
+        _Out_ sai_status_t &status,
+        _Out_ uint64_t &latency)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    switch (record.object_type)
+    {
+        case SAI_OBJECT_TYPE_FDB:
+            {
+                sai_fdb_entry_t entry;
+
+                if (!replay_get_key(record, entry))
+                    return false;
+
+                status = replay_call_entry(fn, record, entry, attrs);
+            }
+            break;
+
+        case SAI_OBJECT_TYPE_NEIGHBOR:
+            {
+                sai_neighbor_entry_t entry;
+
+                if (!replay_get_key(record, entry))
+                    return false;
+
+                entry.rif_id = replay_translate(entry.rif_id);
+
+                status = replay_call_entry(fn, record, entry, attrs);
+            }
+            break;
+
+        case SAI_OBJECT_TYPE_ROUTE:
+            {
+                sai_unicast_route_entry_t entry;
+
+                if (!replay_get_key(record, entry))
+                    return false;
+
+                entry.vr_id = replay_translate(entry.vr_id);
+
+                status = replay_call_entry(fn, record, entry, attrs);
+            }
+            break;
+
+        case SAI_OBJECT_TYPE_VLAN:
+            {
+                sai_vlan_id_t vlan_id;
+
+                if (!replay_get_key(record, vlan_id))
+                    return false;
+
+                if (record.common_api == SAI_COMMON_API_CREATE)
+                    status = ((sai_status_t (*)(sai_vlan_id_t))fn)(vlan_id);
+                else
+                    status = replay_call_value(fn, record, vlan_id, attrs);
+            }
+            break;
+
+        case SAI_OBJECT_TYPE_SWITCH:
+
+            if (record.common_api == SAI_COMMON_API_SET && attrs.size() == 1)
+                status = ((sai_status_t (*)(const sai_attribute_t*))fn)(attrs.data());
+            else if (record.common_api == SAI_COMMON_API_GET)
+                status = ((sai_status_t (*)(sai_uint32_t, sai_attribute_t*))fn)((sai_uint32_t)attrs.size(), attrs.data());
+            else
+                return false;
+
+            break;
+
+        default:
+            {
+                sai_object_id_t id;
+
+                if (!replay_get_key(record, id))
+                    return false;
+
+                if (record.common_api == SAI_COMMON_API_CREATE)
+                {
+                    sai_object_id_t created = SAI_NULL_OBJECT_ID;
+
+                    status = ((sai_status_t (*)(sai_object_id_t*, uint32_t, const sai_attribute_t*))fn)(&created, (uint32_t)attrs.size(), attrs.data());
+
+                    if (status == SAI_STATUS_SUCCESS && id != SAI_NULL_OBJECT_ID)
+                    {
+                        g_oids[id] = created;
+                    }
+                }
+                else
+                {
+                    status = replay_call_value(fn, record, replay_translate(id), attrs);
+                }
+            }
+            break;
+    }
+
+    latency = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    return true;
+}
+
+static void replay_print_latency(
+        _In_ const char *name,
+        _Inout_ std::vector<uint64_t> &latencies)
+{
+    if (latencies.empty())
+    {
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))] / 1000.0;
+    };
+
+    printf("%-16s %10zu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+            name,
+            latencies.size(),
+            percentile(0.5),
+            percentile(0.9),
+            percentile(0.99),
+            percentile(0.999),
+            latencies.back() / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    bool paced = false;
+
+    int opt;
+
+    while ((opt = getopt(argc, argv, "pk:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p':
+                paced = true;
+                break;
+
+            case 'k':
+                {
+                    const char *eq = strchr(optarg, '=');
+
+                    if (eq == NULL)
+                    {
+                        fprintf(stderr, "profile value must be key=value\n");
+                        return 1;
+                    }
+
+                    g_profile[std::string(optarg, eq - optarg)] = eq + 1;
+                }
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-p] [-k key=value]... record_file\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind + 1 != argc)
+    {
+        fprintf(stderr, "usage: %s [-p] [-k key=value]... record_file\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<replay_record_t> records;
+
+    if (!replay_load(argv[optind], records))
+    {
+        return 1;
+    }
+
+    if (sai_api_initialize(0, &g_replay_services) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "sai_api_initialize failed\n");
+        return 1;
+    }
+
+    std::map<uint32_t, void**> tables;
+
+    static const char *api_names[] = { "create", "remove", "set", "get" };
+
+    std::vector<uint64_t> latencies;
+    std::vector<uint64_t> recorded;
+    std::vector<uint64_t> api_latencies[SAI_COMMON_API_MAX];
+
+    std::vector<sai_attribute_t> attrs;
+    std::vector<std::vector<char>> scratch;
+
+    SaiDeserializeContext context;
+
+    uint64_t skipped = 0;
+    uint64_t mismatched = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (const auto &record: records)
+    {
+        if (paced)
+        {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(record.timestamp));
+        }
+
+        auto it = tables.find(record.api);
+
+        if (it == tables.end())
+        {
+            void **table = NULL;
+
+            if (sai_api_query((sai_api_t)record.api, (void**)&table) != SAI_STATUS_SUCCESS)
+            {
+                table = NULL;
+            }
+
+            it = tables.emplace(record.api, table).first;
+        }
+
+        context.reset();
+
+        if (it->second == NULL ||
+                record.common_api >= SAI_COMMON_API_MAX ||
+                !replay_build_attrs(record, attrs, scratch, context))
+        {
+            skipped++;
+            continue;
+        }
+
+        void *fn = it->second[record.method];
+
+        sai_status_t status;
+        uint64_t latency;
+
+        if (fn == NULL || !replay_call(fn, record, attrs, status, latency))
+        {
+            skipped++;
+            continue;
+        }
+
+        mismatched += (status != record.status);
+
+        latencies.push_back(latency);
+        recorded.push_back(record.duration);
+        api_latencies[record.common_api].push_back(latency);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    sai_api_uninitialize();
+
+    printf("%zu records, %zu replayed, %lu skipped, %lu with other status than recorded\n",
+            records.size(), latencies.size(), skipped, mismatched);
+
+    printf("%.0f ops/s in %.3f s%s\n", latencies.size() / seconds, seconds, paced ? " at recorded pacing" : "");
+
+    printf("%-16s %10s %10s %10s %10s %10s %10s\n", "latency us", "ops", "p50", "p90", "p99", "p99.9", "max");
+
+    for (int api = SAI_COMMON_API_CREATE; api < SAI_COMMON_API_MAX; api++)
+    {
+        replay_print_latency(api_names[api], api_latencies[api]);
+    }
+
+    replay_print_latency("all", latencies);
+    replay_print_latency("recorded", recorded);
+
+    return 0;
+}
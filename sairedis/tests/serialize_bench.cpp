@@ -0,0 +1,746 @@
+#include "sai_serialize.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#define BENCH_ITERATIONS    200000
+#define BENCH_LIST_COUNT    16
+
+// previous stringstream based encoder, kept to verify output compatibility
+template<typename T>
+void reference_serialize_primitive(
+        _In_ const T &element,
+        _Out_ std::string &s)
+{
+    std::stringstream ss;
+
+    unsigned const char* mem = reinterpret_cast<const unsigned char*>(&element);
+
+    for (size_t i = 0; i < sizeof(T); i++)
+    {
+        ss << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)mem[i];
+    }
+
+    s += ss.str();
+}
+
+static unsigned char g_list_buffer[BENCH_LIST_COUNT * 64];
+
+template<typename T>
+void bench_set_list(
+        _Out_ T &element)
+{
+    element.count = BENCH_LIST_COUNT;
+    element.list = reinterpret_cast<decltype(element.list)>(g_list_buffer);
+}
+
+void bench_fill_attr(
+        _In_ sai_attr_serialization_type_t type,
+        _Out_ sai_attribute_t &attr)
+{
+    unsigned char *mem = reinterpret_cast<unsigned char*>(&attr.value);
+
+    for (size_t i = 0; i < sizeof(attr.value); i++)
+    {
+        mem[i] = (unsigned char)(i * 37 + 11);
+    }
+
+    attr.id = 0x1234;
+
+    switch (type)
+    {
+        case SAI_SERIALIZATION_TYPE_OBJECT_LIST:    bench_set_list(attr.value.objlist); break;
+        case SAI_SERIALIZATION_TYPE_UINT8_LIST:     bench_set_list(attr.value.u8list); break;
+        case SAI_SERIALIZATION_TYPE_INT8_LIST:      bench_set_list(attr.value.s8list); break;
+        case SAI_SERIALIZATION_TYPE_UINT16_LIST:    bench_set_list(attr.value.u16list); break;
+        case SAI_SERIALIZATION_TYPE_INT16_LIST:     bench_set_list(attr.value.s16list); break;
+        case SAI_SERIALIZATION_TYPE_UINT32_LIST:    bench_set_list(attr.value.u32list); break;
+        case SAI_SERIALIZATION_TYPE_INT32_LIST:     bench_set_list(attr.value.s32list); break;
+        case SAI_SERIALIZATION_TYPE_VLAN_LIST:      bench_set_list(attr.value.vlanlist); break;
+        case SAI_SERIALIZATION_TYPE_VLAN_PORT_LIST: bench_set_list(attr.value.vlanportlist); break;
+        case SAI_SERIALIZATION_TYPE_PORT_BREAKOUT:  bench_set_list(attr.value.portbreakout.port_list); break;
+        case SAI_SERIALIZATION_TYPE_QOS_MAP_LIST:   bench_set_list(attr.value.qosmap); break;
+        case SAI_SERIALIZATION_TYPE_TUNNEL_MAP_LIST: bench_set_list(attr.value.tunnelmap); break;
+
+        case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_OBJECT_LIST:
+            bench_set_list(attr.value.aclfield.data.objlist);
+            break;
+
+        case SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT8_LIST:
+            bench_set_list(attr.value.aclfield.mask.u8list);
+            bench_set_list(attr.value.aclfield.data.u8list);
+            break;
+
+        case SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_LIST:
+            bench_set_list(attr.value.aclaction.parameter.objlist);
+            break;
+
+        default:
+            break;
+    }
+}
+
+double bench_elapsed_ns(
+        _In_ std::chrono::steady_clock::time_point start,
+        _In_ int iterations)
+{
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+int bench_check_hex_codec()
+{
+    int errors = 0;
+
+    std::vector<unsigned char> data(300);
+
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = (unsigned char)rand();
+    }
+
+    for (size_t size = 0; size <= data.size(); size++)
+    {
+        std::string expected;
+
+        for (size_t i = 0; i < size; i++)
+        {
+            reference_serialize_primitive(data[i], expected);
+        }
+
+        std::string s(2 * size, ' ');
+
+        sai_hex_encode(data.data(), size, &s[0]);
+
+        if (s != expected)
+        {
+            fprintf(stderr, "hex encode mismatch for size %zu\n", size);
+            errors++;
+        }
+
+        std::vector<unsigned char> decoded(size + 1);
+
+        if (!sai_hex_decode(s.c_str(), size, decoded.data()) ||
+                memcmp(decoded.data(), data.data(), size) != 0)
+        {
+            fprintf(stderr, "hex decode mismatch for size %zu\n", size);
+            errors++;
+        }
+    }
+
+    unsigned char c;
+
+    if (!sai_hex_decode("aF", 1, &c) || c != 0xaf)
+    {
+        fprintf(stderr, "hex decode failed on mixed case input\n");
+        errors++;
+    }
+
+    if (sai_hex_decode("0g", 1, &c))
+    {
+        fprintf(stderr, "hex decode accepted invalid input\n");
+        errors++;
+    }
+
+    try
+    {
+        std::string s = "zz";
+        int index = 0;
+
+        sai_deserialize_primitive(s, index, c);
+
+        fprintf(stderr, "deserialize primitive did not throw on invalid input\n");
+        errors++;
+    }
+    catch (const std::string &)
+    {
+    }
+
+    return errors;
+}
+
+int bench_check_serialization_type(
+        _In_ sai_object_type_t object_type,
+        _In_ sai_attr_id_t attr_id,
+        _In_ sai_status_t expected_status,
+        _In_ sai_attr_serialization_type_t expected_type)
+{
+    sai_attr_serialization_type_t type = SAI_SERIALIZATION_TYPE_NONE;
+
+    sai_status_t status = sai_get_serialization_type(object_type, attr_id, type);
+
+    if (status != expected_status || (status == SAI_STATUS_SUCCESS && type != expected_type))
+    {
+        fprintf(stderr, "unexpected serialization type lookup for object type %d attr 0x%x\n", object_type, attr_id);
+        return 1;
+    }
+
+    return 0;
+}
+
+int bench_serialization_table()
+{
+    int errors = 0;
+
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_PORT, SAI_PORT_ATTR_SPEED, SAI_STATUS_SUCCESS, SAI_SERIALIZATION_TYPE_UINT32);
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_ROUTE, SAI_ROUTE_ATTR_NEXT_HOP_ID, SAI_STATUS_SUCCESS, SAI_SERIALIZATION_TYPE_OBJECT_ID);
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_ROUTER_INTERFACE, SAI_ROUTER_INTERFACE_ATTR_VLAN_ID, SAI_STATUS_SUCCESS, SAI_SERIALIZATION_TYPE_UINT16);
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_HOST_INTERFACE, SAI_HOSTIF_ATTR_NAME, SAI_STATUS_SUCCESS, SAI_SERIALIZATION_TYPE_CHARDATA);
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_ACL_ENTRY, SAI_ACL_ENTRY_ATTR_FIELD_SRC_IP, SAI_STATUS_SUCCESS, SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_IP4);
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_ACL_ENTRY, SAI_ACL_ENTRY_ATTR_ACTION_REDIRECT, SAI_STATUS_SUCCESS, SAI_SERIALIZATION_TYPE_ACL_ACTION_DATA_OBJECT_ID);
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_ACL_TABLE, SAI_ACL_TABLE_ATTR_FIELD_SRC_IP, SAI_STATUS_SUCCESS, SAI_SERIALIZATION_TYPE_BOOL);
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_TUNNEL_MAP, SAI_TUNNEL_MAP_ATTR_MAP_TO_VALUE_LIST, SAI_STATUS_SUCCESS, SAI_SERIALIZATION_TYPE_TUNNEL_MAP_LIST);
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_PORT, SAI_PORT_ATTR_CUSTOM_RANGE_BASE, SAI_STATUS_NOT_IMPLEMENTED, SAI_SERIALIZATION_TYPE_NONE);
+    errors += bench_check_serialization_type(SAI_OBJECT_TYPE_MAX, 0, SAI_STATUS_NOT_IMPLEMENTED, SAI_SERIALIZATION_TYPE_NONE);
+
+    std::string name;
+
+    if (sai_get_object_type_string(SAI_OBJECT_TYPE_VLAN, name) != SAI_STATUS_SUCCESS || name != "SAI_OBJECT_TYPE_VLAN")
+    {
+        fprintf(stderr, "unexpected object type name %s\n", name.c_str());
+        errors++;
+    }
+
+    sai_attr_serialization_type_t type;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        sai_get_serialization_type(SAI_OBJECT_TYPE_ACL_ENTRY, SAI_ACL_ENTRY_ATTR_ACTION_REDIRECT, type);
+    }
+
+    printf("%-48s %10.1f\n", "sai_get_serialization_type", bench_elapsed_ns(start, BENCH_ITERATIONS));
+
+    return errors;
+}
+
+#define BENCH_MESSAGE_ATTRS 64
+
+int bench_deserialize_context()
+{
+    // message similar to ASIC_STATE dump entry, mostly list attributes
+
+    const sai_attr_serialization_type_t types[] = {
+        SAI_SERIALIZATION_TYPE_OBJECT_LIST,
+        SAI_SERIALIZATION_TYPE_VLAN_PORT_LIST,
+        SAI_SERIALIZATION_TYPE_ACL_FIELD_DATA_UINT8_LIST,
+        SAI_SERIALIZATION_TYPE_UINT32,
+    };
+
+    const size_t type_count = sizeof(types) / sizeof(types[0]);
+
+    std::string s;
+
+    for (int i = 0; i < BENCH_MESSAGE_ATTRS; i++)
+    {
+        sai_attribute_t attr;
+
+        bench_fill_attr(types[i % type_count], attr);
+
+        sai_serialize_attr_value(types[i % type_count], attr, s);
+    }
+
+    std::string b;
+
+    for (int i = 0; i < BENCH_MESSAGE_ATTRS; i++)
+    {
+        sai_attribute_t attr;
+
+        bench_fill_attr(types[i % type_count], attr);
+
+        sai_binary_serialize_attr_value(types[i % type_count], attr, b);
+    }
+
+    sai_attribute_t attrs[BENCH_MESSAGE_ATTRS];
+
+    SaiDeserializeContext context(4096);
+
+    int errors = 0;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        int index = 0;
+
+        std::string round_trip;
+
+        for (int i = 0; i < BENCH_MESSAGE_ATTRS; i++)
+        {
+            if (sai_deserialize_attr_value(s, index, types[i % type_count], attrs[i], context) != SAI_STATUS_SUCCESS)
+            {
+                errors++;
+            }
+
+            sai_serialize_attr_value(types[i % type_count], attrs[i], round_trip);
+        }
+
+        if (round_trip != s)
+        {
+            fprintf(stderr, "context deserialize round trip mismatch\n");
+            errors++;
+        }
+
+        index = 0;
+
+        round_trip.clear();
+
+        for (int i = 0; i < BENCH_MESSAGE_ATTRS; i++)
+        {
+            if (sai_binary_deserialize_attr_value(b, index, types[i % type_count], attrs[i], context) != SAI_STATUS_SUCCESS)
+            {
+                errors++;
+            }
+
+            sai_binary_serialize_attr_value(types[i % type_count], attrs[i], round_trip);
+        }
+
+        if (round_trip != b)
+        {
+            fprintf(stderr, "context binary deserialize round trip mismatch\n");
+            errors++;
+        }
+
+        // second pass must reuse blocks from first one
+        size_t capacity = context.capacity();
+
+        context.reset();
+
+        if (pass == 1 && capacity != context.capacity())
+        {
+            fprintf(stderr, "context did not reuse blocks after reset\n");
+            errors++;
+        }
+    }
+
+    const int iterations = BENCH_ITERATIONS / BENCH_MESSAGE_ATTRS;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int n = 0; n < iterations; n++)
+    {
+        int index = 0;
+
+        for (int i = 0; i < BENCH_MESSAGE_ATTRS; i++)
+        {
+            sai_deserialize_attr_value(s, index, types[i % type_count], attrs[i]);
+        }
+
+        for (int i = 0; i < BENCH_MESSAGE_ATTRS; i++)
+        {
+            sai_deserialize_free_attribute_value(types[i % type_count], attrs[i]);
+        }
+    }
+
+    double heap_ns = bench_elapsed_ns(start, iterations);
+
+    start = std::chrono::steady_clock::now();
+
+    for (int n = 0; n < iterations; n++)
+    {
+        int index = 0;
+
+        for (int i = 0; i < BENCH_MESSAGE_ATTRS; i++)
+        {
+            sai_deserialize_attr_value(s, index, types[i % type_count], attrs[i], context);
+        }
+
+        context.reset();
+    }
+
+    double context_ns = bench_elapsed_ns(start, iterations);
+
+    printf("%-48s %10.1f   (heap %.1f, %d attrs)\n", "deserialize message with context", context_ns, heap_ns, BENCH_MESSAGE_ATTRS);
+
+    return errors;
+}
+
+int bench_attr_list(
+        _In_ sai_serialization_format_t format)
+{
+    const sai_attr_id_t ids[] = {
+        SAI_ACL_ENTRY_ATTR_TABLE_ID,
+        SAI_ACL_ENTRY_ATTR_PRIORITY,
+        SAI_ACL_ENTRY_ATTR_FIELD_SRC_IP,
+        SAI_ACL_ENTRY_ATTR_FIELD_IN_PORTS,
+        SAI_ACL_ENTRY_ATTR_ACTION_REDIRECT,
+    };
+
+    const uint32_t count = sizeof(ids) / sizeof(ids[0]);
+
+    // fields and values as they come in HGETALL reply
+    std::vector<std::string> reply;
+
+    sai_attr_serialization_type_t types[count];
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sai_get_serialization_type(SAI_OBJECT_TYPE_ACL_ENTRY, ids[i], types[i]);
+
+        sai_attribute_t attr;
+
+        bench_fill_attr(types[i], attr);
+
+        attr.id = ids[i];
+
+        std::string field;
+        std::string value;
+
+        sai_serialize_attr_id(format, attr, field);
+        sai_serialize_attr_value(format, types[i], attr, value);
+
+        reply.push_back(field);
+        reply.push_back(value);
+    }
+
+    sai_serialized_view_t fvs[2 * count];
+
+    for (uint32_t i = 0; i < 2 * count; i++)
+    {
+        fvs[i].data = reply[i].data();
+        fvs[i].size = reply[i].size();
+    }
+
+    SaiDeserializeContext context;
+
+    sai_attribute_t attrs[count];
+
+    if (sai_deserialize_attr_list(format, SAI_OBJECT_TYPE_ACL_ENTRY, count, fvs, attrs, context) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to deserialize attribute list\n");
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::string value;
+
+        sai_serialize_attr_value(format, types[i], attrs[i], value);
+
+        if (attrs[i].id != ids[i] || value != reply[2 * i + 1])
+        {
+            fprintf(stderr, "attribute list mismatch at %u\n", i);
+            return 1;
+        }
+    }
+
+    // truncate value of each attribute, list must be rejected
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sai_serialized_view_t truncated[2 * count];
+
+        memcpy(truncated, fvs, sizeof(fvs));
+
+        truncated[2 * i + 1].size--;
+
+        if (sai_deserialize_attr_list(format, SAI_OBJECT_TYPE_ACL_ENTRY, count, truncated, attrs, context) == SAI_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "attribute list accepted truncated value %u\n", i);
+            return 1;
+        }
+    }
+
+    context.reset();
+
+    // previous path, each reply element is copied to std::string first
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int n = 0; n < BENCH_ITERATIONS / 10; n++)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            std::string field(fvs[2 * i].data, fvs[2 * i].size);
+            std::string value(fvs[2 * i + 1].data, fvs[2 * i + 1].size);
+
+            int index = 0;
+
+            if (format == SAI_SERIALIZATION_FORMAT_BINARY)
+            {
+                uint64_t id;
+
+                sai_binary_deserialize_varint(field, index, id);
+
+                attrs[i].id = (sai_attr_id_t)id;
+            }
+            else
+            {
+                sai_deserialize_primitive(field, index, attrs[i].id);
+            }
+
+            sai_attr_serialization_type_t type;
+
+            sai_get_serialization_type(SAI_OBJECT_TYPE_ACL_ENTRY, attrs[i].id, type);
+
+            index = 0;
+
+            if (format == SAI_SERIALIZATION_FORMAT_BINARY)
+            {
+                sai_binary_deserialize_attr_value(value, index, type, attrs[i]);
+            }
+            else
+            {
+                sai_deserialize_attr_value(value, index, type, attrs[i]);
+            }
+
+            sai_deserialize_free_attribute_value(type, attrs[i]);
+        }
+    }
+
+    double string_ns = bench_elapsed_ns(start, BENCH_ITERATIONS / 10);
+
+    start = std::chrono::steady_clock::now();
+
+    for (int n = 0; n < BENCH_ITERATIONS / 10; n++)
+    {
+        sai_deserialize_attr_list(format, SAI_OBJECT_TYPE_ACL_ENTRY, count, fvs, attrs, context);
+
+        context.reset();
+    }
+
+    double view_ns = bench_elapsed_ns(start, BENCH_ITERATIONS / 10);
+
+    printf("%-48s %10.1f   (std::string %.1f, %u attrs)\n",
+            format == SAI_SERIALIZATION_FORMAT_BINARY ? "binary attr list from reply view" : "hex attr list from reply view",
+            view_ns, string_ns, count);
+
+    return 0;
+}
+
+int bench_route_entry()
+{
+    sai_unicast_route_entry_t route_entry;
+
+    memset(&route_entry, 0, sizeof(route_entry));
+
+    route_entry.vr_id = 0x1000000000000001ULL;
+    route_entry.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV6;
+
+    for (int i = 0; i < 16; i++)
+    {
+        route_entry.destination.addr.ip6[i] = (uint8_t)(0x20 + i);
+        route_entry.destination.mask.ip6[i] = (uint8_t)(i < 8 ? 0xff : 0);
+    }
+
+    std::string expected;
+    reference_serialize_primitive(route_entry, expected);
+
+    std::string s;
+    sai_serialize_primitive(route_entry, s);
+
+    if (s != expected)
+    {
+        fprintf(stderr, "route entry serialization is not compatible\n");
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        s.clear();
+        reference_serialize_primitive(route_entry, s);
+    }
+
+    double reference_ns = bench_elapsed_ns(start, BENCH_ITERATIONS);
+
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        s.clear();
+        sai_serialize_primitive(route_entry, s);
+    }
+
+    double serialize_ns = bench_elapsed_ns(start, BENCH_ITERATIONS);
+
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        int index = 0;
+        sai_deserialize_primitive(s, index, route_entry);
+    }
+
+    double deserialize_ns = bench_elapsed_ns(start, BENCH_ITERATIONS);
+
+    printf("%-48s %10.1f %10.1f   (stringstream %.1f)\n",
+            "sai_unicast_route_entry_t", serialize_ns, deserialize_ns, reference_ns);
+
+    return 0;
+}
+
+int bench_attr_value(
+        _In_ sai_attr_serialization_type_t type)
+{
+    sai_attribute_t attr;
+
+    bench_fill_attr(type, attr);
+
+    std::string s;
+
+    if (sai_serialize_attr_value(type, attr, s) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to serialize type %d\n", type);
+        return 1;
+    }
+
+    sai_attribute_t decoded;
+
+    int index = 0;
+
+    if (sai_deserialize_attr_value(s, index, type, decoded) != SAI_STATUS_SUCCESS ||
+            index != (int)s.size())
+    {
+        fprintf(stderr, "failed to deserialize type %d\n", type);
+        return 1;
+    }
+
+    std::string round_trip;
+
+    sai_serialize_attr_value(type, decoded, round_trip);
+
+    sai_deserialize_free_attribute_value(type, decoded);
+
+    if (round_trip != s)
+    {
+        fprintf(stderr, "round trip mismatch for type %d\n", type);
+        return 1;
+    }
+
+    SaiDeserializeContext context;
+
+    for (size_t len = 0; len < s.size(); len++)
+    {
+        // exact size copy, so reading past end is caught by sanitizers
+        std::vector<char> truncated(s.begin(), s.begin() + len);
+
+        if (sai_deserialize_attr_value(SAI_SERIALIZATION_FORMAT_HEX, truncated.data(), len, type, decoded, context) == SAI_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "deserialize accepted truncated type %d\n", type);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        s.clear();
+        sai_serialize_attr_value(type, attr, s);
+    }
+
+    double serialize_ns = bench_elapsed_ns(start, BENCH_ITERATIONS);
+
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        index = 0;
+        sai_deserialize_attr_value(s, index, type, decoded);
+        sai_deserialize_free_attribute_value(type, decoded);
+    }
+
+    double deserialize_ns = bench_elapsed_ns(start, BENCH_ITERATIONS);
+
+    std::string b;
+
+    if (sai_binary_serialize_attr_value(type, attr, b) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to binary serialize type %d\n", type);
+        return 1;
+    }
+
+    index = 0;
+
+    if (sai_binary_deserialize_attr_value(b, index, type, decoded) != SAI_STATUS_SUCCESS ||
+            index != (int)b.size())
+    {
+        fprintf(stderr, "failed to binary deserialize type %d\n", type);
+        return 1;
+    }
+
+    round_trip.clear();
+
+    sai_binary_serialize_attr_value(type, decoded, round_trip);
+
+    sai_deserialize_free_attribute_value(type, decoded);
+
+    if (round_trip != b)
+    {
+        fprintf(stderr, "binary round trip mismatch for type %d\n", type);
+        return 1;
+    }
+
+    for (size_t len = 0; len < b.size(); len++)
+    {
+        std::string truncated = b.substr(0, len);
+
+        index = 0;
+
+        if (sai_binary_deserialize_attr_value(truncated, index, type, decoded) == SAI_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "binary deserialize accepted truncated type %d\n", type);
+            return 1;
+        }
+    }
+
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        b.clear();
+        sai_binary_serialize_attr_value(type, attr, b);
+    }
+
+    double binary_serialize_ns = bench_elapsed_ns(start, BENCH_ITERATIONS);
+
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        index = 0;
+        sai_binary_deserialize_attr_value(b, index, type, decoded);
+        sai_deserialize_free_attribute_value(type, decoded);
+    }
+
+    double binary_deserialize_ns = bench_elapsed_ns(start, BENCH_ITERATIONS);
+
+    printf("%-48d %10.1f %10.1f %10.1f %10.1f   (%zu chars, %zu bytes)\n",
+            type, serialize_ns, deserialize_ns, binary_serialize_ns, binary_deserialize_ns, s.size(), b.size());
+
+    return 0;
+}
+
+int main()
+{
+    int errors = bench_check_hex_codec();
+
+    printf("%-48s %10s %10s %10s %10s\n", "serialization type", "ser ns", "deser ns", "bin ser", "bin deser");
+
+    errors += bench_serialization_table();
+
+    errors += bench_route_entry();
+
+    errors += bench_deserialize_context();
+
+    errors += bench_attr_list(SAI_SERIALIZATION_FORMAT_HEX);
+
+    errors += bench_attr_list(SAI_SERIALIZATION_FORMAT_BINARY);
+
+    for (int type = SAI_SERIALIZATION_TYPE_BOOL; type < SAI_SERIALIZATION_TYPE_NONE; type++)
+    {
+        errors += bench_attr_value((sai_attr_serialization_type_t)type);
+    }
+
+    if (errors != 0)
+    {
+        fprintf(stderr, "%d errors\n", errors);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include "sai_redis_shm_ring.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+
+/*
+ * Measures enqueue latency and throughput of shared memory ring with
+ * consumer in forked process, as between sairedis and its consumer.
+ * Records have size of typical route operation. Consumer checks that
+ * records of every producer arrive complete and in order.
+ *
+ * shm_bench [-t producers] [-n records_per_producer] [-s ring_size]
+ */
+
+#define BENCH_DEFAULT_RECORDS   2000000
+#define BENCH_DEFAULT_RING_SIZE (16 * 1024 * 1024)
+
+// every 64th push is timed, clock read costs about as much as push
+#define BENCH_SAMPLE_MASK       63
+
+static const char *g_name = "/sairedis_shm_bench";
+
+static int bench_consume(
+        _In_ uint32_t producers,
+        _In_ uint64_t records)
+{
+    ShmRing ring;
+
+    if (ring.open(g_name, 0) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "consumer failed to open ring\n");
+        return 1;
+    }
+
+    std::vector<uint64_t> next(producers, 0);
+
+    std::string record;
+
+    sai_serialized_view_t parts[3];
+
+    for (uint64_t received = 0; received < producers * records; )
+    {
+        if (!ring.pop(record))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint32_t producer;
+        uint64_t sequence;
+
+        if (!ShmRing::parse(record, 3, parts) || parts[0].size < sizeof(producer) + sizeof(sequence))
+        {
+            fprintf(stderr, "malformed record\n");
+            return 1;
+        }
+
+        memcpy(&producer, parts[0].data, sizeof(producer));
+        memcpy(&sequence, parts[0].data + sizeof(producer), sizeof(sequence));
+
+        if (producer >= producers || sequence != next[producer])
+        {
+            fprintf(stderr, "record %lu of producer %u out of order\n", sequence, producer);
+            return 1;
+        }
+
+        next[producer]++;
+
+        received++;
+    }
+
+    return 0;
+}
+
+static void bench_produce(
+        _In_ ShmRing *ring,
+        _In_ uint32_t producer,
+        _In_ uint64_t records,
+        _Out_ std::vector<uint64_t> *latencies,
+        _Out_ uint64_t *stalls)
+{
+    std::string key(96, 'k');
+    std::string value(64, 'v');
+    std::string op("Screate");
+
+    sai_serialized_view_t parts[3] = {
+        { key.data(), key.size() },
+        { value.data(), value.size() },
+        { op.data(), op.size() },
+    };
+
+    *stalls = 0;
+
+    for (uint64_t sequence = 0; sequence < records; sequence++)
+    {
+        memcpy(&key[0], &producer, sizeof(producer));
+        memcpy(&key[sizeof(producer)], &sequence, sizeof(sequence));
+
+        bool sampled = (sequence & BENCH_SAMPLE_MASK) == 0;
+
+        auto start = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+        while (!ring->push(3, parts))
+        {
+            (*stalls)++;
+
+            std::this_thread::yield();
+        }
+
+        if (sampled)
+        {
+            latencies->push_back((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count());
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t producers = 1;
+    uint64_t records = BENCH_DEFAULT_RECORDS;
+    uint64_t ring_size = BENCH_DEFAULT_RING_SIZE;
+
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:s:")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': producers = (uint32_t)atoi(optarg); break;
+            case 'n': records = (uint64_t)atoll(optarg); break;
+            case 's': ring_size = (uint64_t)atoll(optarg); break;
+
+            default:
+                fprintf(stderr, "usage: %s [-t producers] [-n records_per_producer] [-s ring_size]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (producers == 0 || records == 0)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    ShmRing::unlink(g_name);
+
+    ShmRing ring;
+
+    if (ring.open(g_name, ring_size) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "failed to create ring\n");
+        return 1;
+    }
+
+    pid_t consumer = fork();
+
+    if (consumer == 0)
+    {
+        _exit(bench_consume(producers, records));
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<std::vector<uint64_t>> latencies(producers);
+    std::vector<uint64_t> stalls(producers);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back(bench_produce, &ring, p, records, &latencies[p], &stalls[p]);
+    }
+
+    for (auto &thread: threads)
+    {
+        thread.join();
+    }
+
+    int status = 1;
+
+    waitpid(consumer, &status, 0);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ShmRing::unlink(g_name);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "consumer failed\n");
+        return 1;
+    }
+
+    std::vector<uint64_t> all;
+    uint64_t total_stalls = 0;
+
+    for (uint32_t p = 0; p < producers; p++)
+    {
+        all.insert(all.end(), latencies[p].begin(), latencies[p].end());
+        total_stalls += stalls[p];
+    }
+
+    std::sort(all.begin(), all.end());
+
+    printf("%u producers, %lu records: %.0f ops/s, %lu full ring retries\n",
+            producers, producers * records, producers * records / seconds, total_stalls);
+
+    printf("enqueue ns p50 %lu p90 %lu p99 %lu p99.9 %lu\n",
+            all[all.size() / 2],
+            all[all.size() * 9 / 10],
+            all[all.size() * 99 / 100],
+            all[all.size() * 999 / 1000]);
+
+    return 0;
+}
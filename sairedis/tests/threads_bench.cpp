@@ -0,0 +1,209 @@
+#include "sai_redis.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <map>
+#include <string>
+
+/*
+ * Measures create/remove route throughput of concurrent callers.
+ * Each thread programs its own routes, run is repeated for 1, 2, 4 ...
+ * up to max threads, every run starts from fresh sai_api_initialize and
+ * ends with sai_redis_sync, so all operations were written to redis.
+ *
+ * Needs running redis, endpoint is taken from profile options:
+ *
+ * threads_bench [-t max_threads] [-n routes_per_thread] [-c pool_size]
+ *               [-a] [-s unix_socket]
+ *
+ * Pool size 0 uses one connection per thread.
+ */
+
+#define BENCH_DEFAULT_ROUTES    20000
+
+static std::map<std::string, std::string> g_profile;
+
+const char* bench_profile_get_value(
+        _In_ sai_switch_profile_id_t profile_id,
+        _In_ const char* variable)
+{
+    auto it = g_profile.find(variable);
+
+    return (it == g_profile.end()) ? NULL : it->second.c_str();
+}
+
+int bench_profile_get_next_value(
+        _In_ sai_switch_profile_id_t profile_id,
+        _Out_ const char** variable,
+        _Out_ const char** value)
+{
+    return -1;
+}
+
+static const service_method_table_t g_bench_services = {
+    bench_profile_get_value,
+    bench_profile_get_next_value
+};
+
+static void bench_thread(
+        _In_ const sai_route_api_t *route_api,
+        _In_ uint32_t thread_index,
+        _In_ uint32_t routes,
+        _Out_ uint32_t *errors)
+{
+    sai_unicast_route_entry_t route;
+
+    memset(&route, 0, sizeof(route));
+
+    route.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+    route.destination.mask.ip4 = 0xffffffff;
+
+    sai_attribute_t attr;
+
+    attr.id = SAI_ROUTE_ATTR_NEXT_HOP_ID;
+    attr.value.oid = 0x1;
+
+    *errors = 0;
+
+    // threads use disjoint prefixes, so they never share key
+
+    for (uint32_t i = 0; i < routes; i++)
+    {
+        route.destination.addr.ip4 = (thread_index << 24) | i;
+
+        *errors += (route_api->create_route(&route, 1, &attr) != SAI_STATUS_SUCCESS);
+    }
+
+    for (uint32_t i = 0; i < routes; i++)
+    {
+        route.destination.addr.ip4 = (thread_index << 24) | i;
+
+        *errors += (route_api->remove_route(&route) != SAI_STATUS_SUCCESS);
+    }
+}
+
+static int bench_run(
+        _In_ uint32_t threads,
+        _In_ uint32_t routes,
+        _In_ uint32_t pool_size,
+        _Out_ double &ops_per_second)
+{
+    g_profile[SAI_REDIS_KEY_CONNECTION_POOL_SIZE] = std::to_string(pool_size == 0 ? threads : pool_size);
+
+    if (sai_api_initialize(0, &g_bench_services) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "sai_api_initialize failed\n");
+        return 1;
+    }
+
+    sai_route_api_t *route_api;
+
+    if (sai_api_query(SAI_API_ROUTE, (void**)&route_api) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "sai_api_query failed\n");
+        return 1;
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<uint32_t> errors(threads);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back(bench_thread, route_api, t + 1, routes, &errors[t]);
+    }
+
+    for (auto &worker: workers)
+    {
+        worker.join();
+    }
+
+    sai_status_t status = sai_redis_sync();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    sai_api_uninitialize();
+
+    uint32_t total_errors = 0;
+
+    for (auto e: errors)
+    {
+        total_errors += e;
+    }
+
+    if (status != SAI_STATUS_SUCCESS || total_errors != 0)
+    {
+        fprintf(stderr, "%u threads: %u failed operations, sync status %d\n", threads, total_errors, status);
+        return 1;
+    }
+
+    ops_per_second = (2.0 * routes * threads) / seconds;
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t routes = BENCH_DEFAULT_ROUTES;
+    uint32_t pool_size = 0;
+
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:c:as:")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': max_threads = (uint32_t)atoi(optarg); break;
+            case 'n': routes = (uint32_t)atoi(optarg); break;
+            case 'c': pool_size = (uint32_t)atoi(optarg); break;
+            case 'a': g_profile[SAI_REDIS_KEY_ASYNC_MODE] = "true"; break;
+            case 's': g_profile[SAI_REDIS_KEY_UNIX_SOCKET] = optarg; break;
+
+            default:
+                fprintf(stderr, "usage: %s [-t max_threads] [-n routes_per_thread] [-c pool_size] [-a] [-s unix_socket]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (max_threads == 0 || routes == 0 || routes > 0xffffff || max_threads > 0xff)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    printf("%8s %14s %10s %12s\n", "threads", "ops/s", "speedup", "efficiency");
+
+    double single = 0;
+
+    for (uint32_t threads = 1; ; threads = std::min(threads * 2, max_threads))
+    {
+        double ops_per_second;
+
+        if (bench_run(threads, routes, pool_size, ops_per_second) != 0)
+        {
+            return 1;
+        }
+
+        if (threads == 1)
+        {
+            single = ops_per_second;
+        }
+
+        double speedup = ops_per_second / single;
+
+        printf("%8u %14.0f %10.2f %11.0f%%\n", threads, ops_per_second, speedup, 100.0 * speedup / threads);
+
+        if (threads == max_threads)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,394 @@
+#include "syncd_vid_rid_map.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <map>
+#include <random>
+#include <vector>
+
+/*
+ * Checks VID/RID map of syncd against std::map: lookups across probe
+ * collisions, erase in the middle of probe chain and at end of table,
+ * growing past load factor, save and load round trip, and rejecting
+ * file of other version or truncated file.
+ */
+
+#define TEST_MIN_CAPACITY       1024
+#define TEST_COLLISIONS         8
+#define TEST_GROW_COUNT         100000
+#define TEST_RANDOM_OPERATIONS  200000
+
+static const char *g_path = "vid_rid_map_test.bin";
+
+static sai_object_id_t test_vid(
+        _In_ sai_object_type_t object_type,
+        _In_ uint64_t index)
+{
+    return ((sai_object_id_t)object_type << 48) | index;
+}
+
+// same hash as map table, to pick ids which collide
+static size_t test_home_slot(
+        _In_ sai_object_id_t key)
+{
+    uint64_t x = key;
+
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+
+    return (size_t)x & (TEST_MIN_CAPACITY - 1);
+}
+
+static std::vector<sai_object_id_t> test_colliding_vids(
+        _In_ size_t home,
+        _In_ size_t count)
+{
+    std::vector<sai_object_id_t> vids;
+
+    for (uint64_t index = 1; vids.size() < count; index++)
+    {
+        sai_object_id_t vid = test_vid(SAI_OBJECT_TYPE_NEXT_HOP, index);
+
+        if (test_home_slot(vid) == home)
+        {
+            vids.push_back(vid);
+        }
+    }
+
+    return vids;
+}
+
+static int test_check(
+        _In_ const char *name,
+        _In_ const VidRidMap &map,
+        _In_ const std::map<sai_object_id_t, sai_object_id_t> &expected)
+{
+    if (map.size() != expected.size())
+    {
+        fprintf(stderr, "%s: size %zu, expected %zu\n", name, map.size(), expected.size());
+        return 1;
+    }
+
+    for (const auto &kv: expected)
+    {
+        if (map.getRid(kv.first) != kv.second || map.getVid(kv.second) != kv.first)
+        {
+            fprintf(stderr, "%s: vid 0x%lx maps to rid 0x%lx, rid maps to vid 0x%lx, expected rid 0x%lx\n",
+                    name, kv.first, map.getRid(kv.first), map.getVid(kv.second), kv.second);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_collisions()
+{
+    int errors = 0;
+
+    // chain in the middle of table and chain which wraps around its end
+    const size_t homes[] = { 100, TEST_MIN_CAPACITY - 2 };
+
+    for (size_t home: homes)
+    {
+        std::vector<sai_object_id_t> vids = test_colliding_vids(home, TEST_COLLISIONS);
+
+        VidRidMap map;
+
+        std::map<sai_object_id_t, sai_object_id_t> expected;
+
+        for (size_t i = 0; i < vids.size(); i++)
+        {
+            map.insert(vids[i], 0x1000 + i);
+            expected[vids[i]] = 0x1000 + i;
+        }
+
+        errors += test_check("insert colliding", map, expected);
+
+        // missing id with same home slot walks whole chain
+        if (map.getRid(test_colliding_vids(home, TEST_COLLISIONS + 1).back()) != SAI_NULL_OBJECT_ID)
+        {
+            fprintf(stderr, "missing vid found in chain at %zu\n", home);
+            errors++;
+        }
+
+        // erase in the middle, entries after it shift back
+        for (size_t i = 1; i < vids.size(); i += 2)
+        {
+            if (!map.erase(vids[i]))
+            {
+                fprintf(stderr, "erase of vid 0x%lx failed\n", vids[i]);
+                errors++;
+            }
+
+            expected.erase(vids[i]);
+
+            errors += test_check("erase in chain", map, expected);
+        }
+
+        if (map.erase(vids[1]))
+        {
+            fprintf(stderr, "erase of erased vid succeeded\n");
+            errors++;
+        }
+
+        // reinsert into holes, then erase head of chain
+        for (size_t i = 1; i < vids.size(); i += 2)
+        {
+            map.insert(vids[i], 0x2000 + i);
+            expected[vids[i]] = 0x2000 + i;
+        }
+
+        map.erase(vids[0]);
+        expected.erase(vids[0]);
+
+        errors += test_check("erase head of chain", map, expected);
+    }
+
+    return errors;
+}
+
+static int test_replace()
+{
+    VidRidMap map;
+
+    map.insert(test_vid(SAI_OBJECT_TYPE_PORT, 1), 0x100);
+    map.insert(test_vid(SAI_OBJECT_TYPE_PORT, 2), 0x200);
+
+    // SAI reuses rid of removed object, old vid is dropped
+    map.insert(test_vid(SAI_OBJECT_TYPE_PORT, 3), 0x100);
+
+    // vid gets other rid, old rid is dropped
+    map.insert(test_vid(SAI_OBJECT_TYPE_PORT, 2), 0x300);
+
+    std::map<sai_object_id_t, sai_object_id_t> expected = {
+        { test_vid(SAI_OBJECT_TYPE_PORT, 2), 0x300 },
+        { test_vid(SAI_OBJECT_TYPE_PORT, 3), 0x100 },
+    };
+
+    int errors = test_check("replace", map, expected);
+
+    if (map.getVid(0x200) != SAI_NULL_OBJECT_ID || map.getRid(test_vid(SAI_OBJECT_TYPE_PORT, 1)) != SAI_NULL_OBJECT_ID)
+    {
+        fprintf(stderr, "replaced mapping is still present\n");
+        errors++;
+    }
+
+    if (map.getCount(SAI_OBJECT_TYPE_PORT) != 2)
+    {
+        fprintf(stderr, "port count %lu, expected 2\n", map.getCount(SAI_OBJECT_TYPE_PORT));
+        errors++;
+    }
+
+    return errors;
+}
+
+static int test_grow()
+{
+    VidRidMap map;
+
+    std::map<sai_object_id_t, sai_object_id_t> expected;
+
+    size_t memory = map.getMemoryUsage();
+
+    for (uint64_t i = 1; i <= TEST_GROW_COUNT; i++)
+    {
+        sai_object_id_t vid = test_vid(i % 2 ? SAI_OBJECT_TYPE_ROUTER_INTERFACE : SAI_OBJECT_TYPE_NEXT_HOP, i);
+
+        map.insert(vid, 0x100000 + i);
+        expected[vid] = 0x100000 + i;
+    }
+
+    int errors = test_check("grow", map, expected);
+
+    if (map.getMemoryUsage() <= memory)
+    {
+        fprintf(stderr, "map did not grow, %zu bytes\n", map.getMemoryUsage());
+        errors++;
+    }
+
+    if (map.getCount(SAI_OBJECT_TYPE_ROUTER_INTERFACE) + map.getCount(SAI_OBJECT_TYPE_NEXT_HOP) != TEST_GROW_COUNT)
+    {
+        fprintf(stderr, "counts by type don't add up to %d\n", TEST_GROW_COUNT);
+        errors++;
+    }
+
+    return errors;
+}
+
+static int test_random()
+{
+    VidRidMap map;
+
+    std::map<sai_object_id_t, sai_object_id_t> expected;
+    std::map<sai_object_id_t, sai_object_id_t> reverse;
+
+    std::mt19937_64 random(1);
+
+    for (int i = 0; i < TEST_RANDOM_OPERATIONS; i++)
+    {
+        sai_object_id_t vid = test_vid(SAI_OBJECT_TYPE_NEXT_HOP, 1 + random() % 5000);
+        sai_object_id_t rid = 1 + random() % 10000;
+
+        if (random() % 2)
+        {
+            if (expected.count(vid))
+            {
+                reverse.erase(expected[vid]);
+            }
+
+            if (reverse.count(rid))
+            {
+                expected.erase(reverse[rid]);
+            }
+
+            expected[vid] = rid;
+            reverse[rid] = vid;
+
+            map.insert(vid, rid);
+        }
+        else
+        {
+            bool mapped = expected.count(vid) != 0;
+
+            if (mapped)
+            {
+                reverse.erase(expected[vid]);
+                expected.erase(vid);
+            }
+
+            if (map.erase(vid) != mapped)
+            {
+                fprintf(stderr, "erase of vid 0x%lx returned %d\n", vid, !mapped);
+                return 1;
+            }
+        }
+    }
+
+    return test_check("random", map, expected);
+}
+
+static int test_save_load()
+{
+    VidRidMap map;
+
+    std::map<sai_object_id_t, sai_object_id_t> expected;
+
+    for (uint64_t i = 1; i <= 3000; i++)
+    {
+        map.insert(test_vid(SAI_OBJECT_TYPE_ROUTER_INTERFACE, i), 0x500000 + i);
+        expected[test_vid(SAI_OBJECT_TYPE_ROUTER_INTERFACE, i)] = 0x500000 + i;
+    }
+
+    map.setJournalPosition(7, 12345);
+
+    if (map.save(g_path) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "save failed\n");
+        return 1;
+    }
+
+    VidRidMap loaded;
+
+    if (loaded.load(g_path) != SAI_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "load failed\n");
+        return 1;
+    }
+
+    int errors = test_check("load", loaded, expected);
+
+    if (loaded.getJournalId() != 7 || loaded.getJournalSequence() != 12345)
+    {
+        fprintf(stderr, "loaded journal position %lu:%lu\n", loaded.getJournalId(), loaded.getJournalSequence());
+        errors++;
+    }
+
+    if (loaded.getCount(SAI_OBJECT_TYPE_ROUTER_INTERFACE) != expected.size())
+    {
+        fprintf(stderr, "loaded count %lu\n", loaded.getCount(SAI_OBJECT_TYPE_ROUTER_INTERFACE));
+        errors++;
+    }
+
+    // file of other version
+
+    FILE *file = fopen(g_path, "r+b");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "failed to open %s\n", g_path);
+        return errors + 1;
+    }
+
+    uint32_t version = SYNCD_VID_RID_MAP_VERSION - 1;
+
+    fseek(file, offsetof(syncd_vid_rid_map_header_t, version), SEEK_SET);
+    fwrite(&version, sizeof(version), 1, file);
+    fclose(file);
+
+    if (loaded.load(g_path) == SAI_STATUS_SUCCESS || loaded.size() != 0)
+    {
+        fprintf(stderr, "file of version %u loaded\n", version);
+        errors++;
+    }
+
+    // truncated in the middle of record, and inside header
+
+    map.save(g_path);
+
+    const off_t sizes[] = {
+        (off_t)(sizeof(syncd_vid_rid_map_header_t) + 16 * expected.size() - 8),
+        (off_t)(sizeof(syncd_vid_rid_map_header_t) - 1)
+    };
+
+    for (off_t size: sizes)
+    {
+        if (truncate(g_path, size) != 0)
+        {
+            fprintf(stderr, "failed to truncate %s\n", g_path);
+            return errors + 1;
+        }
+
+        if (loaded.load(g_path) == SAI_STATUS_SUCCESS || loaded.size() != 0)
+        {
+            fprintf(stderr, "file truncated to %ld bytes loaded\n", (long)size);
+            errors++;
+        }
+    }
+
+    // missing file is empty map
+    unlink(g_path);
+
+    if (loaded.load(g_path) != SAI_STATUS_SUCCESS || loaded.size() != 0)
+    {
+        fprintf(stderr, "missing file not loaded as empty map\n");
+        errors++;
+    }
+
+    return errors;
+}
+
+int main()
+{
+    int errors = test_collisions();
+
+    errors += test_replace();
+
+    errors += test_grow();
+
+    errors += test_random();
+
+    errors += test_save_load();
+
+    if (errors != 0)
+    {
+        fprintf(stderr, "%d errors\n", errors);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,445 @@
+#include "sai_redis_write_combiner.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+
+/*
+ * Feeds sequences of operations through write combiner the same way
+ * as pipeline appends them and checks emitted sequence: combined
+ * operations are dropped, all other keep their order, and applying
+ * emitted sequence gives same state as applying all operations.
+ */
+
+#define TEST_RANDOM_ITERATIONS  2000
+#define TEST_RANDOM_OPERATIONS  64
+
+static RedisOperation test_create(
+        _In_ const std::string &key,
+        _In_ sai_object_type_t object_type)
+{
+    return RedisOperation { key, "", "Screate", object_type, SAI_COMMON_API_CREATE, 0, false, 0, false, 0 };
+}
+
+static RedisOperation test_set(
+        _In_ const std::string &key,
+        _In_ sai_object_type_t object_type,
+        _In_ sai_attr_id_t attr_id,
+        _In_ const std::string &value)
+{
+    return RedisOperation { key, value, "Sset", object_type, SAI_COMMON_API_SET, attr_id, false, 0, false, 0 };
+}
+
+static RedisOperation test_remove(
+        _In_ const std::string &key,
+        _In_ sai_object_type_t object_type)
+{
+    return RedisOperation { key, "", "Dremove", object_type, SAI_COMMON_API_REMOVE, 0, false, 0, false, 0 };
+}
+
+/*
+ * Pending batch of pipeline, operations are combined when appended and
+ * written on flush, index of every operation in input is kept so order
+ * can be checked.
+ */
+class TestBatch
+{
+    public:
+
+        void append(
+                _In_ const RedisOperation &operation)
+        {
+            if (m_combiner.combine(m_pending, operation))
+            {
+                m_dropped.push_back(m_index++);
+                return;
+            }
+
+            m_pending.push_back(operation);
+            m_pendingIndexes.push_back(m_index++);
+        }
+
+        void flush()
+        {
+            for (size_t i = 0; i < m_pending.size(); ++i)
+            {
+                if (m_pending[i].dropped)
+                {
+                    m_dropped.push_back(m_pendingIndexes[i]);
+                    continue;
+                }
+
+                m_emitted.push_back(m_pending[i]);
+                m_emittedIndexes.push_back(m_pendingIndexes[i]);
+            }
+
+            m_pending.clear();
+            m_pendingIndexes.clear();
+
+            m_combiner.clear();
+        }
+
+        TestBatch():
+            m_index(0)
+        {
+        }
+
+        RedisWriteCombiner m_combiner;
+
+        std::vector<RedisOperation> m_pending;
+        std::vector<size_t> m_pendingIndexes;
+
+        std::vector<RedisOperation> m_emitted;
+        std::vector<size_t> m_emittedIndexes;
+
+        std::vector<size_t> m_dropped;
+
+        size_t m_index;
+};
+
+static std::vector<RedisOperation> test_run(
+        _In_ const std::vector<RedisOperation> &operations)
+{
+    TestBatch batch;
+
+    for (const auto &operation: operations)
+    {
+        batch.append(operation);
+    }
+
+    batch.flush();
+
+    return batch.m_emitted;
+}
+
+static std::string test_describe(
+        _In_ const std::vector<RedisOperation> &operations)
+{
+    std::string s;
+
+    for (const auto &operation: operations)
+    {
+        s += " " + operation.op + ":" + operation.key;
+
+        if (operation.api == SAI_COMMON_API_SET)
+        {
+            s += ":" + std::to_string(operation.attrId) + "=" + operation.value;
+        }
+    }
+
+    return s;
+}
+
+static int test_expect(
+        _In_ const char *name,
+        _In_ const std::vector<RedisOperation> &operations,
+        _In_ const std::vector<RedisOperation> &expected)
+{
+    std::vector<RedisOperation> emitted = test_run(operations);
+
+    std::string e = test_describe(expected);
+    std::string a = test_describe(emitted);
+
+    if (e != a)
+    {
+        fprintf(stderr, "%s: expected%s, emitted%s\n", name, e.c_str(), a.c_str());
+        return 1;
+    }
+
+    return 0;
+}
+
+static int test_sequences()
+{
+    const sai_object_type_t route = SAI_OBJECT_TYPE_ROUTE;
+    const sai_object_type_t port = SAI_OBJECT_TYPE_PORT;
+    const sai_object_type_t next_hop = SAI_OBJECT_TYPE_NEXT_HOP;
+
+    int errors = 0;
+
+    errors += test_expect("set then set keeps last",
+            { test_set("p1", port, 1, "a"), test_set("p1", port, 1, "b") },
+            { test_set("p1", port, 1, "b") });
+
+    errors += test_expect("sets of other attributes are kept",
+            { test_set("p1", port, 1, "a"), test_set("p1", port, 2, "b"), test_set("p2", port, 1, "c") },
+            { test_set("p1", port, 1, "a"), test_set("p1", port, 2, "b"), test_set("p2", port, 1, "c") });
+
+    errors += test_expect("set then remove keeps order",
+            { test_set("r1", route, 1, "a"), test_remove("r1", route) },
+            { test_set("r1", route, 1, "a"), test_remove("r1", route) });
+
+    errors += test_expect("create then sets stays ordered",
+            { test_create("r1", route), test_set("r1", route, 1, "a"), test_set("r1", route, 2, "b") },
+            { test_create("r1", route), test_set("r1", route, 1, "a"), test_set("r1", route, 2, "b") });
+
+    errors += test_expect("create then repeated set stays after create",
+            { test_create("r1", route), test_set("r1", route, 1, "a"), test_set("r1", route, 1, "b") },
+            { test_create("r1", route), test_set("r1", route, 1, "b") });
+
+    errors += test_expect("create, set and remove of entry are dropped",
+            { test_set("p1", port, 1, "a"), test_create("r1", route), test_set("r1", route, 1, "a"), test_remove("r1", route), test_set("p1", port, 2, "b") },
+            { test_set("p1", port, 1, "a"), test_set("p1", port, 2, "b") });
+
+    errors += test_expect("create, remove, create keeps last create",
+            { test_create("r1", route), test_remove("r1", route), test_create("r1", route), test_set("r1", route, 1, "a") },
+            { test_create("r1", route), test_set("r1", route, 1, "a") });
+
+    errors += test_expect("create and remove of object are kept",
+            { test_create("nh1", next_hop), test_remove("nh1", next_hop) },
+            { test_create("nh1", next_hop), test_remove("nh1", next_hop) });
+
+    errors += test_expect("sets are not combined across remove",
+            { test_set("r1", route, 1, "nh1"), test_remove("nh1", next_hop), test_set("r1", route, 1, "nh2") },
+            { test_set("r1", route, 1, "nh1"), test_remove("nh1", next_hop), test_set("r1", route, 1, "nh2") });
+
+    errors += test_expect("sets after remove are combined",
+            { test_remove("nh1", next_hop), test_set("r1", route, 1, "a"), test_set("r1", route, 1, "b") },
+            { test_remove("nh1", next_hop), test_set("r1", route, 1, "b") });
+
+    errors += test_expect("remove of entry created in earlier batch is kept",
+            { test_remove("r1", route), test_create("r1", route), test_remove("r1", route) },
+            { test_remove("r1", route) });
+
+    return errors;
+}
+
+static int test_clear()
+{
+    TestBatch batch;
+
+    batch.append(test_create("r1", SAI_OBJECT_TYPE_ROUTE));
+    batch.append(test_set("p1", SAI_OBJECT_TYPE_PORT, 1, "a"));
+
+    batch.flush();
+
+    // nothing of previous batch is pending, so nothing can be combined
+    batch.append(test_set("p1", SAI_OBJECT_TYPE_PORT, 1, "b"));
+    batch.append(test_remove("r1", SAI_OBJECT_TYPE_ROUTE));
+
+    batch.flush();
+
+    if (batch.m_emitted.size() != 4 || !batch.m_dropped.empty())
+    {
+        fprintf(stderr, "combined across batches:%s\n", test_describe(batch.m_emitted).c_str());
+        return 1;
+    }
+
+    if (batch.m_combiner.getCoalescedCount() != 0)
+    {
+        fprintf(stderr, "coalesced count %lu, expected 0\n", batch.m_combiner.getCoalescedCount());
+        return 1;
+    }
+
+    return 0;
+}
+
+typedef std::map<std::string, std::map<sai_attr_id_t, std::string>> TestState;
+
+static void test_apply(
+        _In_ const std::vector<RedisOperation> &operations,
+        _Inout_ TestState &state)
+{
+    for (const auto &operation: operations)
+    {
+        switch (operation.api)
+        {
+            case SAI_COMMON_API_CREATE:
+                state[operation.key].clear();
+                break;
+
+            case SAI_COMMON_API_SET:
+                state[operation.key][operation.attrId] = operation.value;
+                break;
+
+            case SAI_COMMON_API_REMOVE:
+                state.erase(operation.key);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+static int test_random_sequence(
+        _In_ unsigned int seed)
+{
+    srand(seed);
+
+    const char *keys[] = { "r1", "r2", "n1", "nh1", "nh2" };
+    const sai_object_type_t types[] = {
+        SAI_OBJECT_TYPE_ROUTE,
+        SAI_OBJECT_TYPE_ROUTE,
+        SAI_OBJECT_TYPE_NEIGHBOR,
+        SAI_OBJECT_TYPE_NEXT_HOP,
+        SAI_OBJECT_TYPE_NEXT_HOP
+    };
+
+    const size_t objects = sizeof(keys) / sizeof(keys[0]);
+
+    std::set<size_t> created;
+
+    std::vector<RedisOperation> operations;
+
+    TestBatch batch;
+
+    for (int i = 0; i < TEST_RANDOM_OPERATIONS; ++i)
+    {
+        size_t object = rand() % objects;
+
+        RedisOperation operation;
+
+        if (created.find(object) == created.end())
+        {
+            operation = test_create(keys[object], types[object]);
+            created.insert(object);
+        }
+        else if (rand() % 4 == 0)
+        {
+            operation = test_remove(keys[object], types[object]);
+            created.erase(object);
+        }
+        else
+        {
+            operation = test_set(keys[object], types[object], rand() % 3, std::to_string(i));
+        }
+
+        operations.push_back(operation);
+
+        batch.append(operation);
+
+        if (rand() % 16 == 0)
+        {
+            batch.flush();
+        }
+    }
+
+    batch.flush();
+
+    TestState expected;
+    TestState actual;
+
+    test_apply(operations, expected);
+    test_apply(batch.m_emitted, actual);
+
+    if (expected != actual)
+    {
+        fprintf(stderr, "seed %u: state differs, input%s, emitted%s\n",
+                seed, test_describe(operations).c_str(), test_describe(batch.m_emitted).c_str());
+        return 1;
+    }
+
+    for (size_t i = 1; i < batch.m_emittedIndexes.size(); ++i)
+    {
+        if (batch.m_emittedIndexes[i - 1] >= batch.m_emittedIndexes[i])
+        {
+            fprintf(stderr, "seed %u: operation %zu emitted after %zu\n",
+                    seed, batch.m_emittedIndexes[i - 1], batch.m_emittedIndexes[i]);
+            return 1;
+        }
+    }
+
+    if (batch.m_emitted.size() + batch.m_dropped.size() != operations.size() ||
+            batch.m_dropped.size() != batch.m_combiner.getCoalescedCount())
+    {
+        fprintf(stderr, "seed %u: %zu emitted, %zu dropped of %zu, coalesced count %lu\n",
+                seed, batch.m_emitted.size(), batch.m_dropped.size(), operations.size(),
+                batch.m_combiner.getCoalescedCount());
+        return 1;
+    }
+
+    // set may be replaced only by later set of same attribute with no
+    // remove written between them, unless it belongs to dropped entry
+
+    std::set<size_t> emitted(batch.m_emittedIndexes.begin(), batch.m_emittedIndexes.end());
+
+    for (size_t dropped: batch.m_dropped)
+    {
+        const RedisOperation &operation = operations[dropped];
+
+        if (operation.api != SAI_COMMON_API_SET)
+        {
+            continue;
+        }
+
+        size_t remove = operations.size();
+        size_t replaced = operations.size();
+
+        bool entry_dropped = false;
+
+        for (size_t i = dropped + 1; i < operations.size(); ++i)
+        {
+            const RedisOperation &later = operations[i];
+
+            if (later.key == operation.key && later.api == SAI_COMMON_API_REMOVE)
+            {
+                // entry created and removed in same batch
+                entry_dropped = !emitted.count(i);
+                break;
+            }
+
+            if (later.api == SAI_COMMON_API_REMOVE && emitted.count(i) && remove == operations.size())
+            {
+                remove = i;
+            }
+
+            if (later.key == operation.key && later.api == SAI_COMMON_API_SET &&
+                    later.attrId == operation.attrId && replaced == operations.size())
+            {
+                replaced = i;
+            }
+        }
+
+        if (entry_dropped)
+        {
+            continue;
+        }
+
+        if (replaced == operations.size())
+        {
+            fprintf(stderr, "seed %u: set %zu dropped but not replaced\n", seed, dropped);
+            return 1;
+        }
+
+        if (remove < replaced)
+        {
+            fprintf(stderr, "seed %u: set %zu combined with %zu across remove %zu\n", seed, dropped, replaced, remove);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_random()
+{
+    int errors = 0;
+
+    for (unsigned int seed = 1; seed <= TEST_RANDOM_ITERATIONS && errors == 0; ++seed)
+    {
+        errors += test_random_sequence(seed);
+    }
+
+    return errors;
+}
+
+int main()
+{
+    int errors = test_sequences();
+
+    errors += test_clear();
+
+    errors += test_random();
+
+    if (errors != 0)
+    {
+        fprintf(stderr, "%d errors\n", errors);
+        return 1;
+    }
+
+    return 0;
+}